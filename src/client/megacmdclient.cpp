@@ -62,6 +62,9 @@ namespace  megacmd {
 using namespace std;
 void printprogress(long long completed, long long total, const char *title = "TRANSFERRING");
 
+static bool alreadyFinished = false; //flag to show progress
+static float percentDowloaded = 0.0; // to show progress
+
 #ifdef _WIN32
 // convert UTF-8 to Windows Unicode
 void path2local(string* path, string* local)
@@ -235,8 +238,13 @@ string parseArgs(int argc, char* argv[], MegaCmdShellCommunications& comsManager
 
         if (!strcmp(argv[1],"get")
                 || !strcmp(argv[1],"put")
+                || !strcmp(argv[1],"manifest")
+                || !strcmp(argv[1],"storage-report")
+                || !strcmp(argv[1],"rm")
+                || !strcmp(argv[1],"mv")
                 || !strcmp(argv[1],"login")
-                || !strcmp(argv[1],"reload") )
+                || !strcmp(argv[1],"reload")
+                || !strcmp(argv[1],"sync-issues") )
         {
             auto clientIdOpt = comsManager.tryToGetClientId();
             if (clientIdOpt)
@@ -324,6 +332,25 @@ string parseArgs(int argc, char* argv[], MegaCmdShellCommunications& comsManager
                 }
             }
         }
+        else if (!strcmp(argv[1],"manifest")) //localpath args, unless they are manifest ids
+        {
+            bool idArgs = false;
+            for (int i = 2; i < argc; i++)
+            {
+                idArgs = idArgs || !strcmp(argv[i], "-d") || !strcmp(argv[i], "--resume");
+            }
+            for (int i = 2; i < argc; i++)
+            {
+                if (!idArgs && strlen(argv[i]) && argv[i][0] !='-' )
+                {
+                    absolutedargs.push_back(getAbsPath(argv[i]));
+                }
+                else
+                {
+                    absolutedargs.push_back(argv[i]);
+                }
+            }
+        }
         else if (!strcmp(argv[1],"lcd")) //localpath args
         {
             for (int i = 2; i < argc; i++)
@@ -338,6 +365,88 @@ string parseArgs(int argc, char* argv[], MegaCmdShellCommunications& comsManager
                 }
             }
         }
+        else if (!strcmp(argv[1],"export")) //the file with remote paths is local
+        {
+            const string fromFileOpt = "--from-file=";
+            for (int i = 2; i < argc; i++)
+            {
+                if (!strncmp(argv[i], fromFileOpt.c_str(), fromFileOpt.size()) && strlen(argv[i]) > fromFileOpt.size())
+                {
+                    absolutedargs.push_back(fromFileOpt + getAbsPath(argv[i] + fromFileOpt.size()));
+                }
+                else
+                {
+                    absolutedargs.push_back(argv[i]);
+                }
+            }
+        }
+        else if (!strcmp(argv[1],"storage-report")) //the report file is local
+        {
+            const string reportOpt = "--report=";
+            for (int i = 2; i < argc; i++)
+            {
+                if (!strncmp(argv[i], reportOpt.c_str(), reportOpt.size()) && strlen(argv[i]) > reportOpt.size())
+                {
+                    absolutedargs.push_back(reportOpt + getAbsPath(argv[i] + reportOpt.size()));
+                }
+                else
+                {
+                    absolutedargs.push_back(argv[i]);
+                }
+            }
+        }
+        else if (!strcmp(argv[1],"sync-ignore")) //the file with filters or paths is local, or "-" to read them from stdin
+        {
+            const string fromFileOpt = "--from-file=";
+            vector<string> words;
+            bool readFromStdin = false;
+            bool optionsEnded = false;
+            for (int i = 2; i < argc; i++)
+            {
+                if (!optionsEnded && !strcmp(argv[i], "--"))
+                {
+                    optionsEnded = true;
+                }
+                else if (!optionsEnded && fromFileOpt + "-" == argv[i])
+                {
+                    readFromStdin = true;
+                }
+                else if (!optionsEnded && !strncmp(argv[i], fromFileOpt.c_str(), fromFileOpt.size()) && strlen(argv[i]) > fromFileOpt.size())
+                {
+                    absolutedargs.push_back(fromFileOpt + getAbsPath(argv[i] + fromFileOpt.size()));
+                }
+                else if (!optionsEnded && strlen(argv[i]) && argv[i][0] == '-')
+                {
+                    absolutedargs.push_back(argv[i]);
+                }
+                else
+                {
+                    words.push_back(argv[i]);
+                }
+            }
+
+            // Lines read from stdin go before the last word (the sync), after "--" so that filters starting with '-' are not taken as options
+            if (readFromStdin && !words.empty())
+            {
+                string syncWord = words.back();
+                words.pop_back();
+                for (string line; getline(cin, line);)
+                {
+                    if (!line.empty() && line.back() == '\r')
+                    {
+                        line.pop_back();
+                    }
+                    if (!line.empty())
+                    {
+                        words.push_back(line);
+                    }
+                }
+                words.push_back(syncWord);
+            }
+
+            absolutedargs.push_back("--");
+            absolutedargs.insert(absolutedargs.end(), words.begin(), words.end());
+        }
         else if (!strcmp(argv[1],"get") || !strcmp(argv[1],"preview") || !strcmp(argv[1],"thumbnail"))
         {
             for (int i = 2; i < argc; i++)
@@ -464,8 +573,13 @@ wstring parsewArgs(int argc, wchar_t* argv[], MegaCmdShellCommunications& comsMa
 
         if (!wcscmp(argv[1],L"get")
                 || !wcscmp(argv[1],L"put")
+                || !wcscmp(argv[1],L"manifest")
+                || !wcscmp(argv[1],L"storage-report")
+                || !wcscmp(argv[1],L"rm")
+                || !wcscmp(argv[1],L"mv")
                 || !wcscmp(argv[1],L"login")
-                || !wcscmp(argv[1],L"reload") )
+                || !wcscmp(argv[1],L"reload")
+                || !wcscmp(argv[1],L"sync-issues") )
         {
             auto clientIdOpt = comsManager.tryToGetClientId();
             if (clientIdOpt)
@@ -556,6 +670,25 @@ wstring parsewArgs(int argc, wchar_t* argv[], MegaCmdShellCommunications& comsMa
                 }
             }
         }
+        else if (!wcscmp(argv[1],L"manifest")) //localpath args, unless they are manifest ids
+        {
+            bool idArgs = false;
+            for (int i = 2; i < argc; i++)
+            {
+                idArgs = idArgs || !wcscmp(argv[i], L"-d") || !wcscmp(argv[i], L"--resume");
+            }
+            for (int i = 2; i < argc; i++)
+            {
+                if (!idArgs && wcslen(argv[i]) && argv[i][0] !='-' )
+                {
+                    absolutedargs.push_back(getWAbsPath(argv[i]));
+                }
+                else
+                {
+                    absolutedargs.push_back(argv[i]);
+                }
+            }
+        }
         else if (!wcscmp(argv[1],L"lcd")) //localpath args
         {
             for (int i = 2; i < argc; i++)
@@ -570,6 +703,88 @@ wstring parsewArgs(int argc, wchar_t* argv[], MegaCmdShellCommunications& comsMa
                 }
             }
         }
+        else if (!wcscmp(argv[1],L"export")) //the file with remote paths is local
+        {
+            const wstring fromFileOpt = L"--from-file=";
+            for (int i = 2; i < argc; i++)
+            {
+                if (!wcsncmp(argv[i], fromFileOpt.c_str(), fromFileOpt.size()) && wcslen(argv[i]) > fromFileOpt.size())
+                {
+                    absolutedargs.push_back(fromFileOpt + getWAbsPath(argv[i] + fromFileOpt.size()));
+                }
+                else
+                {
+                    absolutedargs.push_back(argv[i]);
+                }
+            }
+        }
+        else if (!wcscmp(argv[1],L"storage-report")) //the report file is local
+        {
+            const wstring reportOpt = L"--report=";
+            for (int i = 2; i < argc; i++)
+            {
+                if (!wcsncmp(argv[i], reportOpt.c_str(), reportOpt.size()) && wcslen(argv[i]) > reportOpt.size())
+                {
+                    absolutedargs.push_back(reportOpt + getWAbsPath(argv[i] + reportOpt.size()));
+                }
+                else
+                {
+                    absolutedargs.push_back(argv[i]);
+                }
+            }
+        }
+        else if (!wcscmp(argv[1],L"sync-ignore")) //the file with filters or paths is local, or "-" to read them from stdin
+        {
+            const wstring fromFileOpt = L"--from-file=";
+            vector<wstring> words;
+            bool readFromStdin = false;
+            bool optionsEnded = false;
+            for (int i = 2; i < argc; i++)
+            {
+                if (!optionsEnded && !wcscmp(argv[i], L"--"))
+                {
+                    optionsEnded = true;
+                }
+                else if (!optionsEnded && fromFileOpt + L"-" == argv[i])
+                {
+                    readFromStdin = true;
+                }
+                else if (!optionsEnded && !wcsncmp(argv[i], fromFileOpt.c_str(), fromFileOpt.size()) && wcslen(argv[i]) > fromFileOpt.size())
+                {
+                    absolutedargs.push_back(fromFileOpt + getWAbsPath(argv[i] + fromFileOpt.size()));
+                }
+                else if (!optionsEnded && wcslen(argv[i]) && argv[i][0] == '-')
+                {
+                    absolutedargs.push_back(argv[i]);
+                }
+                else
+                {
+                    words.push_back(argv[i]);
+                }
+            }
+
+            // Lines read from stdin go before the last word (the sync), after "--" so that filters starting with '-' are not taken as options
+            if (readFromStdin && !words.empty())
+            {
+                wstring syncWord = words.back();
+                words.pop_back();
+                for (wstring line; getline(wcin, line);)
+                {
+                    if (!line.empty() && line.back() == L'\r')
+                    {
+                        line.pop_back();
+                    }
+                    if (!line.empty())
+                    {
+                        words.push_back(line);
+                    }
+                }
+                words.push_back(syncWord);
+            }
+
+            absolutedargs.push_back(L"--");
+            absolutedargs.insert(absolutedargs.end(), words.begin(), words.end());
+        }
         else if (!wcscmp(argv[1],L"get") || !wcscmp(argv[1],L"preview") || !wcscmp(argv[1],L"thumbnail"))
         {
             for (int i = 2; i < argc; i++)
@@ -670,9 +885,6 @@ std::string readresponse(const char *question)
 
 void printprogress(long long completed, long long total, const char *title)
 {
-    static bool alreadyFinished = false; //flag to show progress
-    static float percentDowloaded = 0.0;
-
     float oldpercent = percentDowloaded;
     if (total == 0)
     {
@@ -793,6 +1005,32 @@ void statechangehandle(string statestring, MegaCmdShellCommunications & comsMana
             std::string clientId = newstate.substr(strlen("clientID:"));
             comsManager.setClientIdPromise(clientId);
         }
+        else if (newstate.compare(0, strlen("syncissue:"), "syncissue:") == 0)
+        {
+            // syncissue:<added|removed|changed>:<ISSUE_ID>:<PARENT_SYNC_ID>:<REASON>
+            auto fields = split(newstate.substr(strlen("syncissue:")), ":");
+            if (fields.size() >= 4)
+            {
+                string reason = newstate.substr(strlen("syncissue:") + fields[0].size() + fields[1].size() + fields[2].size() + 3);
+
+                stringstream os;
+                if (shown_partial_progress)
+                {
+                    os << endl;
+                }
+                os << "Sync issue " << fields[0] << ": " << fields[1] << " (sync " << fields[2] << "): " << reason << endl;
+
+#ifdef _WIN32
+                wstring wbuffer;
+                stringtolocalw((const char*)os.str().data(),&wbuffer);
+                WindowsUtf8StdoutGuard utf8Guard;
+                OUTSTREAM << wbuffer << flush;
+#else
+                StdoutMutexGuard stdoutGuard;
+                OUTSTREAM << os.str() << flush;
+#endif
+            }
+        }
         else if (newstate.compare(0, strlen("progress:"), "progress:") == 0)
         {
             string rest = newstate.substr(strlen("progress:"));
@@ -825,6 +1063,28 @@ void statechangehandle(string statestring, MegaCmdShellCommunications & comsMana
             const char * progressTitle = title.empty() ? "TRANSFERRING" : title.c_str();
             printprogress(completed, charstoll(total.c_str()), progressTitle);
         }
+        else if (newstate.compare(0, strlen("readiness:"), "readiness:") == 0)
+        {
+            // readiness:<STATE>:<FETCHED_BYTES>:<TOTAL_BYTES>
+            auto fields = split(newstate.substr(strlen("readiness:")), ":");
+            if (fields.size() >= 3 && charstoll(fields[2].c_str()) > 0)
+            {
+                if (fields[0] == "FETCHING_NODES")
+                {
+                    shown_partial_progress = true;
+                    printprogress(charstoll(fields[1].c_str()), charstoll(fields[2].c_str()), "Fetching nodes");
+                }
+                else if (shown_partial_progress)
+                {
+                    shown_partial_progress = false;
+                    printprogress(PROGRESS_COMPLETE, charstoll(fields[2].c_str()), "Fetching nodes");
+
+                    // The command held meanwhile may show its own progress next
+                    alreadyFinished = false;
+                    percentDowloaded = 0.0;
+                }
+            }
+        }
         else if (newstate == "ack")
         {
             // do nothing, all good
@@ -839,7 +1099,7 @@ void statechangehandle(string statestring, MegaCmdShellCommunications & comsMana
             sleepMilliSeconds(1000);
         }
 
-        if (newstate.compare(0, strlen("progress:"), "progress:") != 0)
+        if (newstate.compare(0, strlen("progress:"), "progress:") != 0 && newstate.compare(0, strlen("readiness:"), "readiness:") != 0)
         {
             shown_partial_progress = false;
         }
@@ -929,6 +1189,13 @@ int executeClient(int argc, char* argv[], OUTSTREAMTYPE & outstream, OUTSTREAMTY
     int outcode = comms->executeCommand(parsedArgs, readresponse, outstream, errorOutput, false);
 #endif
 
+    // A subscription lasts as long as this client: keep printing the changes until interrupted or the server goes away
+    if (outcode == MCMD_OK && command == "sync-issues"
+            && std::any_of(argv + 2, argv + argc, [](const char* arg) { return !strcmp(arg, "--subscribe"); }))
+    {
+        comms->waitForStateListenerEnd();
+    }
+
     // do always return positive error codes (POSIX compliant)
     if (outcode < 0)
     {
@@ -105,6 +105,41 @@ void ComunicationsManager::informStateListenerByClientId(const string &s, int cl
     }
 }
 
+bool ComunicationsManager::setStateListenerSubscription(int clientID, const string &eventType, bool subscribe)
+{
+    std::lock_guard<std::recursive_mutex> g(mStateListenersMutex);
+    for (auto& stateListener : stateListenersPetitions)
+    {
+        if (clientID == stateListener->clientID)
+        {
+            if (subscribe)
+            {
+                stateListener->subscribedEventTypes.insert(eventType);
+            }
+            else
+            {
+                stateListener->subscribedEventTypes.erase(eventType);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void ComunicationsManager::informSubscribedStateListeners(const string &eventType, const string &s)
+{
+    std::lock_guard<std::recursive_mutex> g(mStateListenersMutex);
+    for (auto it = stateListenersPetitions.begin(); it != stateListenersPetitions.end();)
+    {
+        if ((*it)->subscribedEventTypes.count(eventType) && informStateListener(it->get(), s + (char) 0x1F) < 0)
+        {
+            it = stateListenersPetitions.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
 int ComunicationsManager::informStateListener(CmdPetition *inf, const string &s)
 {
     return 0;
@@ -22,6 +22,8 @@
 #include "megacmd.h"
 #include "megacmdcommonutils.h"
 
+#include <set>
+
 namespace megacmd {
 class CmdPetition
 {
@@ -32,6 +34,9 @@ public:
     int clientID = -27;
     bool clientDisconnected = false;
 
+    // Optional kinds of state changes this listener asked for (only meaningful for state listeners)
+    std::set<std::string> subscribedEventTypes;
+
     virtual ~CmdPetition() = default;
 
     void setLine(std::string_view line);
@@ -98,6 +103,15 @@ public:
 
     void informStateListenerByClientId(const std::string &s, int clientID);
 
+    /**
+     * @brief Subscribes (or unsubscribes) the state listener of a client to an optional type of state changes
+     * @returns false if there is no state listener for that client
+     */
+    bool setStateListenerSubscription(int clientID, const std::string &eventType, bool subscribe);
+
+    // Sends an status message only to the listeners subscribed to its type
+    void informSubscribedStateListeners(const std::string &eventType, const std::string &s);
+
     /**
      * @brief informStateListener
      * @param inf This contains the petition that originated the register. It should contain the implementation details that identify a listener
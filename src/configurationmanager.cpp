@@ -458,7 +458,7 @@ void ConfigurationManager::transitionLegacyExclusionRules(MegaApi& api)
 
     sendEvent(StatsManager::MegacmdEvent::TRANSITIONING_PRE_SRW_EXCLUSIONS, &api, false);
 
-    std::set<string> excludeFilters;
+    std::vector<string> excludeFilters;
     std::vector<string> excludePatterns;
     for (std::string line; getline(excludeFile, line);)
     {
@@ -474,7 +474,7 @@ void ConfigurationManager::transitionLegacyExclusionRules(MegaApi& api)
             LOG_warn << "Found invalid pattern \"" << line << "\" in legacy exclude file";
             continue;
         }
-        excludeFilters.insert(filter);
+        excludeFilters.push_back(filter);
     }
 
     // This ensures transition works for active syncs
@@ -972,13 +972,50 @@ ConfiguratorMegaApiHelper::ConfiguratorMegaApiHelper()
                                 std::nullopt/*megaApiGetter*/,
                                 validatorULL());
 
-    mConfigurators.emplace_back("exported_folders_sdks", "Number of additional SDK instances loaded at startup",
-                                "This controls the number of SDK instances that are created at startup in order to download or import contents from exported folder links. "
-                                "Default 5. Min 0. Max 20. If set to 0, you will not be able to download or import from folder links.",
-                                configSetterSyncULLCb([](MegaApi *api, auto value){ return true;/*TODO: implement reactiveness to value changes*/ }),
+    mConfigurators.emplace_back("exported_folders_sdks", "Max number of SDK instances used for folder links",
+                                "This controls the maximum number of SDK instances used to download or import contents from exported folder "
+                                "links. They are created when needed, and destroyed when they are not used for a while (see "
+                                "folder_links_reclaim). Default 5. Min 0. Max 20. If set to 0, you will not be able to download or import from "
+                                "folder links.",
+                                configSetterSyncULLCb([](MegaApi *api, auto value){ updateApiFoldersLimits([value](auto& limits) { limits.mMax = value; }); return true; }),
                                 confGetter,
                                 std::nullopt/*megaApiGetter*/,
                                 validatorULL(0, 20));
+
+    mConfigurators.emplace_back("folder_links_min_sdks", "Min number of SDK instances used for folder links",
+                                "This controls the number of SDK instances for folder links that are created at startup and never destroyed. "
+                                "Default 0. Max 20.",
+                                configSetterSyncULLCb([](MegaApi *api, auto value){ updateApiFoldersLimits([value](auto& limits) { limits.mMin = value; }); return true; }),
+                                confGetter,
+                                std::nullopt/*megaApiGetter*/,
+                                validatorULL(0, 20));
+
+    mConfigurators.emplace_back("folder_links_reclaim", "Seconds before an unused SDK instance for folder links is destroyed",
+                                "SDK instances for folder links that are not logged in and not used for this long are destroyed, keeping at "
+                                "least folder_links_min_sdks. Default 300. Max 86400.",
+                                configSetterSyncULLCb([](MegaApi *api, auto value){ updateApiFoldersLimits([value](auto& limits) { limits.mReclaimAfter = std::chrono::seconds(value); }); return true; }),
+                                confGetter,
+                                std::nullopt/*megaApiGetter*/,
+                                validatorULL(0, 86400));
+
+    mConfigurators.emplace_back("folder_links_idle_secs", "Seconds an idle SDK instance stays logged into a folder link",
+                                "After downloading or importing from a folder link, the SDK instance used stays logged into it, so that accessing "
+                                "the same folder link again does not need to fetch its nodes again. If it is not used for this long, it is logged out. "
+                                "Instances are also reused for other links, least recently used first. Default 300. Min 0 (always log out). Max 86400.",
+                                configSetterSyncULLCb([](MegaApi *api, auto value){ setApiFoldersIdleExpiry(std::chrono::seconds(value)); return true; }),
+                                confGetter,
+                                std::nullopt/*megaApiGetter*/,
+                                validatorULL(0, 86400));
+
+    mConfigurators.emplace_back("nodes_snapshot_mins", "Minutes between snapshots of the exported and shared nodes",
+                                "When set, the exported and shared nodes and the folder counts known by MEGAcmd are saved to disk this often "
+                                "(if they changed) and when the server stops. After a restart (or while the account reloads), \"export\" and \"share\" "
+                                "listings and \"du\" of folders given by their full path are answered from the latest snapshot while the account "
+                                "is still loading, flagged as such. Default 0 (no snapshots). Max 1440.",
+                                configSetterSyncULLCb([](MegaApi *api, auto value){ setNodesSnapshotInterval(std::chrono::minutes(value)); return true; }),
+                                confGetter,
+                                std::nullopt/*megaApiGetter*/,
+                                validatorULL(0, 1440));
 }
 
 const std::vector<ConfiguratorMegaApiHelper::ValueConfigurator> & ConfiguratorMegaApiHelper::getConfigurators()
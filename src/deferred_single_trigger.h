@@ -15,96 +15,81 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
-#include <thread>
 #include <mutex>
-#include <condition_variable>
-#include <cassert>
+#include <unordered_set>
 
 #include "megacmdcommonutils.h"
+#include "megacmd_timer_scheduler.h"
 
 class DeferredSingleTrigger
 {
-    std::unique_ptr<std::thread> mThread;
-    std::condition_variable mConditionVariable;
-    std::mutex mConditionVariableMutex;
-    std::mutex mThreadMutex;
-    bool mDestroyed;
-    size_t mCounter;
-    std::chrono::seconds mSecondsToWait;
-
-    size_t incrementCounter()
-    {
-        // Since the counter is used in the CV predicate, it must be protected with the CV mutex
-        std::unique_lock<std::mutex> lock(mConditionVariableMutex);
-        return ++mCounter;
-    }
-
-    void destroy()
-    {
-        // Since the destroyed flag is used in the CV predicate, it must be protected with the CV mutex
-        std::unique_lock<std::mutex> lock(mConditionVariableMutex);
-        assert(!mDestroyed);
-        mDestroyed = true;
-    }
+    using TimerScheduler = megacmd::TimerScheduler;
 
-    bool isDestroyed()
-    {
-        // Since the destroyed flag is used in the CV predicate, it must be protected with the CV mutex
-        std::unique_lock<std::mutex> lock(mConditionVariableMutex);
-        return mDestroyed;
-    }
-
-    std::unique_lock<std::mutex> ensureThreadIsStopped()
-    {
-        std::unique_lock<std::mutex> lock(mThreadMutex);
-        if (mThread)
-        {
-            mConditionVariable.notify_one();
-            mThread->join();
-            mThread.reset();
-        }
-        return lock;
-    }
+    std::mutex mMutex;
+    bool mDestroyed;
+    TimerScheduler::TimerId mTimerId;
+    // Timers whose callback may still be running: cancelling one that already started doesn't stop it
+    std::unordered_set<TimerScheduler::TimerId> mStartedTimerIds;
+    TimerScheduler::Clock::duration mDelay;
 
 public:
-    DeferredSingleTrigger(std::chrono::seconds secondsToWait) :
+    DeferredSingleTrigger(TimerScheduler::Clock::duration delay) :
         mDestroyed(false),
-        mCounter(0),
-        mSecondsToWait(secondsToWait) {}
+        mTimerId(0),
+        mDelay(delay) {}
 
     ~DeferredSingleTrigger()
     {
-        destroy();
-        ensureThreadIsStopped();
+        std::unordered_set<TimerScheduler::TimerId> timerIds;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDestroyed = true;
+            timerIds = mStartedTimerIds;
+            if (mTimerId)
+            {
+                timerIds.insert(mTimerId);
+            }
+        }
+
+        // Callbacks already running must finish before we're gone
+        for (auto timerId : timerIds)
+        {
+            TimerScheduler::getInstance().cancel(timerId, true);
+        }
     }
 
     template<typename CB>
     void triggerDeferredSingleShot(CB&& callback)
     {
-        const size_t id = incrementCounter();
-        std::unique_lock<std::mutex> lock = ensureThreadIsStopped();
-
-        if (isDestroyed())
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mDestroyed)
         {
-            // Without this check, we might spawn a new thread after the destructor is done
-            // (i.e., if the lock above is waiting on the destructor's lock)
             return;
         }
 
-        mThread.reset(new std::thread([this, id, FWD_CAPTURE(callback)] () {
-            std::unique_lock<std::mutex> lock(mConditionVariableMutex);
+        // Each trigger postpones the previous one; only the last one gets to run
+        auto& scheduler = TimerScheduler::getInstance();
+        if (mTimerId && !scheduler.cancel(mTimerId))
+        {
+            // Too late to cancel it: it's running, and will stop being tracked once it's done
+            mStartedTimerIds.insert(mTimerId);
+        }
 
-            bool cancelled = mConditionVariable.wait_for(lock, mSecondsToWait, [this, id]
-            {
-                assert(mCounter >= id);
-                return mDestroyed || id != mCounter;
-            });
+        // The callback can't run to completion before the id is set: it needs the lock held here
+        auto timerId = std::make_shared<TimerScheduler::TimerId>(0);
+        mTimerId = scheduler.schedule(mDelay, [this, timerId, FWD_CAPTURE(callback)] () mutable
+        {
+            callback();
 
-            if (!cancelled)
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStartedTimerIds.erase(*timerId);
+            if (mTimerId == *timerId)
             {
-                callback();
+                mTimerId = 0;
             }
-        }));
+        });
+        *timerId = mTimerId;
     }
 };
@@ -19,6 +19,9 @@
 #include "listeners.h"
 #include "configurationmanager.h"
 #include "megacmdutils.h"
+#include "megacmd_sync_metrics.h"
+#include "megacmd_fuse.h"
+#include "megacmd_readiness.h"
 
 #ifdef MEGACMD_TESTING_CODE
     #include "../tests/common/Instruments.h"
@@ -78,6 +81,12 @@ MegaCmdGlobalListener::MegaCmdGlobalListener(MegaCmdLogger *logger, MegaCmdSandb
 
 void MegaCmdGlobalListener::onNodesUpdate(MegaApi *api, MegaNodeList *nodes)
 {
+    if (sandboxCMD->cmdexecuter)
+    {
+        sandboxCMD->cmdexecuter->updateFolderInfoCache(nodes);
+        sandboxCMD->cmdexecuter->updateSharedNodesIndex(nodes);
+    }
+
     long long nfolders = 0;
     long long nfiles = 0;
     long long rfolders = 0;
@@ -393,7 +402,7 @@ void MegaCmdGlobalListener::onEvent(MegaApi *api, MegaEvent *event)
     }
     else if (event->getType() == MegaEvent::EVENT_NODES_CURRENT)
     {
-        sandboxCMD->mNodesCurrentPromise.fulfil();
+        Readiness::getInstance().onNodesCurrent();
     }
 }
 
@@ -516,6 +525,7 @@ void MegaCmdMegaListener::onBackupTemporaryError(MegaApi *api, MegaScheduledCopy
 void MegaCmdMegaListener::onSyncAdded(MegaApi *api, MegaSync *sync)
 {
     LOG_verbose << "Sync added: " << sync->getLocalFolder() << " to " << sync->getLastKnownMegaFolder();
+    SyncMetrics::getInstance().onSyncAdded(sync->getBackupId(), sync->getLocalFolder());
 
     if (!ConfigurationManager::getConfigurationValue("firstSyncConfigured", false))
     {
@@ -530,6 +540,8 @@ void MegaCmdMegaListener::onSyncAdded(MegaApi *api, MegaSync *sync)
 
 void MegaCmdMegaListener::onSyncStateChanged(MegaApi *api, MegaSync *sync)
 {
+    SyncMetrics::getInstance().onSyncStateChanged(sync->getBackupId(), sync->getLocalFolder());
+
     std::stringstream ss;
     ss << "Your sync " << sync->getLocalFolder() << " to: " << sync->getLastKnownMegaFolder()
     << " has transitioned to state " << syncRunStateStr(sync->getRunState());
@@ -550,30 +562,51 @@ void MegaCmdMegaListener::onSyncStateChanged(MegaApi *api, MegaSync *sync)
 void MegaCmdMegaListener::onSyncDeleted(MegaApi *api, MegaSync *sync)
 {
     LOG_verbose << "Sync deleted: " << sync->getLocalFolder() << " to " << sync->getLastKnownMegaFolder();
+    SyncMetrics::getInstance().onSyncDeleted(sync->getBackupId());
+}
+
+void MegaCmdMegaListener::onSyncStatsUpdated(MegaApi *api, MegaSyncStats *syncStats)
+{
+    SyncMetrics::getInstance().onScanningChanged(syncStats->getBackupId(), syncStats->isScanning());
 }
 
 void MegaCmdMegaListener::onMountAdded(mega::MegaApi* api, const char* path, int result)
 {
+#ifdef WITH_FUSE
+    FuseCommand::onMountEvent(path, FuseCommand::MountEvent::ADDED, result == MegaMount::SUCCESS);
+#endif
     onMountEvent("Added", "add", path, result);
 }
 
 void MegaCmdMegaListener::onMountRemoved(mega::MegaApi* api, const char* path, int result)
 {
+#ifdef WITH_FUSE
+    FuseCommand::onMountEvent(path, FuseCommand::MountEvent::REMOVED, result == MegaMount::SUCCESS);
+#endif
     onMountEvent("Removed", "remove", path, result);
 }
 
 void MegaCmdMegaListener::onMountChanged(mega::MegaApi* api, const char* path, int result)
 {
+#ifdef WITH_FUSE
+    FuseCommand::onMountEvent(path, FuseCommand::MountEvent::CHANGED, result == MegaMount::SUCCESS);
+#endif
     onMountEvent("Changed", "change", path, result);
 }
 
 void MegaCmdMegaListener::onMountEnabled(mega::MegaApi* api, const char* path, int result)
 {
+#ifdef WITH_FUSE
+    FuseCommand::onMountEvent(path, FuseCommand::MountEvent::ENABLED, result == MegaMount::SUCCESS);
+#endif
     onMountEvent("Enabled", "enable", path, result);
 }
 
 void MegaCmdMegaListener::onMountDisabled(mega::MegaApi* api, const char* path, int result)
 {
+#ifdef WITH_FUSE
+    FuseCommand::onMountEvent(path, FuseCommand::MountEvent::DISABLED, result == MegaMount::SUCCESS);
+#endif
     onMountEvent("Disabled", "disable", path, result);
 }
 
@@ -654,6 +687,8 @@ void MegaCmdListener::onRequestUpdate(MegaApi* api, MegaRequest *request)
 #ifdef MEGACMD_TESTING_CODE
         TestInstruments::Instance().fireEvent(TestInstruments::Event::FETCH_NODES_REQ_UPDATE);
 #endif
+            Readiness::getInstance().onFetchNodesProgress(request->getTransferredBytes(), request->getTotalBytes());
+
             unsigned int cols = getNumberOfCols(80);
             string outputString;
             outputString.resize(cols+1);
@@ -1199,8 +1234,22 @@ MegaCmdGlobalTransferListener::MegaCmdGlobalTransferListener(MegaApi *megaApi, M
     this->listener = parent;
 }
 
+void MegaCmdGlobalTransferListener::onTransferStart(MegaApi* api, MegaTransfer *transfer)
+{
+    mTransferIndex.onTransferStart(*transfer);
+    SyncMetrics::getInstance().onTransferStart(*transfer);
+}
+
+void MegaCmdGlobalTransferListener::onTransferUpdate(MegaApi* api, MegaTransfer *transfer)
+{
+    mTransferIndex.onTransferUpdate(*transfer);
+}
+
 void MegaCmdGlobalTransferListener::onTransferFinish(MegaApi* api, MegaTransfer *transfer, MegaError* error)
 {
+    mTransferIndex.onTransferFinish(*transfer);
+    SyncMetrics::getInstance().onTransferFinish(*transfer, error && error->getErrorCode() == MegaError::API_OK);
+
     completedTransfersMutex.lock();
     completedTransfers.push_front(transfer->copy());
 
@@ -1272,8 +1321,9 @@ bool MegaCmdCatTransferListener::onTransferData(MegaApi *api, MegaTransfer *tran
     return true;
 }
 
-ATransferListener::ATransferListener(const std::shared_ptr<MegaCmdMultiTransferListener> &mMultiTransferListener, const std::string &path)
-    : mMultiTransferListener(mMultiTransferListener), mPath(path)
+ATransferListener::ATransferListener(const std::shared_ptr<MegaCmdMultiTransferListener> &mMultiTransferListener, const std::string &path,
+                                     std::function<void(MegaTransfer*, MegaError*)> onFinishCb)
+    : mMultiTransferListener(mMultiTransferListener), mPath(path), mOnFinishCb(std::move(onFinishCb))
 {
     assert(mMultiTransferListener);
 }
@@ -1292,6 +1342,10 @@ void ATransferListener::onTransferStart(MegaApi *api, MegaTransfer *transfer)
 
 void ATransferListener::onTransferFinish(MegaApi *api, MegaTransfer *transfer, MegaError *e)
 {
+    if (mOnFinishCb)
+    {
+        mOnFinishCb(transfer, e);
+    }
     static_cast<MegaTransferListener *>(mMultiTransferListener.get())->onTransferFinish(api, transfer, e);
     delete this;
 }
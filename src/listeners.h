@@ -21,6 +21,7 @@
 
 #include "megacmdlogger.h"
 #include "megacmdsandbox.h"
+#include "megacmd_transfer_index.h"
 
 namespace megacmd {
 class MegaCmdSandbox;
@@ -195,9 +196,11 @@ class ATransferListener : public mega::MegaTransferListener
 private:
     std::shared_ptr<MegaCmdMultiTransferListener> mMultiTransferListener;  //the listener this belongs too
     const std::string mPath; //The path that originated the transfer
+    std::function<void(mega::MegaTransfer*, mega::MegaError*)> mOnFinishCb; //optional, called when this transfer finishes
 
 public:
-    ATransferListener(const std::shared_ptr<MegaCmdMultiTransferListener> &mMultiTransferListener, const std::string &path);
+    ATransferListener(const std::shared_ptr<MegaCmdMultiTransferListener> &mMultiTransferListener, const std::string &path,
+                      std::function<void(mega::MegaTransfer*, mega::MegaError*)> onFinishCb = nullptr);
     virtual ~ATransferListener();
 
     //Transfer callbacks
@@ -268,6 +271,7 @@ public:
     void onSyncAdded(mega::MegaApi *api, mega::MegaSync *sync) override;
     void onSyncStateChanged(mega::MegaApi *api, mega::MegaSync *sync) override;
     void onSyncDeleted(mega::MegaApi *api, mega::MegaSync *sync) override;
+    void onSyncStatsUpdated(mega::MegaApi *api, mega::MegaSyncStats *syncStats) override;
 
 protected:
     mega::MegaApi *megaApi;
@@ -280,6 +284,7 @@ class MegaCmdGlobalTransferListener : public mega::MegaTransferListener
 private:
     MegaCmdSandbox *sandboxCMD;
     static const int MAXCOMPLETEDTRANSFERSBUFFER;
+    TransferIndex mTransferIndex;
 
 public:
     std::mutex completedTransfersMutex;
@@ -290,10 +295,14 @@ public:
     virtual ~MegaCmdGlobalTransferListener();
 
     //Transfer callbacks
+    void onTransferStart(mega::MegaApi* api, mega::MegaTransfer *transfer);
+    void onTransferUpdate(mega::MegaApi* api, mega::MegaTransfer *transfer);
     void onTransferFinish(mega::MegaApi* api, mega::MegaTransfer *transfer, mega::MegaError* error);
     void onTransferTemporaryError(mega::MegaApi *api, mega::MegaTransfer *transfer, mega::MegaError* e);
     bool onTransferData(mega::MegaApi *api, mega::MegaTransfer *transfer, char *buffer, size_t size);
 
+    const TransferIndex& getTransferIndex() const { return mTransferIndex; }
+
 protected:
     mega::MegaApi *megaApi;
     mega::MegaTransferListener *listener;
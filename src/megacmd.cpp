@@ -28,6 +28,10 @@
 #include "comunicationsmanager.h"
 #include "listeners.h"
 #include "megacmd_fuse.h"
+#include "megacmd_folder_link_cache.h"
+#include "megacmd_readiness.h"
+#include "megacmd_startup_graph.h"
+#include "megacmd_timer_scheduler.h"
 #include "sync_command.h"
 
 #include "megacmdplatform.h"
@@ -111,10 +115,16 @@ MegaSemaphore semaphoreClients; //to limit max parallel petitions
 MegaApi *api = nullptr;
 
 //api objects for folderlinks
-std::queue<MegaApi *> apiFolders;
-std::vector<MegaApi *> occupiedapiFolders;
-MegaSemaphore semaphoreapiFolders;
-std::mutex mutexapiFolders;
+std::unique_ptr<FolderLinkApiCache> apiFolders;
+std::mutex mutexApiFoldersExpiry;
+std::optional<TimerScheduler::TimerId> apiFoldersExpiryTimer;
+FolderLinkApiCache::Clock::time_point apiFoldersExpiryDeadline;
+bool apiFoldersShuttingDown = false;
+// Expiry runs in its own thread, not in the timer's: logging out waits for the request,
+// and destroying an instance joins its threads
+std::thread apiFoldersExpiryThread;
+std::condition_variable apiFoldersExpiryCV;
+bool apiFoldersExpiryDue = false;
 
 MegaCmdLogger *loggerCMD;
 
@@ -324,6 +334,16 @@ void informStateListeners(string s)
     cm->informStateListeners(s);
 }
 
+bool setStateListenerSubscription(int clientID, const string &eventType, bool subscribe)
+{
+    return cm->setStateListenerSubscription(clientID, eventType, subscribe);
+}
+
+void informSubscribedStateListeners(const string &eventType, const string &s)
+{
+    cm->informSubscribedStateListeners(eventType, s);
+}
+
 void informStateListener(string message, int clientID)
 {
     string s;
@@ -392,9 +412,8 @@ void broadcastDelayedMessage(string message, bool keepIfNoListeners)
     if (!ongoing)
     {
         ongoing = true;
-        std::thread([keepIfNoListeners]()
+        TimerScheduler::getInstance().schedule(std::chrono::seconds(4), [keepIfNoListeners]()
         {
-            sleepSeconds(4);
             std::unique_lock<std::mutex> g(delayedBroadcastMutex);
             while (!delayedBroadCastMessages.empty())
             {
@@ -407,7 +426,7 @@ void broadcastDelayedMessage(string message, bool keepIfNoListeners)
             }
 
             ongoing = false;
-        }).detach();
+        });
     }
 }
 
@@ -458,6 +477,7 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validParams->insert("show-creation-time");
         validOptValues->insert("time-format");
         validParams->insert("tree");
+        validParams->insert("no-cache");
 #ifdef USE_PCRE
         validParams->insert("use-pcre");
 #endif
@@ -467,10 +487,20 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validParams->insert("f");
         validOptValues->insert("auth-code");
     }
+    else if ("storage-report" == thecommand)
+    {
+        validParams->insert("h");
+        validParams->insert("recursive");
+        validOptValues->insert("top");
+        validOptValues->insert("threads");
+        validOptValues->insert("report");
+        validOptValues->insert("clientID");
+    }
     else if ("du" == thecommand)
     {
         validParams->insert("h");
         validParams->insert("versions");
+        validParams->insert("no-cache");
         validOptValues->insert("path-display-size");
 #ifdef USE_PCRE
         validParams->insert("use-pcre");
@@ -500,12 +530,14 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
 #ifdef USE_PCRE
         validParams->insert("use-pcre");
 #endif
+        validOptValues->insert("clientID");
     }
     else if ("mv" == thecommand)
     {
 #ifdef USE_PCRE
         validParams->insert("use-pcre");
 #endif
+        validOptValues->insert("clientID");
     }
     else if ("cp" == thecommand)
     {
@@ -612,6 +644,10 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validParams->insert("delete");
 
         validParams->insert("show-handles");
+        validParams->insert("refresh");
+        validParams->insert("no-cache");
+        validParams->insert("stats");
+        validParams->insert("raw");
         validOptValues->insert("path-display-size");
         validOptValues->insert("col-separator");
         validOptValues->insert("output-cols");
@@ -632,7 +668,12 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validParams->insert("disable-path-collapse");
         validParams->insert("detail");
         validParams->insert("all");
+        validParams->insert("refresh");
+        validParams->insert("subscribe");
+        validParams->insert("unsubscribe");
+        validOptValues->insert("clientID");
         validOptValues->insert("limit");
+        validOptValues->insert("sync");
         validOptValues->insert("col-separator");
         validOptValues->insert("output-cols");
     }
@@ -643,6 +684,9 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validParams->insert("add-exclusion");
         validParams->insert("remove");
         validParams->insert("remove-exclusion");
+        validParams->insert("test");
+        validParams->insert("summary");
+        validOptValues->insert("from-file");
     }
     else if ("sync-config" == thecommand)
     {
@@ -661,6 +705,9 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validParams->insert("mega-hosted");
         validOptValues->insert("expire");
         validOptValues->insert("password");
+        validParams->insert("bulk");
+        validOptValues->insert("from-file");
+        validOptValues->insert("max-in-flight");
 #ifdef USE_PCRE
         validParams->insert("use-pcre");
 #endif
@@ -763,13 +810,25 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validParams->insert("c");
         validParams->insert("q");
         validParams->insert("print-tag-at-start");
+        validParams->insert("incremental");
         validParams->insert("ignore-quota-warn"); //deprecated: no use
         validOptValues->insert("clientID");
+        validOptValues->insert("scan-threads");
+    }
+    else if ("manifest" == thecommand)
+    {
+        validParams->insert("q");
+        validParams->insert("d");
+        validParams->insert("resume");
+        validOptValues->insert("clientID");
+        validOptValues->insert("col-separator");
+        validOptValues->insert("output-cols");
     }
     else if ("get" == thecommand)
     {
         validParams->insert("m");
         validParams->insert("q");
+        validParams->insert("incremental");
         validParams->insert("ignore-quota-warn");
         validOptValues->insert("password");
 #ifdef USE_PCRE
@@ -810,6 +869,8 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validParams->insert("p");
         validParams->insert("r");
         validOptValues->insert("limit");
+        validOptValues->insert("offset");
+        validOptValues->insert("sort");
         validOptValues->insert("path-display-size");
         validOptValues->insert("col-separator");
         validOptValues->insert("output-cols");
@@ -867,6 +928,9 @@ void insertValidParamsPerCommand(set<string> *validParams, string thecommand, se
         validOptValues->emplace("enable-at-startup");
         validOptValues->emplace("persistent");
         validOptValues->emplace("read-only");
+        validOptValues->emplace("inode-cache-size");
+        validOptValues->emplace("inode-cache-age");
+        validOptValues->emplace("flush-delay");
     }
 #endif
 #if defined(DEBUG) || defined(MEGACMD_TESTING_CODE)
@@ -1353,6 +1417,13 @@ completionfunction_t *getCompletionFunction(vector<string> words)
             return remotepaths_completion;
         }
     }
+    else if (thecommand == "manifest")
+    {
+        if (currentparameter == 1)
+        {
+            return local_completion;
+        }
+    }
     else if (thecommand == "backup")
     {
         if (currentparameter == 1)
@@ -1546,32 +1617,156 @@ string getListOfCompletionValues(vector<string> words, char separator = ' ', con
     return completionValues;
 }
 
-MegaApi* getFreeApiFolder()
+bool logoutFromFolderLink(MegaApi& apiFolder)
+{
+    auto megaCmdListener = std::make_unique<MegaCmdListener>(&apiFolder);
+    apiFolder.logout(false, megaCmdListener.get());
+    megaCmdListener->wait();
+    if (megaCmdListener->getError()->getErrorCode() != MegaError::API_OK)
+    {
+        LOG_err << "Couldn't logout from apiFolder";
+        return false;
+    }
+    return true;
+}
+
+void scheduleApiFoldersExpiry();
+
+void expireApiFoldersLoop()
 {
+    while (true)
     {
-        std::lock_guard g(mutexapiFolders);
-        if (apiFolders.empty() && occupiedapiFolders.empty())
         {
-            return nullptr;
+            std::unique_lock lock(mutexApiFoldersExpiry);
+            apiFoldersExpiryCV.wait(lock, []() { return apiFoldersExpiryDue || apiFoldersShuttingDown; });
+            if (apiFoldersShuttingDown)
+            {
+                return;
+            }
+            apiFoldersExpiryDue = false;
         }
+
+        if (auto expired = apiFolders->expireIdle(); expired)
+        {
+            const auto stats = apiFolders->getStats();
+            LOG_debug << "Logged out or destroyed " << expired << " idle folder link instance(s). "
+                      << stats.mInstances << " left (peak: " << stats.mPeakInstances << ")";
+        }
+        scheduleApiFoldersExpiry();
     }
+}
 
-    semaphoreapiFolders.wait();
-    mutexapiFolders.lock();
-    MegaApi* toret = apiFolders.front();
-    apiFolders.pop();
-    occupiedapiFolders.push_back(toret);
-    mutexapiFolders.unlock();
-    return toret;
+// Logs out the instances left idle for too long, and destroys the ones not needed anymore.
+// There is at most one timer, scheduled for the earliest deadline, which wakes the expiry thread up
+void scheduleApiFoldersExpiry()
+{
+    const auto nextExpiry = apiFolders->getNextExpiry();
+
+    std::lock_guard g(mutexApiFoldersExpiry);
+    if (!nextExpiry || apiFoldersShuttingDown)
+    {
+        return;
+    }
+
+    if (apiFoldersExpiryTimer)
+    {
+        // If it can't be cancelled it is running, and the expiry it triggers will schedule the next one
+        if (*nextExpiry >= apiFoldersExpiryDeadline || !TimerScheduler::getInstance().cancel(*apiFoldersExpiryTimer))
+        {
+            return;
+        }
+    }
+
+    if (!apiFoldersExpiryThread.joinable())
+    {
+        apiFoldersExpiryThread = std::thread(expireApiFoldersLoop);
+    }
+
+    const auto delay = std::max(*nextExpiry - FolderLinkApiCache::Clock::now(), FolderLinkApiCache::Clock::duration::zero());
+    apiFoldersExpiryDeadline = *nextExpiry;
+    apiFoldersExpiryTimer = TimerScheduler::getInstance().schedule(delay, []()
+    {
+        {
+            std::lock_guard g(mutexApiFoldersExpiry);
+            apiFoldersExpiryTimer.reset();
+            apiFoldersExpiryDue = true;
+        }
+        apiFoldersExpiryCV.notify_one();
+    });
 }
 
-void freeApiFolder(MegaApi *apiFolder)
+void stopApiFoldersExpiry()
 {
-    mutexapiFolders.lock();
-    occupiedapiFolders.erase(std::remove(occupiedapiFolders.begin(), occupiedapiFolders.end(), apiFolder), occupiedapiFolders.end());
-    apiFolders.push(apiFolder);
-    semaphoreapiFolders.release();
-    mutexapiFolders.unlock();
+    std::optional<TimerScheduler::TimerId> timer;
+    {
+        std::lock_guard g(mutexApiFoldersExpiry);
+        apiFoldersShuttingDown = true;
+        timer = apiFoldersExpiryTimer;
+    }
+    apiFoldersExpiryCV.notify_one();
+
+    if (timer)
+    {
+        TimerScheduler::getInstance().cancel(*timer, true /*waitIfRunning*/);
+    }
+
+    // It may be logging out or destroying instances, which must be done before they are all taken
+    if (apiFoldersExpiryThread.joinable())
+    {
+        apiFoldersExpiryThread.join();
+    }
+}
+
+MegaApi* getFreeApiFolder(const std::string& folderLink, bool& loggedIn)
+{
+    const auto lease = apiFolders->acquire(FolderLinkApiCache::getKey(folderLink));
+    loggedIn = lease.mHit;
+
+    if (lease.mApi)
+    {
+        const auto stats = apiFolders->getStats();
+        LOG_debug << "Folder link instance " << (lease.mHit ? "reused" : "not cached")
+                  << (lease.mWaited.count() ? " after waiting " + std::to_string(lease.mWaited.count()) + " ms for it" : "")
+                  << " (hits: " << stats.mHits << ", misses: " << stats.mMisses
+                  << ", evictions: " << stats.mEvictions << ", expirations: " << stats.mExpirations
+                  << ", logged in: " << stats.mBound << "/" << stats.mInstances
+                  << ", waits: " << stats.mWaits << ", total wait: " << stats.mTotalWait.count() << " ms"
+                  << ", max wait: " << stats.mMaxWait.count() << " ms)";
+    }
+    return lease.mApi;
+}
+
+void freeApiFolder(MegaApi *apiFolder, const std::string& folderLink, bool keepLoggedIn)
+{
+    apiFolders->release(apiFolder, FolderLinkApiCache::getKey(folderLink), keepLoggedIn);
+    scheduleApiFoldersExpiry();
+}
+
+void setApiFoldersIdleExpiry(std::chrono::seconds idleExpiry)
+{
+    if (apiFolders)
+    {
+        apiFolders->setIdleExpiry(idleExpiry);
+    }
+}
+
+void updateApiFoldersLimits(const std::function<void(FolderLinkApiCache::Limits&)>& update)
+{
+    if (apiFolders)
+    {
+        auto limits = apiFolders->getLimits();
+        update(limits);
+        apiFolders->setLimits(limits);
+        scheduleApiFoldersExpiry();
+    }
+}
+
+void setNodesSnapshotInterval(std::chrono::minutes interval)
+{
+    if (cmdexecuter)
+    {
+        cmdexecuter->setNodesSnapshotInterval(interval);
+    }
 }
 
 const char * getUsageStr(const char *command, const HelpFlags& flags)
@@ -1660,11 +1855,11 @@ const char * getUsageStr(const char *command, const HelpFlags& flags)
     {
         if (flags.usePcre || flags.showAll)
         {
-            return "ls [-halRr] [--show-handles] [--tree] [--versions] [remotepath] [--use-pcre] [--show-creation-time] [--time-format=FORMAT]";
+            return "ls [-halRr] [--show-handles] [--tree] [--versions] [--no-cache] [remotepath] [--use-pcre] [--show-creation-time] [--time-format=FORMAT]";
         }
         else
         {
-            return "ls [-halRr] [--show-handles] [--tree] [--versions] [remotepath] [--show-creation-time] [--time-format=FORMAT]";
+            return "ls [-halRr] [--show-handles] [--tree] [--versions] [--no-cache] [remotepath] [--show-creation-time] [--time-format=FORMAT]";
         }
     }
     if (!strcmp(command, "tree"))
@@ -1679,15 +1874,19 @@ const char * getUsageStr(const char *command, const HelpFlags& flags)
     {
         return "log [-sc] level";
     }
+    if (!strcmp(command, "storage-report"))
+    {
+        return "storage-report [-h] [--recursive] [--top=N] [--threads=N] [--report=localfile] [remotepath]";
+    }
     if (!strcmp(command, "du"))
     {
         if (flags.usePcre || flags.showAll)
         {
-            return "du [-h] [--versions] [remotepath remotepath2 remotepath3 ... ] [--use-pcre]";
+            return "du [-h] [--versions] [--no-cache] [remotepath remotepath2 remotepath3 ... ] [--use-pcre]";
         }
         else
         {
-            return "du [-h] [--versions] [remotepath remotepath2 remotepath3 ... ]";
+            return "du [-h] [--versions] [--no-cache] [remotepath remotepath2 remotepath3 ... ]";
         }
     }
     if (!strcmp(command, "pwd"))
@@ -1708,7 +1907,11 @@ const char * getUsageStr(const char *command, const HelpFlags& flags)
     }
     if (!strcmp(command, "put"))
     {
-        return "put  [-c] [-q] [--print-tag-at-start] localfile [localfile2 localfile3 ...] [dstremotepath]";
+        return "put  [-c] [-q] [--incremental] [--print-tag-at-start] [--scan-threads=N] localfile [localfile2 localfile3 ...] [dstremotepath]";
+    }
+    if (!strcmp(command, "manifest"))
+    {
+        return "manifest [-q] manifestfile | --resume [-q] [ID ...] | -d ID";
     }
     if (!strcmp(command, "putq"))
     {
@@ -1718,11 +1921,11 @@ const char * getUsageStr(const char *command, const HelpFlags& flags)
     {
         if (flags.usePcre || flags.showAll)
         {
-            return "get [-m] [-q] [--ignore-quota-warn] [--use-pcre] [--password=PASSWORD] exportedlink|remotepath [localpath]";
+            return "get [-m] [-q] [--incremental] [--ignore-quota-warn] [--use-pcre] [--password=PASSWORD] exportedlink|remotepath [localpath]";
         }
         else
         {
-            return "get [-m] [-q] [--ignore-quota-warn] [--password=PASSWORD] exportedlink|remotepath [localpath]";
+            return "get [-m] [-q] [--incremental] [--ignore-quota-warn] [--password=PASSWORD] exportedlink|remotepath [localpath]";
         }
     }
     if (!strcmp(command, "getq"))
@@ -1817,15 +2020,15 @@ const char * getUsageStr(const char *command, const HelpFlags& flags)
     }
     if (!strcmp(command, "sync"))
     {
-        return "sync [localpath dstremotepath| [-dpe] [ID|localpath]";
+        return "sync [localpath dstremotepath| [-dpe] [--refresh] [--no-cache] [ID|localpath] | --stats [--raw] [ID|localpath]]";
     }
     if (!strcmp(command, "sync-issues"))
     {
-        return "sync-issues [[--detail (ID|--all)] [--limit=rowcount] [--disable-path-collapse]] | [--enable-warning|--disable-warning]";
+        return "sync-issues [[--detail (ID|--all)] [--sync=ID|localpath] [--limit=rowcount] [--disable-path-collapse] [--refresh]] | [--enable-warning|--disable-warning] | [--subscribe|--unsubscribe]";
     }
     if (!strcmp(command, "sync-ignore"))
     {
-        return "sync-ignore [--show|[--add|--add-exclusion|--remove|--remove-exclusion] filter1 filter2 ...] (ID|localpath|DEFAULT)";
+        return "sync-ignore [--show|[--add|--add-exclusion|--remove|--remove-exclusion] [--from-file=filtersfile] filter1 filter2 ...|--test [--from-file=pathsfile] [--summary] path1 path2 ...] (ID|localpath|DEFAULT)";
     }
     if (!strcmp(command, "sync-config"))
     {
@@ -1852,7 +2055,8 @@ const char * getUsageStr(const char *command, const HelpFlags& flags)
         return "export [-d|-a"
                " [--writable]"
                " [--mega-hosted]"
-               " [--password=PASSWORD] [--expire=TIMEDELAY] [-f]] [remotepath]"
+               " [--password=PASSWORD] [--expire=TIMEDELAY] [-f]]"
+               " [--bulk [--from-file=pathsfile] [--max-in-flight=N]] [remotepath]"
         #ifdef USE_PCRE
                " [--use-pcre]"
         #endif
@@ -2073,7 +2277,7 @@ const char * getUsageStr(const char *command, const HelpFlags& flags)
     }
     if ((flags.fuse || flags.showAll) && !strcmp(command, "fuse-config"))
     {
-        return "fuse-config [--name=name] [--enable-at-startup=yes|no] [--persistent=yes|no] [--read-only=yes|no] (name|localPath)";
+        return "fuse-config [--name=name] [--enable-at-startup=yes|no] [--persistent=yes|no] [--read-only=yes|no] (name|localPath) | [--inode-cache-size=N] [--inode-cache-age=seconds] [--flush-delay=seconds]";
     }
 #if defined(DEBUG) || defined(MEGACMD_TESTING_CODE)
     else if (!strcmp(command, "echo"))
@@ -2090,6 +2294,60 @@ bool validCommand(string thecommand)
     return stringcontained((char*)thecommand.c_str(), validCommands);
 }
 
+bool needsNodesTree(const string& thecommand)
+{
+    return !stringcontained(thecommand.c_str(), loginInValidCommands) && !stringcontained(thecommand.c_str(), nodesTreeFreeCommands);
+}
+
+// Holds a petition until the account is logged in, with its nodes fetched and up to date (or until that failed)
+void waitUntilAccountReady(const string& thecommand)
+{
+    auto& readiness = Readiness::getInstance();
+    if (!readiness.isBusy())
+    {
+        return;
+    }
+
+    LOG_debug << "Holding " << thecommand << " until the account is ready: " << Readiness::getStateStr(readiness.getState());
+    auto state = readiness.waitWhileBusy();
+    LOG_debug << "Resuming " << thecommand << ": " << Readiness::getStateStr(state);
+}
+
+// Petitions are served while the api (and whatever needs it) is being created at startup, but only the ones not needing it
+// run right away: the rest are held until it's created
+enum class ApiState { CREATING, READY, FAILED };
+std::mutex apiStateMutex;
+std::condition_variable apiStateCV;
+ApiState apiState = ApiState::CREATING;
+std::vector<int> greetingsHeldUntilApiReady; // client IDs of the state listeners registered meanwhile
+
+bool isApiReady()
+{
+    std::lock_guard<std::mutex> g(apiStateMutex);
+    return apiState == ApiState::READY;
+}
+
+// Returns false if the api could not be created
+bool waitUntilApiReady()
+{
+    std::unique_lock<std::mutex> lock(apiStateMutex);
+    apiStateCV.wait(lock, [] { return apiState != ApiState::CREATING; });
+    return apiState == ApiState::READY;
+}
+
+// Only the help is answered without the api. The rest of the commands are run by the executer, which is created
+// with the api; besides, version checks for updates with it and configure reads and applies its values through it
+bool canRunBeforeApiIsReady(const char* line)
+{
+    auto words = getlistOfWords(line);
+    if (words.empty() || words[0] == "?" || words[0] == "h" || words[0] == "sendack"
+            || std::find(words.begin(), words.end(), "--help") != words.end())
+    {
+        return true;
+    }
+    return words[0] == "help" && std::find(words.begin(), words.end(), "--upgrade") == words.end();
+}
+
 string getsupportedregexps()
 {
 #ifdef USE_PCRE
@@ -2281,7 +2539,7 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << "   " << "\t" << "     |+------ e/- whether node is (e)xported" << endl;
         os << "   " << "\t" << "     +-------- Type(d=folder,-=file,r=root,i=inbox,b=rubbish,x=unsupported)" << endl;
         os << "   " << "\t" << "   VERS: Number of versions in a file" << endl;
-        os << "   " << "\t" << "   SIZE: Size of the file in bytes:" << endl;
+        os << "   " << "\t" << "   SIZE: Size of the file (or of the files in a folder) in bytes:" << endl;
         os << "   " << "\t" << "   DATE: Modification date for files and creation date for folders (in UTC time):" << endl;
         os << "   " << "\t" << "   NAME: name of the node" << endl;
         os << " -h" << "\t" << "Show human readable sizes in summary" << endl;
@@ -2291,6 +2549,7 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << " --versions" << "\t" << "show historical versions" << endl;
         os << "   " << "\t" << "You can delete all versions of a file with \"deleteversions\"" << endl;
         os << " --show-creation-time" << "\t" << "show creation time instead of modification time for files" << endl;
+        os << " --no-cache" << "\t" << "Calculate the folder sizes in the summary again, instead of using the ones MEGAcmd keeps up to date" << endl;
         printTimeFormatHelp(os);
 
         if (flags.usePcre || flags.showAll)
@@ -2344,6 +2603,26 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << "   by any command by passing \"-v\" (\"-vv\", \"-vvv\", ...)" << endl;
 
 
+    }
+    else if (!strcmp(command, "storage-report"))
+    {
+        os << "Analyzes the storage used by a folder, previous versions of the files included" << endl;
+        os << endl;
+        os << "It walks the folder (the current one, if none is given) once and shows:" << endl;
+        os << " - the storage used by the files and by their previous versions" << endl;
+        os << " - the folders with the most space in previous versions, the most files and the biggest files." << endl;
+        os << "   Folders are ranked by the files directly in them, so that the ones shown are where the space actually is" << endl;
+        os << " - how many files there are by size and by time since they were last modified" << endl;
+        os << "Results are shown once the whole folder has been walked. Meanwhile, only the progress is shown" << endl;
+        os << endl;
+        os << "Options:" << endl;
+        os << " -h" << "\t" << "Human readable sizes" << endl;
+        os << " --recursive" << "\t" << "Rank folders by everything under them instead, so that subtrees split across many small folders show up" << endl;
+        os << " --top=N" << "\t" << "Number of folders shown in each ranking. Default: 10" << endl;
+        os << " --threads=N" << "\t" << "Number of folders walked at once (1-32). Default: 4" << endl;
+        os << " --report=localfile" << "\t" << "Also write the results to a local file, as tab separated values" << endl;
+        os << endl;
+        os << "You can remove all versions with \"deleteversions\" and list them with \"ls --versions\"" << endl;
     }
     else if (!strcmp(command, "du"))
     {
@@ -2354,6 +2633,7 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << " -h" << "\t" << "Human readable" << endl;
         os << " --versions" << "\t" << "Calculate size including all versions." << endl;
         os << "   " << "\t" << "You can remove all versions with \"deleteversions\" and list them with \"ls --versions\"" << endl;
+        os << " --no-cache" << "\t" << "Calculate the sizes again, instead of using the ones MEGAcmd keeps up to date with the changes in the account" << endl;
         os << " --path-display-size=N" << "\t" << "Use a fixed size of N characters for paths" << endl;
 
         if (flags.usePcre || flags.showAll)
@@ -2407,7 +2687,13 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << "Options:" << endl;
         os << " -c" << "\t" << "Creates remote folder destination in case of not existing." << endl;
         os << " -q" << "\t" << "queue upload: execute in the background. Don't wait for it to end" << endl;
+        os << " --incremental" << "\t" << "Only upload files that differ from the remote ones." << endl;
+        os << "              " << "\t" << "  Files with the same size and modification time (or same contents) are skipped." << endl;
+        os << "              " << "\t" << "  Not compatible with --scan-threads." << endl;
         os << " --print-tag-at-start" << "\t" << "Prints start message including transfer TAG, even when using -q." << endl;
+        os << " --scan-threads=N" << "\t" << "Scan local folders with N threads, uploading their files as soon as they are found." << endl;
+        os << "                 " << "\t" << "  Recommended for folders with a huge number of files: transfers will start while scanning goes on." << endl;
+        os << "                 " << "\t" << "  Remote folders are created as they are found, and each file is uploaded as an individual transfer." << endl;
 
         os << endl;
         os << "Notice that the dstremotepath can only be omitted when only one local path is provided." << endl;
@@ -2415,6 +2701,28 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << " Mind that using wildcards for local paths in non-interactive mode in a supportive console (e.g. bash)," << endl;
         os << " could result in multiple paths being passed to MEGAcmd." << endl;
     }
+    else if (!strcmp(command, "manifest"))
+    {
+        os << "Transfers a list of files/folders, keeping track of their progress so that it can be resumed" << endl;
+        os << endl;
+        os << "The manifest file contains one transfer per line, with tab separated fields:" << endl;
+        os << "  get<TAB>remotepath<TAB>localpath" << endl;
+        os << "  put<TAB>localpath<TAB>remotepath" << endl;
+        os << " Empty lines and lines starting with # are ignored." << endl;
+        os << " Relative paths are resolved against the current local and remote folders when the manifest is created." << endl;
+        os << endl;
+        os << "The state of each transfer is recorded in a journal within MEGAcmd configuration folder." << endl;
+        os << " If MEGAcmd is restarted before the transfers finish, they are resumed in the background once the session" << endl;
+        os << " is resumed and the account is up to date. Otherwise (e.g. after logging in again) use --resume to continue:" << endl;
+        os << " completed transfers will not be repeated, and failed ones will be retried." << endl;
+        os << "If executed without arguments, it will list the existing manifests and the state of their transfers" << endl;
+        os << endl;
+        os << "Options:" << endl;
+        os << " -q" << "\t" << "queue transfers: execute in the background. Don't wait for them to end" << endl;
+        os << " --resume [ID ...]" << "\t" << "Resume the transfers of the manifests with those IDs (or of all the unfinished ones if none is given)" << endl;
+        os << " -d ID" << "\t" << "Discard the journal of the manifest with that ID" << endl;
+        printColumnDisplayerHelp(os);
+    }
     else if (!strcmp(command, "get"))
     {
         os << "Downloads a remote file/folder or a public link " << endl;
@@ -2436,6 +2744,9 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << " -q" << "\t" << "queue download: execute in the background. Don't wait for it to end" << endl;
         os << " -m" << "\t" << "if the folder already exists, the contents will be merged with the" << endl;
         os << "                     downloaded one (preserving the existing files)" << endl;
+        os << " --incremental" << "\t" << "Only download files that differ from the local ones, replacing them." << endl;
+        os << "              " << "\t" << "  Files with the same size and modification time (or same contents) are skipped." << endl;
+        os << "              " << "\t" << "  Not available for links." << endl;
         os << " --ignore-quota-warn" << "\t" << "ignore quota surpassing warning." << endl;
         os << "                    " << "\t" << "  The download will be attempted anyway." << endl;
         os << " --password=PASSWORD" << "\t" << "Password to decrypt the password-protected link. Please, avoid using passwords containing \" or '" << endl;
@@ -2656,6 +2967,13 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << " [deprecated] -r" << " " << "ID|localpath" << "\t" << "same as --enable." << endl;
         os << " --path-display-size=N" << "\t" << "Use at least N characters for displaying paths." << endl;
         os << " --show-handles" << "\t" << "Prints remote nodes handles (H:XXXXXXXX)." << endl;
+        os << " --refresh" << "\t" << "Requests the list of sync issues again, instead of using the latest one received." << endl;
+        os << " --no-cache" << "\t" << "Calculate the SIZE, FILES and DIRS columns again, instead of using the values MEGAcmd keeps up to date." << endl;
+        os << " --stats" << "\t" << "Shows activity counters of the syncs (or of the one provided) since MEGAcmd server started, instead of their state." << endl;
+        os << "        " << "\t" << "Columns: UPLOADED/DOWNLOADED (files), UP_BYTES/DOWN_BYTES, IN_FLIGHT (sync transfers in progress), FAILED (transfers)," << endl;
+        os << "        " << "\t" << "SCANS (completed), LAST_SCAN and SCAN_TIME (duration of the last scan and of all of them), STALLS (sync issues that appeared)" << endl;
+        os << "        " << "\t" << "and LAST_ACTIVITY (time since the last transfer, scan, state change or issue)." << endl;
+        os << "   --raw" << "\t" << "Shows exact numbers: bytes, milliseconds and UNIX timestamps. Use it with --col-separator for a machine-readable dump." << endl;
         printColumnDisplayerHelp(os);
         os << endl;
         os << "DISPLAYED columns:" << endl;
@@ -2694,10 +3012,15 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << "                       " << "\t" << "\t" << "SIZE: The size of the file. Empty for directories." << endl;
         os << "                       " << "\t" << "\t" << "TYPE: The type of the path (file or directory). This column is hidden if the information is not relevant for the particular sync issue." << endl;
         os << "                       " << "\t" << "The \"--all\" argument can be used to show the details of all issues." << endl;
+        os << " --sync=ID|localpath " << "\t" << "Only shows the issues of the given sync, followed by a summary of the path problems found in it." << endl;
         os << " --limit=rowcount " << "\t" << "Limits the amount of rows displayed. Set to 0 to display unlimited rows. Default is 10. Can also be combined with \"--detail\"." << endl;
         os << " --disable-path-collapse " << "\t" << "Ensures all paths are fully shown. By default long paths are truncated for readability." << endl;
+        os << " --refresh " << "\t" << "Requests the list of sync issues to the sync engine. By default, the latest list received (updated whenever sync issues change) is used; its age is shown after the issues." << endl;
         os << " --enable-warning " << "\t" << "Enables the notification that appears when issues are detected. This setting is saved for the next time you open MEGAcmd, but will be removed if you logout." << endl;
         os << " --disable-warning " << "\t" << "Disables the notification that appears when issues are detected. This setting is saved for the next time you open MEGAcmd, but will be removed if you logout." << endl;
+        os << " --subscribe " << "\t" << "Notifies this MEGAcmd shell of every sync issue added, removed or changed from now on, with one line per issue." << endl;
+        os << "             " << "\t" << "  From a script (mega-sync-issues), the command keeps running and printing those lines until interrupted." << endl;
+        os << " --unsubscribe " << "\t" << "Stops the notifications enabled with \"--subscribe\" in this MEGAcmd shell." << endl;
         printColumnDisplayerHelp(os);
         os << endl;
         os << "DISPLAYED columns:" << endl;
@@ -2723,6 +3046,15 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << "--remove" << "\t" << "Remove the specified filters from the selected sync" << endl;
         os << "--remove-exclusion" << "\t" << "Same as \"--remove\", but the <CLASS> is 'exclude'" << endl;
         os << "                  " << "\t" << "Note: the `-` must be omitted from the filter (using '--' is not necessary)" << endl;
+        os << " --from-file=filtersfile" << "\t" << "Also adds/removes the filters in the given local file, one per line (empty lines and lines starting with '#' are ignored)" << endl;
+        os << "                        " << "\t" << "Use \"-\" to read them from the standard input (only from the scripts/client executables)." << endl;
+        os << "                        " << "\t" << "Additions are appended to the .megaignore file, and all removals are written in a single step." << endl;
+        os << "--test" << "\t" << "Shows whether the filters of the selected sync would exclude the given paths, without waiting for the sync engine" << endl;
+        os << "      " << "\t" << "Paths can be absolute (within the sync) or relative to its root. Paths ending in '/' are considered directories, and files otherwise." << endl;
+        os << "      " << "\t" << "For each path, EXCLUDED or INCLUDED is shown, followed by the filter that decided it (if any)." << endl;
+        os << "      " << "\t" << "A path is excluded if any of its parent directories is. Size filters and the filters of sub-folders are not taken into account." << endl;
+        os << " --from-file=pathsfile" << "\t" << "Also tests the paths in the given local file, one per line" << endl;
+        os << " --summary" << "\t" << "Only shows how many paths were excluded and included, and how long it took to evaluate them" << endl;
         os << endl;
         os << "Filters must have the following format: <CLASS><TARGET><TYPE><STRATEGY>:<PATTERN>" << endl;
         os << "\t" << "<CLASS> Must be either exclude, or include" << endl;
@@ -2899,6 +3231,13 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
                                "or other proprietary rights of any person or entity." << endl;
         os << " -d" << "\t" << "Deletes an export." << endl;
         os << "   " << "\t" << "The file/folder itself is not deleted, only the export link." << endl;
+        os << " --bulk" << "\t" << "Adds (with -a) or deletes (with -d) the exports of all the given paths, sending several requests at once." << endl;
+        os << "       " << "\t" << "Each result is printed as soon as it is known, as a line with the remote path and the link separated by a tab." << endl;
+        os << "       " << "\t" << "Writable links add their AuthToken (and, with --mega-hosted, the share key encryption key) as further columns." << endl;
+        os << "       " << "\t" << "When deleting, the link shown is the one that was removed." << endl;
+        os << "       " << "\t" << "Paths that fail are reported and skipped; the rest are processed nonetheless." << endl;
+        os << " --from-file=pathsfile" << "\t" << "Also processes the remote paths in the given local file, one per line (empty lines and lines starting with '#' are ignored). Implies --bulk." << endl;
+        os << " --max-in-flight=N" << "\t" << "Maximum number of export requests waiting for a response at once in bulk mode. Default: 32." << endl;
         printTimeFormatHelp(os);
         os << endl;
         os << "If a remote path is provided without the add/delete options, all existing exports within its tree will be displayed." << endl;
@@ -3201,11 +3540,13 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << " --only-downloads" << "\t" << "Show/Operate only download transfers" << endl;
         os << endl;
         os << "Show options:" << endl;
-        os << " --summary" << "\t" << "Prints summary of on going transfers" << endl;
+        os << " --summary" << "\t" << "Prints summary of on going transfers, including the number of transfers in each state and how many belong to syncs" << endl;
         os << " --show-syncs" << "\t" << "Show synchronization transfers" << endl;
         os << " --show-completed" << "\t" << "Show completed transfers" << endl;
         os << " --only-completed" << "\t" << "Show only completed download" << endl;
         os << " --limit=N" << "\t" << "Show only first N transfers" << endl;
+        os << " --offset=N" << "\t" << "Skip the first N transfers. Use it together with --limit to page through long transfer queues" << endl;
+        os << " --sort=speed|size" << "\t" << "Sort ongoing transfers by current speed or by size (biggest first). Otherwise, they are shown in queue order" << endl;
         os << " --path-display-size=N" << "\t" << "Use at least N characters for displaying paths" << endl;
         printColumnDisplayerHelp(os);
         os << endl;
@@ -3338,6 +3679,9 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
         os << "   PERSISTENT: If the mount is saved across restarts, \"YES\". Otherwise, \"NO\"." << endl;
         os << "   ENABLED: If the mount is currently enabled, \"YES\". Otherwise, \"NO\"." << endl;
         os << endl;
+        os << "When a single mount is shown, its activity since the server started (enable/disable and failure counts)" << endl;
+        os << "and the FUSE settings shared by all mounts are displayed too." << endl;
+        os << endl;
         os << "Parameters:" << endl;
         os << FuseCommand::getIdentifierParameter() << endl;
         os << "                    If not provided, the list of mounts will be shown instead." << endl;
@@ -3352,17 +3696,26 @@ string getHelpStr(const char *command, const HelpFlags& flags = {})
     }
     else if ((flags.fuse || flags.showAll) && !strcmp(command, "fuse-config"))
     {
-        os << "Modifies the specified FUSE mount configuration." << endl;
+        os << "Modifies the specified FUSE mount configuration, or the FUSE settings shared by all mounts." << endl;
         os << endl;
         os << "Parameters:" << endl;
         os << FuseCommand::getIdentifierParameter() << endl;
+        os << "                    Required to change mount flags. It must be omitted when only settings are changed." << endl;
         os << endl;
-        os << "Options:" << endl;
+        os << "Mount flags:" << endl;
         os << " --name=name                  Sets the friendly name used to uniquely identify the mount." << endl;
         os << " --enable-at-startup=yes|no   Controls whether or not the mount should be enabled automatically on startup." << endl;
         os << " --persistent=yes|no          Controls whether or not the mount is saved across restarts." << endl;
         os << " --read-only=yes|no           Controls whether the mount is read-only or writable." << endl;
         os << endl;
+        os << "Settings (shared by all mounts, saved across restarts):" << endl;
+        os << " --inode-cache-size=N         Maximum number of inodes (file and folder descriptions) kept in memory." << endl;
+        os << "                              A bigger cache makes listing and opening lots of files faster, at the cost of memory." << endl;
+        os << " --inode-cache-age=seconds    Time after which unused inodes may be evicted from the cache." << endl;
+        os << " --flush-delay=seconds        Time to wait after a file is modified before uploading it." << endl;
+        os << "                              Longer delays avoid uploading files that are still being written." << endl;
+        os << "Use fuse-show with a mount to see the current settings." << endl;
+        os << endl;
         os << "Note: " << FuseCommand::getBetaMsg() << endl;
     }
     return os.str();
@@ -3561,7 +3914,11 @@ void executecommand(const char* ptr)
 
     insertValidParamsPerCommand(&validParams, thecommand);
 
-    if (!validCommand(thecommand))   //unknown command
+    // While login in, commands needing the nodes tree are held until the account is ready instead of rejected
+    const bool heldWhileLoginIn = loginInAtStartup && !getBlocked() && needsNodesTree(thecommand)
+            && stringcontained(thecommand.c_str(), allValidCommands);
+
+    if (!validCommand(thecommand) && !heldWhileLoginIn)   //unknown command
     {
         setCurrentThreadOutCode(MCMD_EARGS);
         if (loginInAtStartup)
@@ -3752,6 +4109,15 @@ void executecommand(const char* ptr)
         return;
     }
 
+    if (needsNodesTree(thecommand))
+    {
+        if (Readiness::getInstance().isBusy() && cmdexecuter->executeFromNodesSnapshot(words, &clflags, &cloptions))
+        {
+            return;
+        }
+        waitUntilAccountReady(thecommand);
+    }
+
     cmdexecuter->executecommand(words, &clflags, &cloptions);
 }
 
@@ -4014,10 +4380,8 @@ bool isBareCommand(const char *l, const string &command)
 
 bool hasOngoingTransfersOrDelayedSyncs(MegaApi& api)
 {
-    std::unique_ptr<MegaTransferData> transferData(api.getTransferData());
-    assert(transferData);
-
-    if (transferData->getNumDownloads() > 0 || transferData->getNumUploads() > 0)
+    // Kept up to date by the transfer listener, so this doesn't need to go through the transfer queues
+    if (cmdexecuter->getTransferIndex().hasPendingTransfers())
     {
         return true;
     }
@@ -4067,7 +4431,10 @@ void MegaCmdExecuter::mayExecutePendingStuffInWorkerThread()
 
 static bool process_line(const std::string_view line)
 {
-    cmdexecuter->mayExecutePendingStuffInWorkerThread();
+    if (isApiReady())
+    {
+        cmdexecuter->mayExecutePendingStuffInWorkerThread();
+    }
 
     const char* l = line.data();
     assert(line.size() == strlen(l)); // string_view does not guarantee null termination, which is depended upon
@@ -4265,7 +4632,22 @@ void* doProcessLine(void* infRaw)
 
     LOG_verbose << " Processing " << inf->getRedactedLine() << " in thread: " << MegaThread::currentThreadId() << " " << inf->getPetitionDetails();
 
-    doExit = process_line(inf->getUniformLine());
+    bool apiAvailable = true;
+    if (!canRunBeforeApiIsReady(inf->getUniformLine().data()) && !isApiReady())
+    {
+        LOG_debug << "Holding " << inf->getRedactedLine() << " until the api is created";
+        apiAvailable = waitUntilApiReady();
+    }
+
+    if (apiAvailable)
+    {
+        doExit = process_line(inf->getUniformLine());
+    }
+    else
+    {
+        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+        LOG_err << "MEGAcmd server failed to start";
+    }
 
     if (doExit)
     {
@@ -4402,6 +4784,11 @@ void finalize(bool waitForRestartSignal_param)
         delete console;
     }
 
+    if (cmdexecuter)
+    {
+        cmdexecuter->stopNodesSnapshots();
+    }
+
     delete megaCmdMegaListener;
     if (threadRetryConnections)
     {
@@ -4410,19 +4797,15 @@ void finalize(bool waitForRestartSignal_param)
     delete threadRetryConnections;
     delete api;
 
-    while (!apiFolders.empty())
-    {
-        delete apiFolders.front();
-        apiFolders.pop();
-    }
-
-    for (std::vector< MegaApi * >::iterator it = occupiedapiFolders.begin(); it != occupiedapiFolders.end(); ++it)
+    if (apiFolders)
     {
-        delete ( *it );
+        stopApiFoldersExpiry();
+        for (MegaApi* apiFolder : apiFolders->takeAll())
+        {
+            delete apiFolder;
+        }
     }
 
-    occupiedapiFolders.clear();
-
     delete megaCmdGlobalListener;
     delete cmdexecuter;
 
@@ -4441,6 +4824,7 @@ void finalize(bool waitForRestartSignal_param)
         }
     }
 #endif
+    Readiness::getInstance().setListener(nullptr);
     delete cm; //this needs to go after restartServer();
     LOG_debug << "resources have been cleaned ...";
     LOG_info << "----------------------------- program end -------------------------------";
@@ -4460,6 +4844,11 @@ int currentclientID = 1;
 
 void * retryConnections(void *pointer)
 {
+    if (!waitUntilApiReady())
+    {
+        return NULL;
+    }
+
     while(!doExit)
     {
         LOG_verbose << "Calling recurrent retryPendingConnections";
@@ -4592,7 +4981,11 @@ void processCommandInPetitionQueues(std::unique_ptr<CmdPetition> inf)
     //append new one
     auto petitionThread = new MegaThread();
 
-    petitionThreads.emplace_back(petitionThread);
+    {
+        // Startup steps may queue petitions before the main loop starts serving them
+        std::lock_guard<std::mutex> g(mutexEndedPetitionThreads);
+        petitionThreads.emplace_back(petitionThread);
+    }
     inf->setPetitionThread(petitionThread);
 
     LOG_verbose << "starting processing: <" << inf->getRedactedLine() << ">";
@@ -4608,6 +5001,199 @@ void processCommandLinePetitionQueues(std::string what)
     processCommandInPetitionQueues(std::move(inf));
 }
 
+// Tells a state listener that just registered about the state of the server. Needs the api
+void greetStateListener(int clientID)
+{
+    std::string s;
+
+#if defined(_WIN32) || defined(__APPLE__)
+    ostringstream os;
+    auto updatMsgOpt = lookForAvailableNewerVersions(api);
+    //TODO: have this executed in worker thread instead (see MegaCmdExecuter::mayExecutePendingStuffInWorkerThread)
+    // still store the update message to be consumed here
+    if (updatMsgOpt)
+    {
+        os << *updatMsgOpt;
+    }
+
+    int autoupdate = ConfigurationManager::getConfigurationValue("autoupdate", -1);
+    if (autoupdate == -1 || autoupdate == 2)
+    {
+        os << "ENABLING AUTOUPDATE BY DEFAULT. You can disable it with \"update --auto=off\"" << endl;
+        autoupdate = 1;
+    }
+
+    if (autoupdate == 1)
+    {
+        startcheckingForUpdates();
+    }
+
+    auto message = os.str();
+    if (message.size())
+    {
+        s += "message:";
+        s += message;
+        s += (char) 0x1F;
+    }
+#endif
+
+    bool isOSdeprecated = false;
+#ifdef MEGACMD_DEPRECATED_OS
+    isOSdeprecated = true;
+#endif
+
+
+#ifdef _WIN32
+    OSVERSIONINFOEX osvi;
+    ZeroMemory(&osvi, sizeof(OSVERSIONINFOEX));
+    osvi.dwOSVersionInfoSize = sizeof(OSVERSIONINFOEX);
+#pragma warning(disable: 4996) //  warning C4996: 'GetVersionExW': was declared deprecated
+    if (GetVersionEx((OSVERSIONINFO*)&osvi) && osvi.dwMajorVersion < 6)
+    {
+        isOSdeprecated = true;
+    }
+#endif
+    if (isOSdeprecated)
+    {
+        s += "message:";
+        s += "Your Operative System is too old.\n";
+        s += "You might not receive new updates for this application.\n";
+        s += "We strongly recommend you to update to a new version.\n";
+        s += (char) 0x1F;
+    }
+
+    if (sandboxCMD->storageStatus != MegaApi::STORAGE_STATE_GREEN)
+    {
+        s += "message:";
+
+        if (sandboxCMD->storageStatus == MegaApi::STORAGE_STATE_PAYWALL)
+        {
+            std::unique_ptr<char[]> myEmail(api->getMyEmail());
+            std::unique_ptr<MegaIntegerList> warningsList(api->getOverquotaWarningsTs());
+            s += "We have contacted you by email to " + string(myEmail.get()) + " on ";
+            s += getReadableTime(warningsList->get(0),"%b %e %Y");
+            if (warningsList->size() > 1)
+            {
+                for (int i = 1; i < warningsList->size() - 1; i++)
+                {
+                    s += ", " + getReadableTime(warningsList->get(i),"%b %e %Y");
+                }
+                s += " and " + getReadableTime(warningsList->get(warningsList->size() - 1),"%b %e %Y");
+            }
+            std::unique_ptr<MegaNode> rootNode(api->getRootNode());
+            auto listener = std::make_unique<SynchronousRequestListener>();
+            api->getFolderInfo(rootNode.get(), listener.get());
+            listener->wait();
+            auto error = listener->getError();
+            assert(error != nullptr);
+            if (error->getErrorCode() == MegaError::API_OK)
+            {
+                long long totalFiles = 0;
+
+                auto info = listener->getRequest()->getMegaFolderInfo();
+                if (info != nullptr)
+                {
+                    totalFiles += info->getNumFolders();
+                }
+                s += ", but you still have " + std::to_string(totalFiles) + " files taking up " + sizeToText(sandboxCMD->receivedStorageSum);
+            }
+            else
+            {
+                s += ", but you still have files taking up" + sizeToText(sandboxCMD->receivedStorageSum);
+            }
+
+            s += " in your MEGA account, which requires you to upgrade your account.\n\n";
+            long long daysLeft = (api->getOverquotaDeadlineTs() - m_time(NULL)) / 86400;
+            if (daysLeft > 0)
+            {
+                 s += "You have " + std::to_string(daysLeft) + " days left to upgrade. ";
+                 s += "After that, your data is subject to deletion.\n";
+            }
+            else
+            {
+                 s += "You must act immediately to save your data. From now on, your data is subject to deletion.\n";
+            }
+        }
+        else if (sandboxCMD->storageStatus == MegaApi::STORAGE_STATE_RED)
+        {
+            s += "You have exeeded your available storage.\n";
+            s += "You can change your account plan to increase your quota limit.\n";
+        }
+        else
+        {
+            s += "You are running out of available storage.\n";
+            s += "You can change your account plan to increase your quota limit.\n";
+        }
+        s += "See \"help --upgrade\" for further details.\n";
+        s += (char) 0x1F;
+    }
+
+    // if server resuming session, lets give him a very litle while before sending greeting message to the early clients
+    // (to aovid "Resuming session..." being printed fast resumed session)
+    while (getloginInAtStartup() && ((m_time(nullptr) - timeLoginStarted() < RESUME_SESSION_TIMEOUT * 0.3)))
+    {
+        sleepMilliSeconds(300);
+    }
+
+    {
+        std::lock_guard<std::mutex> g(greetingsmsgsMutex);
+
+        while(greetingsFirstClientMsgs.size())
+        {
+            cm->informStateListenerByClientId(greetingsFirstClientMsgs.front(), clientID);
+            greetingsFirstClientMsgs.pop_front();
+        }
+
+        for (const auto& m: greetingsAllClientMsgs)
+        {
+            cm->informStateListenerByClientId(m, clientID);
+        }
+    }
+
+    // if server resuming session, lets give him a litle while before returning a prompt to the early clients
+    // This will block the server from responging any commands in the meantime, but that assumable, it will only happen
+    // the first time the server is initiated.
+    while (getloginInAtStartup() && ((m_time(nullptr) - timeLoginStarted() < RESUME_SESSION_TIMEOUT * 0.7)))
+    {
+        sleepMilliSeconds(300);
+    }
+
+    // communicate status info (the delimiter after the last one is added when informing)
+    s +=  "prompt:";
+    s += dynamicprompt;
+
+    if (!sandboxCMD->getReasonblocked().size())
+    {
+        cmdexecuter->checkAndInformPSA(clientID);
+    }
+
+    cm->informStateListenerByClientId(s, clientID);
+}
+
+// Releases the petitions held until the api was created or, if that failed, fails them and stops the server
+void onApiCreationFinished(bool succeeded)
+{
+    std::vector<int> heldGreetings;
+    {
+        std::lock_guard<std::mutex> g(apiStateMutex);
+        apiState = succeeded ? ApiState::READY : ApiState::FAILED;
+        heldGreetings.swap(greetingsHeldUntilApiReady);
+    }
+    apiStateCV.notify_all();
+
+    if (!succeeded)
+    {
+        doExit = true;
+        cm->stopWaiting();
+        return;
+    }
+
+    for (int clientID : heldGreetings)
+    {
+        greetStateListener(clientID);
+    }
+}
+
 // main loop
 void megacmd()
 {
@@ -4628,7 +5214,10 @@ void megacmd()
             continue;
         }
 
-        api->retryPendingConnections();
+        if (isApiReady())
+        {
+            api->retryPendingConnections();
+        }
 
         if (doExit)
         {
@@ -4669,171 +5258,16 @@ void megacmd()
                     cm->informStateListener(inf, clientIdStr);
                 }
 
-                std::string s;
-
-#if defined(_WIN32) || defined(__APPLE__)
-                ostringstream os;
-                auto updatMsgOpt = lookForAvailableNewerVersions(api);
-                //TODO: have this executed in worker thread instead (see MegaCmdExecuter::mayExecutePendingStuffInWorkerThread)
-                // still store the update message to be consumed here
-                if (updatMsgOpt)
-                {
-                    os << *updatMsgOpt;
-                }
-
-                int autoupdate = ConfigurationManager::getConfigurationValue("autoupdate", -1);
-                if (autoupdate == -1 || autoupdate == 2)
-                {
-                    os << "ENABLING AUTOUPDATE BY DEFAULT. You can disable it with \"update --auto=off\"" << endl;
-                    autoupdate = 1;
-                }
-
-                if (autoupdate == 1)
-                {
-                    startcheckingForUpdates();
-                }
-
-                auto message = os.str();
-                if (message.size())
-                {
-                    s += "message:";
-                    s += message;
-                    s += (char) 0x1F;
-                }
-#endif
-
-                bool isOSdeprecated = false;
-#ifdef MEGACMD_DEPRECATED_OS
-                isOSdeprecated = true;
-#endif
-
-
-#ifdef _WIN32
-                OSVERSIONINFOEX osvi;
-                ZeroMemory(&osvi, sizeof(OSVERSIONINFOEX));
-                osvi.dwOSVersionInfoSize = sizeof(OSVERSIONINFOEX);
-#pragma warning(disable: 4996) //  warning C4996: 'GetVersionExW': was declared deprecated
-                if (GetVersionEx((OSVERSIONINFO*)&osvi) && osvi.dwMajorVersion < 6)
-                {
-                    isOSdeprecated = true;
-                }
-#endif
-                if (isOSdeprecated)
                 {
-                    s += "message:";
-                    s += "Your Operative System is too old.\n";
-                    s += "You might not receive new updates for this application.\n";
-                    s += "We strongly recommend you to update to a new version.\n";
-                    s += (char) 0x1F;
-                }
-
-                if (sandboxCMD->storageStatus != MegaApi::STORAGE_STATE_GREEN)
-                {
-                    s += "message:";
-
-                    if (sandboxCMD->storageStatus == MegaApi::STORAGE_STATE_PAYWALL)
-                    {
-                        std::unique_ptr<char[]> myEmail(api->getMyEmail());
-                        std::unique_ptr<MegaIntegerList> warningsList(api->getOverquotaWarningsTs());
-                        s += "We have contacted you by email to " + string(myEmail.get()) + " on ";
-                        s += getReadableTime(warningsList->get(0),"%b %e %Y");
-                        if (warningsList->size() > 1)
-                        {
-                            for (int i = 1; i < warningsList->size() - 1; i++)
-                            {
-                                s += ", " + getReadableTime(warningsList->get(i),"%b %e %Y");
-                            }
-                            s += " and " + getReadableTime(warningsList->get(warningsList->size() - 1),"%b %e %Y");
-                        }
-                        std::unique_ptr<MegaNode> rootNode(api->getRootNode());
-                        auto listener = std::make_unique<SynchronousRequestListener>();
-                        api->getFolderInfo(rootNode.get(), listener.get());
-                        listener->wait();
-                        auto error = listener->getError();
-                        assert(error != nullptr);
-                        if (error->getErrorCode() == MegaError::API_OK)
-                        {
-                            long long totalFiles = 0;
-
-                            auto info = listener->getRequest()->getMegaFolderInfo();
-                            if (info != nullptr)
-                            {
-                                totalFiles += info->getNumFolders();
-                            }
-                            s += ", but you still have " + std::to_string(totalFiles) + " files taking up " + sizeToText(sandboxCMD->receivedStorageSum);
-                        }
-                        else
-                        {
-                            s += ", but you still have files taking up" + sizeToText(sandboxCMD->receivedStorageSum);
-                        }
-
-                        s += " in your MEGA account, which requires you to upgrade your account.\n\n";
-                        long long daysLeft = (api->getOverquotaDeadlineTs() - m_time(NULL)) / 86400;
-                        if (daysLeft > 0)
-                        {
-                             s += "You have " + std::to_string(daysLeft) + " days left to upgrade. ";
-                             s += "After that, your data is subject to deletion.\n";
-                        }
-                        else
-                        {
-                             s += "You must act immediately to save your data. From now on, your data is subject to deletion.\n";
-                        }
-                    }
-                    else if (sandboxCMD->storageStatus == MegaApi::STORAGE_STATE_RED)
-                    {
-                        s += "You have exeeded your available storage.\n";
-                        s += "You can change your account plan to increase your quota limit.\n";
-                    }
-                    else
-                    {
-                        s += "You are running out of available storage.\n";
-                        s += "You can change your account plan to increase your quota limit.\n";
-                    }
-                    s += "See \"help --upgrade\" for further details.\n";
-                    s += (char) 0x1F;
-                }
-
-                // if server resuming session, lets give him a very litle while before sending greeting message to the early clients
-                // (to aovid "Resuming session..." being printed fast resumed session)
-                while (getloginInAtStartup() && ((m_time(nullptr) - timeLoginStarted() < RESUME_SESSION_TIMEOUT * 0.3)))
-                {
-                    sleepMilliSeconds(300);
-                }
-
-                {
-                    std::lock_guard<std::mutex> g(greetingsmsgsMutex);
-
-                    while(greetingsFirstClientMsgs.size())
-                    {
-                        cm->informStateListener(inf,greetingsFirstClientMsgs.front().append(1, (char)0x1F));
-                        greetingsFirstClientMsgs.pop_front();
-                    }
-
-                    for (auto m: greetingsAllClientMsgs)
+                    std::lock_guard<std::mutex> g(apiStateMutex);
+                    if (apiState != ApiState::READY)
                     {
-                        cm->informStateListener(inf, m.append(1, (char)0x1F));
+                        // Greeted once the api is created, so as not to hold the petitions coming meanwhile
+                        greetingsHeldUntilApiReady.push_back(inf->clientID);
+                        continue;
                     }
                 }
-
-                // if server resuming session, lets give him a litle while before returning a prompt to the early clients
-                // This will block the server from responging any commands in the meantime, but that assumable, it will only happen
-                // the first time the server is initiated.
-                while (getloginInAtStartup() && ((m_time(nullptr) - timeLoginStarted() < RESUME_SESSION_TIMEOUT * 0.7)))
-                {
-                    sleepMilliSeconds(300);
-                }
-
-                // communicate status info
-                s +=  "prompt:";
-                s += dynamicprompt;
-                s += (char) 0x1F;
-
-                if (!sandboxCMD->getReasonblocked().size())
-                {
-                    cmdexecuter->checkAndInformPSA(inf);
-                }
-
-                cm->informStateListener(inf, s);
+                greetStateListener(inf->clientID);
             }
             else
             { // normal petition
@@ -5441,6 +5875,10 @@ int executeServer(int argc, char* argv[],
     mcmdMainArgv = argv;
     mcmdMainArgc = argc;
 
+    // Every startup step is timed from here: the breakdown is logged (at debug level) once all of them are done
+    StartupGraph startup;
+    auto stepStart = StartupGraph::Clock::now();
+
     ConfigurationManager::loadConfiguration(logConfig.mCmdLogLevel >= MegaApi::LOG_LEVEL_DEBUG);
     if (!ConfigurationManager::lockExecution() && !skiplockcheck)
     {
@@ -5448,7 +5886,9 @@ int executeServer(int argc, char* argv[],
         sleepSeconds(5);
         return -2;
     }
+    startup.record("configuration", stepStart);
 
+    stepStart = StartupGraph::Clock::now();
     // The logger stream must be created after the configuration is loaded (so the .megaCmd directory is created if necessary)
     if (createLoggedStream)
     {
@@ -5468,69 +5908,10 @@ int executeServer(int argc, char* argv[],
     LOG_info << "----------------------- program start -----------------------";
     LOG_debug << "MEGAcmd version: " << MEGACMD_MAJOR_VERSION << "." << MEGACMD_MINOR_VERSION << "." << MEGACMD_MICRO_VERSION << "." << MEGACMD_BUILD_ID << ": code " << MEGACMD_CODE_VERSION;
     LOG_debug << "MEGA SDK version: " << SDK_COMMIT_HASH;
+    startup.record("logger", stepStart);
 
-    const fs::path configDirPath = ConfigurationManager::getAndCreateConfigDir();
-    const std::string configDirStrUtf8 = pathAsUtf8(configDirPath);
-
-    api = new MegaApi("BdARkQSQ", configDirStrUtf8.c_str(), userAgent);
-
-    if (!debug_api_url.empty())
-    {
-        api->changeApiUrl(debug_api_url.c_str(), disablepkp);
-    }
-
-    api->setLanguage(localecode.c_str());
-    if (logConfig.mJsonLogs)
-    {
-        MegaApi::setLogJSON(MegaApi::JSON_LOG_CHUNK_RECEIVED | MegaApi::JSON_LOG_CHUNK_CONSUMED | MegaApi::JSON_LOG_SENDING | MegaApi::JSON_LOG_NONCHUNK_RECEIVED);
-        MegaApi::setMaxPayloadLogSize(0); // Max size
-    }
-    LOG_debug << "Language set to: " << localecode;
-
-    sandboxCMD = new MegaCmdSandbox();
-    cmdexecuter = new MegaCmdExecuter(api, loggerCMD, sandboxCMD);
-    sandboxCMD->cmdexecuter = cmdexecuter;
-
-    auto cmdFatalErrorListener = std::make_unique<MegaCmdFatalErrorListener>(*sandboxCMD);
-
-    auto numberOfApiFolders = ConfigurationManager::getConfigurationValue("exported_folders_sdks", 5);
-    LOG_debug << "Loading " << numberOfApiFolders << " auxiliar MegaApi folders";
-
-    for (int i = 0; i < numberOfApiFolders; i++)
-    {
-        const fs::path apiFolderPath = ConfigurationManager::getConfigFolderSubdir("apiFolder_" + std::to_string(i));
-        const std::string apiFolderStrUtf8 = pathAsUtf8(apiFolderPath);
-
-        MegaApi *apiFolder = new MegaApi("BdARkQSQ", apiFolderStrUtf8.c_str(), userAgent);
-        apiFolder->setLanguage(localecode.c_str());
-        apiFolder->addGlobalListener(cmdFatalErrorListener.get());
-
-        apiFolders.push(apiFolder);
-        semaphoreapiFolders.release();
-    }
-
-    for (int i = 0; i < 100; i++)
-    {
-        semaphoreClients.release();
-    }
-
-    if (const char* fuseLogLevelStr = getenv("MEGACMD_FUSE_LOG_LEVEL"); fuseLogLevelStr)
-    {
-        setFuseLogLevel(*api, fuseLogLevelStr);
-    }
-
-    if (getenv("MEGACMD_FUSE_DISABLE_LIST_VIEW"))
-    {
-        disableFuseExplorerListView(*api);
-    }
-
-    GlobalSyncConfig::loadFromConfigurationManager(*api);
-
-    megaCmdGlobalListener = new MegaCmdGlobalListener(loggerCMD, sandboxCMD);
-    megaCmdMegaListener = new MegaCmdMegaListener(api, NULL, sandboxCMD);
-    api->addGlobalListener(megaCmdGlobalListener);
-    api->addGlobalListener(cmdFatalErrorListener.get());
-    api->addListener(megaCmdMegaListener);
+    // The petition listener is set up first, so that clients can connect (and their petitions wait) while the rest is initialized
+    stepStart = StartupGraph::Clock::now();
 
     // set up the console
 #ifdef _WIN32
@@ -5567,63 +5948,228 @@ int executeServer(int argc, char* argv[],
 
     atexit(finalize);
 
+    for (int i = 0; i < 100; i++)
+    {
+        semaphoreClients.release();
+    }
+    startup.record("listener", stepStart);
 
-#if defined(_WIN32) || defined(__APPLE__)
-    if (!ConfigurationManager::getConfigurationValue("updaterregistered", false))
+    // A step that throws fails, along with the ones depending on it. Serving petitions that need the api is one of them
+    startup.setFailureHandler([](const std::string& name, const std::string& error)
     {
-        LOG_debug << "Registering automatic updater";
-        if (registerUpdater())
+        LOG_fatal << "Startup step " << name << " failed: " << error;
+        if (name == "serving")
         {
-            ConfigurationManager::savePropertyValue("updaterregistered", true);
-            LOG_verbose << "Registered automatic updater";
+            onApiCreationFinished(false);
         }
-        else
+    });
+
+    std::unique_ptr<MegaCmdFatalErrorListener> cmdFatalErrorListener;
+    startup.add("api", {}, [&cmdFatalErrorListener, userAgentStr = std::string(userAgent), localecode, debug_api_url, disablepkp, jsonLogs = logConfig.mJsonLogs]
+    {
+        const fs::path configDirPath = ConfigurationManager::getAndCreateConfigDir();
+        const std::string configDirStrUtf8 = pathAsUtf8(configDirPath);
+
+        api = new MegaApi("BdARkQSQ", configDirStrUtf8.c_str(), userAgentStr.c_str());
+
+        if (!debug_api_url.empty())
         {
-            LOG_err << "Failed to register automatic updater";
+            api->changeApiUrl(debug_api_url.c_str(), disablepkp);
         }
-    }
+
+        api->setLanguage(localecode.c_str());
+        if (jsonLogs)
+        {
+            MegaApi::setLogJSON(MegaApi::JSON_LOG_CHUNK_RECEIVED | MegaApi::JSON_LOG_CHUNK_CONSUMED | MegaApi::JSON_LOG_SENDING | MegaApi::JSON_LOG_NONCHUNK_RECEIVED);
+            MegaApi::setMaxPayloadLogSize(0); // Max size
+        }
+        LOG_debug << "Language set to: " << localecode;
+
+        sandboxCMD = new MegaCmdSandbox();
+        cmdexecuter = new MegaCmdExecuter(api, loggerCMD, sandboxCMD);
+        sandboxCMD->cmdexecuter = cmdexecuter;
+
+        cmdFatalErrorListener = std::make_unique<MegaCmdFatalErrorListener>(*sandboxCMD);
+    });
+
+    // Auxiliar MegaApi folders are created when needed, up to exported_folders_sdks, and destroyed when idle.
+    // The minimum ones are created afterwards, so that they don't delay serving petitions
+    startup.add("folder-links", {"api"}, [&cmdFatalErrorListener, userAgentStr = std::string(userAgent), localecode]
+    {
+        FolderLinkApiCache::Limits apiFoldersLimits;
+        apiFoldersLimits.mMax = ConfigurationManager::getConfigurationValue("exported_folders_sdks", 5u);
+        apiFoldersLimits.mReclaimAfter = std::chrono::seconds(ConfigurationManager::getConfigurationValue("folder_links_reclaim", 300u));
+
+        const auto apiFoldersIdleExpiry = std::chrono::seconds(ConfigurationManager::getConfigurationValue("folder_links_idle_secs", 300u));
+        apiFolders = std::make_unique<FolderLinkApiCache>(apiFoldersIdleExpiry, [](MegaApi* apiFolder) { logoutFromFolderLink(*apiFolder); });
+        apiFolders->setElastic(apiFoldersLimits,
+            [userAgentStr, localecode, fatalErrorListener = cmdFatalErrorListener.get()](size_t slot)
+            {
+                const fs::path apiFolderPath = ConfigurationManager::getConfigFolderSubdir("apiFolder_" + std::to_string(slot));
+                const std::string apiFolderStrUtf8 = pathAsUtf8(apiFolderPath);
+
+                MegaApi *apiFolder = new MegaApi("BdARkQSQ", apiFolderStrUtf8.c_str(), userAgentStr.c_str());
+                apiFolder->setLanguage(localecode.c_str());
+                apiFolder->addGlobalListener(fatalErrorListener);
+                LOG_debug << "Created auxiliar MegaApi folder " << slot;
+                return apiFolder;
+            },
+            [](MegaApi* apiFolder)
+            {
+                delete apiFolder;
+            });
+    });
+
+    startup.add("folder-links-minimum", {"folder-links"}, []
+    {
+        // Read now: it might have been configured in the meantime
+        updateApiFoldersLimits([](FolderLinkApiCache::Limits& limits)
+        {
+            limits.mMin = ConfigurationManager::getConfigurationValue("folder_links_min_sdks", 0u);
+        });
+        LOG_debug << "Auxiliar MegaApi folders: " << apiFolders->getLimits().mMin << " to " << apiFolders->getLimits().mMax;
+    });
+
+    startup.add("settings", {"api"}, []
+    {
+        if (const char* fuseLogLevelStr = getenv("MEGACMD_FUSE_LOG_LEVEL"); fuseLogLevelStr)
+        {
+            setFuseLogLevel(*api, fuseLogLevelStr);
+        }
+
+        if (getenv("MEGACMD_FUSE_DISABLE_LIST_VIEW"))
+        {
+            disableFuseExplorerListView(*api);
+        }
+
+#ifdef WITH_FUSE
+        FuseCommand::loadSettingsFromConfigurationManager(*api);
 #endif
 
-    int configuredProxyType = ConfigurationManager::getConfigurationValue("proxy_type", -1);
-    auto configuredProxyUrl = ConfigurationManager::getConfigurationSValue("proxy_url");
+        GlobalSyncConfig::loadFromConfigurationManager(*api);
+    });
 
-    auto configuredProxyUsername = ConfigurationManager::getConfigurationSValue("proxy_username");
-    auto configuredProxyPassword = ConfigurationManager::getConfigurationSValue("proxy_password");
-    if (configuredProxyType != -1 && configuredProxyType != MegaProxy::PROXY_AUTO) //AUTO is default, no need to set
+    startup.add("listeners", {"api"}, [&cmdFatalErrorListener]
     {
-        std::string command("proxy ");
-        command.append(configuredProxyUrl);
-        if (configuredProxyUsername.size())
+        megaCmdGlobalListener = new MegaCmdGlobalListener(loggerCMD, sandboxCMD);
+        megaCmdMegaListener = new MegaCmdMegaListener(api, NULL, sandboxCMD);
+        api->addGlobalListener(megaCmdGlobalListener);
+        api->addGlobalListener(cmdFatalErrorListener.get());
+        api->addListener(megaCmdMegaListener);
+    });
+
+#if defined(_WIN32) || defined(__APPLE__)
+    startup.add("updater", {}, []
+    {
+        if (!ConfigurationManager::getConfigurationValue("updaterregistered", false))
         {
-            command.append(" --username=").append(configuredProxyUsername);
-            if (configuredProxyPassword.size())
+            LOG_debug << "Registering automatic updater";
+            if (registerUpdater())
+            {
+                ConfigurationManager::savePropertyValue("updaterregistered", true);
+                LOG_verbose << "Registered automatic updater";
+            }
+            else
             {
-                command.append(" --password=").append(configuredProxyPassword);
+                LOG_err << "Failed to register automatic updater";
             }
         }
-        processCommandLinePetitionQueues(command);
-    }
+    });
+#endif
 
-    if (ConfigurationManager::getHasBeenUpdated())
+    // Clients are told about every change of readiness and fetch nodes progress, e.g. to show why their commands are held
+    Readiness::getInstance().setListener([](const Readiness::Status& status)
     {
-        // Wait for this event to ensure an automatic login on startup doesn't prevent the event from being sent
-        sendEvent(StatsManager::MegacmdEvent::UPDATE, api, true);
+        informStateListeners(Readiness::getStateMessage(status));
+    });
 
-        stringstream ss;
-        ss << "MEGAcmd has been updated to version " << MEGACMD_MAJOR_VERSION << "." << MEGACMD_MINOR_VERSION << "." << MEGACMD_MICRO_VERSION << "." << MEGACMD_BUILD_ID << " - code " << MEGACMD_CODE_VERSION << endl;
-        broadcastMessage(ss.str(), true);
-    }
-
-    if (!ConfigurationManager::session.empty())
+    // Set before serving any petition, so that early clients are told the session is being resumed
+    const bool resumeSession = !ConfigurationManager::session.empty();
+    if (resumeSession)
     {
         loginInAtStartup = true;
-        stringstream logLine;
-        logLine << "login " << ConfigurationManager::session;
-        LOG_debug << "Executing ... " << logLine.str().substr(0,9) << "...";
-        processCommandLinePetitionQueues(logLine.str());
+        Readiness::getInstance().onLoginStarted();
     }
 
+    startup.add("session", {"settings", "listeners"}, [resumeSession]
+    {
+        int configuredProxyType = ConfigurationManager::getConfigurationValue("proxy_type", -1);
+        auto configuredProxyUrl = ConfigurationManager::getConfigurationSValue("proxy_url");
+
+        auto configuredProxyUsername = ConfigurationManager::getConfigurationSValue("proxy_username");
+        auto configuredProxyPassword = ConfigurationManager::getConfigurationSValue("proxy_password");
+        if (configuredProxyType != -1 && configuredProxyType != MegaProxy::PROXY_AUTO) //AUTO is default, no need to set
+        {
+            std::string command("proxy ");
+            command.append(configuredProxyUrl);
+            if (configuredProxyUsername.size())
+            {
+                command.append(" --username=").append(configuredProxyUsername);
+                if (configuredProxyPassword.size())
+                {
+                    command.append(" --password=").append(configuredProxyPassword);
+                }
+            }
+            processCommandLinePetitionQueues(command);
+        }
+
+        if (ConfigurationManager::getHasBeenUpdated())
+        {
+            // Wait for this event to ensure an automatic login on startup doesn't prevent the event from being sent
+            sendEvent(StatsManager::MegacmdEvent::UPDATE, api, true);
+
+            stringstream ss;
+            ss << "MEGAcmd has been updated to version " << MEGACMD_MAJOR_VERSION << "." << MEGACMD_MINOR_VERSION << "." << MEGACMD_MICRO_VERSION << "." << MEGACMD_BUILD_ID << " - code " << MEGACMD_CODE_VERSION << endl;
+            broadcastMessage(ss.str(), true);
+        }
+
+        cmdexecuter->setNodesSnapshotInterval(std::chrono::minutes(ConfigurationManager::getConfigurationValue("nodes_snapshot_mins", 0u)));
+
+        if (resumeSession)
+        {
+            cmdexecuter->loadNodesSnapshot();
+
+            stringstream logLine;
+            logLine << "login " << ConfigurationManager::session;
+            LOG_debug << "Executing ... " << logLine.str().substr(0,9) << "...";
+            processCommandLinePetitionQueues(logLine.str());
+        }
+    });
+
+    // Manifests interrupted by the previous run are resumed once the account is up to date, as "manifest --resume -q" would
+    startup.add("manifests", {"session"}, [resumeSession]
+    {
+        auto& readiness = Readiness::getInstance();
+        while (resumeSession && !doExit && readiness.isBusy())
+        {
+            readiness.waitWhileBusy(std::chrono::seconds(1));
+        }
+
+        if (resumeSession && !doExit && readiness.getState() == Readiness::State::READY)
+        {
+            LOG_debug << "Resuming unfinished transfer manifests";
+            processCommandLinePetitionQueues("manifest --resume -q");
+        }
+    });
+
+    // Petitions are served as soon as the graph starts: the ones needing the api are held until this step runs
+    startup.add("serving", {"api", "folder-links", "settings", "listeners"}, []
+    {
+        onApiCreationFinished(true);
+    });
+
+    std::vector<std::string> allSteps{"api", "folder-links", "folder-links-minimum", "settings", "listeners", "session", "serving"};
+#if defined(_WIN32) || defined(__APPLE__)
+    allSteps.push_back("updater");
+#endif
+    startup.add("timings", allSteps, [&startup]
+    {
+        LOG_debug << "Startup timings (start+duration since the server started): " << startup.getSummary();
+    });
+
+    startup.start();
     megacmd::megacmd();
+    startup.waitForAll(); // none of them may be using what is about to be destroyed
     finalize(waitForRestartSignal);
 
     return 0;
@@ -40,6 +40,8 @@ using std::exception;
 
 #include "megaapi_impl.h"
 #include "megacmd_events.h"
+#include "megacmd_folder_link_cache.h"
+#include "megacmd_readiness.h"
 
 #define PROGRESS_COMPLETE -2
 namespace megacmd {
@@ -83,6 +85,8 @@ void changeprompt(const char *newprompt);
 void informStateListener(std::string message, int clientID);
 void broadcastMessage(std::string message, bool keepIfNoListeners = false);
 void informStateListeners(std::string s);
+bool setStateListenerSubscription(int clientID, const std::string &eventType, bool subscribe);
+void informSubscribedStateListeners(const std::string &eventType, const std::string &s);
 
 
 void removeDelayedBroadcastMatching(const std::string &toMatch);
@@ -114,6 +118,7 @@ public:
     {
         appendGreetingStatusAllListener(std::string("login:"));
         setloginInAtStartup(true);
+        Readiness::getInstance().onLoginStarted();
     }
 
     ~LoginGuard()
@@ -121,12 +126,20 @@ public:
         removeGreetingStatusAllListener(std::string("login:"));
         informStateListeners("loged:"); //send this even when failed!
         setloginInAtStartup(false);
+        Readiness::getInstance().onLoginFinished();
     }
 };
 
 
-mega::MegaApi* getFreeApiFolder();
-void freeApiFolder(mega::MegaApi *apiFolder);
+// Returns nullptr if there are no instances for folder links. If loggedIn is set, the instance is already
+// logged into the folder link and has its nodes fetched (it was kept from a previous access to it)
+mega::MegaApi* getFreeApiFolder(const std::string& folderLink, bool& loggedIn);
+// With keepLoggedIn, the instance stays logged into the folder link to be reused until it is idle for too long
+void freeApiFolder(mega::MegaApi *apiFolder, const std::string& folderLink, bool keepLoggedIn);
+bool logoutFromFolderLink(mega::MegaApi& apiFolder);
+void setApiFoldersIdleExpiry(std::chrono::seconds idleExpiry);
+void updateApiFoldersLimits(const std::function<void(megacmd::FolderLinkApiCache::Limits&)>& update);
+void setNodesSnapshotInterval(std::chrono::minutes interval);
 
 struct HelpFlags
 {
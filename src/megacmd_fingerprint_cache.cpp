@@ -0,0 +1,178 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_fingerprint_cache.h"
+
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace megacmd {
+
+namespace {
+    const char* CACHE_HEADER = "MEGAcmd fingerprints v2"; // v1 entries had neither device nor nanoseconds
+}
+
+std::optional<LocalFileInfo> getLocalFileInfo(const fs::path& path)
+{
+    LocalFileInfo info;
+#ifdef _WIN32
+    HANDLE h = CreateFileW(path.wstring().c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (h == INVALID_HANDLE_VALUE)
+    {
+        return {};
+    }
+
+    BY_HANDLE_FILE_INFORMATION fileInfo;
+    const bool ok = GetFileInformationByHandle(h, &fileInfo);
+    CloseHandle(h);
+    if (!ok)
+    {
+        return {};
+    }
+
+    info.mDevice = fileInfo.dwVolumeSerialNumber;
+    info.mInode = (static_cast<uint64_t>(fileInfo.nFileIndexHigh) << 32) | fileInfo.nFileIndexLow;
+    info.mSize = static_cast<int64_t>((static_cast<uint64_t>(fileInfo.nFileSizeHigh) << 32) | fileInfo.nFileSizeLow);
+
+    // FILETIME counts 100ns intervals since 1601-01-01
+    const uint64_t fileTime = (static_cast<uint64_t>(fileInfo.ftLastWriteTime.dwHighDateTime) << 32) | fileInfo.ftLastWriteTime.dwLowDateTime;
+    info.mMtime = static_cast<int64_t>(fileTime / 10000000ULL) - 11644473600LL;
+    info.mMtimeNanos = static_cast<int64_t>(fileTime % 10000000ULL) * 100;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st))
+    {
+        return {};
+    }
+
+    info.mDevice = static_cast<uint64_t>(st.st_dev);
+    info.mInode = static_cast<uint64_t>(st.st_ino);
+    info.mSize = static_cast<int64_t>(st.st_size);
+    info.mMtime = static_cast<int64_t>(st.st_mtime);
+#ifdef __APPLE__
+    info.mMtimeNanos = static_cast<int64_t>(st.st_mtimespec.tv_nsec);
+#else
+    info.mMtimeNanos = static_cast<int64_t>(st.st_mtim.tv_nsec);
+#endif
+#endif
+    return info;
+}
+
+LocalFingerprintCache::LocalFingerprintCache(const fs::path& cacheFilePath, size_t maxEntries) :
+    mCacheFilePath(cacheFilePath),
+    mMaxEntries(maxEntries)
+{
+    load();
+}
+
+void LocalFingerprintCache::load()
+{
+    std::ifstream ifs(mCacheFilePath, std::ios::binary);
+    std::string line;
+    if (!ifs.is_open() || !std::getline(ifs, line) || line != CACHE_HEADER)
+    {
+        return;
+    }
+
+    while (std::getline(ifs, line))
+    {
+        std::istringstream iss(line);
+        Key key;
+        std::string fingerprint;
+        if (iss >> key.mDevice >> key.mInode >> key.mMtime >> key.mMtimeNanos >> key.mSize >> fingerprint)
+        {
+            mEntries[key].mFingerprint = std::move(fingerprint);
+        }
+    }
+}
+
+std::string LocalFingerprintCache::getFingerprint(const fs::path& path, const LocalFileInfo& info, const ComputeFn& compute)
+{
+    const Key key{info.mDevice, info.mInode, info.mMtime, info.mMtimeNanos, info.mSize};
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        auto it = mEntries.find(key);
+        if (it != mEntries.end())
+        {
+            it->second.mUsed = true;
+            return it->second.mFingerprint;
+        }
+    }
+
+    // Reading the file can take long: not done while holding the lock
+    std::string fingerprint = compute(path);
+    if (fingerprint.empty() || fingerprint.find_first_of(" \t\r\n") != std::string::npos)
+    {
+        return fingerprint;
+    }
+
+    std::lock_guard<std::mutex> g(mMutex);
+    auto& value = mEntries[key];
+    value.mFingerprint = fingerprint;
+    value.mUsed = true;
+    mDirty = true;
+    return fingerprint;
+}
+
+bool LocalFingerprintCache::save()
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    if (!mDirty)
+    {
+        return true;
+    }
+
+    if (mEntries.size() > mMaxEntries)
+    {
+        for (auto it = mEntries.begin(); it != mEntries.end(); )
+        {
+            it = it->second.mUsed ? std::next(it) : mEntries.erase(it);
+        }
+    }
+
+    fs::path tmpPath = mCacheFilePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream ofs(tmpPath, std::ios::binary | std::ios::trunc);
+        ofs << CACHE_HEADER << '\n';
+        for (const auto& [key, value] : mEntries)
+        {
+            ofs << key.mDevice << ' ' << key.mInode << ' ' << key.mMtime << ' ' << key.mMtimeNanos << ' ' << key.mSize << ' ' << value.mFingerprint << '\n';
+        }
+        if (!ofs.flush())
+        {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, mCacheFilePath, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    mDirty = false;
+    return true;
+}
+
+} // end namespace
@@ -0,0 +1,92 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+
+#include "megacmd_utf8.h"
+
+namespace megacmd {
+
+struct LocalFileInfo
+{
+    uint64_t mInode = 0;
+    int64_t mMtime = 0; // seconds since epoch
+    int64_t mSize = 0;
+    uint64_t mDevice = 0; // inodes are only unique within a device
+    int64_t mMtimeNanos = 0; // within the second, so that rewrites within it are told apart
+};
+
+// Returns the identity and modification time of a local file, or nothing if it cannot be accessed
+std::optional<LocalFileInfo> getLocalFileInfo(const fs::path& path);
+
+/**
+ * @brief Persistent cache of local file fingerprints, keyed by device + inode + mtime (to the nanosecond) + size,
+ * so that files that have not changed do not need to be read again to obtain them.
+ */
+class LocalFingerprintCache
+{
+public:
+    using ComputeFn = std::function<std::string(const fs::path&)>;
+
+    explicit LocalFingerprintCache(const fs::path& cacheFilePath, size_t maxEntries = 1000000);
+
+    // Returns the fingerprint of the file, calling compute only if it is not cached (or the file changed since then).
+    // Empty if it could not be obtained.
+    std::string getFingerprint(const fs::path& path, const LocalFileInfo& info, const ComputeFn& compute);
+
+    // Writes the cache to disk if anything changed. When over the limit, entries not used since loaded are dropped.
+    bool save();
+
+private:
+    struct Key
+    {
+        uint64_t mDevice;
+        uint64_t mInode;
+        int64_t mMtime;
+        int64_t mMtimeNanos;
+        int64_t mSize;
+
+        bool operator<(const Key& other) const
+        {
+            return std::tie(mDevice, mInode, mMtime, mMtimeNanos, mSize)
+                    < std::tie(other.mDevice, other.mInode, other.mMtime, other.mMtimeNanos, other.mSize);
+        }
+    };
+
+    struct Value
+    {
+        std::string mFingerprint;
+        bool mUsed = false;
+    };
+
+    void load();
+
+    const fs::path mCacheFilePath;
+    const size_t mMaxEntries;
+
+    std::mutex mMutex;
+    std::map<Key, Value> mEntries;
+    bool mDirty = false;
+};
+
+} // end namespace
@@ -0,0 +1,100 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_folder_info_cache.h"
+
+namespace megacmd {
+
+std::optional<FolderInfoCache::Counts> FolderInfoCache::get(mega::MegaHandle folder) const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    auto it = mCounts.find(folder);
+    if (it == mCounts.end())
+    {
+        return {};
+    }
+    return it->second;
+}
+
+std::unordered_map<mega::MegaHandle, FolderInfoCache::Counts> FolderInfoCache::getAll() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mCounts;
+}
+
+uint64_t FolderInfoCache::getGeneration() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mGeneration;
+}
+
+void FolderInfoCache::set(mega::MegaHandle folder, const Counts& counts, uint64_t generation)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    if (generation == mGeneration)
+    {
+        mCounts[folder] = counts;
+    }
+}
+
+bool FolderInfoCache::empty() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mCounts.empty();
+}
+
+void FolderInfoCache::applyDelta(const std::vector<mega::MegaHandle>& ancestors, const Counts& delta)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mGeneration++;
+    for (auto handle : ancestors)
+    {
+        auto it = mCounts.find(handle);
+        if (it == mCounts.end())
+        {
+            continue;
+        }
+
+        Counts& counts = it->second;
+        counts.mFiles += delta.mFiles;
+        counts.mFolders += delta.mFolders;
+        counts.mSize += delta.mSize;
+        counts.mSizeWithVersions += delta.mSizeWithVersions;
+        if (counts.mFiles < 0 || counts.mFolders < 0 || counts.mSize < 0 || counts.mSizeWithVersions < counts.mSize)
+        {
+            // Out of sync: better fetch it again
+            mCounts.erase(it);
+        }
+    }
+}
+
+void FolderInfoCache::invalidate(const std::vector<mega::MegaHandle>& folders)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mGeneration++;
+    for (auto handle : folders)
+    {
+        mCounts.erase(handle);
+    }
+}
+
+void FolderInfoCache::clear()
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mGeneration++;
+    mCounts.clear();
+}
+
+} // end namespace
@@ -0,0 +1,67 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "megaapi.h"
+
+namespace megacmd {
+
+/**
+ * @brief Caches the result of folder info requests (the files, folders and bytes under each folder),
+ * keeping it up to date with the node updates received.
+ *
+ * Node updates are applied to every cached ancestor of the node updated: new or removed files, folders and
+ * versions adjust the totals, and changes whose effect cannot be known (like a removed folder) drop the cached values.
+ */
+class FolderInfoCache
+{
+public:
+    struct Counts
+    {
+        long long mFiles = 0;
+        long long mFolders = 0;
+        long long mSize = 0; // of the current version of the files
+        long long mSizeWithVersions = 0; // of every version of the files, the current ones included
+    };
+
+    std::optional<Counts> get(mega::MegaHandle folder) const;
+    std::unordered_map<mega::MegaHandle, Counts> getAll() const;
+
+    // Increased with every update. Values obtained before an update must not be cached.
+    uint64_t getGeneration() const;
+
+    // Caches counts obtained when the cache was at the given generation: ignored if there were updates since then
+    void set(mega::MegaHandle folder, const Counts& counts, uint64_t generation);
+
+    bool empty() const;
+
+    void applyDelta(const std::vector<mega::MegaHandle>& ancestors, const Counts& delta);
+    void invalidate(const std::vector<mega::MegaHandle>& folders);
+    void clear();
+
+private:
+    mutable std::mutex mMutex;
+    std::unordered_map<mega::MegaHandle, Counts> mCounts;
+    uint64_t mGeneration = 0;
+};
+
+} // end namespace
@@ -0,0 +1,424 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_folder_link_cache.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace megacmd {
+
+FolderLinkApiCache::FolderLinkApiCache(Clock::duration idleExpiry, ResetFunc&& reset) :
+    mIdleExpiry(idleExpiry),
+    mReset(std::move(reset))
+{
+}
+
+void FolderLinkApiCache::setElastic(const Limits& limits, CreateFunc&& create, DestroyFunc&& destroy)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mLimits = limits;
+    mCreate = std::move(create);
+    mDestroy = std::move(destroy);
+    createUpToMinimum(lock);
+}
+
+void FolderLinkApiCache::setLimits(const Limits& limits)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mLimits = limits;
+    createUpToMinimum(lock);
+}
+
+FolderLinkApiCache::Limits FolderLinkApiCache::getLimits() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mLimits;
+}
+
+void FolderLinkApiCache::add(mega::MegaApi* api)
+{
+    assert(api);
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        Entry entry;
+        entry.mApi = api;
+        entry.mSlot = mEntries.size();
+        mEntries.push_back(std::move(entry));
+        mStats.mPeakInstances = std::max(mStats.mPeakInstances, mEntries.size());
+    }
+    mCV.notify_all();
+}
+
+FolderLinkApiCache::Entry* FolderLinkApiCache::findEntry(mega::MegaApi* api)
+{
+    auto it = std::find_if(mEntries.begin(), mEntries.end(), [api](const Entry& e) { return e.mApi == api; });
+    return it == mEntries.end() ? nullptr : &*it;
+}
+
+std::optional<size_t> FolderLinkApiCache::reserveSlot()
+{
+    if (!mCreate || mClosed || getLiveCount() >= mLimits.mMax)
+    {
+        return {};
+    }
+
+    auto isTaken = [this](size_t slot)
+    {
+        return std::any_of(mEntries.begin(), mEntries.end(), [slot](const Entry& e) { return e.mSlot == slot; })
+            || std::find(mCreatingSlots.begin(), mCreatingSlots.end(), slot) != mCreatingSlots.end();
+    };
+
+    size_t slot = 0;
+    while (isTaken(slot))
+    {
+        ++slot;
+    }
+    mCreatingSlots.push_back(slot);
+    return slot;
+}
+
+mega::MegaApi* FolderLinkApiCache::create(std::unique_lock<std::mutex>& lock, size_t slot, bool inUse, Clock::time_point now)
+{
+    lock.unlock();
+    mega::MegaApi* api = mCreate(slot);
+    lock.lock();
+
+    mCreatingSlots.erase(std::find(mCreatingSlots.begin(), mCreatingSlots.end(), slot));
+    if (api && mClosed)
+    {
+        lock.unlock();
+        mDestroy(api);
+        lock.lock();
+        api = nullptr;
+    }
+
+    if (api)
+    {
+        Entry entry;
+        entry.mApi = api;
+        entry.mSlot = slot;
+        entry.mInUse = inUse;
+        entry.mLastUsed = now;
+        mEntries.push_back(std::move(entry));
+
+        mStats.mCreated++;
+        mStats.mPeakInstances = std::max(mStats.mPeakInstances, mEntries.size());
+    }
+
+    // Either there is a new free instance, or room to create another one
+    mCV.notify_all();
+    return api;
+}
+
+void FolderLinkApiCache::createUpToMinimum(std::unique_lock<std::mutex>& lock)
+{
+    while (getLiveCount() < std::min(mLimits.mMin, mLimits.mMax))
+    {
+        auto slot = reserveSlot();
+        if (!slot || !create(lock, *slot, false, Clock::now()))
+        {
+            break;
+        }
+    }
+}
+
+FolderLinkApiCache::Lease FolderLinkApiCache::acquire(const std::string& key, Clock::time_point now)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    std::optional<Clock::time_point> waitStart;
+    auto recordWait = [this, &waitStart]()
+    {
+        if (!waitStart)
+        {
+            return std::chrono::milliseconds(0);
+        }
+
+        const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - *waitStart);
+        mStats.mWaits++;
+        mStats.mTotalWait += waited;
+        mStats.mMaxWait = std::max(mStats.mMaxWait, waited);
+        return waited;
+    };
+
+    bool creationFailed = false;
+    while (true)
+    {
+        Entry* hit = nullptr;
+        Entry* unbound = nullptr;
+        Entry* leastRecentlyUsed = nullptr;
+        for (Entry& entry : mEntries)
+        {
+            if (entry.mInUse)
+            {
+                continue;
+            }
+
+            if (entry.mKey.empty())
+            {
+                unbound = (unbound ? unbound : &entry);
+            }
+            else if (entry.mKey == key)
+            {
+                hit = (hit && hit->mLastUsed > entry.mLastUsed ? hit : &entry);
+            }
+            else if (!leastRecentlyUsed || entry.mLastUsed < leastRecentlyUsed->mLastUsed)
+            {
+                leastRecentlyUsed = &entry;
+            }
+        }
+
+        if (hit)
+        {
+            hit->mInUse = true;
+            hit->mLastUsed = now;
+            mStats.mHits++;
+            return {hit->mApi, true, recordWait()};
+        }
+
+        if (unbound)
+        {
+            unbound->mInUse = true;
+            unbound->mLastUsed = now;
+            mStats.mMisses++;
+            return {unbound->mApi, false, recordWait()};
+        }
+
+        // Growing the pool is preferred to evicting what other links have fetched
+        if (auto slot = (creationFailed ? std::nullopt : reserveSlot()); slot)
+        {
+            if (mega::MegaApi* api = create(lock, *slot, true, now); api)
+            {
+                mStats.mMisses++;
+                return {api, false, recordWait()};
+            }
+            creationFailed = true;
+            continue; // the lock was released: look again
+        }
+
+        if (leastRecentlyUsed)
+        {
+            leastRecentlyUsed->mInUse = true;
+            leastRecentlyUsed->mLastUsed = now;
+            leastRecentlyUsed->mKey.clear();
+            mStats.mMisses++;
+            mStats.mEvictions++;
+            const auto waited = recordWait();
+
+            mega::MegaApi* api = leastRecentlyUsed->mApi;
+            lock.unlock();
+            mReset(api);
+            return {api, false, waited};
+        }
+
+        if (mEntries.empty() && mCreatingSlots.empty())
+        {
+            return {};
+        }
+
+        if (!waitStart)
+        {
+            waitStart = Clock::now();
+        }
+        mCV.wait(lock);
+    }
+}
+
+void FolderLinkApiCache::release(mega::MegaApi* api, const std::string& key, bool keepBound, Clock::time_point now)
+{
+    bool cachingDisabled;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        cachingDisabled = (mIdleExpiry <= Clock::duration::zero());
+    }
+
+    if (keepBound && (cachingDisabled || key.empty()))
+    {
+        mReset(api);
+        keepBound = false;
+    }
+
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        Entry* entry = findEntry(api);
+        if (!entry) // taken by takeAll
+        {
+            return;
+        }
+
+        entry->mInUse = false;
+        entry->mKey = (keepBound ? key : std::string());
+        entry->mLastUsed = now;
+    }
+    mCV.notify_all(); // waiters may be waiting for this very key
+}
+
+size_t FolderLinkApiCache::expireIdle(Clock::time_point now)
+{
+    std::vector<mega::MegaApi*> expired;
+    std::vector<mega::MegaApi*> reclaimed;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        for (Entry& entry : mEntries)
+        {
+            if (!entry.mInUse && !entry.mKey.empty() && now - entry.mLastUsed >= mIdleExpiry)
+            {
+                entry.mInUse = true; // so nobody acquires it while it is being reset
+                entry.mKey.clear();
+                entry.mLastUsed = now; // the reclaim time counts from now
+                expired.push_back(entry.mApi);
+            }
+        }
+        mStats.mExpirations += expired.size();
+
+        if (mDestroy)
+        {
+            for (auto it = mEntries.begin(); it != mEntries.end() && mEntries.size() > mLimits.mMin;)
+            {
+                if (!it->mInUse && it->mKey.empty() && now - it->mLastUsed >= mLimits.mReclaimAfter)
+                {
+                    reclaimed.push_back(it->mApi);
+                    it = mEntries.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            mStats.mDestroyed += reclaimed.size();
+        }
+    }
+
+    for (mega::MegaApi* api : reclaimed)
+    {
+        mDestroy(api);
+    }
+
+    if (expired.empty())
+    {
+        return reclaimed.size();
+    }
+
+    for (mega::MegaApi* api : expired)
+    {
+        mReset(api);
+    }
+
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        for (mega::MegaApi* api : expired)
+        {
+            if (Entry* entry = findEntry(api); entry)
+            {
+                entry->mInUse = false;
+            }
+        }
+    }
+    mCV.notify_all();
+    return expired.size() + reclaimed.size();
+}
+
+std::optional<FolderLinkApiCache::Clock::time_point> FolderLinkApiCache::getNextExpiry() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    const bool canReclaim = mDestroy && mEntries.size() > mLimits.mMin;
+
+    std::optional<Clock::time_point> next;
+    for (const Entry& entry : mEntries)
+    {
+        if (entry.mInUse || (entry.mKey.empty() && !canReclaim))
+        {
+            continue;
+        }
+
+        const auto deadline = entry.mLastUsed + (entry.mKey.empty() ? mLimits.mReclaimAfter : mIdleExpiry);
+        if (!next || deadline < *next)
+        {
+            next = deadline;
+        }
+    }
+    return next;
+}
+
+void FolderLinkApiCache::setIdleExpiry(Clock::duration idleExpiry)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mIdleExpiry = idleExpiry;
+}
+
+FolderLinkApiCache::Stats FolderLinkApiCache::getStats() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    Stats stats = mStats;
+    stats.mInstances = mEntries.size();
+    for (const Entry& entry : mEntries)
+    {
+        stats.mBound += !entry.mKey.empty();
+        stats.mInUse += entry.mInUse;
+    }
+    return stats;
+}
+
+std::vector<mega::MegaApi*> FolderLinkApiCache::takeAll()
+{
+    std::vector<mega::MegaApi*> apis;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        for (const Entry& entry : mEntries)
+        {
+            apis.push_back(entry.mApi);
+        }
+        mEntries.clear();
+        mClosed = true;
+    }
+    mCV.notify_all();
+    return apis;
+}
+
+std::string FolderLinkApiCache::getKey(const std::string& folderLink)
+{
+    std::string key = folderLink;
+    const auto hashPos = key.find('#');
+    if (hashPos == std::string::npos)
+    {
+        return key;
+    }
+
+    // Legacy format: #F!handle!key[!subhandle|?subhandle]
+    if (key.compare(hashPos, 3, "#F!") == 0)
+    {
+        const auto keySep = key.find('!', hashPos + 3);
+        if (keySep != std::string::npos)
+        {
+            const auto subSep = key.find_first_of("!?", keySep + 1);
+            if (subSep != std::string::npos)
+            {
+                key.resize(subSep);
+            }
+        }
+        return key;
+    }
+
+    // folder/handle#key[/folder/subhandle|/file/subhandle]: keys are base64url, so they contain no '/'
+    const auto subPos = key.find_first_of("/?", hashPos + 1);
+    if (subPos != std::string::npos)
+    {
+        key.resize(subPos);
+    }
+    return key;
+}
+
+} // end namespace
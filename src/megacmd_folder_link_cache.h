@@ -0,0 +1,154 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mega {
+class MegaApi;
+}
+
+namespace megacmd {
+
+/**
+ * @brief Pool of the auxiliary MegaApi instances used to access folder links, which keeps them
+ * logged into the last folder link they accessed so that the nodes don't need to be fetched again.
+ *
+ * An instance logged into a folder link is bound to the link's key until it is evicted (least recently
+ * used first, when another link needs an instance) or it stays idle for longer than the idle expiry.
+ * Evicted and expired instances are reset (logged out) through the reset function, never with the lock held.
+ * With an idle expiry of zero instances are never kept bound, which is the same as not caching at all.
+ *
+ * With a create function the pool is elastic: instances are created on demand, up to the maximum, when
+ * none is free (before evicting any bound one), and the ones left unbound and idle for longer than the
+ * reclaim time are destroyed, down to the minimum. Each instance gets a slot below the maximum that no
+ * other live instance has, to be used e.g. for its working folder.
+ */
+class FolderLinkApiCache
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using ResetFunc = std::function<void(mega::MegaApi*)>;
+    using CreateFunc = std::function<mega::MegaApi*(size_t slot)>; // may return nullptr
+    using DestroyFunc = std::function<void(mega::MegaApi*)>;
+
+    struct Limits
+    {
+        size_t mMin = 0;
+        size_t mMax = 0;
+        Clock::duration mReclaimAfter = std::chrono::minutes(5);
+    };
+
+    struct Lease
+    {
+        mega::MegaApi* mApi = nullptr;
+        bool mHit = false; // already logged into the requested link, with its nodes fetched
+        std::chrono::milliseconds mWaited{0}; // for an instance to be free
+    };
+
+    struct Stats
+    {
+        uint64_t mHits = 0;
+        uint64_t mMisses = 0;
+        uint64_t mEvictions = 0;
+        uint64_t mExpirations = 0;
+        uint64_t mCreated = 0;
+        uint64_t mDestroyed = 0;
+        size_t mInstances = 0;
+        size_t mPeakInstances = 0;
+        size_t mBound = 0;
+        size_t mInUse = 0;
+
+        // Acquisitions that had to wait for an instance to be free
+        uint64_t mWaits = 0;
+        std::chrono::milliseconds mTotalWait{0};
+        std::chrono::milliseconds mMaxWait{0};
+    };
+
+    FolderLinkApiCache(Clock::duration idleExpiry, ResetFunc&& reset);
+
+    FolderLinkApiCache(const FolderLinkApiCache&) = delete;
+    FolderLinkApiCache& operator=(const FolderLinkApiCache&) = delete;
+
+    // Makes the pool elastic, and creates instances up to the minimum right away
+    void setElastic(const Limits& limits, CreateFunc&& create, DestroyFunc&& destroy);
+    void setLimits(const Limits& limits);
+    Limits getLimits() const;
+
+    // The cache does not own the instances: see takeAll
+    void add(mega::MegaApi* api);
+
+    // Waits until an instance is free. Returns an empty lease if there are no instances at all
+    Lease acquire(const std::string& key, Clock::time_point now = Clock::now());
+
+    // With keepBound the instance is logged into key and can be handed to the next acquire of it.
+    // Otherwise it must have been logged out already (or never logged in)
+    void release(mega::MegaApi* api, const std::string& key, bool keepBound, Clock::time_point now = Clock::now());
+
+    // Resets the bound instances that have been idle for at least the idle expiry, and destroys the unbound ones
+    // idle for at least the reclaim time (keeping the minimum). Returns how many instances were reset or destroyed
+    size_t expireIdle(Clock::time_point now = Clock::now());
+
+    // When the next instance will expire or be reclaimed, if any
+    std::optional<Clock::time_point> getNextExpiry() const;
+
+    void setIdleExpiry(Clock::duration idleExpiry);
+    Stats getStats() const;
+
+    // Removes all the instances (including the ones in use) and hands them to the caller
+    std::vector<mega::MegaApi*> takeAll();
+
+    // The part of a folder link identifying the folder, so that links to its subfolders and files share instances
+    static std::string getKey(const std::string& folderLink);
+
+private:
+    struct Entry
+    {
+        mega::MegaApi* mApi = nullptr;
+        size_t mSlot = 0;
+        std::string mKey; // empty if not logged in
+        bool mInUse = false;
+        Clock::time_point mLastUsed;
+    };
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCV;
+    std::vector<Entry> mEntries;
+    Clock::duration mIdleExpiry;
+    ResetFunc mReset;
+    Stats mStats;
+
+    Limits mLimits;
+    CreateFunc mCreate;
+    DestroyFunc mDestroy;
+    std::vector<size_t> mCreatingSlots; // being created, without the lock held
+    bool mClosed = false; // after takeAll
+
+    Entry* findEntry(mega::MegaApi* api);
+    size_t getLiveCount() const { return mEntries.size() + mCreatingSlots.size(); }
+    std::optional<size_t> reserveSlot(); // if below the maximum
+    mega::MegaApi* create(std::unique_lock<std::mutex>& lock, size_t slot, bool inUse, Clock::time_point now);
+    void createUpToMinimum(std::unique_lock<std::mutex>& lock);
+};
+
+} // end namespace
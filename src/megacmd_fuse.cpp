@@ -43,6 +43,11 @@ std::string_view getIdentifierParameter()
 #include "listeners.h"
 #include "megacmdlogger.h"
 #include "configurationmanager.h"
+#include "megacmdutils.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
 
 using namespace mega;
 using namespace megacmd;
@@ -51,6 +56,38 @@ namespace FuseCommand {
 namespace {
 
 constexpr const char* sFirstMountConfigKey = "firstFuseMountConfigured";
+constexpr const char* sInodeCacheMaxSizeConfigKey = "FuseSettings:inodeCacheMaxSize";
+constexpr const char* sInodeCacheCleanAgeConfigKey = "FuseSettings:inodeCacheCleanAge";
+constexpr const char* sFlushDelayConfigKey = "FuseSettings:flushDelay";
+
+struct MountActivity
+{
+    std::optional<std::chrono::system_clock::time_point> mEnabledSince;
+    unsigned mEnableCount = 0;
+    unsigned mDisableCount = 0;
+    unsigned mChangeCount = 0;
+    unsigned mFailureCount = 0;
+    std::optional<std::chrono::system_clock::time_point> mLastFailure;
+};
+
+std::mutex sMountActivityMutex;
+std::map<std::string, MountActivity> sMountActivityByPath;
+
+std::optional<MountActivity> getMountActivity(const std::string& path)
+{
+    std::lock_guard<std::mutex> g(sMountActivityMutex);
+    auto it = sMountActivityByPath.find(path);
+    if (it == sMountActivityByPath.end())
+    {
+        return {};
+    }
+    return it->second;
+}
+
+std::string timePointToText(std::chrono::system_clock::time_point timePoint)
+{
+    return getReadableTime(std::chrono::system_clock::to_time_t(timePoint));
+}
 
 std::string getNodePath(MegaApi& api, MegaNode& node)
 {
@@ -331,7 +368,36 @@ void printMount(mega::MegaApi& api, const mega::MegaMount& mount)
         << "  Enable at startup:  " <<  (flags->getEnableAtStartup() ? "YES" : "NO") << "\n"
         << "  Read-only:          " << (flags->getReadOnly() ? "YES" : "NO") << "\n";
 
+    const bool enabled = api.isMountEnabled(flags->getName());
+    const auto activity = getMountActivity(mount.getPath());
+    oss << "Activity since the server started\n"
+        << "  Enabled since:      ";
+    if (!enabled)
+    {
+        oss << "-";
+    }
+    else if (activity && activity->mEnabledSince)
+    {
+        oss << timePointToText(*activity->mEnabledSince);
+    }
+    else
+    {
+        oss << "<unknown>";
+    }
+    oss << "\n"
+        << "  Times enabled:      " << (activity ? activity->mEnableCount : 0) << "\n"
+        << "  Times disabled:     " << (activity ? activity->mDisableCount : 0) << "\n"
+        << "  Flag changes:       " << (activity ? activity->mChangeCount : 0) << "\n"
+        << "  Failed operations:  " << (activity ? activity->mFailureCount : 0);
+    if (activity && activity->mLastFailure)
+    {
+        oss << " (last on " << timePointToText(*activity->mLastFailure) << ")";
+    }
+    oss << "\n"
+        << "Settings shared by all mounts (see fuse-config)\n";
+
     OUTSTREAM << oss.str();
+    printSettings(api);
 }
 
 void printAllMounts(mega::MegaApi& api, ColumnDisplayer& cd, bool onlyEnabled, bool disablePathCollapse, int rowCountLimit)
@@ -385,6 +451,11 @@ bool ConfigDelta::isAnyFlagSet() const
     return mEnableAtStartup || mPersistent || mReadOnly || mName;
 }
 
+bool ConfigDelta::isAnySettingSet() const
+{
+    return mInodeCacheMaxSize || mInodeCacheCleanAge || mFlushDelay;
+}
+
 bool ConfigDelta::isPersistentStartupInvalid() const
 {
     bool enableAtStartup = mEnableAtStartup && *mEnableAtStartup;
@@ -436,6 +507,126 @@ void changeConfig(mega::MegaApi& api, const mega::MegaMount& mount, const Config
               << "  Persistent:         " << (flags->getPersistent() ? "YES" : "NO") << "\n"
               << "  Read-only:          " << (flags->getReadOnly() ? "YES" : "NO") << "\n";
 }
+
+namespace {
+void applySettings(MegaApi& api, const ConfigDelta& delta)
+{
+    std::unique_ptr<MegaFuseFlags> fuseFlags(api.getFUSEFlags());
+    assert(fuseFlags);
+
+    MegaFuseInodeCacheFlags* inodeCacheFlags = fuseFlags->getInodeCacheFlags();
+    assert(inodeCacheFlags);
+
+    if (delta.mInodeCacheMaxSize)
+    {
+        inodeCacheFlags->setMaxSize(*delta.mInodeCacheMaxSize);
+
+        // The cache cannot evict more inodes than it can hold
+        if (inodeCacheFlags->getCleanSize() > *delta.mInodeCacheMaxSize)
+        {
+            inodeCacheFlags->setCleanSize(*delta.mInodeCacheMaxSize);
+        }
+    }
+    if (delta.mInodeCacheCleanAge)
+    {
+        inodeCacheFlags->setCleanAgeThreshold(*delta.mInodeCacheCleanAge);
+    }
+    if (delta.mFlushDelay)
+    {
+        fuseFlags->setFlushDelay(*delta.mFlushDelay);
+    }
+
+    api.setFUSEFlags(fuseFlags.get());
+}
+} // end namespace
+
+void changeSettings(mega::MegaApi& api, const ConfigDelta& delta)
+{
+    assert(delta.isAnySettingSet());
+
+    applySettings(api, delta);
+
+    if (delta.mInodeCacheMaxSize)
+    {
+        ConfigurationManager::savePropertyValue(sInodeCacheMaxSizeConfigKey, *delta.mInodeCacheMaxSize);
+    }
+    if (delta.mInodeCacheCleanAge)
+    {
+        ConfigurationManager::savePropertyValue(sInodeCacheCleanAgeConfigKey, *delta.mInodeCacheCleanAge);
+    }
+    if (delta.mFlushDelay)
+    {
+        ConfigurationManager::savePropertyValue(sFlushDelayConfigKey, *delta.mFlushDelay);
+    }
+
+    OUTSTREAM << "FUSE settings (shared by all mounts) are now\n";
+    printSettings(api);
+}
+
+void loadSettingsFromConfigurationManager(mega::MegaApi& api)
+{
+    ConfigDelta delta;
+    delta.mInodeCacheMaxSize = ConfigurationManager::getConfigurationValueOpt<size_t>(sInodeCacheMaxSizeConfigKey);
+    delta.mInodeCacheCleanAge = ConfigurationManager::getConfigurationValueOpt<size_t>(sInodeCacheCleanAgeConfigKey);
+    delta.mFlushDelay = ConfigurationManager::getConfigurationValueOpt<size_t>(sFlushDelayConfigKey);
+
+    if (delta.isAnySettingSet())
+    {
+        applySettings(api, delta);
+        LOG_debug << "Restored saved FUSE settings";
+    }
+}
+
+void printSettings(mega::MegaApi& api)
+{
+    std::unique_ptr<MegaFuseFlags> fuseFlags(api.getFUSEFlags());
+    assert(fuseFlags);
+
+    const MegaFuseInodeCacheFlags* inodeCacheFlags = fuseFlags->getInodeCacheFlags();
+    assert(inodeCacheFlags);
+
+    OUTSTREAM << "  Inode cache size:   " << inodeCacheFlags->getMaxSize() << " inodes\n"
+              << "  Inode cache age:    " << secondsToText(static_cast<m_time_t>(inodeCacheFlags->getCleanAgeThreshold())) << "\n"
+              << "  Flush delay:        " << secondsToText(static_cast<m_time_t>(fuseFlags->getFlushDelay())) << "\n";
+}
+
+void onMountEvent(const std::string& path, MountEvent event, bool succeeded)
+{
+    const auto now = std::chrono::system_clock::now();
+
+    std::lock_guard<std::mutex> g(sMountActivityMutex);
+    if (event == MountEvent::REMOVED && succeeded)
+    {
+        sMountActivityByPath.erase(path);
+        return;
+    }
+
+    MountActivity& activity = sMountActivityByPath[path];
+    if (!succeeded)
+    {
+        activity.mFailureCount++;
+        activity.mLastFailure = now;
+        return;
+    }
+
+    switch (event)
+    {
+        case MountEvent::ENABLED:
+            activity.mEnableCount++;
+            activity.mEnabledSince = now;
+            break;
+        case MountEvent::DISABLED:
+            activity.mDisableCount++;
+            activity.mEnabledSince.reset();
+            break;
+        case MountEvent::CHANGED:
+            activity.mChangeCount++;
+            break;
+        case MountEvent::ADDED:
+        case MountEvent::REMOVED:
+            break;
+    }
+}
 }
 
 #endif // WITH_FUSE
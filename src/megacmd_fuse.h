@@ -49,11 +49,27 @@ namespace FuseCommand
         std::optional<bool> mReadOnly;
         std::optional<std::string> mName;
 
+        // Settings shared by all mounts
+        std::optional<size_t> mInodeCacheMaxSize;
+        std::optional<size_t> mInodeCacheCleanAge;
+        std::optional<size_t> mFlushDelay;
+
         bool isAnyFlagSet() const;
+        bool isAnySettingSet() const;
         bool isPersistentStartupInvalid() const;
     };
 
     void changeConfig(mega::MegaApi& api, const mega::MegaMount& mount, const ConfigDelta& delta);
+
+    // Applies and saves the settings of the delta, so they are restored on startup
+    void changeSettings(mega::MegaApi& api, const ConfigDelta& delta);
+    void loadSettingsFromConfigurationManager(mega::MegaApi& api);
+    void printSettings(mega::MegaApi& api);
+
+    enum class MountEvent { ADDED, REMOVED, CHANGED, ENABLED, DISABLED };
+
+    // Keeps track of the activity of each mount (by local path) since the server started
+    void onMountEvent(const std::string& path, MountEvent event, bool succeeded);
 }
 
 #endif // WITH_FUSE
@@ -0,0 +1,350 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_ignore_filters.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace megacmd {
+
+namespace {
+    std::string toLowerAscii(std::string_view str)
+    {
+        std::string lower(str);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [] (unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower;
+    }
+
+    bool hasWildcards(std::string_view str)
+    {
+        return str.find_first_of("*?") != std::string_view::npos;
+    }
+
+    // Classic iterative glob matching: on mismatch, backtrack to the last '*' and let it swallow one more character
+    bool globMatch(std::string_view pattern, std::string_view subject)
+    {
+        size_t p = 0;
+        size_t s = 0;
+        size_t starP = std::string_view::npos;
+        size_t starS = 0;
+
+        while (s < subject.size())
+        {
+            if (p < pattern.size() && pattern[p] == '*')
+            {
+                starP = p++;
+                starS = s;
+                continue;
+            }
+
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == subject[s]))
+            {
+                ++p;
+                ++s;
+                continue;
+            }
+
+            if (starP == std::string_view::npos)
+            {
+                return false;
+            }
+            p = starP + 1;
+            s = ++starS;
+        }
+
+        while (p < pattern.size() && pattern[p] == '*')
+        {
+            ++p;
+        }
+        return p == pattern.size();
+    }
+
+    bool endsWith(std::string_view str, std::string_view suffix)
+    {
+        return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+std::optional<IgnoreFilters::Filter> IgnoreFilters::parseFilter(const std::string& text, std::string& error)
+{
+    const size_t colon = text.find(':');
+    if (text.empty() || (text[0] != '-' && text[0] != '+') || colon == std::string::npos || colon + 1 == text.size() || colon > 4)
+    {
+        error = "The filter \"" + text + "\" does not have valid format";
+        return {};
+    }
+
+    Filter filter;
+    filter.mText = text;
+    filter.mExclude = text[0] == '-';
+
+    bool regex = false;
+    size_t i = 1;
+    if (i < colon && std::string_view("adfs").find(text[i]) != std::string_view::npos)
+    {
+        filter.mTarget = text[i] == 'd' ? Target::FOLDERS : (text[i] == 'f' ? Target::FILES : (text[i] == 's' ? Target::SYMLINKS : Target::ALL));
+        ++i;
+    }
+    if (i < colon && std::string_view("Nnp").find(text[i]) != std::string_view::npos)
+    {
+        filter.mType = text[i] == 'N' ? Type::DIRECT_CHILD_NAME : (text[i] == 'p' ? Type::PATH : Type::NAME);
+        ++i;
+    }
+    if (i < colon && std::string_view("GgRr").find(text[i]) != std::string_view::npos)
+    {
+        regex = text[i] == 'R' || text[i] == 'r';
+        filter.mCaseSensitive = text[i] == 'G' || text[i] == 'R';
+        ++i;
+    }
+    if (i != colon)
+    {
+        error = "The filter \"" + text + "\" does not have valid format";
+        return {};
+    }
+
+    std::string pattern = text.substr(colon + 1);
+    if (regex)
+    {
+        try
+        {
+            auto flags = std::regex::extended | std::regex::optimize;
+            if (!filter.mCaseSensitive)
+            {
+                flags |= std::regex::icase;
+            }
+            filter.mRegex.emplace(pattern, flags);
+        }
+        catch (const std::regex_error& e)
+        {
+            error = "The filter \"" + text + "\" is not a valid regular expression: " + e.what();
+            return {};
+        }
+        filter.mMatchKind = MatchKind::REGEX;
+        filter.mPattern = std::move(pattern);
+        return filter;
+    }
+
+    if (!filter.mCaseSensitive)
+    {
+        pattern = toLowerAscii(pattern);
+    }
+
+    // Globs whose only wildcards are leading/trailing '*' become plain string comparisons
+    const bool leadingStar = pattern.size() > 1 && pattern.front() == '*';
+    const bool trailingStar = pattern.size() > 1 && pattern.back() == '*';
+    const std::string_view inner = std::string_view(pattern).substr(leadingStar ? 1 : 0, pattern.size() - (leadingStar ? 1 : 0) - (trailingStar ? 1 : 0));
+
+    if (!hasWildcards(pattern))
+    {
+        filter.mMatchKind = MatchKind::LITERAL;
+    }
+    else if (!inner.empty() && !hasWildcards(inner))
+    {
+        filter.mMatchKind = leadingStar && trailingStar ? MatchKind::CONTAINS : (leadingStar ? MatchKind::SUFFIX : MatchKind::PREFIX);
+        pattern = std::string(inner);
+    }
+    else
+    {
+        filter.mMatchKind = MatchKind::GLOB;
+    }
+    filter.mPattern = std::move(pattern);
+    return filter;
+}
+
+std::unique_ptr<IgnoreFilters> IgnoreFilters::compile(const std::vector<std::string>& filterTexts, std::string& error)
+{
+    std::unique_ptr<IgnoreFilters> filters(new IgnoreFilters());
+    for (const auto& text : filterTexts)
+    {
+        auto filter = parseFilter(text, error);
+        if (!filter)
+        {
+            return nullptr;
+        }
+
+        const int index = static_cast<int>(filters->mFilters.size());
+        const bool byName = filter->mType != Type::PATH;
+        if (byName && filter->mMatchKind == MatchKind::LITERAL)
+        {
+            auto& literals = filter->mCaseSensitive ? filters->mLiteralNames : filters->mLiteralNamesCaseInsensitive;
+            literals[filter->mPattern].push_back(index);
+        }
+        else if (byName && filter->mMatchKind == MatchKind::SUFFIX && filter->mPattern.rfind('.') == 0)
+        {
+            auto& extensions = filter->mCaseSensitive ? filters->mExtensions : filters->mExtensionsCaseInsensitive;
+            extensions[filter->mPattern].push_back(index);
+        }
+        else
+        {
+            filters->mScannedFilters.push_back(index);
+        }
+
+        filters->mAnyCaseInsensitive = filters->mAnyCaseInsensitive || !filter->mCaseSensitive;
+        filters->mFilters.push_back(std::move(*filter));
+    }
+
+    std::reverse(filters->mScannedFilters.begin(), filters->mScannedFilters.end());
+    return filters;
+}
+
+bool IgnoreFilters::Filter::appliesTo(bool isFolder, size_t depth) const
+{
+    if (mType == Type::DIRECT_CHILD_NAME && depth)
+    {
+        return false;
+    }
+
+    switch (mTarget)
+    {
+        case Target::ALL: return true;
+        case Target::FOLDERS: return isFolder;
+        case Target::FILES: return !isFolder;
+        case Target::SYMLINKS: return false; // symlinks are never synced, so these filters never matter
+    }
+    return false;
+}
+
+bool IgnoreFilters::Filter::matches(std::string_view subject) const
+{
+    switch (mMatchKind)
+    {
+        case MatchKind::LITERAL: return subject == mPattern;
+        case MatchKind::PREFIX: return subject.compare(0, mPattern.size(), mPattern) == 0;
+        case MatchKind::SUFFIX: return endsWith(subject, mPattern);
+        case MatchKind::CONTAINS: return subject.find(mPattern) != std::string_view::npos;
+        case MatchKind::GLOB: return globMatch(mPattern, subject);
+        case MatchKind::REGEX: return std::regex_match(subject.begin(), subject.end(), *mRegex);
+    }
+    return false;
+}
+
+IgnoreFilters::Result IgnoreFilters::evaluateEntry(std::string_view relativePath, std::string_view name, bool isFolder, size_t depth) const
+{
+    int best = -1;
+
+    std::string lowerPath;
+    std::string_view lowerName;
+    if (mAnyCaseInsensitive)
+    {
+        lowerPath = toLowerAscii(relativePath);
+        lowerName = std::string_view(lowerPath).substr(lowerPath.size() - name.size());
+    }
+
+    auto lookUp = [this, &best, isFolder, depth] (const std::unordered_map<std::string, std::vector<int>>& literals, std::string_view key)
+    {
+        if (literals.empty())
+        {
+            return;
+        }
+
+        auto it = literals.find(std::string(key));
+        if (it == literals.end())
+        {
+            return;
+        }
+
+        for (auto indexIt = it->second.rbegin(); indexIt != it->second.rend() && *indexIt > best; ++indexIt)
+        {
+            if (mFilters[*indexIt].appliesTo(isFolder, depth))
+            {
+                best = *indexIt;
+                break;
+            }
+        }
+    };
+    lookUp(mLiteralNames, name);
+    lookUp(mLiteralNamesCaseInsensitive, lowerName);
+
+    if (const size_t dot = name.rfind('.'); dot != std::string_view::npos)
+    {
+        lookUp(mExtensions, name.substr(dot));
+        if (!mExtensionsCaseInsensitive.empty())
+        {
+            lookUp(mExtensionsCaseInsensitive, lowerName.substr(dot));
+        }
+    }
+
+    // Filters are scanned from the last one: the first match found is the one that decides
+    for (int index : mScannedFilters)
+    {
+        if (index <= best)
+        {
+            break;
+        }
+
+        const Filter& filter = mFilters[index];
+        if (!filter.appliesTo(isFolder, depth))
+        {
+            continue;
+        }
+
+        const bool byPath = filter.mType == Type::PATH;
+        const bool lowercase = !filter.mCaseSensitive && filter.mMatchKind != MatchKind::REGEX;
+        std::string_view subject = byPath ? (lowercase ? std::string_view(lowerPath) : relativePath)
+                                          : (lowercase ? lowerName : name);
+        if (filter.matches(subject))
+        {
+            best = index;
+            break;
+        }
+    }
+
+    Result result;
+    result.mFilterIndex = best;
+    result.mExcluded = best >= 0 && mFilters[best].mExclude;
+    return result;
+}
+
+IgnoreFiltersEvaluator::Result IgnoreFiltersEvaluator::evaluate(std::string_view relativePath, bool isFolder)
+{
+    size_t depth = 0;
+    size_t start = 0;
+    while (true)
+    {
+        const size_t end = relativePath.find('/', start);
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+
+        const std::string_view ancestorPath = relativePath.substr(0, end);
+        if (mAncestors.size() <= depth || mAncestors[depth].mPath != ancestorPath)
+        {
+            mAncestors.resize(depth);
+            Ancestor ancestor;
+            ancestor.mPath = std::string(ancestorPath);
+            ancestor.mResult = mFilters.evaluateEntry(ancestorPath, ancestorPath.substr(start), true, depth);
+            mAncestors.push_back(std::move(ancestor));
+        }
+
+        if (mAncestors[depth].mResult.mExcluded)
+        {
+            Result result;
+            static_cast<IgnoreFilters::Result&>(result) = mAncestors[depth].mResult;
+            result.mExcludedAncestor = mAncestors[depth].mPath;
+            return result;
+        }
+
+        start = end + 1;
+        ++depth;
+    }
+
+    Result result;
+    static_cast<IgnoreFilters::Result&>(result) = mFilters.evaluateEntry(relativePath, relativePath.substr(start), isFolder, depth);
+    return result;
+}
+
+} // end namespace
@@ -0,0 +1,128 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace megacmd {
+
+/**
+ * @brief The name filters of a .megaignore file, compiled to evaluate lots of paths quickly.
+ *
+ * Filters have the form <CLASS><TARGET><TYPE><STRATEGY>:<PATTERN>:
+ *  - CLASS: '-' excludes, '+' includes.
+ *  - TARGET: 'a' all (default), 'd' folders, 'f' files, 's' symlinks.
+ *  - TYPE: 'n' name at any depth (default), 'N' name of the direct children only, 'p' relative path.
+ *  - STRATEGY: 'G'/'g' glob (default 'G'), 'R'/'r' POSIX extended regular expression (uppercase is case sensitive).
+ *    Like the sync engine's, globs only have the '*' and '?' wildcards: any other character, '[' included, is literal.
+ *
+ * The last filter matching an entry decides whether it's excluded; entries no filter matches are included.
+ * Globs are turned into literal, prefix, suffix or substring comparisons whenever possible, and literal
+ * names and extensions are looked up in hash tables, so most filters are never evaluated one by one.
+ */
+class IgnoreFilters
+{
+public:
+    struct Result
+    {
+        bool mExcluded = false;
+        int mFilterIndex = -1; // -1 if no filter matched
+    };
+
+    // Returns nullptr and sets error if any filter is malformed (size filters and comments are not accepted)
+    static std::unique_ptr<IgnoreFilters> compile(const std::vector<std::string>& filters, std::string& error);
+
+    // Evaluates a single entry, assuming its ancestors are included. Depth 0 means a direct child.
+    Result evaluateEntry(std::string_view relativePath, std::string_view name, bool isFolder, size_t depth) const;
+
+    size_t size() const { return mFilters.size(); }
+    const std::string& getFilter(int index) const { return mFilters.at(index).mText; }
+
+private:
+    enum class Target { ALL, FOLDERS, FILES, SYMLINKS };
+    enum class Type { NAME, DIRECT_CHILD_NAME, PATH };
+    enum class MatchKind { LITERAL, PREFIX, SUFFIX, CONTAINS, GLOB, REGEX };
+
+    struct Filter
+    {
+        std::string mText;
+        bool mExclude = true;
+        Target mTarget = Target::ALL;
+        Type mType = Type::NAME;
+        bool mCaseSensitive = true;
+
+        MatchKind mMatchKind = MatchKind::LITERAL;
+        std::string mPattern; // lowercase if not case sensitive; literal part for everything but GLOB
+        std::optional<std::regex> mRegex;
+
+        bool appliesTo(bool isFolder, size_t depth) const;
+        bool matches(std::string_view subject) const;
+    };
+
+    static std::optional<Filter> parseFilter(const std::string& text, std::string& error);
+
+    std::vector<Filter> mFilters;
+
+    // Name filters with literal patterns, by pattern
+    std::unordered_map<std::string, std::vector<int>> mLiteralNames;
+    std::unordered_map<std::string, std::vector<int>> mLiteralNamesCaseInsensitive;
+
+    // Name filters like "*.ext", by extension (including the dot)
+    std::unordered_map<std::string, std::vector<int>> mExtensions;
+    std::unordered_map<std::string, std::vector<int>> mExtensionsCaseInsensitive;
+
+    // Every other filter, in reverse order
+    std::vector<int> mScannedFilters;
+    bool mAnyCaseInsensitive = false;
+};
+
+/**
+ * @brief Evaluates full relative paths: an entry is excluded if any of its ancestor folders is.
+ *
+ * The results for the ancestors of the last path are kept, so consecutive paths of the same folder
+ * (e.g. the listing of a tree) only evaluate their last component.
+ */
+class IgnoreFiltersEvaluator
+{
+public:
+    struct Result : IgnoreFilters::Result
+    {
+        std::string mExcludedAncestor; // not empty if excluded because of an ancestor
+    };
+
+    IgnoreFiltersEvaluator(const IgnoreFilters& filters) : mFilters(filters) {}
+
+    // Paths use '/' as separator, and are relative to the folder containing the .megaignore
+    Result evaluate(std::string_view relativePath, bool isFolder);
+
+private:
+    struct Ancestor
+    {
+        std::string mPath;
+        IgnoreFilters::Result mResult;
+    };
+
+    const IgnoreFilters& mFilters;
+    std::vector<Ancestor> mAncestors;
+};
+
+} // end namespace
@@ -0,0 +1,215 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_local_scanner.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace megacmd {
+
+double LocalTreeScanner::Stats::getEntriesPerSecond() const
+{
+    const auto entries = static_cast<double>(mFolders + mFiles);
+    return mElapsed.count() ? entries * 1000.0 / static_cast<double>(mElapsed.count()) : entries;
+}
+
+LocalTreeScanner::LocalTreeScanner(const fs::path& root, unsigned numThreads, size_t maxPendingEntries) :
+    mMaxPendingEntries(std::max<size_t>(1, maxPendingEntries)),
+    mStartTime(std::chrono::steady_clock::now())
+{
+    std::error_code ec;
+    if (!fs::is_directory(root, ec))
+    {
+        if (fs::exists(root, ec))
+        {
+            mEntries.push_back({root, false});
+            mFiles++;
+        }
+        else
+        {
+            mErrors++;
+        }
+        mScanFinished = true;
+        mElapsedMs = 0;
+        return;
+    }
+
+    mEntries.push_back({root, true});
+    mFolders++;
+    mFoldersToList.push_back(root);
+
+    numThreads = std::max(1u, numThreads);
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        mWorkers.emplace_back([this] () { workerLoop(); });
+    }
+}
+
+LocalTreeScanner::~LocalTreeScanner()
+{
+    mStop = true;
+    {
+        std::lock_guard<std::mutex> g(mFoldersMutex);
+        mFoldersCV.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> g(mEntriesMutex);
+        mEntriesCV.notify_all();
+    }
+
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+void LocalTreeScanner::workerLoop()
+{
+    while (true)
+    {
+        fs::path folder;
+        {
+            std::unique_lock<std::mutex> lock(mFoldersMutex);
+            mFoldersCV.wait(lock, [this] () { return mStop || !mFoldersToList.empty() || !mBusyWorkers; });
+
+            if (mStop || mFoldersToList.empty())
+            {
+                // Nothing left to list, and nobody else can add more folders
+                break;
+            }
+
+            folder = std::move(mFoldersToList.front());
+            mFoldersToList.pop_front();
+            mBusyWorkers++;
+        }
+
+        listFolder(folder);
+
+        {
+            std::lock_guard<std::mutex> g(mFoldersMutex);
+            mBusyWorkers--;
+            if (!mBusyWorkers && mFoldersToList.empty())
+            {
+                mFoldersCV.notify_all();
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> g(mEntriesMutex);
+    if (!mScanFinished)
+    {
+        mScanFinished = true;
+        mElapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mStartTime).count();
+    }
+    mEntriesCV.notify_all();
+}
+
+void LocalTreeScanner::listFolder(const fs::path& folder)
+{
+    std::error_code ec;
+    fs::directory_iterator it(folder, fs::directory_options::skip_permission_denied, ec);
+    if (ec)
+    {
+        mErrors++;
+        return;
+    }
+
+    // Note: directory entries cache the file type obtained when reading the folder,
+    // so there is no need to stat every single entry
+    for (; !mStop && it != fs::directory_iterator(); it.increment(ec))
+    {
+        std::error_code typeEc;
+        const fs::directory_entry& dirEntry = *it;
+
+        if (dirEntry.is_symlink(typeEc))
+        {
+            mSymlinks++;
+            pushEntry({dirEntry.path(), false, true});
+        }
+        else if (dirEntry.is_directory(typeEc))
+        {
+            mFolders++;
+
+            // The folder is handed out before it can be listed: its children will always come after it
+            pushEntry({dirEntry.path(), true});
+
+            std::lock_guard<std::mutex> g(mFoldersMutex);
+            mFoldersToList.push_back(dirEntry.path());
+            mFoldersCV.notify_one();
+        }
+        else if (dirEntry.is_regular_file(typeEc))
+        {
+            mFiles++;
+            pushEntry({dirEntry.path(), false});
+        }
+
+        if (typeEc)
+        {
+            mErrors++;
+        }
+    }
+
+    if (ec)
+    {
+        mErrors++;
+    }
+}
+
+void LocalTreeScanner::pushEntry(Entry&& entry)
+{
+    std::unique_lock<std::mutex> lock(mEntriesMutex);
+    mEntriesCV.wait(lock, [this] () { return mStop || mEntries.size() < mMaxPendingEntries; });
+    if (mStop)
+    {
+        return;
+    }
+
+    mEntries.push_back(std::move(entry));
+    mEntriesCV.notify_all();
+}
+
+std::optional<LocalTreeScanner::Entry> LocalTreeScanner::next()
+{
+    std::unique_lock<std::mutex> lock(mEntriesMutex);
+    mEntriesCV.wait(lock, [this] () { return !mEntries.empty() || mScanFinished; });
+    if (mEntries.empty())
+    {
+        return {};
+    }
+
+    Entry entry = std::move(mEntries.front());
+    mEntries.pop_front();
+
+    // Wake up scanners waiting for room in the queue
+    mEntriesCV.notify_all();
+    return entry;
+}
+
+LocalTreeScanner::Stats LocalTreeScanner::getStats() const
+{
+    Stats stats;
+    stats.mFolders = mFolders;
+    stats.mFiles = mFiles;
+    stats.mSymlinks = mSymlinks;
+    stats.mErrors = mErrors;
+
+    const int64_t elapsedMs = mElapsedMs;
+    stats.mElapsed = elapsedMs >= 0 ? std::chrono::milliseconds(elapsedMs)
+                                    : std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mStartTime);
+    return stats;
+}
+
+} // end namespace
@@ -0,0 +1,94 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "megacmd_utf8.h"
+
+namespace megacmd {
+
+/**
+ * @brief Walks a local folder tree with several threads, handing out the entries found
+ * as soon as they are listed, so that they can be processed while the scan goes on.
+ *
+ * A folder is always handed out before any of its children.
+ */
+class LocalTreeScanner
+{
+public:
+    struct Entry
+    {
+        fs::path mPath;
+        bool mIsFolder = false;
+        bool mIsSymlink = false; // handed out so that they can be reported, but never followed
+    };
+
+    struct Stats
+    {
+        uint64_t mFolders = 0;
+        uint64_t mFiles = 0;
+        uint64_t mSymlinks = 0;
+        uint64_t mErrors = 0;
+        std::chrono::milliseconds mElapsed{0};
+
+        double getEntriesPerSecond() const;
+    };
+
+    LocalTreeScanner(const fs::path& root, unsigned numThreads, size_t maxPendingEntries = 10000);
+    ~LocalTreeScanner();
+
+    // Blocks until an entry is available. Returns an empty optional once the whole tree has been handed out.
+    std::optional<Entry> next();
+
+    Stats getStats() const;
+
+private:
+    void workerLoop();
+    void listFolder(const fs::path& folder);
+    void pushEntry(Entry&& entry);
+
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mFoldersMutex;
+    std::condition_variable mFoldersCV;
+    std::deque<fs::path> mFoldersToList;
+    unsigned mBusyWorkers = 0;
+
+    std::mutex mEntriesMutex;
+    std::condition_variable mEntriesCV;
+    std::deque<Entry> mEntries;
+    const size_t mMaxPendingEntries;
+    bool mScanFinished = false;
+
+    std::atomic_bool mStop = false;
+
+    std::atomic<uint64_t> mFolders = 0;
+    std::atomic<uint64_t> mFiles = 0;
+    std::atomic<uint64_t> mSymlinks = 0;
+    std::atomic<uint64_t> mErrors = 0;
+    const std::chrono::steady_clock::time_point mStartTime;
+    std::atomic<int64_t> mElapsedMs = -1;
+};
+
+} // end namespace
@@ -0,0 +1,119 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_mutation_batch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace megacmd {
+
+MutationBatch::MutationBatch(size_t maxInFlight) :
+    mMaxInFlight(std::max<size_t>(1, maxInFlight))
+{
+}
+
+void MutationBatch::add(std::string description, Submit&& submit)
+{
+    mMutations.push_back({std::move(description), std::move(submit)});
+}
+
+MutationBatch::Result MutationBatch::run(const ProgressFunc& progress)
+{
+    // Shared with the finish callbacks, which may still be returning when run does
+    struct State
+    {
+        std::mutex mMutex;
+        std::condition_variable mCV;
+        size_t mInFlight = 0;
+        size_t mFinished = 0;
+        std::vector<int> mErrorCodes;
+    };
+    auto state = std::make_shared<State>();
+    state->mErrorCodes.resize(mMutations.size(), 0);
+
+    const size_t total = mMutations.size();
+    size_t reported = 0;
+
+    // Waits until the condition holds, reporting progress meanwhile
+    auto waitUntil = [&state, &reported, &progress, total](auto condition)
+    {
+        while (true)
+        {
+            size_t finished;
+            bool done;
+            {
+                std::unique_lock<std::mutex> lock(state->mMutex);
+                state->mCV.wait(lock, [&state, &reported, &condition]() { return condition(*state) || state->mFinished != reported; });
+                finished = state->mFinished;
+                done = condition(*state);
+            }
+
+            if (progress && finished != reported)
+            {
+                progress(finished, total);
+            }
+            reported = finished;
+
+            if (done)
+            {
+                return;
+            }
+        }
+    };
+
+    for (size_t i = 0; i < total; ++i)
+    {
+        waitUntil([this](const State& s) { return s.mInFlight < mMaxInFlight; });
+
+        {
+            std::lock_guard<std::mutex> g(state->mMutex);
+            state->mInFlight++;
+        }
+
+        // Submitted without the lock held: the request may finish right away, in this very thread
+        mMutations[i].mSubmit([state, i](int errorCode)
+        {
+            std::lock_guard<std::mutex> g(state->mMutex);
+            assert(state->mInFlight);
+            state->mErrorCodes[i] = errorCode;
+            state->mInFlight--;
+            state->mFinished++;
+            state->mCV.notify_all();
+        });
+    }
+
+    waitUntil([total](const State& s) { return s.mFinished == total; });
+
+    Result result;
+    for (size_t i = 0; i < total; ++i)
+    {
+        if (state->mErrorCodes[i])
+        {
+            result.mFailures.push_back({std::move(mMutations[i].mDescription), state->mErrorCodes[i]});
+        }
+        else
+        {
+            result.mSucceeded++;
+        }
+    }
+    mMutations.clear();
+    return result;
+}
+
+} // end namespace
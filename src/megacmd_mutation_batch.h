@@ -0,0 +1,73 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace megacmd {
+
+/**
+ * @brief A batch of independent node mutations (removals, moves) run with up to a number of requests
+ * in flight, instead of waiting for each request to finish before submitting the next one.
+ *
+ * Mutations are submitted in the order they were added and may finish in any order, from any thread.
+ * Failures are collected rather than reported, so that the caller can report them once the batch is done.
+ */
+class MutationBatch
+{
+public:
+    // To be called exactly once, with the error code of the request (0, i.e. API_OK, on success)
+    using Finish = std::function<void(int errorCode)>;
+    using Submit = std::function<void(Finish&& finish)>;
+    using ProgressFunc = std::function<void(size_t finished, size_t total)>;
+
+    struct Failure
+    {
+        std::string mDescription;
+        int mErrorCode = 0;
+    };
+
+    struct Result
+    {
+        size_t mSucceeded = 0;
+        std::vector<Failure> mFailures; // in the order the mutations were added
+    };
+
+    explicit MutationBatch(size_t maxInFlight);
+
+    void add(std::string description, Submit&& submit);
+    size_t size() const { return mMutations.size(); }
+    bool empty() const { return mMutations.empty(); }
+
+    // Runs the mutations added so far and waits for all of them to finish. Progress is reported
+    // from the calling thread, whenever some mutation finished since the last report
+    Result run(const ProgressFunc& progress = nullptr);
+
+private:
+    struct Mutation
+    {
+        std::string mDescription;
+        Submit mSubmit;
+    };
+
+    size_t mMaxInFlight;
+    std::vector<Mutation> mMutations;
+};
+
+} // end namespace
@@ -0,0 +1,212 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+
+#include "megacmd_nodes_snapshot.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "megacmd_shared_nodes_index.h"
+
+namespace megacmd {
+
+namespace {
+    const char* SNAPSHOT_HEADER = "MEGAcmd nodes snapshot v2";
+}
+
+NodesSnapshot::NodesSnapshot(const fs::path& filePath) :
+    mFilePath(filePath)
+{
+}
+
+bool NodesSnapshot::write(const Entries& entries, Clock::time_point takenAt)
+{
+    fs::path tmpPath = mFilePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream ofs(tmpPath, std::ios::binary | std::ios::trunc);
+        ofs << SNAPSHOT_HEADER << '\n';
+        ofs << std::chrono::duration_cast<std::chrono::seconds>(takenAt.time_since_epoch()).count() << '\n';
+        for (const auto& [handle, entry] : entries)
+        {
+            if (entry.mPath.empty() || entry.mPath.find('\n') != std::string::npos)
+            {
+                continue;
+            }
+
+            // <handle> <shared kinds> <files> <folders> <size> <size with versions> <path>, with -1 if unknown
+            const auto& counts = entry.mFolderCounts;
+            ofs << handle << ' ' << static_cast<unsigned>(entry.mSharedKinds) << ' '
+                << (counts ? counts->mFiles : -1) << ' '
+                << (counts ? counts->mFolders : -1) << ' '
+                << (counts ? counts->mSize : -1) << ' '
+                << (counts ? counts->mSizeWithVersions : -1) << ' '
+                << entry.mPath << '\n';
+        }
+        if (!ofs.flush())
+        {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, mFilePath, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    Entries written;
+    for (const auto& [handle, entry] : entries)
+    {
+        if (!entry.mPath.empty() && entry.mPath.find('\n') == std::string::npos)
+        {
+            written.emplace(handle, entry);
+        }
+    }
+
+    std::lock_guard<std::mutex> g(mMutex);
+    mEntries = std::move(written);
+    // Stored with a precision of seconds
+    mTakenAt = Clock::time_point(std::chrono::duration_cast<std::chrono::seconds>(takenAt.time_since_epoch()));
+    return true;
+}
+
+bool NodesSnapshot::read()
+{
+    std::ifstream ifs(mFilePath, std::ios::binary);
+    std::string line;
+    if (!ifs.is_open() || !std::getline(ifs, line) || line != SNAPSHOT_HEADER || !std::getline(ifs, line))
+    {
+        return false;
+    }
+
+    long long takenAt = 0;
+    try
+    {
+        takenAt = std::stoll(line);
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    Entries entries;
+    while (std::getline(ifs, line))
+    {
+        std::istringstream iss(line);
+        mega::MegaHandle handle;
+        unsigned kinds;
+        long long files, folders, size, sizeWithVersions;
+        if (!(iss >> handle >> kinds >> files >> folders >> size >> sizeWithVersions) || iss.get() != ' ')
+        {
+            continue;
+        }
+
+        Entry& entry = entries[handle];
+        std::getline(iss, entry.mPath);
+        entry.mSharedKinds = static_cast<uint8_t>(kinds);
+        if (files >= 0 && folders >= 0 && size >= 0 && sizeWithVersions >= 0)
+        {
+            entry.mFolderCounts = FolderInfoCache::Counts{files, folders, size, sizeWithVersions};
+        }
+    }
+
+    std::lock_guard<std::mutex> g(mMutex);
+    mEntries = std::move(entries);
+    mTakenAt = Clock::time_point(std::chrono::seconds(takenAt));
+    return true;
+}
+
+void NodesSnapshot::remove()
+{
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mEntries.clear();
+        mTakenAt.reset();
+    }
+
+    std::error_code ec;
+    fs::remove(mFilePath, ec);
+}
+
+bool NodesSnapshot::isLoaded() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mTakenAt.has_value();
+}
+
+std::optional<NodesSnapshot::Clock::time_point> NodesSnapshot::getTakenAt() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mTakenAt;
+}
+
+std::vector<std::pair<mega::MegaHandle, NodesSnapshot::Entry>> NodesSnapshot::getShared(uint8_t kinds, const std::string& root) const
+{
+    std::vector<std::pair<mega::MegaHandle, Entry>> shared;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        for (const auto& [handle, entry] : mEntries)
+        {
+            if ((entry.mSharedKinds & kinds) && SharedNodesIndex::isPathInTree(entry.mPath, root))
+            {
+                shared.emplace_back(handle, entry);
+            }
+        }
+    }
+
+    std::sort(shared.begin(), shared.end(), [](const auto& a, const auto& b) { return a.second.mPath < b.second.mPath; });
+    return shared;
+}
+
+std::optional<NodesSnapshot::Entry> NodesSnapshot::findByPath(const std::string& path) const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    auto it = std::find_if(mEntries.begin(), mEntries.end(), [&path](const auto& e) { return e.second.mPath == path; });
+    if (it == mEntries.end())
+    {
+        return {};
+    }
+    return it->second;
+}
+
+std::string NodesSnapshot::getAgeStr(Clock::duration age)
+{
+    const long long seconds = std::max(0LL, static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(age).count()));
+
+    auto plural = [](long long n, const char* unit)
+    {
+        return std::to_string(n) + " " + unit + (n == 1 ? "" : "s");
+    };
+
+    if (seconds < 60)
+    {
+        return plural(seconds, "second");
+    }
+    if (seconds < 3600)
+    {
+        return plural(seconds / 60, "minute");
+    }
+    if (seconds < 86400)
+    {
+        return plural(seconds / 3600, "hour");
+    }
+    return plural(seconds / 86400, "day");
+}
+
+} // end namespace
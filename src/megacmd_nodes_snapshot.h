@@ -0,0 +1,87 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "megaapi.h"
+#include "megacmd_folder_info_cache.h"
+#include "megacmd_utf8.h"
+
+namespace megacmd {
+
+/**
+ * @brief On-disk snapshot of the MEGAcmd-side indexes (shared and exported nodes, folder counts and sizes) with
+ * the paths of their nodes, so that some read-only commands can be answered after a restart before the
+ * nodes are fetched again.
+ *
+ * It is only a picture of the account when it was taken: whatever is served from it must be presented as such.
+ */
+class NodesSnapshot
+{
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Entry
+    {
+        std::string mPath;
+        uint8_t mSharedKinds = 0; // see SharedNodesIndex::Kind
+        std::optional<FolderInfoCache::Counts> mFolderCounts;
+    };
+
+    using Entries = std::unordered_map<mega::MegaHandle, Entry>;
+
+    explicit NodesSnapshot(const fs::path& filePath);
+
+    // Replaces the snapshot on disk, and the one loaded (so that a later busy period is served the latest one).
+    // Written to a temporary file first, so that there is never half a snapshot
+    bool write(const Entries& entries, Clock::time_point takenAt = Clock::now());
+
+    // Loads the snapshot on disk, if any
+    bool read();
+
+    // Forgets the snapshot loaded and removes it from disk
+    void remove();
+
+    bool isLoaded() const;
+    std::optional<Clock::time_point> getTakenAt() const;
+
+    // Loaded entries of any of the given shared kinds within the given path, sorted by path
+    std::vector<std::pair<mega::MegaHandle, Entry>> getShared(uint8_t kinds, const std::string& root = "/") const;
+
+    // The loaded entry of a node given its full path (without trailing separators)
+    std::optional<Entry> findByPath(const std::string& path) const;
+
+    // e.g. "5 minutes"
+    static std::string getAgeStr(Clock::duration age);
+
+private:
+    const fs::path mFilePath;
+
+    mutable std::mutex mMutex;
+    Entries mEntries;
+    std::optional<Clock::time_point> mTakenAt; // set if loaded
+};
+
+} // end namespace
@@ -0,0 +1,220 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+
+#include "megacmd_readiness.h"
+
+namespace megacmd {
+
+Readiness& Readiness::getInstance()
+{
+    static Readiness readiness;
+    return readiness;
+}
+
+void Readiness::setListener(Listener&& listener)
+{
+    std::lock_guard<std::mutex> g(mListenerMutex);
+    mListener = std::move(listener);
+}
+
+bool Readiness::isBusy(State state)
+{
+    return state == State::LOGGING_IN || state == State::FETCHING_NODES || state == State::CATCHING_UP;
+}
+
+void Readiness::setState(std::unique_lock<std::mutex>& lock, State state)
+{
+    if (mStatus.mState == state)
+    {
+        return;
+    }
+
+    mStatus.mState = state;
+    notify(lock);
+}
+
+void Readiness::notify(std::unique_lock<std::mutex>& lock)
+{
+    const uint64_t change = ++mChanges;
+    const Status status = mStatus;
+    lock.unlock();
+    mCV.notify_all();
+
+    // Changes notified from different threads may get here out of order: the stale ones are dropped
+    std::lock_guard<std::mutex> g(mListenerMutex);
+    if (mListener && change > mLastNotified)
+    {
+        mLastNotified = change;
+        mListener(status);
+    }
+}
+
+void Readiness::onLoginStarted()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mStatus.mState == State::LOGGED_OUT) // e.g. a login attempted while logged in would fail right away
+    {
+        setState(lock, State::LOGGING_IN);
+    }
+}
+
+void Readiness::onLoginFinished()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mStatus.mState == State::LOGGING_IN)
+    {
+        setState(lock, State::LOGGED_OUT);
+    }
+}
+
+void Readiness::onFetchNodesStarted()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mStatus.mFetchedBytes = mStatus.mTotalBytes = 0;
+    mCurrentWhileFetching = false;
+    mLastPercent = -1;
+    setState(lock, State::FETCHING_NODES);
+}
+
+void Readiness::onFetchNodesProgress(int64_t fetchedBytes, int64_t totalBytes)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mStatus.mState != State::FETCHING_NODES)
+    {
+        return;
+    }
+
+    mStatus.mFetchedBytes = fetchedBytes;
+    mStatus.mTotalBytes = totalBytes;
+
+    // Fetch updates are very frequent: only whole percents are worth telling
+    const int percent = totalBytes > 0 ? static_cast<int>(fetchedBytes * 100 / totalBytes) : 0;
+    if (percent != mLastPercent)
+    {
+        mLastPercent = percent;
+        notify(lock);
+    }
+}
+
+bool Readiness::onFetchNodesFinished(bool succeeded)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mStatus.mState != State::FETCHING_NODES)
+    {
+        return false;
+    }
+
+    if (!succeeded)
+    {
+        setState(lock, State::LOGGED_OUT);
+        return false;
+    }
+
+    mStatus.mFetchedBytes = mStatus.mTotalBytes;
+    const bool catchingUp = !mCurrentWhileFetching;
+    setState(lock, catchingUp ? State::CATCHING_UP : State::READY);
+    return catchingUp;
+}
+
+void Readiness::onNodesCurrent()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mStatus.mState == State::FETCHING_NODES)
+    {
+        mCurrentWhileFetching = true;
+    }
+    else if (mStatus.mState == State::CATCHING_UP)
+    {
+        setState(lock, State::READY);
+    }
+}
+
+bool Readiness::onCatchUpTimedOut()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mStatus.mState != State::CATCHING_UP)
+    {
+        return false;
+    }
+
+    setState(lock, State::READY);
+    return true;
+}
+
+void Readiness::onLoggedOut()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mStatus.mFetchedBytes = mStatus.mTotalBytes = 0;
+    setState(lock, State::LOGGED_OUT);
+}
+
+Readiness::Status Readiness::getStatus() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mStatus;
+}
+
+Readiness::State Readiness::getState() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mStatus.mState;
+}
+
+bool Readiness::isBusy() const
+{
+    return isBusy(getState());
+}
+
+Readiness::State Readiness::waitWhileBusy(std::optional<Clock::duration> timeout) const
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto notBusy = [this] { return !isBusy(mStatus.mState); };
+    if (timeout)
+    {
+        mCV.wait_for(lock, *timeout, notBusy);
+    }
+    else
+    {
+        mCV.wait(lock, notBusy);
+    }
+    return mStatus.mState;
+}
+
+const char* Readiness::getStateStr(State state)
+{
+    switch (state)
+    {
+        case State::LOGGED_OUT:
+            return "LOGGED_OUT";
+        case State::LOGGING_IN:
+            return "LOGGING_IN";
+        case State::FETCHING_NODES:
+            return "FETCHING_NODES";
+        case State::CATCHING_UP:
+            return "CATCHING_UP";
+        case State::READY:
+            return "READY";
+    }
+    return "UNKNOWN";
+}
+
+std::string Readiness::getStateMessage(const Status& status)
+{
+    return std::string("readiness:") + getStateStr(status.mState)
+            + ":" + std::to_string(status.mFetchedBytes) + ":" + std::to_string(status.mTotalBytes);
+}
+
+} // end namespace
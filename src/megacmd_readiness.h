@@ -0,0 +1,111 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace megacmd {
+
+/**
+ * @brief Tracks whether the account is ready to be operated on: logged in, with its nodes fetched and
+ * up to date with the changes that happened while the session was not running.
+ *
+ * Fetching the nodes and catching up no longer block the thread that logged in: petitions needing the
+ * nodes tree wait here instead, while the rest are served right away. Every change of state (and every
+ * new percent of the fetch) is handed to the listener, so that clients can be told about it.
+ */
+class Readiness
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State
+    {
+        LOGGED_OUT, // also after a failed login or fetch nodes
+        LOGGING_IN,
+        FETCHING_NODES,
+        CATCHING_UP, // nodes fetched, waiting for the account to be current
+        READY,
+    };
+
+    struct Status
+    {
+        State mState = State::LOGGED_OUT;
+        int64_t mFetchedBytes = 0;
+        int64_t mTotalBytes = 0; // 0 if unknown
+    };
+
+    using Listener = std::function<void(const Status&)>;
+
+    // The instance shared by the whole server
+    static Readiness& getInstance();
+
+    void setListener(Listener&& listener);
+
+    // Only taken into account while logged out
+    void onLoginStarted();
+    // If the login ended without fetching the nodes, it failed
+    void onLoginFinished();
+    void onFetchNodesStarted();
+    void onFetchNodesProgress(int64_t fetchedBytes, int64_t totalBytes);
+    // Returns whether the account still needs to catch up (i.e. it is not current yet)
+    bool onFetchNodesFinished(bool succeeded);
+    void onNodesCurrent();
+    // Gives up waiting for the account to be current. Returns false if it was not catching up anymore
+    bool onCatchUpTimedOut();
+    void onLoggedOut();
+
+    Status getStatus() const;
+    State getState() const;
+
+    // Logging in, fetching the nodes or catching up
+    bool isBusy() const;
+
+    // Waits while busy, up to the timeout if any. Returns the state it was left in
+    State waitWhileBusy(std::optional<Clock::duration> timeout = {}) const;
+
+    static const char* getStateStr(State state);
+
+    // The state change sent to the clients, e.g. "readiness:FETCHING_NODES:1024:4096"
+    static std::string getStateMessage(const Status& status);
+
+private:
+    mutable std::mutex mMutex;
+    mutable std::condition_variable mCV;
+    Status mStatus;
+    bool mCurrentWhileFetching = false; // the account can be current before fetch nodes finishes
+    int mLastPercent = -1;
+    uint64_t mChanges = 0;
+
+    std::mutex mListenerMutex;
+    Listener mListener;
+    uint64_t mLastNotified = 0;
+
+    static bool isBusy(State state);
+
+    // Must be called with the lock held, which is released to notify the listener
+    void setState(std::unique_lock<std::mutex>& lock, State state);
+    void notify(std::unique_lock<std::mutex>& lock);
+};
+
+} // end namespace
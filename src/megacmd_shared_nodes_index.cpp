@@ -0,0 +1,102 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_shared_nodes_index.h"
+
+namespace megacmd {
+
+bool SharedNodesIndex::isLoaded() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mLoaded;
+}
+
+uint64_t SharedNodesIndex::getGeneration() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mGeneration;
+}
+
+bool SharedNodesIndex::load(std::unordered_map<mega::MegaHandle, uint8_t>&& kindsByNode, uint64_t generation)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    if (generation != mGeneration)
+    {
+        return false;
+    }
+
+    mKindsByNode = std::move(kindsByNode);
+    mLoaded = true;
+    return true;
+}
+
+void SharedNodesIndex::update(mega::MegaHandle node, uint8_t kinds)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mGeneration++;
+    if (!mLoaded)
+    {
+        return;
+    }
+
+    if (kinds)
+    {
+        mKindsByNode[node] = kinds;
+    }
+    else
+    {
+        mKindsByNode.erase(node);
+    }
+}
+
+void SharedNodesIndex::clear()
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    mGeneration++;
+    mKindsByNode.clear();
+    mLoaded = false;
+}
+
+std::vector<mega::MegaHandle> SharedNodesIndex::get(uint8_t kinds) const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    std::vector<mega::MegaHandle> nodes;
+    for (const auto& [node, nodeKinds] : mKindsByNode)
+    {
+        if (nodeKinds & kinds)
+        {
+            nodes.push_back(node);
+        }
+    }
+    return nodes;
+}
+
+bool SharedNodesIndex::isPathInTree(const std::string& path, const std::string& root)
+{
+    if (root.empty() || path.compare(0, root.size(), root) != 0)
+    {
+        return false;
+    }
+
+    if (path.size() == root.size())
+    {
+        return true;
+    }
+
+    // "/" is followed by a name, unless it is the beginning of "//bin" or "//in"
+    return root.back() == '/' ? path[root.size()] != '/' : path[root.size()] == '/';
+}
+
+} // end namespace
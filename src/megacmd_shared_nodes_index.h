@@ -0,0 +1,71 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "megaapi.h"
+
+namespace megacmd {
+
+/**
+ * @brief Index of the nodes that are exported, shared or have pending outgoing shares, so that they
+ * can be listed without walking the whole tree.
+ *
+ * It is loaded in one go (from the lists of public links and outgoing shares), and kept up to date
+ * with the node updates received afterwards. A load made with the values obtained before an update
+ * is discarded, the same as with FolderInfoCache.
+ */
+class SharedNodesIndex
+{
+public:
+    enum Kind : uint8_t
+    {
+        EXPORTED        = 1 << 0,
+        SHARED          = 1 << 1,
+        PENDING_SHARED  = 1 << 2,
+    };
+
+    bool isLoaded() const;
+
+    // Increased with every update
+    uint64_t getGeneration() const;
+
+    // Returns false if there were updates since the given generation, in which case nothing is loaded
+    bool load(std::unordered_map<mega::MegaHandle, uint8_t>&& kindsByNode, uint64_t generation);
+
+    // Sets the kinds of a node (none to remove it). Only applied if loaded
+    void update(mega::MegaHandle node, uint8_t kinds);
+    void clear();
+
+    // The nodes that are of any of the given kinds
+    std::vector<mega::MegaHandle> get(uint8_t kinds) const;
+
+    // Whether a path is the root path or within it, e.g. "/a/b" is in "/a" and "/", but "//bin/x" is not in "/"
+    static bool isPathInTree(const std::string& path, const std::string& root);
+
+private:
+    mutable std::mutex mMutex;
+    std::unordered_map<mega::MegaHandle, uint8_t> mKindsByNode;
+    bool mLoaded = false;
+    uint64_t mGeneration = 0;
+};
+
+} // end namespace
@@ -0,0 +1,259 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_startup_graph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <sstream>
+
+namespace megacmd {
+
+namespace {
+
+long long toMs(StartupGraph::Clock::duration d)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+} // end namespace
+
+StartupGraph::StartupGraph(Clock::time_point startTime) :
+    mStartTime(startTime)
+{
+}
+
+StartupGraph::~StartupGraph()
+{
+    waitForAll();
+}
+
+void StartupGraph::setFailureHandler(FailureHandler&& handler)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    assert(!mStarted);
+    mFailureHandler = std::move(handler);
+}
+
+void StartupGraph::add(const std::string& name, const std::vector<std::string>& dependencies, Task&& task)
+{
+    std::vector<std::pair<std::string, std::string>> failures;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        assert(mSteps.find(name) == mSteps.end());
+        assert(std::all_of(dependencies.begin(), dependencies.end(), [this](const std::string& d) { return mSteps.count(d) > 0; }));
+
+        Step& step = mSteps[name];
+        step.mDependencies = dependencies;
+        step.mTask = std::move(task);
+
+        if (mStarted)
+        {
+            failures = startReadySteps();
+        }
+    }
+    fail(failures);
+}
+
+void StartupGraph::start()
+{
+    std::vector<std::pair<std::string, std::string>> failures;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mStarted = true;
+        failures = startReadySteps();
+    }
+    fail(failures);
+}
+
+bool StartupGraph::isReady(const Step& step) const
+{
+    return std::all_of(step.mDependencies.begin(), step.mDependencies.end(), [this](const std::string& d)
+    {
+        auto it = mSteps.find(d);
+        return it != mSteps.end() && it->second.mDone;
+    });
+}
+
+std::optional<std::string> StartupGraph::getFailedDependency(const Step& step) const
+{
+    for (const std::string& d : step.mDependencies)
+    {
+        auto it = mSteps.find(d);
+        if (it != mSteps.end() && it->second.mFailed)
+        {
+            return d;
+        }
+    }
+    return {};
+}
+
+std::vector<std::pair<std::string, std::string>> StartupGraph::startReadySteps()
+{
+    std::vector<std::pair<std::string, std::string>> failures;
+
+    // Failing a step may get the ones depending on it ready to fail too
+    bool failedAny = true;
+    while (failedAny)
+    {
+        failedAny = false;
+        for (auto& [name, step] : mSteps)
+        {
+            if (step.mStarted || !isReady(step))
+            {
+                continue;
+            }
+
+            step.mStarted = true;
+            if (auto failedDependency = getFailedDependency(step))
+            {
+                step.mDone = true;
+                step.mFailed = true;
+                failures.emplace_back(name, "depends on " + *failedDependency + ", which failed");
+                failedAny = true;
+                continue;
+            }
+            mThreads.emplace_back(&StartupGraph::run, this, name);
+        }
+    }
+
+    if (!failures.empty())
+    {
+        mDoneCV.notify_all();
+    }
+    return failures;
+}
+
+void StartupGraph::run(const std::string& name)
+{
+    Task task;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        task = std::move(mSteps[name].mTask);
+    }
+
+    const auto stepStart = Clock::now();
+    std::optional<std::string> error;
+    try
+    {
+        task();
+    }
+    catch (const std::exception& e)
+    {
+        error = e.what();
+    }
+    catch (...)
+    {
+        error = "unknown exception";
+    }
+    const auto stepEnd = Clock::now();
+
+    std::vector<std::pair<std::string, std::string>> failures;
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        Step& step = mSteps[name];
+        step.mDone = true;
+        step.mTiming = Timing{name, stepStart - mStartTime, stepEnd - stepStart};
+        if (error)
+        {
+            step.mFailed = true;
+            failures.emplace_back(name, *error);
+        }
+
+        auto dependentFailures = startReadySteps();
+        failures.insert(failures.end(), dependentFailures.begin(), dependentFailures.end());
+    }
+    mDoneCV.notify_all();
+    fail(failures);
+}
+
+void StartupGraph::fail(const std::vector<std::pair<std::string, std::string>>& failures)
+{
+    // Not guarded: it's set before starting
+    if (!mFailureHandler)
+    {
+        return;
+    }
+
+    for (const auto& [name, error] : failures)
+    {
+        mFailureHandler(name, error);
+    }
+}
+
+bool StartupGraph::waitFor(const std::string& name)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    assert(mStarted && mSteps.count(name));
+    mDoneCV.wait(lock, [this, &name] { return mSteps[name].mDone; });
+    return !mSteps[name].mFailed;
+}
+
+void StartupGraph::waitForAll()
+{
+    std::vector<std::thread> threads;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mStarted)
+        {
+            mDoneCV.wait(lock, [this]
+            {
+                return std::all_of(mSteps.begin(), mSteps.end(), [](const auto& s) { return s.second.mDone; });
+            });
+        }
+        threads.swap(mThreads);
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void StartupGraph::record(const std::string& name, Clock::time_point stepStart)
+{
+    const auto stepEnd = Clock::now();
+    std::lock_guard<std::mutex> g(mMutex);
+    mRecorded.push_back(Timing{name, stepStart - mStartTime, stepEnd - stepStart});
+}
+
+std::vector<StartupGraph::Timing> StartupGraph::getTimings() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    std::vector<Timing> timings = mRecorded;
+    for (const auto& [name, step] : mSteps)
+    {
+        if (step.mTiming)
+        {
+            timings.push_back(*step.mTiming);
+        }
+    }
+
+    std::stable_sort(timings.begin(), timings.end(), [](const Timing& a, const Timing& b) { return a.mStart < b.mStart; });
+    return timings;
+}
+
+std::string StartupGraph::getSummary() const
+{
+    std::ostringstream os;
+    for (const Timing& timing : getTimings())
+    {
+        os << (os.tellp() ? ", " : "") << timing.mName << " " << toMs(timing.mStart) << "+" << toMs(timing.mDuration) << " ms";
+    }
+    return os.str();
+}
+
+} // end namespace
@@ -0,0 +1,110 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace megacmd {
+
+/**
+ * @brief Runs the server initialization steps as a dependency graph, each step on its own thread as soon
+ * as the steps it depends on are done, and keeps when each of them started and ended.
+ *
+ * Steps done outside of the graph (e.g. the ones every other step needs) can be recorded too, so that
+ * the timings cover the whole startup. Dependencies must be added before the steps depending on them,
+ * so there cannot be cycles.
+ *
+ * A step that throws fails, and so do (without running) the steps depending on it. Failures are
+ * reported to the failure handler, from the thread of the step that failed.
+ */
+class StartupGraph
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Task = std::function<void()>;
+    using FailureHandler = std::function<void(const std::string& name, const std::string& error)>;
+
+    struct Timing
+    {
+        std::string mName;
+        Clock::duration mStart{}; // since the graph was created
+        Clock::duration mDuration{};
+    };
+
+    StartupGraph(Clock::time_point startTime = Clock::now());
+    ~StartupGraph(); // waits for all the steps
+
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    // To be set before starting
+    void setFailureHandler(FailureHandler&& handler);
+
+    void add(const std::string& name, const std::vector<std::string>& dependencies, Task&& task);
+
+    // Starts the steps that are ready; the rest are started as their dependencies finish
+    void start();
+
+    // Returns false if the step failed
+    bool waitFor(const std::string& name);
+    void waitForAll();
+
+    // Records a step done outside of the graph, from the given time until now
+    void record(const std::string& name, Clock::time_point stepStart);
+
+    // Sorted by start time. Only steps that have finished are included
+    std::vector<Timing> getTimings() const;
+
+    // e.g. "configuration 0+3 ms, api 3+40 ms"
+    std::string getSummary() const;
+
+private:
+    struct Step
+    {
+        std::vector<std::string> mDependencies;
+        Task mTask;
+        bool mStarted = false;
+        bool mDone = false;
+        bool mFailed = false;
+        std::optional<Timing> mTiming;
+    };
+
+    mutable std::mutex mMutex;
+    std::condition_variable mDoneCV;
+    const Clock::time_point mStartTime;
+    std::map<std::string, Step> mSteps;
+    std::vector<Timing> mRecorded;
+    std::vector<std::thread> mThreads;
+    bool mStarted = false;
+    FailureHandler mFailureHandler;
+
+    bool isReady(const Step& step) const;
+    std::optional<std::string> getFailedDependency(const Step& step) const;
+    // With the lock held. Returns the steps that failed because of a failed dependency, along with the reason
+    std::vector<std::pair<std::string, std::string>> startReadySteps();
+    void run(const std::string& name);
+    void fail(const std::vector<std::pair<std::string, std::string>>& failures);
+};
+
+} // end namespace
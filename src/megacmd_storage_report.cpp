@@ -0,0 +1,229 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_storage_report.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace megacmd {
+
+namespace {
+    const char* REPORT_HEADER = "MEGAcmd storage report v1";
+
+    constexpr long long KB = 1024;
+    constexpr long long MB = 1024 * KB;
+    constexpr long long GB = 1024 * MB;
+
+    // Upper bounds (exclusive) of every bucket but the last one
+    const std::vector<std::pair<long long, const char*>> SIZE_BUCKETS {
+        {KB, "< 1 KB"}, {MB, "1 KB - 1 MB"}, {10 * MB, "1 MB - 10 MB"}, {100 * MB, "10 MB - 100 MB"}, {GB, "100 MB - 1 GB"}, {0, ">= 1 GB"}
+    };
+
+    constexpr int64_t DAY = 24 * 3600;
+    const std::vector<std::pair<int64_t, const char*>> AGE_BUCKETS {
+        {DAY, "< 1 day"}, {7 * DAY, "1 day - 1 week"}, {30 * DAY, "1 week - 1 month"}, {365 * DAY, "1 month - 1 year"}, {0, ">= 1 year"}
+    };
+
+    template <typename T>
+    std::vector<StorageReport::Bucket> makeBuckets(const std::vector<std::pair<T, const char*>>& bounds)
+    {
+        std::vector<StorageReport::Bucket> buckets(bounds.size());
+        for (size_t i = 0; i < bounds.size(); ++i)
+        {
+            buckets[i].mLabel = bounds[i].second;
+        }
+        return buckets;
+    }
+
+    template <typename T>
+    size_t findBucket(const std::vector<std::pair<T, const char*>>& bounds, T value)
+    {
+        size_t i = 0;
+        while (i + 1 < bounds.size() && value >= bounds[i].first)
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    void writeFolders(std::ofstream& ofs, const char* kind, const std::vector<StorageReport::FolderEntry>& folders)
+    {
+        for (const auto& folder : folders)
+        {
+            const auto& t = folder.mTotals;
+            ofs << kind << '\t' << t.mFiles << '\t' << t.mSize << '\t' << t.mVersions << '\t' << t.mVersionsSize << '\t' << folder.mPath << '\n';
+        }
+    }
+
+    void writeBuckets(std::ofstream& ofs, const char* kind, const std::vector<StorageReport::Bucket>& buckets)
+    {
+        for (const auto& bucket : buckets)
+        {
+            ofs << kind << '\t' << bucket.mLabel << '\t' << bucket.mFiles << '\t' << bucket.mSize << '\n';
+        }
+    }
+}
+
+StorageReport::StorageReport(int64_t now) :
+    mNow(now),
+    mSizeHistogram(makeBuckets(SIZE_BUCKETS)),
+    mAgeHistogram(makeBuckets(AGE_BUCKETS))
+{
+}
+
+void StorageReport::addFolder(mega::MegaHandle folder, mega::MegaHandle parent)
+{
+    mTotals.mFolders++;
+    mFolders[parent].mFolders++;
+    mParents[folder] = parent;
+}
+
+void StorageReport::addFile(mega::MegaHandle parent, long long size, int64_t modificationTime, long long versions, long long versionsSize)
+{
+    for (Totals* totals : {&mTotals, &mFolders[parent]})
+    {
+        totals->mFiles++;
+        totals->mSize += size;
+        totals->mVersions += versions;
+        totals->mVersionsSize += versionsSize;
+    }
+
+    Bucket& sizeBucket = mSizeHistogram[findBucket(SIZE_BUCKETS, size)];
+    sizeBucket.mFiles++;
+    sizeBucket.mSize += size;
+
+    Bucket& ageBucket = mAgeHistogram[findBucket(AGE_BUCKETS, std::max<int64_t>(0, mNow - modificationTime))];
+    ageBucket.mFiles++;
+    ageBucket.mSize += size;
+}
+
+void StorageReport::merge(const StorageReport& other)
+{
+    auto add = [](Totals& to, const Totals& from)
+    {
+        to.mFiles += from.mFiles;
+        to.mFolders += from.mFolders;
+        to.mSize += from.mSize;
+        to.mVersions += from.mVersions;
+        to.mVersionsSize += from.mVersionsSize;
+    };
+
+    add(mTotals, other.mTotals);
+    for (const auto& [handle, totals] : other.mFolders)
+    {
+        add(mFolders[handle], totals);
+    }
+    mParents.insert(other.mParents.begin(), other.mParents.end());
+
+    for (size_t i = 0; i < mSizeHistogram.size(); ++i)
+    {
+        mSizeHistogram[i].mFiles += other.mSizeHistogram[i].mFiles;
+        mSizeHistogram[i].mSize += other.mSizeHistogram[i].mSize;
+    }
+    for (size_t i = 0; i < mAgeHistogram.size(); ++i)
+    {
+        mAgeHistogram[i].mFiles += other.mAgeHistogram[i].mFiles;
+        mAgeHistogram[i].mSize += other.mAgeHistogram[i].mSize;
+    }
+}
+
+StorageReport::Summary StorageReport::getSummary(size_t topCount, const PathResolver& getPath, bool recursive) const
+{
+    Summary summary;
+    summary.mTotals = mTotals;
+    summary.mSizeHistogram = mSizeHistogram;
+    summary.mAgeHistogram = mAgeHistogram;
+    summary.mRecursive = recursive;
+
+    std::unordered_map<mega::MegaHandle, Totals> subtrees;
+    if (recursive)
+    {
+        // Every folder adds what is directly in it to all its ancestors. Folders without a parent are
+        // the one analyzed, whose subtree is the whole tree, so it is not ranked
+        for (const auto& [handle, totals] : mFolders)
+        {
+            for (auto it = mParents.find(handle); it != mParents.end(); it = mParents.find(it->second))
+            {
+                Totals& subtree = subtrees[it->first];
+                subtree.mFiles += totals.mFiles;
+                subtree.mFolders += totals.mFolders;
+                subtree.mSize += totals.mSize;
+                subtree.mVersions += totals.mVersions;
+                subtree.mVersionsSize += totals.mVersionsSize;
+            }
+        }
+    }
+    const auto& folders = recursive ? subtrees : mFolders;
+
+    auto getTop = [&folders, topCount, &getPath](long long Totals::* value)
+    {
+        std::vector<FolderEntry> top;
+        for (const auto& [handle, totals] : folders)
+        {
+            if (totals.*value > 0)
+            {
+                top.push_back({handle, {}, totals});
+            }
+        }
+
+        // Ties are sorted by handle, so that reports of the same tree are the same
+        auto greater = [value](const FolderEntry& a, const FolderEntry& b)
+        {
+            return a.mTotals.*value != b.mTotals.*value ? a.mTotals.*value > b.mTotals.*value : a.mHandle < b.mHandle;
+        };
+        const size_t count = std::min(topCount, top.size());
+        std::partial_sort(top.begin(), top.begin() + static_cast<std::ptrdiff_t>(count), top.end(), greater);
+        top.resize(count);
+
+        for (auto& entry : top)
+        {
+            entry.mPath = getPath(entry.mHandle);
+        }
+        return top;
+    };
+
+    summary.mTopByVersionsSize = getTop(&Totals::mVersionsSize);
+    summary.mTopByFiles = getTop(&Totals::mFiles);
+    summary.mTopBySize = getTop(&Totals::mSize);
+    return summary;
+}
+
+bool StorageReport::write(const fs::path& filePath, const std::string& analyzedPath, const Summary& summary, int64_t now)
+{
+    std::ofstream ofs(filePath, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open())
+    {
+        return false;
+    }
+
+    const Totals& t = summary.mTotals;
+    ofs << REPORT_HEADER << '\n';
+    ofs << "path\t" << analyzedPath << '\n';
+    ofs << "time\t" << now << '\n';
+    ofs << "ranking\t" << (summary.mRecursive ? "recursive" : "direct") << '\n';
+    ofs << "# totals\tfiles\tfolders\tsize\tversions\tversions_size\n";
+    ofs << "totals\t" << t.mFiles << '\t' << t.mFolders << '\t' << t.mSize << '\t' << t.mVersions << '\t' << t.mVersionsSize << '\n';
+    ofs << "# top_*\tfiles\tsize\tversions\tversions_size\tpath\n";
+    writeFolders(ofs, "top_versions", summary.mTopByVersionsSize);
+    writeFolders(ofs, "top_files", summary.mTopByFiles);
+    writeFolders(ofs, "top_size", summary.mTopBySize);
+    ofs << "# *_histogram\trange\tfiles\tsize\n";
+    writeBuckets(ofs, "size_histogram", summary.mSizeHistogram);
+    writeBuckets(ofs, "age_histogram", summary.mAgeHistogram);
+    return static_cast<bool>(ofs.flush());
+}
+
+} // end namespace
@@ -0,0 +1,103 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "megaapi.h"
+#include "megacmd_utf8.h"
+
+namespace megacmd {
+
+/**
+ * @brief Storage statistics of a tree, collected in a single pass over its files: totals per folder
+ * (versions included), from which the folders with the most version overhead, files and size are
+ * picked, and histograms of the sizes and ages of the files.
+ *
+ * Folders are ranked by the files directly in them by default, so that the ones ranked are where the
+ * space actually is rather than their ancestors. They can be ranked by their whole subtrees instead, so
+ * that a subtree spread across many small folders shows up too.
+ */
+class StorageReport
+{
+public:
+    struct Totals
+    {
+        long long mFiles = 0;
+        long long mFolders = 0;
+        long long mSize = 0; // of the current versions
+        long long mVersions = 0; // older versions, not counted as files
+        long long mVersionsSize = 0;
+    };
+
+    struct FolderEntry
+    {
+        mega::MegaHandle mHandle = mega::INVALID_HANDLE;
+        std::string mPath;
+        Totals mTotals;
+    };
+
+    struct Bucket
+    {
+        std::string mLabel;
+        long long mFiles = 0;
+        long long mSize = 0;
+    };
+
+    struct Summary
+    {
+        Totals mTotals;
+        std::vector<FolderEntry> mTopByVersionsSize;
+        std::vector<FolderEntry> mTopByFiles;
+        std::vector<FolderEntry> mTopBySize;
+        std::vector<Bucket> mSizeHistogram;
+        std::vector<Bucket> mAgeHistogram; // by last modification
+        bool mRecursive = false; // whether folders were ranked by their subtrees
+    };
+
+    using PathResolver = std::function<std::string(mega::MegaHandle folder)>;
+
+    // Ages are relative to now (seconds since the epoch, like modification times)
+    explicit StorageReport(int64_t now);
+
+    // The folder analyzed is not added, only what is under it
+    void addFolder(mega::MegaHandle folder, mega::MegaHandle parent);
+    void addFile(mega::MegaHandle parent, long long size, int64_t modificationTime, long long versions, long long versionsSize);
+
+    // Adds what another report (of a different part of the same tree) collected
+    void merge(const StorageReport& other);
+
+    // Paths are only resolved for the folders ranked. Folders without any of the ranked value are left out.
+    // When recursive, folders are ranked by their subtrees, and the folder analyzed is left out
+    Summary getSummary(size_t topCount, const PathResolver& getPath, bool recursive = false) const;
+
+    // Writes a compact, tab separated, version of the summary
+    static bool write(const fs::path& filePath, const std::string& analyzedPath, const Summary& summary, int64_t now);
+
+private:
+    int64_t mNow;
+    Totals mTotals;
+    std::unordered_map<mega::MegaHandle, Totals> mFolders; // of the files and folders directly in them
+    std::unordered_map<mega::MegaHandle, mega::MegaHandle> mParents;
+    std::vector<Bucket> mSizeHistogram;
+    std::vector<Bucket> mAgeHistogram;
+};
+
+} // end namespace
@@ -0,0 +1,257 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_sync_metrics.h"
+
+#include <algorithm>
+
+using namespace mega;
+
+namespace megacmd {
+
+namespace {
+
+void trimTrailingSeparators(std::string& path)
+{
+    while (path.size() > 1 && (path.back() == '/' || path.back() == '\\'))
+    {
+        path.pop_back();
+    }
+}
+
+} // end namespace
+
+SyncMetrics& SyncMetrics::getInstance()
+{
+    static SyncMetrics instance;
+    return instance;
+}
+
+bool SyncMetrics::isAccountable(const MegaTransfer& transfer)
+{
+    return transfer.isSyncTransfer()
+            && (transfer.getType() == MegaTransfer::TYPE_DOWNLOAD || transfer.getType() == MegaTransfer::TYPE_UPLOAD)
+            && !transfer.isFolderTransfer()
+            && !transfer.isStreamingTransfer();
+}
+
+SyncMetrics::SyncEntry& SyncMetrics::upsertSync(MegaHandle backupId, const std::string& localPath)
+{
+    std::string path = localPath;
+    trimTrailingSeparators(path);
+
+    SyncEntry& entry = mSyncs[backupId];
+    if (entry.mLocalPath != path)
+    {
+        auto it = mSyncsByLocalPath.find(entry.mLocalPath);
+        if (it != mSyncsByLocalPath.end() && it->second == backupId)
+        {
+            mSyncsByLocalPath.erase(it);
+        }
+        entry.mLocalPath = path;
+    }
+
+    if (!path.empty())
+    {
+        mSyncsByLocalPath[path] = backupId;
+    }
+    return entry;
+}
+
+std::optional<MegaHandle> SyncMetrics::findSyncByLocalPath(std::string path) const
+{
+    trimTrailingSeparators(path);
+
+    // Syncs cannot be nested, so the first sync root found going up is the one containing the path
+    while (!path.empty())
+    {
+        auto it = mSyncsByLocalPath.find(path);
+        if (it != mSyncsByLocalPath.end())
+        {
+            return it->second;
+        }
+
+        const auto pos = path.find_last_of("/\\");
+        if (pos == std::string::npos || (pos == 0 && path.size() == 1))
+        {
+            break;
+        }
+        path.erase(pos == 0 ? 1 : pos);
+    }
+    return {};
+}
+
+void SyncMetrics::onSyncAdded(MegaHandle backupId, const std::string& localPath)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    upsertSync(backupId, localPath);
+}
+
+void SyncMetrics::onSyncStateChanged(MegaHandle backupId, const std::string& localPath, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    SyncEntry& entry = upsertSync(backupId, localPath);
+    entry.mCounters.mRunStateChanges++;
+    entry.mCounters.mLastActivity = now;
+}
+
+void SyncMetrics::onSyncDeleted(MegaHandle backupId)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    auto it = mSyncs.find(backupId);
+    if (it == mSyncs.end())
+    {
+        return;
+    }
+
+    auto pathIt = mSyncsByLocalPath.find(it->second.mLocalPath);
+    if (pathIt != mSyncsByLocalPath.end() && pathIt->second == backupId)
+    {
+        mSyncsByLocalPath.erase(pathIt);
+    }
+    mSyncs.erase(it);
+
+    for (auto tagIt = mSyncByTransferTag.begin(); tagIt != mSyncByTransferTag.end();)
+    {
+        tagIt = (tagIt->second == backupId ? mSyncByTransferTag.erase(tagIt) : std::next(tagIt));
+    }
+}
+
+void SyncMetrics::onScanningChanged(MegaHandle backupId, bool scanning, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    auto it = mSyncs.find(backupId);
+    if (it == mSyncs.end())
+    {
+        return;
+    }
+
+    SyncEntry& entry = it->second;
+    Counters& counters = entry.mCounters;
+    if (scanning == counters.mScanning)
+    {
+        return;
+    }
+
+    counters.mScanning = scanning;
+    counters.mLastActivity = now;
+    if (scanning)
+    {
+        entry.mScanStart = now;
+        return;
+    }
+
+    if (entry.mScanStart)
+    {
+        counters.mLastScanDuration = std::chrono::duration_cast<std::chrono::milliseconds>(now - *entry.mScanStart);
+        counters.mTotalScanDuration += counters.mLastScanDuration;
+        counters.mScanCount++;
+        entry.mScanStart.reset();
+    }
+}
+
+void SyncMetrics::onStall(MegaHandle backupId, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    auto it = mSyncs.find(backupId);
+    if (it != mSyncs.end())
+    {
+        it->second.mCounters.mStallCount++;
+        it->second.mCounters.mLastActivity = now;
+    }
+}
+
+void SyncMetrics::onTransferStart(const MegaTransfer& transfer, Clock::time_point now)
+{
+    if (!isAccountable(transfer) || !transfer.getPath())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> g(mMutex);
+    auto backupId = findSyncByLocalPath(transfer.getPath());
+    if (!backupId)
+    {
+        return;
+    }
+
+    if (mSyncByTransferTag.emplace(transfer.getTag(), *backupId).second)
+    {
+        Counters& counters = mSyncs[*backupId].mCounters;
+        counters.mTransfersInFlight++;
+        counters.mLastActivity = now;
+    }
+}
+
+void SyncMetrics::onTransferFinish(const MegaTransfer& transfer, bool succeeded, Clock::time_point now)
+{
+    if (!isAccountable(transfer))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> g(mMutex);
+
+    std::optional<MegaHandle> backupId;
+    bool wasInFlight = false;
+    auto tagIt = mSyncByTransferTag.find(transfer.getTag());
+    if (tagIt != mSyncByTransferTag.end())
+    {
+        backupId = tagIt->second;
+        wasInFlight = true;
+        mSyncByTransferTag.erase(tagIt);
+    }
+    else if (transfer.getPath()) // started before the metrics were collected
+    {
+        backupId = findSyncByLocalPath(transfer.getPath());
+    }
+
+    auto it = backupId ? mSyncs.find(*backupId) : mSyncs.end();
+    if (it == mSyncs.end())
+    {
+        return;
+    }
+
+    Counters& counters = it->second.mCounters;
+    if (wasInFlight && counters.mTransfersInFlight)
+    {
+        counters.mTransfersInFlight--;
+    }
+    counters.mLastActivity = now;
+
+    if (succeeded)
+    {
+        const bool upload = transfer.getType() == MegaTransfer::TYPE_UPLOAD;
+        (upload ? counters.mFilesUploaded : counters.mFilesDownloaded)++;
+        (upload ? counters.mBytesUploaded : counters.mBytesDownloaded) += static_cast<uint64_t>(std::max(0LL, transfer.getTotalBytes()));
+    }
+    else if (transfer.getState() != MegaTransfer::STATE_CANCELLED) // the sync engine cancels transfers of files that changed
+    {
+        counters.mFailedTransfers++;
+    }
+}
+
+std::optional<SyncMetrics::Counters> SyncMetrics::getCounters(MegaHandle backupId) const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    auto it = mSyncs.find(backupId);
+    if (it == mSyncs.end())
+    {
+        return {};
+    }
+    return it->second.mCounters;
+}
+
+} // end namespace
@@ -0,0 +1,94 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "megaapi.h"
+
+namespace megacmd {
+
+/**
+ * @brief Per-sync activity counters, collected from the sync and transfer callbacks.
+ *
+ * Transfers are attributed to the sync whose local root contains their local path.
+ * Counters live in memory only: they start from zero every time the server starts.
+ */
+class SyncMetrics
+{
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Counters
+    {
+        uint64_t mFilesUploaded = 0;
+        uint64_t mBytesUploaded = 0;
+        uint64_t mFilesDownloaded = 0;
+        uint64_t mBytesDownloaded = 0;
+        uint64_t mFailedTransfers = 0;
+        unsigned mTransfersInFlight = 0;
+
+        uint64_t mScanCount = 0; // completed scans
+        bool mScanning = false;
+        std::chrono::milliseconds mLastScanDuration{0};
+        std::chrono::milliseconds mTotalScanDuration{0};
+
+        uint64_t mStallCount = 0; // sync issues that appeared
+        uint64_t mRunStateChanges = 0;
+        std::optional<Clock::time_point> mLastActivity;
+    };
+
+    static SyncMetrics& getInstance();
+
+    void onSyncAdded(mega::MegaHandle backupId, const std::string& localPath);
+    void onSyncStateChanged(mega::MegaHandle backupId, const std::string& localPath, Clock::time_point now = Clock::now());
+    void onSyncDeleted(mega::MegaHandle backupId);
+
+    void onScanningChanged(mega::MegaHandle backupId, bool scanning, Clock::time_point now = Clock::now());
+    void onStall(mega::MegaHandle backupId, Clock::time_point now = Clock::now());
+
+    // Only sync file transfers are accounted
+    void onTransferStart(const mega::MegaTransfer& transfer, Clock::time_point now = Clock::now());
+    void onTransferFinish(const mega::MegaTransfer& transfer, bool succeeded, Clock::time_point now = Clock::now());
+
+    std::optional<Counters> getCounters(mega::MegaHandle backupId) const;
+
+private:
+    struct SyncEntry
+    {
+        std::string mLocalPath;
+        Counters mCounters;
+        std::optional<Clock::time_point> mScanStart;
+    };
+
+    mutable std::mutex mMutex;
+    std::unordered_map<mega::MegaHandle, SyncEntry> mSyncs;
+    std::map<std::string, mega::MegaHandle> mSyncsByLocalPath;
+    std::unordered_map<int, mega::MegaHandle> mSyncByTransferTag; // transfers in flight
+
+    static bool isAccountable(const mega::MegaTransfer& transfer);
+
+    SyncEntry& upsertSync(mega::MegaHandle backupId, const std::string& localPath);
+    std::optional<mega::MegaHandle> findSyncByLocalPath(std::string path) const;
+};
+
+} // end namespace
@@ -0,0 +1,132 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_timer_scheduler.h"
+
+#include <cassert>
+
+namespace megacmd {
+
+TimerScheduler::TimerScheduler() :
+    mThread([this] () { loop(); })
+{
+}
+
+TimerScheduler::~TimerScheduler()
+{
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mStop = true;
+    }
+    mCV.notify_one();
+    mThread.join();
+}
+
+TimerScheduler& TimerScheduler::getInstance()
+{
+    static TimerScheduler scheduler;
+    return scheduler;
+}
+
+TimerScheduler::TimerId TimerScheduler::schedule(Clock::duration delay, Callback&& callback)
+{
+    const auto deadline = Clock::now() + delay;
+
+    std::lock_guard<std::mutex> g(mMutex);
+    const TimerId id = ++mLastId;
+    mTimers.emplace(id, Timer{deadline, std::move(callback)});
+    auto it = mDeadlines.emplace(deadline, id);
+
+    // Only a new earliest deadline requires waking up the thread
+    if (it == mDeadlines.begin())
+    {
+        mCV.notify_one();
+    }
+    return id;
+}
+
+bool TimerScheduler::cancel(TimerId id, bool waitIfRunning)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto it = mTimers.find(id);
+    if (it == mTimers.end())
+    {
+        if (waitIfRunning && std::this_thread::get_id() != mThread.get_id())
+        {
+            mCallbackDoneCV.wait(lock, [this, id] () { return mRunningId != id; });
+        }
+        return false;
+    }
+
+    auto range = mDeadlines.equal_range(it->second.mDeadline);
+    for (auto deadlineIt = range.first; deadlineIt != range.second; ++deadlineIt)
+    {
+        if (deadlineIt->second == id)
+        {
+            mDeadlines.erase(deadlineIt);
+            break;
+        }
+    }
+    mTimers.erase(it);
+
+    // No need to wake up the thread: at worst, it'll wake up for nothing once
+    return true;
+}
+
+size_t TimerScheduler::getPendingCount() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mTimers.size();
+}
+
+void TimerScheduler::loop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mStop)
+    {
+        if (mDeadlines.empty())
+        {
+            mCV.wait(lock);
+            continue;
+        }
+
+        auto first = mDeadlines.begin();
+        if (Clock::now() < first->first)
+        {
+            mCV.wait_until(lock, first->first);
+            continue;
+        }
+
+        const TimerId id = first->second;
+        mDeadlines.erase(first);
+
+        auto it = mTimers.find(id);
+        assert(it != mTimers.end());
+        Callback callback = std::move(it->second.mCallback);
+        mTimers.erase(it);
+
+        mRunningId = id;
+        lock.unlock();
+
+        callback();
+        callback = nullptr; // whatever it captured must not be destroyed with the lock held
+
+        lock.lock();
+        mRunningId = 0;
+        mCallbackDoneCV.notify_all();
+    }
+}
+
+} // end namespace
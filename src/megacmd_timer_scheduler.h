@@ -0,0 +1,82 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace megacmd {
+
+/**
+ * @brief Runs callbacks once their deadline is reached, all of them from a single thread.
+ *
+ * The thread only wakes up when the earliest deadline expires or the set of timers changes,
+ * so there are no wakeups at all while nothing is scheduled. Callbacks must be short: a slow
+ * callback delays every timer expiring after it.
+ */
+class TimerScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    TimerScheduler();
+    ~TimerScheduler();
+
+    TimerScheduler(const TimerScheduler&) = delete;
+    TimerScheduler& operator=(const TimerScheduler&) = delete;
+
+    // The instance shared by the whole server
+    static TimerScheduler& getInstance();
+
+    TimerId schedule(Clock::duration delay, Callback&& callback);
+
+    // Returns false if the timer had already expired (or was cancelled).
+    // With waitIfRunning, if the callback is running it won't return until the callback is done,
+    // so that whatever it uses can be destroyed afterwards (ignored if called from the callback itself).
+    bool cancel(TimerId id, bool waitIfRunning = false);
+
+    size_t getPendingCount() const;
+
+private:
+    void loop();
+
+    struct Timer
+    {
+        Clock::time_point mDeadline;
+        Callback mCallback;
+    };
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCV;
+    std::condition_variable mCallbackDoneCV;
+    std::unordered_map<TimerId, Timer> mTimers;
+    std::multimap<Clock::time_point, TimerId> mDeadlines;
+    TimerId mLastId = 0;
+    TimerId mRunningId = 0;
+    bool mStop = false;
+
+    std::thread mThread;
+};
+
+} // end namespace
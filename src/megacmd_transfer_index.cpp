@@ -0,0 +1,220 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_transfer_index.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace mega;
+
+namespace megacmd {
+
+bool TransferIndex::Filter::matches(const TransferIndexEntry& entry) const
+{
+    if (entry.mIsSync && !mSyncs)
+    {
+        return false;
+    }
+    return entry.mType == MegaTransfer::TYPE_DOWNLOAD ? mDownloads : mUploads;
+}
+
+std::optional<TransferIndex::SortBy> TransferIndex::sortByFromString(const std::string& str)
+{
+    if (str.empty() || str == "queue")
+    {
+        return SortBy::QUEUE;
+    }
+    if (str == "speed")
+    {
+        return SortBy::SPEED;
+    }
+    if (str == "size")
+    {
+        return SortBy::SIZE;
+    }
+    return {};
+}
+
+bool TransferIndex::isIndexable(const MegaTransfer& transfer)
+{
+    // Folder transfers are containers of file transfers (which are indexed on their own),
+    // and streaming ones are not part of the transfer queues
+    return (transfer.getType() == MegaTransfer::TYPE_DOWNLOAD || transfer.getType() == MegaTransfer::TYPE_UPLOAD)
+            && !transfer.isFolderTransfer()
+            && !transfer.isStreamingTransfer();
+}
+
+TransferAggregates& TransferIndex::getAggregates(int type)
+{
+    return type == MegaTransfer::TYPE_DOWNLOAD ? mSummary.mDownloads : mSummary.mUploads;
+}
+
+void TransferIndex::account(const TransferIndexEntry& entry, int sign)
+{
+    assert(sign == 1 || sign == -1);
+    auto& aggregates = getAggregates(entry.mType);
+    aggregates.mCount += sign;
+    if (entry.mIsSync)
+    {
+        aggregates.mSyncCount += sign;
+    }
+    aggregates.mTotalBytes += sign * entry.mTotalBytes;
+    aggregates.mTransferredBytes += sign * entry.mTransferredBytes;
+    if (entry.mState >= 0 && entry.mState < static_cast<int>(aggregates.mCountByState.size()))
+    {
+        aggregates.mCountByState[entry.mState] += sign;
+    }
+}
+
+void TransferIndex::upsert(const MegaTransfer& transfer)
+{
+    if (!isIndexable(transfer))
+    {
+        return;
+    }
+
+    TransferIndexEntry entry;
+    entry.mTag = transfer.getTag();
+    entry.mType = transfer.getType();
+    entry.mState = transfer.getState();
+    entry.mIsSync = transfer.isSyncTransfer();
+    entry.mIsBackup = transfer.isBackupTransfer();
+    entry.mTotalBytes = transfer.getTotalBytes();
+    entry.mTransferredBytes = transfer.getTransferredBytes();
+    entry.mSpeed = transfer.getSpeed();
+
+    std::lock_guard<std::mutex> g(mMutex);
+    auto [it, inserted] = mEntries.emplace(entry.mTag, entry);
+    if (!inserted)
+    {
+        account(it->second, -1);
+        it->second = entry;
+    }
+    account(entry, 1);
+}
+
+void TransferIndex::onTransferStart(const MegaTransfer& transfer)
+{
+    if (transfer.isFolderTransfer() && !transfer.isStreamingTransfer())
+    {
+        std::lock_guard<std::mutex> g(mMutex);
+        mFolderTransferTags.insert(transfer.getTag());
+        return;
+    }
+    upsert(transfer);
+}
+
+void TransferIndex::onTransferUpdate(const MegaTransfer& transfer)
+{
+    // Updates might arrive for transfers that started before the listener was registered
+    upsert(transfer);
+}
+
+void TransferIndex::onTransferFinish(const MegaTransfer& transfer)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    if (transfer.isFolderTransfer())
+    {
+        mFolderTransferTags.erase(transfer.getTag());
+        return;
+    }
+
+    auto it = mEntries.find(transfer.getTag());
+    if (it == mEntries.end())
+    {
+        return;
+    }
+
+    account(it->second, -1);
+    mEntries.erase(it);
+}
+
+TransferIndexSummary TransferIndex::getSummary() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mSummary;
+}
+
+bool TransferIndex::hasPendingTransfers() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mSummary.mDownloads.mCount || mSummary.mUploads.mCount || !mFolderTransferTags.empty();
+}
+
+bool TransferIndex::hasPendingSyncTransfers() const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    return mSummary.getSyncCount() > 0;
+}
+
+std::vector<int> TransferIndex::getPage(const Filter& filter, SortBy sortBy, size_t offset, size_t limit) const
+{
+    std::vector<int> tags;
+
+    std::lock_guard<std::mutex> g(mMutex);
+    if (sortBy == SortBy::QUEUE)
+    {
+        // Entries are already sorted by tag: no need to go beyond the requested page
+        for (auto it = mEntries.begin(); it != mEntries.end() && tags.size() < limit; ++it)
+        {
+            if (!filter.matches(it->second))
+            {
+                continue;
+            }
+
+            if (offset)
+            {
+                --offset;
+                continue;
+            }
+            tags.push_back(it->first);
+        }
+        return tags;
+    }
+
+    std::vector<const TransferIndexEntry*> candidates;
+    for (const auto& [tag, entry] : mEntries)
+    {
+        if (filter.matches(entry))
+        {
+            candidates.push_back(&entry);
+        }
+    }
+
+    if (offset >= candidates.size())
+    {
+        return tags;
+    }
+
+    auto greaterThan = [sortBy](const TransferIndexEntry* a, const TransferIndexEntry* b)
+    {
+        const long long valueA = sortBy == SortBy::SPEED ? a->mSpeed : a->mTotalBytes;
+        const long long valueB = sortBy == SortBy::SPEED ? b->mSpeed : b->mTotalBytes;
+        return valueA != valueB ? valueA > valueB : a->mTag < b->mTag;
+    };
+
+    // Only the entries up to the end of the requested page need to be sorted
+    const size_t pageEnd = std::min(candidates.size(), offset + std::min(limit, candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + pageEnd, candidates.end(), greaterThan);
+
+    for (size_t i = offset; i < pageEnd; ++i)
+    {
+        tags.push_back(candidates[i]->mTag);
+    }
+    return tags;
+}
+
+} // end namespace
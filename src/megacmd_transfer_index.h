@@ -0,0 +1,115 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "megaapi.h"
+
+namespace megacmd {
+
+// Lightweight copy of the fields of a MegaTransfer needed to filter, sort and aggregate
+struct TransferIndexEntry
+{
+    int mTag = -1;
+    int mType = mega::MegaTransfer::TYPE_DOWNLOAD;
+    int mState = mega::MegaTransfer::STATE_NONE;
+    bool mIsSync = false;
+    bool mIsBackup = false;
+    long long mTotalBytes = 0;
+    long long mTransferredBytes = 0;
+    long long mSpeed = 0;
+};
+
+struct TransferAggregates
+{
+    unsigned mCount = 0;
+    unsigned mSyncCount = 0; // out of mCount
+    long long mTotalBytes = 0;
+    long long mTransferredBytes = 0;
+    std::array<unsigned, mega::MegaTransfer::STATE_FAILED + 1> mCountByState = {};
+};
+
+struct TransferIndexSummary
+{
+    TransferAggregates mDownloads;
+    TransferAggregates mUploads;
+
+    unsigned getSyncCount() const { return mDownloads.mSyncCount + mUploads.mSyncCount; }
+    unsigned getNonSyncCount() const { return mDownloads.mCount + mUploads.mCount - getSyncCount(); }
+};
+
+/**
+ * @brief Index of the ongoing (file) transfers, kept up to date from the global transfer listener callbacks.
+ *
+ * It allows answering summaries in constant time and listing a page of transfers without having to
+ * retrieve a MegaTransfer for every transfer in the queues.
+ */
+class TransferIndex
+{
+public:
+    enum class SortBy
+    {
+        QUEUE, // tag order, i.e: the order in which transfers were started
+        SPEED, // fastest first
+        SIZE,  // biggest first
+    };
+
+    struct Filter
+    {
+        bool mDownloads = true;
+        bool mUploads = true;
+        bool mSyncs = true;
+
+        bool matches(const TransferIndexEntry& entry) const;
+    };
+
+    static std::optional<SortBy> sortByFromString(const std::string& str);
+
+    void onTransferStart(const mega::MegaTransfer& transfer);
+    void onTransferUpdate(const mega::MegaTransfer& transfer);
+    void onTransferFinish(const mega::MegaTransfer& transfer);
+
+    TransferIndexSummary getSummary() const;
+
+    bool hasPendingTransfers() const; // including folder transfers
+    bool hasPendingSyncTransfers() const;
+
+    // Returns the tags of at most `limit` transfers matching `filter` (sorted by `sortBy`), skipping the first `offset` ones
+    std::vector<int> getPage(const Filter& filter, SortBy sortBy, size_t offset, size_t limit) const;
+
+private:
+    mutable std::mutex mMutex;
+    std::map<int, TransferIndexEntry> mEntries;
+    TransferIndexSummary mSummary;
+
+    // Folder transfers are not indexed, but they are pending (e.g. while scanning) until they finish
+    std::set<int> mFolderTransferTags;
+
+    static bool isIndexable(const mega::MegaTransfer& transfer);
+
+    TransferAggregates& getAggregates(int type);
+    void account(const TransferIndexEntry& entry, int sign);
+    void upsert(const mega::MegaTransfer& transfer);
+};
+
+} // end namespace
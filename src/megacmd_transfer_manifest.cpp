@@ -0,0 +1,311 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include "megacmd_transfer_manifest.h"
+
+#include <cassert>
+
+namespace megacmd {
+
+namespace {
+    const char* JOURNAL_HEADER = "MEGAcmd transfer manifest v1";
+
+    std::vector<std::string> splitByTabs(const std::string& line)
+    {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true)
+        {
+            const size_t end = line.find('\t', start);
+            fields.push_back(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+            if (end == std::string::npos)
+            {
+                return fields;
+            }
+            start = end + 1;
+        }
+    }
+
+    std::string escapeField(const std::string& field)
+    {
+        std::string escaped;
+        escaped.reserve(field.size());
+        for (char c : field)
+        {
+            switch (c)
+            {
+                case '\\': escaped += "\\\\"; break;
+                case '\t': escaped += "\\t"; break;
+                case '\n': escaped += "\\n"; break;
+                case '\r': escaped += "\\r"; break;
+                default: escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    std::string unescapeField(const std::string& field)
+    {
+        std::string unescaped;
+        unescaped.reserve(field.size());
+        for (size_t i = 0; i < field.size(); ++i)
+        {
+            if (field[i] != '\\' || i + 1 == field.size())
+            {
+                unescaped += field[i];
+                continue;
+            }
+
+            switch (field[++i])
+            {
+                case 't': unescaped += '\t'; break;
+                case 'n': unescaped += '\n'; break;
+                case 'r': unescaped += '\r'; break;
+                default: unescaped += field[i];
+            }
+        }
+        return unescaped;
+    }
+
+    std::optional<size_t> parseIndex(const std::string& str, size_t numItems)
+    {
+        try
+        {
+            size_t pos = 0;
+            const unsigned long long index = std::stoull(str, &pos);
+            if (pos == str.size() && index < numItems)
+            {
+                return static_cast<size_t>(index);
+            }
+        }
+        catch (const std::exception&) {}
+        return {};
+    }
+}
+
+std::optional<TransferManifest::Item> TransferManifest::parseManifestLine(const std::string& receivedLine, std::string& error)
+{
+    error.clear();
+
+    std::string line = receivedLine;
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.pop_back();
+    }
+
+    if (line.empty() || line[0] == '#')
+    {
+        return {};
+    }
+
+    auto fields = splitByTabs(line);
+    if (fields.size() != 3 || fields[1].empty() || fields[2].empty())
+    {
+        error = "expected \"get|put<TAB>source<TAB>destination\"";
+        return {};
+    }
+
+    Item item;
+    if (fields[0] == "get")
+    {
+        item.mDirection = Direction::DOWNLOAD;
+    }
+    else if (fields[0] == "put")
+    {
+        item.mDirection = Direction::UPLOAD;
+    }
+    else
+    {
+        error = "unknown transfer type \"" + fields[0] + "\"";
+        return {};
+    }
+
+    item.mSource = std::move(fields[1]);
+    item.mDestination = std::move(fields[2]);
+    return item;
+}
+
+TransferManifest::TransferManifest(const fs::path& journalPath, std::vector<Item>&& items) :
+    mJournalPath(journalPath),
+    mItems(std::move(items))
+{
+}
+
+std::unique_ptr<TransferManifest> TransferManifest::create(const fs::path& journalPath, std::vector<Item>&& items)
+{
+    std::unique_ptr<TransferManifest> manifest(new TransferManifest(journalPath, std::move(items)));
+    if (!manifest->writeCompacted())
+    {
+        return nullptr;
+    }
+    return manifest;
+}
+
+std::unique_ptr<TransferManifest> TransferManifest::load(const fs::path& journalPath)
+{
+    std::ifstream ifs(journalPath, std::ios::binary);
+    std::string line;
+    if (!ifs.is_open() || !std::getline(ifs, line) || line != JOURNAL_HEADER)
+    {
+        return nullptr;
+    }
+
+    std::vector<Item> items;
+    while (std::getline(ifs, line))
+    {
+        if (ifs.eof())
+        {
+            // Every record is terminated by a new line: this one was being written when we stopped
+            break;
+        }
+
+        auto fields = splitByTabs(line);
+        if (fields[0] == "I" && fields.size() == 6)
+        {
+            Item item;
+            item.mDirection = fields[1] == "p" ? Direction::UPLOAD : Direction::DOWNLOAD;
+            item.mState = fields[2] == "1" ? ItemState::DONE : (fields[2] == "2" ? ItemState::FAILED : ItemState::PENDING);
+            item.mErrorCode = std::atoi(fields[3].c_str());
+            item.mSource = unescapeField(fields[4]);
+            item.mDestination = unescapeField(fields[5]);
+            items.push_back(std::move(item));
+        }
+        else if (fields[0] == "D" && fields.size() == 2)
+        {
+            if (auto index = parseIndex(fields[1], items.size()))
+            {
+                items[*index].mState = ItemState::DONE;
+                items[*index].mErrorCode = 0;
+            }
+        }
+        else if (fields[0] == "F" && fields.size() == 3)
+        {
+            if (auto index = parseIndex(fields[1], items.size()))
+            {
+                items[*index].mState = ItemState::FAILED;
+                items[*index].mErrorCode = std::atoi(fields[2].c_str());
+            }
+        }
+    }
+    ifs.close();
+
+    std::unique_ptr<TransferManifest> manifest(new TransferManifest(journalPath, std::move(items)));
+    if (!manifest->writeCompacted())
+    {
+        return nullptr;
+    }
+    return manifest;
+}
+
+bool TransferManifest::writeCompacted()
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    if (mJournal.is_open())
+    {
+        mJournal.close();
+    }
+
+    fs::path tmpPath = mJournalPath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream ofs(tmpPath, std::ios::binary | std::ios::trunc);
+        ofs << JOURNAL_HEADER << '\n';
+        for (const auto& item : mItems)
+        {
+            ofs << "I\t" << (item.mDirection == Direction::UPLOAD ? "p" : "g")
+                << '\t' << static_cast<int>(item.mState) << '\t' << item.mErrorCode
+                << '\t' << escapeField(item.mSource) << '\t' << escapeField(item.mDestination) << '\n';
+        }
+        if (!ofs.flush())
+        {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, mJournalPath, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    mJournal.open(mJournalPath, std::ios::binary | std::ios::app);
+    return mJournal.is_open();
+}
+
+void TransferManifest::appendRecord(const std::string& record)
+{
+    // Flushing each record makes it survive a crash of the process (not of the system),
+    // which is enough to avoid repeating transfers after a restart
+    mJournal << record << '\n';
+    mJournal.flush();
+}
+
+std::vector<size_t> TransferManifest::getUnfinishedItems() const
+{
+    std::vector<size_t> unfinished;
+    std::lock_guard<std::mutex> g(mMutex);
+    for (size_t i = 0; i < mItems.size(); ++i)
+    {
+        if (mItems[i].mState != ItemState::DONE)
+        {
+            unfinished.push_back(i);
+        }
+    }
+    return unfinished;
+}
+
+TransferManifest::Item TransferManifest::getItem(size_t index) const
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    assert(index < mItems.size());
+    return mItems[index];
+}
+
+TransferManifest::Counts TransferManifest::getCounts() const
+{
+    Counts counts;
+    std::lock_guard<std::mutex> g(mMutex);
+    for (const auto& item : mItems)
+    {
+        switch (item.mState)
+        {
+            case ItemState::PENDING: counts.mPending++; break;
+            case ItemState::DONE: counts.mDone++; break;
+            case ItemState::FAILED: counts.mFailed++; break;
+        }
+    }
+    return counts;
+}
+
+void TransferManifest::markDone(size_t index)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    assert(index < mItems.size());
+    mItems[index].mState = ItemState::DONE;
+    mItems[index].mErrorCode = 0;
+    appendRecord("D\t" + std::to_string(index));
+}
+
+void TransferManifest::markFailed(size_t index, int errorCode)
+{
+    std::lock_guard<std::mutex> g(mMutex);
+    assert(index < mItems.size());
+    mItems[index].mState = ItemState::FAILED;
+    mItems[index].mErrorCode = errorCode;
+    appendRecord("F\t" + std::to_string(index) + "\t" + std::to_string(errorCode));
+}
+
+} // end namespace
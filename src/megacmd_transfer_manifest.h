@@ -0,0 +1,97 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "megacmd_utf8.h"
+
+namespace megacmd {
+
+/**
+ * @brief A list of (source, destination) transfers whose progress is checkpointed into an on-disk journal,
+ * so that they can be resumed after a restart skipping the ones already completed.
+ *
+ * The journal starts with the items (and their state when it was last compacted), followed by one short
+ * record per finished item. It is compacted (atomically rewritten) every time it is loaded.
+ */
+class TransferManifest
+{
+public:
+    enum class Direction
+    {
+        DOWNLOAD,
+        UPLOAD
+    };
+
+    enum class ItemState
+    {
+        PENDING,
+        DONE,
+        FAILED
+    };
+
+    struct Item
+    {
+        Direction mDirection = Direction::DOWNLOAD;
+        std::string mSource;
+        std::string mDestination;
+        ItemState mState = ItemState::PENDING;
+        int mErrorCode = 0;
+    };
+
+    struct Counts
+    {
+        size_t mPending = 0;
+        size_t mDone = 0;
+        size_t mFailed = 0;
+    };
+
+    // Parses a line of a manifest file: "get<TAB>remotepath<TAB>localpath" or "put<TAB>localpath<TAB>remotepath"
+    static std::optional<Item> parseManifestLine(const std::string& line, std::string& error);
+
+    static std::unique_ptr<TransferManifest> create(const fs::path& journalPath, std::vector<Item>&& items);
+    static std::unique_ptr<TransferManifest> load(const fs::path& journalPath);
+
+    const fs::path& getJournalPath() const { return mJournalPath; }
+
+    // Items that have not been completed yet (failed ones are retried)
+    std::vector<size_t> getUnfinishedItems() const;
+    Item getItem(size_t index) const;
+    Counts getCounts() const;
+
+    void markDone(size_t index);
+    void markFailed(size_t index, int errorCode);
+
+private:
+    TransferManifest(const fs::path& journalPath, std::vector<Item>&& items);
+
+    bool writeCompacted();
+    void appendRecord(const std::string& record);
+
+    const fs::path mJournalPath;
+
+    mutable std::mutex mMutex;
+    std::vector<Item> mItems;
+    std::ofstream mJournal;
+};
+
+} // end namespace
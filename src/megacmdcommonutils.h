@@ -97,7 +97,7 @@ enum confirmresponse
 static std::vector<std::string> validGlobalParameters {"v", "help"};
 static std::vector<std::string> localremotefolderpatterncommands {"sync", "fuse-add"};
 static std::vector<std::string> remotepatterncommands {"export", "attr"};
-static std::vector<std::string> remotefolderspatterncommands {"cd", "share"};
+static std::vector<std::string> remotefolderspatterncommands {"cd", "share", "storage-report"};
 
 static std::vector<std::string> multipleremotepatterncommands {"ls", "tree", "mkdir", "rm", "du", "find", "mv", "deleteversions", "cat", "mediainfo"
 #ifdef HAVE_LIBUV
@@ -114,7 +114,7 @@ static std::vector<std::string> localfolderpatterncommands {"lcd", "sync-ignore"
 static std::vector<std::string> emailpatterncommands {"invite", "signup", "ipc", "users"};
 
 static std::vector<std::string> loginInValidCommands { "log", "debug", "speedlimit", "help", "logout", "version", "quit",
-                            "clear", "https", "exit", "errorcode", "proxy", "sync-config", "configure"
+                            "clear", "https", "exit", "errorcode", "proxy", "sync-config", "configure", "lpwd"
 #if defined(_WIN32) && defined(NO_READLINE)
                              , "autocomplete", "codepage"
 #elif defined(_WIN32)
@@ -125,8 +125,12 @@ static std::vector<std::string> loginInValidCommands { "log", "debug", "speedlim
 #endif
                            };
 
+// Besides the ones valid while login in, the commands that don't need the nodes tree.
+// The rest are held until the account is ready (nodes fetched and up to date)
+static std::vector<std::string> nodesTreeFreeCommands { "login", "signup", "confirm", "session", "whoami", "lcd" };
+
 static std::vector<std::string> allValidCommands { "login", "signup", "confirm", "session", "mount", "ls", "cd", "log", "debug", "pwd", "lcd", "lpwd", "import", "masterkey",
-                             "put", "get", "attr", "userattr", "mkdir", "rm", "du", "mv", "cp", "sync", "sync-ignore", "export", "share", "invite", "ipc", "df",
+                             "put", "get", "manifest", "attr", "userattr", "mkdir", "rm", "du", "storage-report", "mv", "cp", "sync", "sync-ignore", "export", "share", "invite", "ipc", "df",
                              "showpcr", "users", "speedlimit", "killsession", "whoami", "help", "passwd", "reload", "logout", "version", "quit",
                              "thumbnail", "preview", "find", "completion", "clear", "https", "sync-issues",
                              "transfers", "exclude", "exit", "errorcode", "graphics",
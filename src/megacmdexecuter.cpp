@@ -30,13 +30,22 @@
 #include "sync_command.h"
 #include "sync_ignore.h"
 #include "megacmd_fuse.h"
+#include "megacmd_local_scanner.h"
+#include "megacmd_readiness.h"
 
+#include <algorithm>
+#include <deque>
 #include <iomanip>
 #include <limits>
 #include <string>
 #include <ctime>
 #include <functional>
 #include <set>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 #include <signal.h>
 
@@ -51,6 +60,8 @@ using namespace std;
 namespace megacmd {
 static const char* rootnodenames[] = { "ROOT", "INBOX", "RUBBISH" };
 static const char* rootnodepaths[] = { "/", "//in", "//bin" };
+static const size_t MAX_MUTATIONS_IN_FLIGHT = 32; // removals and moves of rm and mv
+static const size_t MAX_MUTATION_FAILURES_REPORTED = 10;
 
 #define SSTR( x ) static_cast< const std::ostringstream & >( \
         ( std::ostringstream() << std::dec << x ) ).str()
@@ -75,7 +86,87 @@ std::vector<std::string> resolvewildcard(const std::string& pattern) {
 }
 #endif
 
+// Gets an instance logged into the folder link with its nodes fetched, reusing the one kept from a previous
+// access to the same link if any. Returns nullptr on failure. Release it with freeApiFolder(apiFolder, publicLink, true)
+MegaApi* getApiFolderForLink(MegaApi& api, const std::string& publicLink)
+{
+    bool loggedIn = false;
+    MegaApi* apiFolder = getFreeApiFolder(publicLink, loggedIn);
+    if (!apiFolder)
+    {
+        setCurrentThreadOutCode(MCMD_NOTFOUND);
+        LOG_err << "No available Api folder. Use configure to increase exported_folders_sdks";
+        return nullptr;
+    }
+
+    std::unique_ptr<char[]> accountAuth(api.getAccountAuth());
+    apiFolder->setAccountAuth(accountAuth.get());
+
+    if (loggedIn)
+    {
+        if (apiFolder->isFilesystemAvailable())
+        {
+            return apiFolder;
+        }
+
+        LOG_debug << "Cached folder link instance is no longer usable. Logging in again";
+        logoutFromFolderLink(*apiFolder);
+    }
+
+    auto loginListener = std::make_unique<MegaCmdListener>(apiFolder);
+    apiFolder->loginToFolder(publicLink.c_str(), loginListener.get());
+    loginListener->wait();
+    if (!checkNoErrors(loginListener->getError(), "login to folder"))
+    {
+        freeApiFolder(apiFolder, publicLink, false);
+        return nullptr;
+    }
+
+    auto fetchNodesListener = std::make_unique<MegaCmdListener>(apiFolder);
+    apiFolder->fetchNodes(fetchNodesListener.get());
+    fetchNodesListener->wait();
+    if (!checkNoErrors(fetchNodesListener->getError(), "access folder link " + publicLink))
+    {
+        logoutFromFolderLink(*apiFolder);
+        freeApiFolder(apiFolder, publicLink, false);
+        return nullptr;
+    }
+    return apiFolder;
+}
+
 #ifdef WITH_FUSE
+bool loadFuseSetting(const std::map<std::string, std::string>& cloptions, const char* optName, bool allowZero, std::optional<size_t>& value)
+{
+    auto valueStr = getOptionAsOptional(cloptions, optName);
+    if (!valueStr)
+    {
+        return true;
+    }
+
+    if (valueStr->empty() || !std::all_of(valueStr->begin(), valueStr->end(), [](unsigned char c) { return std::isdigit(c); }))
+    {
+        LOG_err << "Option \"" << optName << "\" must be a non-negative integer";
+        return false;
+    }
+
+    try
+    {
+        value = std::stoull(*valueStr);
+    }
+    catch (...)
+    {
+        LOG_err << "Option \"" << optName << "\" is out of range";
+        return false;
+    }
+
+    if (!allowZero && *value == 0)
+    {
+        LOG_err << "Option \"" << optName << "\" must be greater than 0";
+        return false;
+    }
+    return true;
+}
+
 std::optional<FuseCommand::ConfigDelta> loadFuseConfigDelta(const std::map<std::string, std::string>& cloptions)
 {
     FuseCommand::ConfigDelta configDelta;
@@ -115,7 +206,14 @@ std::optional<FuseCommand::ConfigDelta> loadFuseConfigDelta(const std::map<std::
 
     configDelta.mName = getOptionAsOptional(cloptions, "name");
 
-    if (!configDelta.isAnyFlagSet())
+    if (!loadFuseSetting(cloptions, "inode-cache-size", false, configDelta.mInodeCacheMaxSize)
+        || !loadFuseSetting(cloptions, "inode-cache-age", false, configDelta.mInodeCacheCleanAge)
+        || !loadFuseSetting(cloptions, "flush-delay", true, configDelta.mFlushDelay))
+    {
+        return {};
+    }
+
+    if (!configDelta.isAnyFlagSet() && !configDelta.isAnySettingSet())
     {
         LOG_err << "At least one flag must be set";
         return {};
@@ -192,6 +290,8 @@ MegaCmdExecuter::MegaCmdExecuter(MegaApi *api, MegaCmdLogger *loggerCMD, MegaCmd
     // Give a few seconds in order for key sharing to happen
     mFsAccessCMD(::mega::createFSA()),
     mDeferredSharedFoldersVerifier(std::chrono::seconds(5)),
+    mCatchUpWarning(std::chrono::seconds(30)),
+    mCatchUpTimeout(std::chrono::seconds(150)),
     mSyncIssuesManager(api)
 {
     signingup = false;
@@ -213,6 +313,11 @@ MegaCmdExecuter::~MegaCmdExecuter()
     delete globalTransferListener;
 }
 
+const TransferIndex& MegaCmdExecuter::getTransferIndex() const
+{
+    return globalTransferListener->getTransferIndex();
+}
+
 // list available top-level nodes and contacts/incoming shares
 void MegaCmdExecuter::listtrees()
 {
@@ -261,16 +366,12 @@ bool MegaCmdExecuter::includeIfIsShared(MegaApi *api, MegaNode * n, void *arg)
 
 bool MegaCmdExecuter::includeIfIsPendingOutShare(MegaApi *api, MegaNode * n, void *arg)
 {
-    MegaShareList* pendingoutShares = api->getPendingOutShares(n);
+    std::unique_ptr<MegaShareList> pendingoutShares(api->getPendingOutShares(n));
     if (pendingoutShares && pendingoutShares->size())
     {
         (( vector<MegaNode*> * )arg )->push_back(n->copy());
         return true;
     }
-    if (pendingoutShares)
-    {
-        delete pendingoutShares;
-    }
     return false;
 }
 
@@ -282,16 +383,12 @@ bool MegaCmdExecuter::includeIfIsSharedOrPendingOutShare(MegaApi *api, MegaNode
         (( vector<MegaNode*> * )arg )->push_back(n->copy());
         return true;
     }
-    MegaShareList* pendingoutShares = api->getPendingOutShares(n);
+    std::unique_ptr<MegaShareList> pendingoutShares(api->getPendingOutShares(n));
     if (pendingoutShares && pendingoutShares->size())
     {
         (( vector<MegaNode*> * )arg )->push_back(n->copy());
         return true;
     }
-    if (pendingoutShares)
-    {
-        delete pendingoutShares;
-    }
     return false;
 }
 
@@ -1011,7 +1108,7 @@ bool MegaCmdExecuter::decryptLinkIfEncrypted(MegaApi *api, std::string &publicLi
     return true;
 }
 
-bool MegaCmdExecuter::checkAndInformPSA(CmdPetition *inf, bool enforce)
+bool MegaCmdExecuter::checkAndInformPSA(std::optional<int> clientID, bool enforce)
 {
     bool toret = false;
     m_time_t now = m_time();
@@ -1065,9 +1162,9 @@ bool MegaCmdExecuter::checkAndInformPSA(CmdPetition *inf, bool enforce)
 
             oss << endl << " Execute \"psa --discard\" to stop seeing this message";
 
-            if (inf)
+            if (clientID)
             {
-                informStateListener(oss.str(), inf->clientID);
+                informStateListener(oss.str(), *clientID);
             }
             else
             {
@@ -1467,7 +1564,7 @@ void MegaCmdExecuter::dumpNodeSummaryHeader(const char *timeFormat, std::map<std
     OUTSTREAM << endl;
 }
 
-void MegaCmdExecuter::dumpNodeSummary(MegaNode *n, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, bool humanreadable, const char *title)
+void MegaCmdExecuter::dumpNodeSummary(MegaNode *n, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, bool humanreadable, const char *title, std::optional<long long> folderSize)
 {
     if (!title && !( title = n->getName()))
     {
@@ -1550,15 +1647,16 @@ void MegaCmdExecuter::dumpNodeSummary(MegaNode *n, const char *timeFormat, std::
 
     OUTSTREAM << " ";
 
-    if (n->isFile())
+    if (n->isFile() || folderSize)
     {
+        const long long size = n->isFile() ? n->getSize() : *folderSize;
         if (humanreadable)
         {
-            OUTSTREAM << getFixLengthString(sizeToText(n->getSize()), DUMPNODE_SIZE_WIDTH, ' ', true);
+            OUTSTREAM << getFixLengthString(sizeToText(size), DUMPNODE_SIZE_WIDTH, ' ', true);
         }
         else
         {
-            OUTSTREAM << getFixLengthString(SSTR(n->getSize()), DUMPNODE_SIZE_WIDTH, ' ', true);
+            OUTSTREAM << getFixLengthString(SSTR(size), DUMPNODE_SIZE_WIDTH, ' ', true);
         }
     }
     else
@@ -1835,9 +1933,18 @@ void MegaCmdExecuter::dumpTreeSummary(MegaNode *n, const char *timeFormat, std::
                 OUTSTREAM << pathToShow << ":" << endl;
             }
 
+            // Sizes of the child folders, obtained all at once (the files have theirs)
+            std::vector<MegaNode*> childFolders;
+            for (int i = 0; i < children->size(); i++)
+            {
+                MegaNode *c = children->get(i);
+                childFolders.push_back(c->isFile() ? nullptr : c);
+            }
+            const auto childrenInfo = getFolderInfo(childFolders, !getFlag(clflags, "no-cache"));
+
             for (int i = 0; i < children->size(); i++)
             {
-                dumpNodeSummary(children->get(i), timeFormat, clflags, cloptions, humanreadable);
+                dumpNodeSummary(children->get(i), timeFormat, clflags, cloptions, humanreadable, NULL, childrenInfo[i].mSize);
             }
 
             if (show_versions)
@@ -2058,21 +2165,16 @@ string MegaCmdExecuter::getDisplayPath(string givenPath, MegaNode* n_param)
 int MegaCmdExecuter::dumpListOfExported(MegaNode* n_param, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, string givenPath)
 {
     int toret = 0;
-    vector<MegaNode *> listOfExported;
-    processTree(n_param, includeIfIsExported, (void*)&listOfExported);
-    for (std::vector< MegaNode * >::iterator it = listOfExported.begin(); it != listOfExported.end(); ++it)
+    auto listOfExported = getSharedNodesInTree(n_param, SharedNodesIndex::EXPORTED, includeIfIsExported);
+    for (const auto& n : listOfExported)
     {
-        MegaNode * n = *it;
-        if (n)
+        if (n->isExported()) // the index might be a node update behind
         {
-            string pathToShow = getDisplayPath(givenPath, n);
-            dumpNode(n, timeFormat, clflags, cloptions, 2, 1, false, pathToShow.c_str());
-
-            delete n;
+            string pathToShow = getDisplayPath(givenPath, n.get());
+            dumpNode(n.get(), timeFormat, clflags, cloptions, 2, 1, false, pathToShow.c_str());
+            toret++;
         }
     }
-    toret = int(listOfExported.size());
-    listOfExported.clear();
     return toret;
 }
 
@@ -2140,64 +2242,38 @@ void MegaCmdExecuter::listnodeshares(MegaNode* n, string name, bool listPending
 
 void MegaCmdExecuter::dumpListOfShared(MegaNode* n_param, string givenPath)
 {
-    vector<MegaNode *> listOfShared;
-    processTree(n_param, includeIfIsShared, (void*)&listOfShared);
+    auto listOfShared = getSharedNodesInTree(n_param, SharedNodesIndex::SHARED, includeIfIsShared);
     if (!listOfShared.size())
     {
         setCurrentThreadOutCode(MCMD_NOTFOUND);
         LOG_err << "No shared found for given path: " << givenPath;
     }
-    for (std::vector< MegaNode * >::iterator it = listOfShared.begin(); it != listOfShared.end(); ++it)
+    for (const auto& n : listOfShared)
     {
-        MegaNode * n = *it;
-        if (n)
-        {
-            string pathToShow = getDisplayPath(givenPath, n);
-            listnodeshares(n, pathToShow);
-
-            delete n;
-        }
+        string pathToShow = getDisplayPath(givenPath, n.get());
+        listnodeshares(n.get(), pathToShow);
     }
-
-    listOfShared.clear();
 }
 
 //includes pending and normal shares
 void MegaCmdExecuter::dumpListOfAllShared(MegaNode* n_param, string givenPath)
 {
-    vector<MegaNode *> listOfShared;
-    processTree(n_param, includeIfIsSharedOrPendingOutShare, (void*)&listOfShared);
-    for (std::vector< MegaNode * >::iterator it = listOfShared.begin(); it != listOfShared.end(); ++it)
+    auto listOfShared = getSharedNodesInTree(n_param, SharedNodesIndex::SHARED | SharedNodesIndex::PENDING_SHARED, includeIfIsSharedOrPendingOutShare);
+    for (const auto& n : listOfShared)
     {
-        MegaNode * n = *it;
-        if (n)
-        {
-            string pathToShow = getDisplayPath(givenPath, n);
-            listnodeshares(n, pathToShow, true);
-            delete n;
-        }
+        string pathToShow = getDisplayPath(givenPath, n.get());
+        listnodeshares(n.get(), pathToShow, true);
     }
-
-    listOfShared.clear();
 }
 
 void MegaCmdExecuter::dumpListOfPendingShares(MegaNode* n_param, string givenPath)
 {
-    vector<MegaNode *> listOfShared;
-    processTree(n_param, includeIfIsPendingOutShare, (void*)&listOfShared);
-
-    for (std::vector< MegaNode * >::iterator it = listOfShared.begin(); it != listOfShared.end(); ++it)
+    auto listOfShared = getSharedNodesInTree(n_param, SharedNodesIndex::PENDING_SHARED, includeIfIsPendingOutShare);
+    for (const auto& n : listOfShared)
     {
-        MegaNode * n = *it;
-        if (n)
-        {
-            string pathToShow = getDisplayPath(givenPath, n);
-            listnodeshares(n, pathToShow, true, true);
-            delete n;
-        }
+        string pathToShow = getDisplayPath(givenPath, n.get());
+        listnodeshares(n.get(), pathToShow, true, true);
     }
-
-    listOfShared.clear();
 }
 
 
@@ -2489,6 +2565,7 @@ bool MegaCmdExecuter::actUponFetchNodes(MegaApi *api, SynchronousRequestListener
         if (trywaitout)
         {
             LOG_err << "Fetch nodes took too long, it may have failed. No further actions performed";
+            Readiness::getInstance().onFetchNodesFinished(false);
             return false;
         }
     }
@@ -2513,31 +2590,43 @@ bool MegaCmdExecuter::actUponFetchNodes(MegaApi *api, SynchronousRequestListener
         session = std::unique_ptr<char[]>(srl->getApi()->dumpSession());
         ConfigurationManager::saveSession(session.get());
 
-        LOG_verbose << "ActUponFetchNodes ok. Let's wait for nodes current:";
-
-        auto futureNodesCurrent = sandboxCMD->mNodesCurrentPromise.getFuture();
-        bool discardGet = false;
-
-        LOG_debug << "Waiting for nodes current ...";
-
-        if (futureNodesCurrent.wait_for(std::chrono::seconds(30)) == std::future_status::timeout)
+        auto cwdNode = (cwd == UNDEF) ? nullptr : std::unique_ptr<MegaNode>(api->getNodeByHandle(cwd));
+        if (cwd == UNDEF || !cwdNode)
         {
-            LOG_warn << "Getting up to date with last changes in your account is taking long ...";
-            if (futureNodesCurrent.wait_for(std::chrono::seconds(120)) == std::future_status::timeout)
+            auto rootNode = std::unique_ptr<MegaNode>(api->getRootNode());
+            if (rootNode)
             {
-                LOG_err << "Getting up to date with last changes in your account is taking more than expected. MEGAcmd will continue. "
-                           "Caveat: you may be interacting with an out-dated version of your account.";
-                sendEvent(StatsManager::MegacmdEvent::WAITED_TOO_LONG_FOR_NODES_CURRENT, api, false);
-
-                discardGet = true;
+                cwd = rootNode->getHandle();
+            }
+            else
+            {
+                LOG_err << "Root node was not found after fetching nodes";
+                sendEvent(StatsManager::MegacmdEvent::ROOT_NODE_NOT_FOUND_AFTER_FETCHING, api);
             }
         }
 
-        if (!discardGet)
+        // This thread doesn't wait for the account to be up to date: petitions needing the nodes tree do
+        if (Readiness::getInstance().onFetchNodesFinished(true))
         {
-            auto eventCurrentArrivedOk = futureNodesCurrent.get();
-            assert(eventCurrentArrivedOk);
-            LOG_debug << "Waited for nodes current ... " << eventCurrentArrivedOk;
+            LOG_verbose << "ActUponFetchNodes ok. Nodes current will be waited for by the commands needing them";
+
+            mCatchUpWarning.triggerDeferredSingleShot([]
+            {
+                if (Readiness::getInstance().getState() == Readiness::State::CATCHING_UP)
+                {
+                    LOG_warn << "Getting up to date with last changes in your account is taking long ...";
+                }
+            });
+
+            mCatchUpTimeout.triggerDeferredSingleShot([api]
+            {
+                if (Readiness::getInstance().onCatchUpTimedOut())
+                {
+                    LOG_err << "Getting up to date with last changes in your account is taking more than expected. MEGAcmd will continue. "
+                               "Caveat: you may be interacting with an out-dated version of your account.";
+                    sendEvent(StatsManager::MegacmdEvent::WAITED_TOO_LONG_FOR_NODES_CURRENT, api, false);
+                }
+            });
         }
 
         std::string sessionString(session ? session.get() : "");
@@ -2549,10 +2638,8 @@ bool MegaCmdExecuter::actUponFetchNodes(MegaApi *api, SynchronousRequestListener
 
         return true;
     }
-    else
-    {
-        sandboxCMD->mNodesCurrentPromise.reset();
-    }
+
+    Readiness::getInstance().onFetchNodesFinished(false);
     return false;
 }
 
@@ -2756,7 +2843,7 @@ void MegaCmdExecuter::fetchNodes(MegaApi *api, int clientID)
 {
     if (!api) api = this->api;
 
-    sandboxCMD->mNodesCurrentPromise.initiatePromise();
+    Readiness::getInstance().onFetchNodesStarted();
     auto megaCmdListener = std::make_unique<MegaCmdListener>(api, nullptr, clientID);
     api->fetchNodes(megaCmdListener.get());
 
@@ -2772,22 +2859,7 @@ void MegaCmdExecuter::fetchNodes(MegaApi *api, int clientID)
     //automatic now:
     //api->enableTransferResumption();
 
-    auto cwdNode = (cwd == UNDEF) ? nullptr : std::unique_ptr<MegaNode>(api->getNodeByHandle(cwd));
-    if (cwd == UNDEF || !cwdNode)
-    {
-        auto rootNode = std::unique_ptr<MegaNode>(api->getRootNode());
-        if (rootNode)
-        {
-            cwd = rootNode->getHandle();
-        }
-        else
-        {
-            LOG_err << "Root node was not found after fetching nodes";
-            sendEvent(StatsManager::MegacmdEvent::ROOT_NODE_NOT_FOUND_AFTER_FETCHING, api);
-        }
-    }
-
-    setloginInAtStartup(false); //to enable all commands before giving clients the green light!
+    setloginInAtStartup(false); //to enable all commands before giving clients the green light! (the ones needing nodes will wait for them to be current)
     informStateListeners("loged:"); // tell the clients login ended, before providing them the first prompt
     updateprompt(api);
     LOG_debug << " Fetch nodes correctly";
@@ -2809,7 +2881,7 @@ void MegaCmdExecuter::fetchNodes(MegaApi *api, int clientID)
         // if we were green, don't need to ask: if there are changes they will be received via action packet indicating STATE_CHANGE
     }
 
-    checkAndInformPSA(NULL); // this needs broacasting in case there's another Shell running.
+    checkAndInformPSA(std::nullopt); // this needs broacasting in case there's another Shell running.
     // no need to enforce, because time since last check should has been restored
 
     mtxBackupsMap.lock();
@@ -2969,6 +3041,17 @@ void MegaCmdExecuter::actUponLogout(MegaApi& api, MegaError* e, bool keptSession
     {
         LOG_verbose << "actUponLogout logout ok";
         cwd = UNDEF;
+        mSharedNodesIndex.clear();
+        Readiness::getInstance().onLoggedOut();
+        if (!keptSession)
+        {
+            std::lock_guard<std::mutex> g(mNodesSnapshotMutex);
+            if (mNodesSnapshot)
+            {
+                mNodesSnapshot->remove();
+            }
+            mNodesSnapshotGenerations.reset();
+        }
         session.reset();
         mtxSyncMap.lock();
         ConfigurationManager::unloadConfiguration();
@@ -3037,7 +3120,10 @@ void MegaCmdExecuter::confirmDelete()
     {
         std::unique_ptr<MegaNode> nodeToConfirmDelete = std::move(mNodesToConfirmDelete.front());
         mNodesToConfirmDelete.erase(mNodesToConfirmDelete.begin());
-        doDeleteNode(nodeToConfirmDelete, api);
+
+        MutationBatch deletions(1);
+        addNodeDeletion(deletions, nodeToConfirmDelete, api);
+        runMutations(deletions, "delete node", "Removing");
     }
 
 
@@ -3077,12 +3163,13 @@ void MegaCmdExecuter::discardDelete()
 
 void MegaCmdExecuter::confirmDeleteAll()
 {
-    while (mNodesToConfirmDelete.size())
+    MutationBatch deletions(MAX_MUTATIONS_IN_FLIGHT);
+    for (const auto& nodeToConfirmDelete : mNodesToConfirmDelete)
     {
-        std::unique_ptr<MegaNode> nodeToConfirmDelete = std::move(mNodesToConfirmDelete.front());
-        mNodesToConfirmDelete.erase(mNodesToConfirmDelete.begin());
-        doDeleteNode(nodeToConfirmDelete, api);
+        addNodeDeletion(deletions, nodeToConfirmDelete, api);
     }
+    mNodesToConfirmDelete.clear();
+    runMutations(deletions, "delete node", "Removing");
 
     setprompt(COMMAND);
 }
@@ -3094,42 +3181,96 @@ void MegaCmdExecuter::discardDeleteAll()
 }
 
 
-void MegaCmdExecuter::doDeleteNode(const std::unique_ptr<MegaNode>& nodeToDelete, MegaApi* api)
+void MegaCmdExecuter::addNodeDeletion(MutationBatch& deletions, const std::unique_ptr<MegaNode>& nodeToDelete, MegaApi* api)
 {
-    char* nodePath = api->getNodePath(nodeToDelete.get());
+    std::unique_ptr<char[]> nodePath(api->getNodePath(nodeToDelete.get()));
     if (nodePath)
     {
-        LOG_verbose << "Deleting: "<< nodePath;
+        LOG_verbose << "Deleting: "<< nodePath.get();
     }
     else
     {
         LOG_warn << "Deleting node whose path could not be found " << nodeToDelete->getName();
     }
 
-    MegaCmdListener* megaCmdListener = new MegaCmdListener(api, nullptr);
     std::unique_ptr<MegaNode> parent(api->getParentNode(nodeToDelete.get()));
-    if (parent && parent->getType() == MegaNode::TYPE_FILE)
+    const bool isVersion = parent && parent->getType() == MegaNode::TYPE_FILE;
+
+    std::shared_ptr<MegaNode> node(nodeToDelete->copy());
+    deletions.add(nodePath ? nodePath.get() : nodeToDelete->getName(), [api, node, isVersion](MutationBatch::Finish&& finish)
+    {
+        auto megaCmdListener = new MegaCmdListenerFuncExecuter([finish = std::move(finish)](MegaApi*, MegaRequest*, MegaError* e)
+        {
+            finish(e ? e->getErrorCode() : MegaError::API_EINTERNAL);
+        }, true);
+
+        if (isVersion)
+        {
+            api->removeVersion(node.get(), megaCmdListener);
+        }
+        else
+        {
+            api->remove(node.get(), megaCmdListener);
+        }
+    });
+}
+
+void MegaCmdExecuter::addNodeMove(MutationBatch& moves, const std::unique_ptr<MegaNode>& n, MegaNode& destinyFolder)
+{
+    assert(destinyFolder.getType() != MegaNode::TYPE_FILE);
+
+    std::unique_ptr<char[]> nodePath(api->getNodePath(n.get()));
+    std::unique_ptr<char[]> destinyPath(api->getNodePath(&destinyFolder));
+    LOG_debug << "Moving : " << (nodePath ? nodePath.get() : n->getName()) << " to " << (destinyPath ? destinyPath.get() : destinyFolder.getName());
+
+    std::shared_ptr<MegaNode> node(n->copy());
+    std::shared_ptr<MegaNode> newParent(destinyFolder.copy());
+    moves.add(nodePath ? nodePath.get() : n->getName(), [this, node, newParent](MutationBatch::Finish&& finish)
+    {
+        api->moveNode(node.get(), newParent.get(), new MegaCmdListenerFuncExecuter([finish = std::move(finish)](MegaApi*, MegaRequest*, MegaError* e)
+        {
+            finish(e ? e->getErrorCode() : MegaError::API_EINTERNAL);
+        }, true));
+    });
+}
+
+bool MegaCmdExecuter::runMutations(MutationBatch& batch, const string& action, const string& title, int clientID)
+{
+    // A single mutation finishes all at once: there is no progress to show
+    const bool showProgress = batch.size() > 1;
+    const long long total = static_cast<long long>(batch.size());
+    auto lastProgress = std::chrono::steady_clock::now();
+
+    auto result = batch.run([&](size_t finished, size_t)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (showProgress && now - lastProgress >= std::chrono::milliseconds(500))
+        {
+            lastProgress = now;
+            informProgressUpdate(static_cast<long long>(finished), total, clientID, title);
+        }
+    });
+
+    if (showProgress)
     {
-        api->removeVersion(nodeToDelete.get(), megaCmdListener);
+        informProgressUpdate(PROGRESS_COMPLETE, total, clientID, title);
     }
-    else
+
+    for (size_t i = 0; i < result.mFailures.size() && i < MAX_MUTATION_FAILURES_REPORTED; ++i)
     {
-        api->remove(nodeToDelete.get(), megaCmdListener);
+        checkNoErrors(result.mFailures[i].mErrorCode, action + " " + result.mFailures[i].mDescription);
     }
-    megaCmdListener->wait();
 
-    string msj = "delete node ";
-    if (nodePath)
+    if (result.mFailures.size() > MAX_MUTATION_FAILURES_REPORTED)
     {
-        msj += nodePath;
+        LOG_err << "... and " << result.mFailures.size() - MAX_MUTATION_FAILURES_REPORTED << " more failures";
     }
-    else
+
+    if (result.mFailures.size() && total > 1)
     {
-        msj += nodeToDelete->getName();
+        LOG_err << result.mFailures.size() << " out of " << total << " requests to " << action << " failed";
     }
-    checkNoErrors(megaCmdListener->getError(), msj);
-    delete megaCmdListener;
-    delete []nodePath;
+    return result.mFailures.empty();
 }
 
 int MegaCmdExecuter::deleteNodeVersions(const std::unique_ptr<MegaNode>& nodeToDelete, MegaApi* api, int force)
@@ -3213,9 +3354,10 @@ int MegaCmdExecuter::deleteNodeVersions(const std::unique_ptr<MegaNode>& nodeToD
  * @param api
  * @param recursive
  * @param force
+ * @param deletions where the deletion is added once confirmed
  * @return confirmation code
  */
-int MegaCmdExecuter::deleteNode(const std::unique_ptr<MegaNode>& nodeToDelete, MegaApi* api, int recursive, int force)
+int MegaCmdExecuter::deleteNode(const std::unique_ptr<MegaNode>& nodeToDelete, MegaApi* api, int recursive, int force, MutationBatch& deletions)
 {
     if (nodeToDelete->getType() != MegaNode::TYPE_FILE && !recursive)
     {
@@ -3261,7 +3403,7 @@ int MegaCmdExecuter::deleteNode(const std::unique_ptr<MegaNode>& nodeToDelete, M
             if (confirmationResponse == MCMDCONFIRM_YES || confirmationResponse == MCMDCONFIRM_ALL)
             {
                 LOG_debug << "confirmation received";
-                doDeleteNode(nodeToDelete, api);
+                addNodeDeletion(deletions, nodeToDelete, api);
             }
             else
             {
@@ -3271,7 +3413,7 @@ int MegaCmdExecuter::deleteNode(const std::unique_ptr<MegaNode>& nodeToDelete, M
         }
         else //force
         {
-            doDeleteNode(nodeToDelete, api);
+            addNodeDeletion(deletions, nodeToDelete, api);
             return MCMDCONFIRM_ALL;
         }
     }
@@ -3279,11 +3421,8 @@ int MegaCmdExecuter::deleteNode(const std::unique_ptr<MegaNode>& nodeToDelete, M
     return MCMDCONFIRM_NO; //default return
 }
 
-void MegaCmdExecuter::downloadNode(string source, string path, MegaApi* api, MegaNode *node, bool background, bool ignorequotawarn,
-                                   int clientID, std::shared_ptr<MegaCmdMultiTransferListener> multiTransferListener)
+bool MegaCmdExecuter::checkDownloadQuota(MegaApi* api, long long bytesToDownload, bool ignorequotawarn)
 {
-
-
     if (sandboxCMD->isOverquota() && !ignorequotawarn)
     {
         m_time_t ts = m_time();
@@ -3327,13 +3466,13 @@ void MegaCmdExecuter::downloadNode(string source, string path, MegaApi* api, Meg
                      "Alternatively, you can try again in " << secondsToText(sandboxCMD->secondsOverQuota-(ts-sandboxCMD->timeOfOverquota)) <<
                      "." << endl << "See \"help --upgrade\" for further details" << endl;
         OUTSTREAM << "Use --ignore-quota-warn to initiate nevertheless" << endl;
-        return;
+        return false;
     }
 
     if (!ignorequotawarn)
     {
-        MegaCmdListener *megaCmdListener = new MegaCmdListener(api, NULL);
-        api->queryTransferQuota(node->getSize(),megaCmdListener);
+        std::unique_ptr<MegaCmdListener> megaCmdListener(new MegaCmdListener(api, NULL));
+        api->queryTransferQuota(bytesToDownload, megaCmdListener.get());
         megaCmdListener->wait();
         if (checkNoErrors(megaCmdListener->getError(), "query transfer quota"))
         {
@@ -3341,12 +3480,18 @@ void MegaCmdExecuter::downloadNode(string source, string path, MegaApi* api, Meg
             {
                 OUTSTREAM << "Transfer not started: proceeding will exceed transfer quota. "
                              "Use --ignore-quota-warn to initiate nevertheless" << endl;
-                return;
+                return false;
             }
         }
-        delete megaCmdListener;
     }
 
+    return true;
+}
+
+void MegaCmdExecuter::startNodeDownload(const string &source, string path, MegaApi* api, MegaNode *node,
+                                        const std::shared_ptr<MegaCmdMultiTransferListener> &multiTransferListener,
+                                        const char *customName)
+{
     multiTransferListener->onNewTransfer();
 
 #ifdef _WIN32
@@ -3357,7 +3502,7 @@ void MegaCmdExecuter::downloadNode(string source, string path, MegaApi* api, Meg
     api->startDownload(
                 node, //MegaNode* node,
                 path.c_str(), // const char* localPath,
-                nullptr, // const char *customName,
+                customName, // const char *customName,
                 nullptr, // const char *appData,
                 false, // bool startFirst,
                 nullptr, // MegaCancelToken *cancelToken,
@@ -3368,6 +3513,95 @@ void MegaCmdExecuter::downloadNode(string source, string path, MegaApi* api, Meg
      );
 }
 
+void MegaCmdExecuter::downloadNode(string source, string path, MegaApi* api, MegaNode *node, bool background, bool ignorequotawarn,
+                                   int clientID, std::shared_ptr<MegaCmdMultiTransferListener> multiTransferListener)
+{
+    if (!checkDownloadQuota(api, node->getSize(), ignorequotawarn))
+    {
+        return;
+    }
+
+    startNodeDownload(source, path, api, node, multiTransferListener);
+}
+
+namespace {
+// "name (N).ext", the way the SDK renames downloads that collide with existing local files
+std::string nameWithNumber(const std::string &name, unsigned number)
+{
+    const auto dot = name.find_last_of('.');
+    const bool hasExtension = dot != std::string::npos && dot != 0;
+    const std::string base = hasExtension ? name.substr(0, dot) : name;
+    const std::string extension = hasExtension ? name.substr(dot) : std::string();
+    return base + " (" + std::to_string(number) + ")" + extension;
+}
+}
+
+std::chrono::milliseconds MegaCmdExecuter::downloadNodes(const string &source, const string &path, MegaApi* api,
+                                                         const std::vector<std::unique_ptr<MegaNode>> &nodes, bool ignorequotawarn,
+                                                         const std::shared_ptr<MegaCmdMultiTransferListener> &multiTransferListener)
+{
+    const auto planningStart = std::chrono::steady_clock::now();
+
+    // All nodes go into the same destination: give the ones sharing their name a free "name (N)" before starting any transfer,
+    // instead of leaving it to whichever of them happens to reach the disk later
+    long long totalBytes = 0;
+    std::set<std::string> takenNames;
+    for (const auto &node : nodes)
+    {
+        totalBytes += node->getSize();
+        takenNames.insert(node->getName() ? node->getName() : "");
+    }
+
+    std::set<std::string> assignedNames;
+    std::vector<std::optional<std::string>> customNames(nodes.size());
+    unsigned collisions = 0;
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const std::string name = nodes[i]->getName() ? nodes[i]->getName() : "";
+        if (assignedNames.insert(name).second)
+        {
+            continue;
+        }
+
+        std::string newName;
+        for (unsigned number = 1; ; ++number)
+        {
+            newName = nameWithNumber(name, number);
+            if (!takenNames.count(newName) && !assignedNames.count(newName))
+            {
+                break;
+            }
+        }
+        assignedNames.insert(newName);
+        LOG_debug << "Downloading " << name << " as " << newName << ": another item to download has the same name";
+        customNames[i] = std::move(newName);
+        ++collisions;
+    }
+    if (collisions)
+    {
+        LOG_warn << collisions << " of the " << nodes.size() << " items to download share their name with others."
+                 << " They will be stored appending \" (NUM)\" to their names";
+    }
+
+    // Quota is evaluated once for the whole set
+    const bool quotaAllows = checkDownloadQuota(api, totalBytes, ignorequotawarn);
+
+    const auto planningTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - planningStart);
+    LOG_verbose << "Planned download of " << nodes.size() << " items (" << sizeToText(totalBytes) << ") in "
+                << planningTime.count() << " ms";
+    if (!quotaAllows)
+    {
+        return planningTime;
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        startNodeDownload(source, path, api, nodes[i].get(), multiTransferListener,
+                          customNames[i] ? customNames[i]->c_str() : nullptr);
+    }
+    return planningTime;
+}
+
 
 
 class SelfDestructingTransferStartCallbackListener: public MegaTransferListener
@@ -3395,8 +3629,6 @@ void MegaCmdExecuter::uploadNode(const std::map<std::string, int> &clflags, cons
                                  const std::string &receivedPath, MegaApi* api, MegaNode *node, const string &newname,
                                  MegaCmdMultiTransferListener *multiTransferListener)
 {
-    bool printTag = getFlag(&clflags,"print-tag-at-start");
-
     std::string path = receivedPath;
     unescapeifRequired(path);
 
@@ -3407,6 +3639,14 @@ void MegaCmdExecuter::uploadNode(const std::map<std::string, int> &clflags, cons
         return;
     }
 
+    startNodeUpload(clflags, std::move(path), api, node, newname, multiTransferListener);
+}
+
+void MegaCmdExecuter::startNodeUpload(const std::map<std::string, int> &clflags, std::string path, MegaApi* api, MegaNode *node,
+                                      const string &newname, MegaCmdMultiTransferListener *multiTransferListener)
+{
+    bool printTag = getFlag(&clflags,"print-tag-at-start");
+
     MegaTransferListener *thelistener = multiTransferListener;
 
     std::optional<std::promise<std::pair<int/*tag*/, std::string/*path*/>>> promiseStarted;
@@ -3459,47 +3699,1111 @@ void MegaCmdExecuter::uploadNode(const std::map<std::string, int> &clflags, cons
 }
 
 
-bool MegaCmdExecuter::amIPro()
+void MegaCmdExecuter::uploadFolderWithParallelScan(const std::map<std::string, int> &clflags, const std::map<std::string, std::string> &cloptions,
+                                                   const std::string &receivedPath, MegaApi* api, MegaNode *node, const string &newname,
+                                                   unsigned scanThreads, MegaCmdMultiTransferListener *multiTransferListener)
 {
-    int prolevel = -1;
-
-#ifdef MEGACMD_TESTING_CODE
-    auto proLevelOpt = TI::Instance().testValue(TI::TestValue::AMIPRO_LEVEL);
-    if (proLevelOpt)
-    {
-        prolevel = static_cast<int>(std::get<int64_t>(*proLevelOpt));
-        LOG_debug << "Enforced test value for Pro Level: " << prolevel;
-        return prolevel;
-    }
-#endif
+    std::string path = receivedPath;
+    unescapeifRequired(path);
+    const fs::path root = fs::u8path(removeTrailingSeparators(path));
 
-    auto megaCmdListener = std::make_unique<MegaCmdListener>(api, nullptr);
-    api->getAccountDetails(megaCmdListener.get());
-    megaCmdListener->wait();
+    LOG_debug << "Starting upload of " << path << " scanning it with " << scanThreads << " threads";
+    LocalTreeScanner scanner(root, scanThreads);
 
-    if (checkNoErrors(megaCmdListener->getError(), "get account details"))
+    auto getOrCreateFolder = [this, api](MegaNode &parent, const std::string &name) -> std::unique_ptr<MegaNode>
     {
-        std::unique_ptr<MegaAccountDetails> details(megaCmdListener->getRequest()->getMegaAccountDetails());
-        prolevel = details->getProLevel();
-    }
-
-    return prolevel > 0;
-}
+        std::unique_ptr<MegaNode> folder(api->getChildNode(&parent, name.c_str()));
+        if (folder)
+        {
+            if (folder->getType() == MegaNode::TYPE_FILE)
+            {
+                setCurrentThreadOutCode(MCMD_INVALIDTYPE);
+                LOG_err << "Unable to upload folder " << name << ": a file with the same name exists in the destination";
+                return nullptr;
+            }
+            return folder;
+        }
 
-void MegaCmdExecuter::exportNode(MegaNode *n, int64_t expireTime, const std::optional<std::string>& password,
-                                 std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions)
-{
-    const bool force = getFlag(clflags,"f");
-    const bool writable = getFlag(clflags,"writable");
-    const bool megaHosted = getFlag(clflags,"mega-hosted");
+        auto megaCmdListener = std::make_unique<MegaCmdListener>(nullptr);
+        api->createFolder(name.c_str(), &parent, megaCmdListener.get());
+        megaCmdListener->wait();
+        if (!checkNoErrors(megaCmdListener->getError(), "create folder " + name))
+        {
+            return nullptr;
+        }
+        return std::unique_ptr<MegaNode>(api->getNodeByHandle(megaCmdListener->getRequest()->getNodeHandle()));
+    };
 
-    bool alreadyAcceptedBefore = false;
-    bool copyrightAccepted = force ||
-            [&alreadyAcceptedBefore]() { return alreadyAcceptedBefore = ConfigurationManager::getConfigurationValue("copyrightAccepted", false); }();
+    // Remote folders created (or found) for each local folder scanned
+    std::map<fs::path, MegaHandle> remoteFolders;
+    std::unique_ptr<MegaNode> parent; // Entries of the same folder tend to come together: keep the last one
 
-    if (!copyrightAccepted)
+    uint64_t entriesProcessed = 0;
+    while (auto entry = scanner.next())
     {
-        auto publicLinks = std::unique_ptr<MegaNodeList>(api->getPublicLinks());
+        const bool isRoot = (entry->mPath == root);
+        const MegaHandle parentHandle = [&]()
+        {
+            if (isRoot)
+            {
+                return node->getHandle();
+            }
+            auto it = remoteFolders.find(entry->mPath.parent_path());
+            return it == remoteFolders.end() ? INVALID_HANDLE : it->second;
+        }();
+
+        if (parentHandle == INVALID_HANDLE)
+        {
+            // Its parent folder could not be created (already reported)
+            continue;
+        }
+
+        if (!parent || parent->getHandle() != parentHandle)
+        {
+            parent.reset(api->getNodeByHandle(parentHandle));
+            if (!parent)
+            {
+                setCurrentThreadOutCode(MCMD_NOTFOUND);
+                LOG_err << "Destination folder for " << entry->mPath.u8string() << " could not be found";
+                continue;
+            }
+        }
+
+        if (entry->mIsSymlink)
+        {
+            LOG_warn << "Symbolic link not uploaded: " << entry->mPath.u8string();
+        }
+        else if (entry->mIsFolder)
+        {
+            const std::string name = (isRoot && newname.size()) ? newname : entry->mPath.filename().u8string();
+            if (auto folder = getOrCreateFolder(*parent, name))
+            {
+                remoteFolders[entry->mPath] = folder->getHandle();
+            }
+        }
+        else
+        {
+            // Scanned paths are real names: they must not be unescaped again
+            startNodeUpload(clflags, entry->mPath.u8string(), api, parent.get(), "", multiTransferListener);
+        }
+
+        if (++entriesProcessed % 10000 == 0)
+        {
+            auto stats = scanner.getStats();
+            LOG_debug << "Upload of " << path << ": " << entriesProcessed << " entries processed. Scanned "
+                      << stats.mFolders << " folders and " << stats.mFiles << " files so far ("
+                      << static_cast<long long>(stats.getEntriesPerSecond()) << " entries/s)";
+        }
+    }
+
+    auto stats = scanner.getStats();
+    LOG_verbose << "Scanned " << path << ": " << stats.mFolders << " folders and " << stats.mFiles << " files in "
+                << stats.mElapsed.count() << " ms (" << static_cast<long long>(stats.getEntriesPerSecond()) << " entries/s)";
+    if (stats.mErrors)
+    {
+        LOG_warn << stats.mErrors << " local entries could not be read while scanning " << path;
+    }
+    if (stats.mSymlinks)
+    {
+        LOG_warn << stats.mSymlinks << " symbolic links were not uploaded from " << path;
+    }
+}
+
+
+void MegaCmdExecuter::updateFolderInfoCache(MegaNodeList *nodes)
+{
+    if (!nodes)
+    {
+        mFolderInfoCache.clear();
+        return;
+    }
+
+    if (mFolderInfoCache.empty())
+    {
+        // Nothing to adjust, but the folder info requests in flight must not cache what they get
+        for (int i = 0; i < nodes->size(); i++)
+        {
+            MegaNode *n = nodes->get(i);
+            if (n->hasChanged(MegaNode::CHANGE_TYPE_NEW) || n->isRemoved() || n->hasChanged(MegaNode::CHANGE_TYPE_PARENT))
+            {
+                mFolderInfoCache.clear();
+                return;
+            }
+        }
+        return;
+    }
+
+    // Folder ancestors of each parent, shared by the nodes updated within the same folder.
+    // Versions hang from the newer versions of their file, so those are skipped (and flagged)
+    struct Ancestors
+    {
+        std::vector<MegaHandle> mFolders;
+        bool mIsVersion = false;
+    };
+    std::map<MegaHandle, std::optional<Ancestors>> ancestorsByParent;
+    auto getAncestors = [this, &ancestorsByParent](MegaHandle parentHandle) -> const std::optional<Ancestors>&
+    {
+        auto [it, inserted] = ancestorsByParent.emplace(parentHandle, std::nullopt);
+        if (inserted)
+        {
+            Ancestors ancestors;
+            for (MegaHandle h = parentHandle; h != INVALID_HANDLE; )
+            {
+                std::unique_ptr<MegaNode> ancestor(api->getNodeByHandle(h));
+                if (!ancestor)
+                {
+                    return it->second; // unknown: it might be gone too
+                }
+                if (ancestor->getType() == MegaNode::TYPE_FILE)
+                {
+                    ancestors.mIsVersion = true;
+                }
+                else
+                {
+                    ancestors.mFolders.push_back(h);
+                }
+                h = ancestor->getParentHandle();
+            }
+            it->second = std::move(ancestors);
+        }
+        return it->second;
+    };
+
+    for (int i = 0; i < nodes->size(); i++)
+    {
+        MegaNode *n = nodes->get(i);
+        const bool isFile = n->getType() == MegaNode::TYPE_FILE;
+        const bool isNew = n->hasChanged(MegaNode::CHANGE_TYPE_NEW);
+        const bool isRemoved = n->isRemoved();
+        const bool isMoved = n->hasChanged(MegaNode::CHANGE_TYPE_PARENT);
+
+        if (!isNew && !isRemoved && !isMoved)
+        {
+            continue;
+        }
+
+        const auto &ancestors = getAncestors(n->getParentHandle());
+        if (ancestors && isMoved && isFile && !isNew && !isRemoved && ancestors->mIsVersion)
+        {
+            // A new version was added: the file it replaced hangs from it now, as a version
+            FolderInfoCache::Counts delta;
+            delta.mFiles = -1;
+            delta.mSize = -n->getSize();
+            mFolderInfoCache.applyDelta(ancestors->mFolders, delta);
+            continue;
+        }
+
+        if (!ancestors || isMoved)
+        {
+            // Where it was (or the whole branch) is unknown
+            mFolderInfoCache.clear();
+            return;
+        }
+
+        if (!isFile && isRemoved)
+        {
+            // How many nodes it contained is unknown
+            auto toInvalidate = ancestors->mFolders;
+            toInvalidate.push_back(n->getHandle());
+            mFolderInfoCache.invalidate(toInvalidate);
+            continue;
+        }
+
+        const long long sign = isRemoved ? -1 : 1;
+        FolderInfoCache::Counts delta;
+        if (!isFile)
+        {
+            delta.mFolders = sign;
+        }
+        else if (ancestors->mIsVersion)
+        {
+            delta.mSizeWithVersions = sign * n->getSize();
+        }
+        else
+        {
+            delta.mFiles = sign;
+            delta.mSize = delta.mSizeWithVersions = sign * n->getSize();
+        }
+        mFolderInfoCache.applyDelta(ancestors->mFolders, delta);
+    }
+}
+
+uint8_t getSharedNodeKinds(MegaApi& api, MegaNode& n)
+{
+    uint8_t kinds = n.isExported() ? SharedNodesIndex::EXPORTED : 0;
+
+    std::unique_ptr<MegaShareList> outShares(api.getOutShares(&n));
+    for (int i = 0; outShares && i < outShares->size(); i++)
+    {
+        kinds |= (outShares->get(i)->isPending() ? SharedNodesIndex::PENDING_SHARED : SharedNodesIndex::SHARED);
+    }
+
+    std::unique_ptr<MegaShareList> pendingOutShares(api.getPendingOutShares(&n));
+    if (pendingOutShares && pendingOutShares->size())
+    {
+        kinds |= SharedNodesIndex::PENDING_SHARED;
+    }
+    return kinds;
+}
+
+void MegaCmdExecuter::updateSharedNodesIndex(MegaNodeList *nodes)
+{
+    if (!nodes)
+    {
+        mSharedNodesIndex.clear();
+        return;
+    }
+
+    for (int i = 0; i < nodes->size(); i++)
+    {
+        MegaNode *n = nodes->get(i);
+        if (n->isRemoved())
+        {
+            mSharedNodesIndex.update(n->getHandle(), 0);
+        }
+        else if (n->hasChanged(MegaNode::CHANGE_TYPE_PUBLIC_LINK)
+                 || n->hasChanged(MegaNode::CHANGE_TYPE_OUTSHARE)
+                 || n->hasChanged(MegaNode::CHANGE_TYPE_PENDINGSHARE))
+        {
+            mSharedNodesIndex.update(n->getHandle(), getSharedNodeKinds(*api, *n));
+        }
+    }
+}
+
+bool MegaCmdExecuter::loadSharedNodesIndex()
+{
+    const auto generation = mSharedNodesIndex.getGeneration();
+    std::unordered_map<MegaHandle, uint8_t> kindsByNode;
+
+    std::unique_ptr<MegaNodeList> publicLinks(api->getPublicLinks());
+    for (int i = 0; publicLinks && i < publicLinks->size(); i++)
+    {
+        kindsByNode[publicLinks->get(i)->getHandle()] |= SharedNodesIndex::EXPORTED;
+    }
+
+    std::unique_ptr<MegaShareList> outShares(api->getOutShares());
+    for (int i = 0; outShares && i < outShares->size(); i++)
+    {
+        MegaShare* share = outShares->get(i);
+        kindsByNode[share->getNodeHandle()] |= (share->isPending() ? SharedNodesIndex::PENDING_SHARED : SharedNodesIndex::SHARED);
+    }
+
+    std::unique_ptr<MegaShareList> pendingOutShares(api->getPendingOutShares());
+    for (int i = 0; pendingOutShares && i < pendingOutShares->size(); i++)
+    {
+        kindsByNode[pendingOutShares->get(i)->getNodeHandle()] |= SharedNodesIndex::PENDING_SHARED;
+    }
+
+    LOG_debug << "Loaded index of " << kindsByNode.size() << " exported/shared nodes";
+    return mSharedNodesIndex.load(std::move(kindsByNode), generation);
+}
+
+std::vector<std::unique_ptr<MegaNode>> MegaCmdExecuter::getSharedNodesInTree(MegaNode* n, uint8_t kinds, bool processor(MegaApi *, MegaNode *, void *))
+{
+    std::vector<std::unique_ptr<MegaNode>> nodes;
+    if (!n)
+    {
+        return nodes;
+    }
+
+    // Only the own nodes are indexed: trees within incoming shares are walked
+    std::unique_ptr<char[]> rootPath(api->getNodePath(n));
+    const bool useIndex = rootPath && rootPath[0] == '/' && (mSharedNodesIndex.isLoaded() || loadSharedNodesIndex());
+    if (!useIndex)
+    {
+        vector<MegaNode *> found;
+        processTree(n, processor, (void*)&found);
+        for (MegaNode* node : found)
+        {
+            nodes.emplace_back(node);
+        }
+        return nodes;
+    }
+
+    std::vector<std::pair<string, std::unique_ptr<MegaNode>>> found;
+    for (MegaHandle h : mSharedNodesIndex.get(kinds))
+    {
+        std::unique_ptr<MegaNode> node(api->getNodeByHandle(h));
+        std::unique_ptr<char[]> path(node ? api->getNodePath(node.get()) : nullptr);
+        if (path && SharedNodesIndex::isPathInTree(path.get(), rootPath.get()))
+        {
+            found.emplace_back(path.get(), std::move(node));
+        }
+    }
+
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (auto& [path, node] : found)
+    {
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
+
+void MegaCmdExecuter::setNodesSnapshotInterval(std::chrono::minutes interval)
+{
+    std::optional<TimerScheduler::TimerId> previousTimer;
+    {
+        std::lock_guard<std::mutex> g(mNodesSnapshotMutex);
+        mNodesSnapshotInterval = interval;
+        previousTimer = mNodesSnapshotTimer;
+        mNodesSnapshotTimer.reset();
+        const uint64_t schedule = ++mNodesSnapshotSchedule;
+
+        if (interval.count() <= 0)
+        {
+            mNodesSnapshot.reset();
+        }
+        else
+        {
+            if (!mNodesSnapshot)
+            {
+                mNodesSnapshot = std::make_unique<NodesSnapshot>(ConfigurationManager::getConfigFolderSubdir("cache") / "nodes_snapshot");
+                mNodesSnapshotGenerations.reset();
+            }
+            scheduleNodesSnapshot(schedule);
+        }
+    }
+
+    if (previousTimer)
+    {
+        TimerScheduler::getInstance().cancel(*previousTimer, true /*waitIfRunning*/);
+    }
+
+    if (interval.count() <= 0)
+    {
+        // Including the one of a previous run, if they were enabled then
+        std::error_code ec;
+        fs::remove(ConfigurationManager::getConfigFolderSubdir("cache") / "nodes_snapshot", ec);
+    }
+}
+
+void MegaCmdExecuter::scheduleNodesSnapshot(uint64_t schedule)
+{
+    if (mNodesSnapshotsStopped)
+    {
+        return;
+    }
+
+    if (!mNodesSnapshotThread.joinable())
+    {
+        mNodesSnapshotThread = std::thread([this] { nodesSnapshotLoop(); });
+    }
+
+    mNodesSnapshotTimer = TimerScheduler::getInstance().schedule(mNodesSnapshotInterval, [this, schedule]
+    {
+        {
+            std::lock_guard<std::mutex> g(mNodesSnapshotMutex);
+            mNodesSnapshotDue = schedule;
+        }
+        mNodesSnapshotCV.notify_one();
+    });
+}
+
+void MegaCmdExecuter::nodesSnapshotLoop()
+{
+    std::unique_lock<std::mutex> lock(mNodesSnapshotMutex);
+    while (true)
+    {
+        mNodesSnapshotCV.wait(lock, [this] { return mNodesSnapshotDue || mNodesSnapshotsStopped; });
+        if (mNodesSnapshotsStopped)
+        {
+            return;
+        }
+
+        const uint64_t schedule = *mNodesSnapshotDue;
+        mNodesSnapshotDue.reset();
+
+        lock.unlock();
+        saveNodesSnapshot();
+        lock.lock();
+
+        if (schedule == mNodesSnapshotSchedule) // neither stopped nor rescheduled meanwhile
+        {
+            scheduleNodesSnapshot(schedule);
+        }
+    }
+}
+
+void MegaCmdExecuter::stopNodesSnapshots()
+{
+    std::optional<TimerScheduler::TimerId> timer;
+    {
+        std::lock_guard<std::mutex> g(mNodesSnapshotMutex);
+        ++mNodesSnapshotSchedule;
+        mNodesSnapshotsStopped = true;
+        timer = mNodesSnapshotTimer;
+        mNodesSnapshotTimer.reset();
+    }
+    mNodesSnapshotCV.notify_one();
+
+    if (timer)
+    {
+        TimerScheduler::getInstance().cancel(*timer, true /*waitIfRunning*/);
+    }
+
+    // It may be taking one: the last one must be written after it
+    if (mNodesSnapshotThread.joinable())
+    {
+        mNodesSnapshotThread.join();
+    }
+    saveNodesSnapshot();
+}
+
+bool MegaCmdExecuter::loadNodesSnapshot()
+{
+    std::lock_guard<std::mutex> g(mNodesSnapshotMutex);
+    if (!mNodesSnapshot || !mNodesSnapshot->read())
+    {
+        return false;
+    }
+
+    LOG_debug << "Loaded nodes snapshot taken " << NodesSnapshot::getAgeStr(NodesSnapshot::Clock::now() - *mNodesSnapshot->getTakenAt()) << " ago";
+    return true;
+}
+
+void MegaCmdExecuter::saveNodesSnapshot()
+{
+    // A snapshot of an account that is not up to date would be even more outdated
+    if (Readiness::getInstance().getState() != Readiness::State::READY
+            || (!mSharedNodesIndex.isLoaded() && !loadSharedNodesIndex()))
+    {
+        return;
+    }
+
+    const auto generations = std::make_pair(mSharedNodesIndex.getGeneration(), mFolderInfoCache.getGeneration());
+    {
+        std::lock_guard<std::mutex> g(mNodesSnapshotMutex);
+        if (!mNodesSnapshot || mNodesSnapshotGenerations == generations)
+        {
+            return;
+        }
+    }
+
+    NodesSnapshot::Entries entries;
+    for (uint8_t kind : {SharedNodesIndex::EXPORTED, SharedNodesIndex::SHARED, SharedNodesIndex::PENDING_SHARED})
+    {
+        for (MegaHandle h : mSharedNodesIndex.get(kind))
+        {
+            entries[h].mSharedKinds |= kind;
+        }
+    }
+
+    for (const auto& [h, counts] : mFolderInfoCache.getAll())
+    {
+        entries[h].mFolderCounts = counts;
+    }
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        std::unique_ptr<MegaNode> node(api->getNodeByHandle(it->first));
+        std::unique_ptr<char[]> path(node ? api->getNodePath(node.get()) : nullptr);
+        if (!path)
+        {
+            it = entries.erase(it);
+            continue;
+        }
+        it->second.mPath = path.get();
+        ++it;
+    }
+
+    std::lock_guard<std::mutex> g(mNodesSnapshotMutex);
+    if (!mNodesSnapshot) // disabled meanwhile
+    {
+        return;
+    }
+
+    if (mNodesSnapshot->write(entries))
+    {
+        mNodesSnapshotGenerations = generations;
+        LOG_debug << "Nodes snapshot written with " << entries.size() << " nodes";
+    }
+    else
+    {
+        LOG_warn << "Failed to write the nodes snapshot";
+    }
+}
+
+bool MegaCmdExecuter::executeFromNodesSnapshot(const vector<string>& words, map<string, int> *clflags, map<string, string> *cloptions)
+{
+    // Only plain listings and sizes can be answered from a snapshot: anything else waits for the account
+    if (words.empty() || (words[0] != "export" && words[0] != "share" && words[0] != "du"))
+    {
+        return false;
+    }
+    const bool isDu = words[0] == "du";
+    if (!isDu && words.size() > 2)
+    {
+        return false;
+    }
+
+    for (const auto& [flag, value] : *clflags)
+    {
+        if (value && flag != "v" && !(isDu && (flag == "h" || flag == "versions")))
+        {
+            return false;
+        }
+    }
+
+    for (const auto& [option, value] : *cloptions)
+    {
+        if (option != "clientID" && option != "client-width" && !(isDu && option == "path-display-size"))
+        {
+            return false;
+        }
+    }
+
+    // Paths relative to the working folder cannot be resolved until the nodes are fetched
+    vector<string> paths(words.begin() + 1, words.end());
+    if (paths.empty())
+    {
+        if (isDu)
+        {
+            return false;
+        }
+        paths.push_back("/");
+    }
+    for (auto& path : paths)
+    {
+        if (isDu)
+        {
+            unescapeifRequired(path);
+        }
+        if (path.empty() || path[0] != '/' || (isDu && isRegExp(path)))
+        {
+            return false;
+        }
+        while (path.size() > 1 && path.back() == '/')
+        {
+            path.pop_back();
+        }
+    }
+
+    std::lock_guard<std::mutex> g(mNodesSnapshotMutex);
+    if (!mNodesSnapshot || !mNodesSnapshot->isLoaded())
+    {
+        return false;
+    }
+
+    // Either all the sizes are known, or it waits for the account
+    std::vector<NodesSnapshot::Entry> sized;
+    for (size_t i = 0; isDu && i < paths.size(); ++i)
+    {
+        auto entry = mNodesSnapshot->findByPath(paths[i]);
+        if (!entry || !entry->mFolderCounts)
+        {
+            return false;
+        }
+        sized.push_back(std::move(*entry));
+    }
+
+    OUTSTREAM << "[Your account is still loading. This is from a snapshot taken "
+              << NodesSnapshot::getAgeStr(NodesSnapshot::Clock::now() - *mNodesSnapshot->getTakenAt())
+              << " ago: it may be out of date]" << endl;
+
+    if (isDu)
+    {
+        int PATHSIZE = getintOption(cloptions, "path-display-size");
+        if (!PATHSIZE)
+        {
+            unsigned int width = getNumberOfCols(75);
+            PATHSIZE = min(50, int(width - 22));
+        }
+        PATHSIZE = max(0, PATHSIZE);
+
+        const bool humanreadable = getFlag(clflags, "h");
+        const bool show_versions_size = getFlag(clflags, "versions");
+        long long totalSize = 0;
+        long long totalVersionsSize = 0;
+
+        OUTSTREAM << getFixLengthString("FILENAME", PATHSIZE) << getFixLengthString("SIZE", 12, ' ', true);
+        if (show_versions_size)
+        {
+            OUTSTREAM << getFixLengthString("S.WITH VERS", 12, ' ', true);
+        }
+        OUTSTREAM << endl;
+
+        for (const auto& entry : sized)
+        {
+            const auto& counts = *entry.mFolderCounts;
+            totalSize += counts.mSize;
+            totalVersionsSize += counts.mSizeWithVersions;
+
+            OUTSTREAM << getFixLengthString(entry.mPath + ":", PATHSIZE) << getFixLengthString(sizeToText(counts.mSize, true, humanreadable), 12, ' ', true);
+            if (show_versions_size)
+            {
+                OUTSTREAM << getFixLengthString(sizeToText(counts.mSizeWithVersions, true, humanreadable), 12, ' ', true);
+            }
+            OUTSTREAM << endl;
+        }
+
+        OUTSTREAM << string(PATHSIZE + 12 + (show_versions_size ? 12 : 0), '-') << endl;
+        OUTSTREAM << getFixLengthString("Total storage used:", PATHSIZE) << getFixLengthString(sizeToText(totalSize, true, humanreadable), 12, ' ', true);
+        if (show_versions_size)
+        {
+            OUTSTREAM << getFixLengthString(sizeToText(totalVersionsSize, true, humanreadable), 12, ' ', true);
+        }
+        OUTSTREAM << endl;
+        return true;
+    }
+
+    const string& root = paths[0];
+    const bool exports = words[0] == "export";
+    const auto entries = mNodesSnapshot->getShared(exports ? SharedNodesIndex::EXPORTED : SharedNodesIndex::SHARED | SharedNodesIndex::PENDING_SHARED, root);
+
+    if (entries.empty())
+    {
+        OUTSTREAM << "No " << (exports ? "exported" : "shared") << " nodes found in the snapshot within " << root << endl;
+        return true;
+    }
+
+    for (const auto& [handle, entry] : entries)
+    {
+        OUTSTREAM << entry.mPath;
+        if (exports)
+        {
+            OUTSTREAM << " (exported)";
+        }
+        else if (entry.mSharedKinds & SharedNodesIndex::SHARED)
+        {
+            OUTSTREAM << ((entry.mSharedKinds & SharedNodesIndex::PENDING_SHARED) ? " (shared, with pending shares)" : " (shared)");
+        }
+        else
+        {
+            OUTSTREAM << " (pending share)";
+        }
+        OUTSTREAM << endl;
+    }
+    return true;
+}
+
+LocalFingerprintCache &MegaCmdExecuter::getFingerprintCache()
+{
+    std::lock_guard<std::mutex> g(mFingerprintCacheMutex);
+    if (!mFingerprintCache)
+    {
+        mFingerprintCache = std::make_unique<LocalFingerprintCache>(ConfigurationManager::getConfigFolderSubdir("cache") / "local_fingerprints");
+    }
+    return *mFingerprintCache;
+}
+
+std::map<std::string, std::vector<std::unique_ptr<MegaNode>>> MegaCmdExecuter::getChildrenByName(MegaNode &folder)
+{
+    // Remote names need not be unique: all the nodes with each name are kept
+    std::map<std::string, std::vector<std::unique_ptr<MegaNode>>> childrenByName;
+    std::unique_ptr<MegaNodeList> children(api->getChildren(&folder));
+    for (int i = 0; children && i < children->size(); i++)
+    {
+        MegaNode *child = children->get(i);
+        childrenByName[child->getName()].emplace_back(child->copy());
+    }
+    return childrenByName;
+}
+
+bool MegaCmdExecuter::isLocalFileUnchanged(const fs::path &localPath, MegaNode &node, IncrementalTransferStats &stats)
+{
+    auto info = getLocalFileInfo(localPath);
+    if (!info || info->mSize != node.getSize())
+    {
+        return false;
+    }
+
+    if (info->mMtime == node.getModificationTime())
+    {
+        return true;
+    }
+
+    // Same size but different modification time: compare contents
+    std::unique_ptr<char[]> remoteCrc(api->getCRC(&node));
+    if (!remoteCrc)
+    {
+        return false;
+    }
+
+    const std::string localCrc = getFingerprintCache().getFingerprint(localPath, *info, [this, &stats](const fs::path &path)
+    {
+        stats.mHashed++;
+        std::unique_ptr<char[]> crc(api->getCRC(path.u8string().c_str()));
+        return crc ? std::string(crc.get()) : std::string();
+    });
+    return !localCrc.empty() && localCrc == remoteCrc.get();
+}
+
+void MegaCmdExecuter::uploadIncrementally(const fs::path &localPath, MegaNode &remoteParent, const std::string &name,
+                                          const std::map<std::string, std::vector<std::unique_ptr<MegaNode>>> &remoteSiblings,
+                                          IncrementalTransferStats &stats, MegaCmdMultiTransferListener *multiTransferListener)
+{
+    auto it = remoteSiblings.find(name);
+    const size_t sameNameCount = it == remoteSiblings.end() ? 0 : it->second.size();
+    MegaNode *existing = sameNameCount ? it->second.front().get() : nullptr;
+
+    std::error_code ec;
+    if (fs::is_directory(localPath, ec))
+    {
+        // Uploads merge into a folder with the same name, if there is any
+        for (size_t i = 0; i < sameNameCount; i++)
+        {
+            if (it->second[i]->getType() != MegaNode::TYPE_FILE)
+            {
+                existing = it->second[i].get();
+                break;
+            }
+        }
+
+        std::unique_ptr<MegaNode> folder;
+        if (existing && existing->getType() != MegaNode::TYPE_FILE)
+        {
+            folder.reset(existing->copy());
+        }
+        else if (existing)
+        {
+            setCurrentThreadOutCode(MCMD_INVALIDTYPE);
+            LOG_err << "Unable to upload folder " << localPath.u8string() << ": a file with the same name exists in the destination";
+            stats.mErrors++;
+            return;
+        }
+        else
+        {
+            auto megaCmdListener = std::make_unique<MegaCmdListener>(nullptr);
+            api->createFolder(name.c_str(), &remoteParent, megaCmdListener.get());
+            megaCmdListener->wait();
+            if (!checkNoErrors(megaCmdListener->getError(), "create folder " + name))
+            {
+                stats.mErrors++;
+                return;
+            }
+            folder.reset(api->getNodeByHandle(megaCmdListener->getRequest()->getNodeHandle()));
+        }
+
+        if (!folder)
+        {
+            stats.mErrors++;
+            return;
+        }
+
+        // Remote children are fetched once per folder
+        const auto remoteChildren = getChildrenByName(*folder);
+        for (const auto &dirEntry : fs::directory_iterator(localPath, ec))
+        {
+            std::error_code typeEc;
+            if (!dirEntry.is_symlink(typeEc))
+            {
+                uploadIncrementally(dirEntry.path(), *folder, dirEntry.path().filename().u8string(), remoteChildren, stats, multiTransferListener);
+            }
+        }
+        if (ec)
+        {
+            LOG_err << "Unable to list local folder " << localPath.u8string() << ": " << ec.message();
+            stats.mErrors++;
+        }
+        return;
+    }
+
+    if (!fs::is_regular_file(localPath, ec))
+    {
+        return;
+    }
+
+    // With several nodes of the same name it can't be told which one the file would be compared to: it is uploaded
+    if (sameNameCount > 1)
+    {
+        LOG_debug << "Several remote nodes named " << name << " in " << remoteParent.getName() << ": " << localPath.u8string() << " will be uploaded";
+    }
+    else if (existing && existing->getType() == MegaNode::TYPE_FILE && isLocalFileUnchanged(localPath, *existing, stats))
+    {
+        stats.mSkipped++;
+        return;
+    }
+
+    if (multiTransferListener)
+    {
+        multiTransferListener->onNewTransfer();
+    }
+
+    std::string path = localPath.u8string();
+#ifdef _WIN32
+    replaceAll(path, "/", "\\");
+#endif
+    LOG_debug << "Starting upload: " << path << " to : " << remoteParent.getName() << "/" << name;
+    api->startUpload(path.c_str(), &remoteParent, name.c_str(), MegaApi::INVALID_CUSTOM_MOD_TIME, nullptr,
+                     false, false, nullptr, multiTransferListener);
+    stats.mQueued++;
+}
+
+void MegaCmdExecuter::downloadIncrementally(MegaNode &node, const fs::path &localTarget, IncrementalTransferStats &stats,
+                                            const std::shared_ptr<MegaCmdMultiTransferListener> &multiTransferListener)
+{
+    std::error_code ec;
+    if (node.getType() != MegaNode::TYPE_FILE)
+    {
+        fs::create_directories(localTarget, ec);
+        if (ec)
+        {
+            setCurrentThreadOutCode(MCMD_NOTPERMITTED);
+            LOG_err << "Unable to create local folder " << localTarget.u8string() << ": " << ec.message();
+            stats.mErrors++;
+            return;
+        }
+
+        std::unique_ptr<MegaNodeList> children(api->getChildren(&node));
+        for (int i = 0; children && i < children->size(); i++)
+        {
+            MegaNode *child = children->get(i);
+            downloadIncrementally(*child, localTarget / fs::u8path(child->getName()), stats, multiTransferListener);
+        }
+        return;
+    }
+
+    if (isLocalFileUnchanged(localTarget, node, stats))
+    {
+        stats.mSkipped++;
+        return;
+    }
+
+    multiTransferListener->onNewTransfer();
+
+    const std::string path = localTarget.u8string();
+    LOG_debug << "Starting download: " << node.getName() << " to : " << path;
+
+    // Changed files replace the local ones, as in a mirror
+    api->startDownload(&node, path.c_str(), nullptr, nullptr, false, nullptr,
+                       MegaTransfer::COLLISION_CHECK_FINGERPRINT, MegaTransfer::COLLISION_RESOLUTION_OVERWRITE, false,
+                       new ATransferListener(multiTransferListener, path));
+    stats.mQueued++;
+}
+
+void MegaCmdExecuter::downloadNodesIncrementally(const std::vector<MegaNode*> &nodes, const std::string &path, bool ignorequotawarn,
+                                                  const std::shared_ptr<MegaCmdMultiTransferListener> &multiTransferListener)
+{
+    // What differs is not known yet: the quota check assumes everything will be downloaded
+    long long totalBytes = 0;
+    for (MegaNode *node : nodes)
+    {
+        totalBytes += api->getSize(node);
+    }
+    if (!checkDownloadQuota(api, totalBytes, ignorequotawarn))
+    {
+        return;
+    }
+
+    const bool intoFolder = path.size() && (path.back() == '/' || path.back() == '\\');
+    IncrementalTransferStats incrementalStats;
+    for (MegaNode *node : nodes)
+    {
+        fs::path target = fs::u8path(path);
+        if (intoFolder)
+        {
+            target /= fs::u8path(node->getName());
+        }
+        downloadIncrementally(*node, target, incrementalStats, multiTransferListener);
+    }
+    informIncrementalTransferStats(incrementalStats);
+}
+
+void MegaCmdExecuter::informIncrementalTransferStats(const IncrementalTransferStats &stats)
+{
+    if (!getFingerprintCache().save())
+    {
+        LOG_warn << "Unable to save local fingerprints cache";
+    }
+
+    LOG_verbose << "Incremental transfer: " << stats.mQueued << " files queued, " << stats.mSkipped << " unchanged files skipped ("
+                << stats.mHashed << " local files had to be read to compare them). Errors: " << stats.mErrors;
+}
+
+fs::path MegaCmdExecuter::getTransferManifestPath(const std::string &id)
+{
+    return ConfigurationManager::getConfigFolderSubdir("manifests") / fs::u8path(id + ".journal");
+}
+
+std::shared_ptr<TransferManifest> MegaCmdExecuter::getRunningTransferManifest(const std::string &id)
+{
+    std::lock_guard<std::mutex> g(mRunningManifestsMutex);
+    auto it = mRunningManifests.find(id);
+    return it == mRunningManifests.end() ? nullptr : it->second.lock();
+}
+
+void MegaCmdExecuter::runTransferManifest(const std::string &id, const std::shared_ptr<TransferManifest> &manifest, bool background, int clientID)
+{
+    {
+        std::lock_guard<std::mutex> g(mRunningManifestsMutex);
+        mRunningManifests[id] = manifest;
+    }
+
+    auto multiTransferListener = std::make_shared<MegaCmdMultiTransferListener>(api, sandboxCMD, nullptr, clientID);
+
+    size_t started = 0;
+    const size_t alreadyCompleted = manifest->getCounts().mDone;
+    for (size_t index : manifest->getUnfinishedItems())
+    {
+        const auto item = manifest->getItem(index);
+
+        // Each transfer listener keeps the manifest alive until its transfer finishes
+        auto onFinishCb = [manifest, index](MegaTransfer*, MegaError *e)
+        {
+            if (e->getErrorCode() == MegaError::API_OK)
+            {
+                manifest->markDone(index);
+            }
+            else
+            {
+                manifest->markFailed(index, e->getErrorCode());
+            }
+        };
+
+        if (item.mDirection == TransferManifest::Direction::DOWNLOAD)
+        {
+            std::unique_ptr<MegaNode> node = nodebypath(item.mSource.c_str());
+            if (!node)
+            {
+                LOG_err << "Couldn't find " << item.mSource;
+                manifest->markFailed(index, MegaError::API_ENOENT);
+                continue;
+            }
+
+            std::string localPath = item.mDestination;
+#ifdef _WIN32
+            replaceAll(localPath, "/", "\\");
+#endif
+            multiTransferListener->onNewTransfer();
+            api->startDownload(node.get(), localPath.c_str(), nullptr, nullptr, false, nullptr,
+                               MegaTransfer::COLLISION_CHECK_FINGERPRINT, MegaTransfer::COLLISION_RESOLUTION_NEW_WITH_N, false,
+                               new ATransferListener(multiTransferListener, item.mSource, std::move(onFinishCb)));
+        }
+        else
+        {
+            std::string localPath = item.mSource;
+            if (!pathExists(localPath))
+            {
+                LOG_err << "Unable to open local path: " << localPath;
+                manifest->markFailed(index, MegaError::API_ENOENT);
+                continue;
+            }
+
+            std::string newname;
+            std::unique_ptr<MegaNode> parent = nodebypath(item.mDestination.c_str(), nullptr, &newname);
+            if (parent && parent->getType() == MegaNode::TYPE_FILE)
+            {
+                // Uploading onto an existing file
+                newname = parent->getName();
+                parent.reset(api->getNodeByHandle(parent->getParentHandle()));
+            }
+            if (!parent)
+            {
+                LOG_err << "Couldn't find destination folder: " << item.mDestination;
+                manifest->markFailed(index, MegaError::API_ENOENT);
+                continue;
+            }
+
+#ifdef _WIN32
+            replaceAll(localPath, "/", "\\");
+#endif
+            multiTransferListener->onNewTransfer();
+            api->startUpload(removeTrailingSeparators(localPath).c_str(), parent.get(), newname.size() ? newname.c_str() : nullptr,
+                             MegaApi::INVALID_CUSTOM_MOD_TIME, nullptr, false, false, nullptr,
+                             new ATransferListener(multiTransferListener, item.mSource, std::move(onFinishCb)));
+        }
+        started++;
+    }
+
+    LOG_verbose << "Manifest " << id << ": " << started << " transfers started. "
+                << alreadyCompleted << " were already completed";
+
+    if (background)
+    {
+        OUTSTREAM << "Manifest " << id << ": " << started << " transfers started in the background" << endl;
+        return;
+    }
+
+    multiTransferListener->waitMultiEnd();
+    if (multiTransferListener->getProgressinformed() || getCurrentThreadOutCode() == MCMD_OK)
+    {
+        informProgressUpdate(PROGRESS_COMPLETE, multiTransferListener->getTotalbytes(), clientID);
+    }
+
+    const auto counts = manifest->getCounts();
+    if (counts.mFailed || counts.mPending)
+    {
+        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+    }
+    OUTSTREAM << "Manifest " << id << ": " << counts.mDone << " completed, " << counts.mFailed << " failed, "
+              << counts.mPending << " pending" << endl;
+}
+
+void MegaCmdExecuter::listTransferManifests(ColumnDisplayer &cd)
+{
+    std::error_code ec;
+    const fs::path manifestsFolder = ConfigurationManager::getConfigFolderSubdir("manifests");
+
+    for (const auto &dirEntry : fs::directory_iterator(manifestsFolder, ec))
+    {
+        if (dirEntry.path().extension() != ".journal")
+        {
+            continue;
+        }
+
+        const std::string id = dirEntry.path().stem().u8string();
+
+        // Loading a journal compacts it: never do that with the ones in use
+        std::shared_ptr<TransferManifest> manifest = getRunningTransferManifest(id);
+        const bool running = manifest != nullptr;
+        if (!manifest)
+        {
+            manifest = TransferManifest::load(dirEntry.path());
+        }
+        if (!manifest)
+        {
+            LOG_warn << "Unable to read transfer manifest journal: " << dirEntry.path().u8string();
+            continue;
+        }
+
+        const auto counts = manifest->getCounts();
+        cd.addValue("ID", id);
+        cd.addValue("COMPLETED", std::to_string(counts.mDone));
+        cd.addValue("FAILED", std::to_string(counts.mFailed));
+        cd.addValue("PENDING", std::to_string(counts.mPending));
+        cd.addValue("STATUS", running ? "In progress" : (counts.mFailed || counts.mPending ? "Stopped" : "Finished"));
+        cd.endregistry();
+    }
+
+    OUTSTREAM << cd.str();
+}
+
+bool MegaCmdExecuter::amIPro()
+{
+    int prolevel = -1;
+
+#ifdef MEGACMD_TESTING_CODE
+    auto proLevelOpt = TI::Instance().testValue(TI::TestValue::AMIPRO_LEVEL);
+    if (proLevelOpt)
+    {
+        prolevel = static_cast<int>(std::get<int64_t>(*proLevelOpt));
+        LOG_debug << "Enforced test value for Pro Level: " << prolevel;
+        return prolevel;
+    }
+#endif
+
+    auto megaCmdListener = std::make_unique<MegaCmdListener>(api, nullptr);
+    api->getAccountDetails(megaCmdListener.get());
+    megaCmdListener->wait();
+
+    if (checkNoErrors(megaCmdListener->getError(), "get account details"))
+    {
+        std::unique_ptr<MegaAccountDetails> details(megaCmdListener->getRequest()->getMegaAccountDetails());
+        prolevel = details->getProLevel();
+    }
+
+    return prolevel > 0;
+}
+
+bool MegaCmdExecuter::acceptExportCopyright(bool force)
+{
+    bool alreadyAcceptedBefore = false;
+    bool copyrightAccepted = force ||
+            [&alreadyAcceptedBefore]() { return alreadyAcceptedBefore = ConfigurationManager::getConfigurationValue("copyrightAccepted", false); }();
+
+    if (!copyrightAccepted)
+    {
+        auto publicLinks = std::unique_ptr<MegaNodeList>(api->getPublicLinks());
 
         // Implicit acceptance (the user already has public links)
         copyrightAccepted = (publicLinks && publicLinks->size());
@@ -3518,7 +4822,7 @@ void MegaCmdExecuter::exportNode(MegaNode *n, int64_t expireTime, const std::opt
         const int confirmationResponse = askforConfirmation(confirmationQuery);
         if (confirmationResponse != MCMDCONFIRM_YES && confirmationResponse != MCMDCONFIRM_ALL)
         {
-            return;
+            return false;
         }
     }
 
@@ -3527,6 +4831,19 @@ void MegaCmdExecuter::exportNode(MegaNode *n, int64_t expireTime, const std::opt
         // Save as accepted regardless of the source of acceptance
         ConfigurationManager::savePropertyValue("copyrightAccepted", true);
     }
+    return true;
+}
+
+void MegaCmdExecuter::exportNode(MegaNode *n, int64_t expireTime, const std::optional<std::string>& password,
+                                 std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions)
+{
+    const bool writable = getFlag(clflags,"writable");
+    const bool megaHosted = getFlag(clflags,"mega-hosted");
+
+    if (!acceptExportCopyright(getFlag(clflags,"f")))
+    {
+        return;
+    }
 
     auto megaCmdListener = std::make_unique<MegaCmdListener>(api, nullptr);
     api->exportNode(n, expireTime, writable, megaHosted, megaCmdListener.get());
@@ -3598,83 +4915,253 @@ void MegaCmdExecuter::exportNode(MegaNode *n, int64_t expireTime, const std::opt
             api->encryptLinkWithPassword(publicLink.get(), password->c_str(), megaCmdListener.get());
             megaCmdListener->wait();
 
-            if (checkNoErrors(megaCmdListener->getError(), "protect public link with password"))
-            {
-                publicPassProtectedLink = megaCmdListener->getRequest()->getText();
-            }
+            if (checkNoErrors(megaCmdListener->getError(), "protect public link with password"))
+            {
+                publicPassProtectedLink = megaCmdListener->getRequest()->getText();
+            }
+        }
+        else
+        {
+            LOG_err << "Only PRO users can protect links with passwords. Showing UNPROTECTED link";
+        }
+    }
+
+    const int64_t actualExpireTime = nexported->getExpirationTime();
+    if (expireTime != 0 && !actualExpireTime)
+    {
+        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+        LOG_err << "Could not add expiration date to exported node";
+    }
+
+    const string authKey(nexported->getWritableLinkAuthKey() ? nexported->getWritableLinkAuthKey() : "");
+    if (writable && authKey.empty())
+    {
+        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+        LOG_err << "Failed to generate writable folder: missing auth key. Showing read-only link";
+    }
+
+    const string nodeLink(publicPassProtectedLink.size() ? publicPassProtectedLink : publicLink.get());
+    OUTSTREAM << "Exported " << nodepath.get() << ": " << nodeLink;
+
+    constexpr const char* prefix = "https://mega.nz/folder/";
+    if (authKey.size() && nodeLink.rfind(prefix, 0) == 0)
+    {
+        string authToken = nodeLink.substr(strlen(prefix)).append(":").append(authKey);
+        OUTSTREAM << "\n          AuthToken = " << authToken;
+        if (megaHosted && megaCmdListener->getRequest()->getPassword())
+        {
+            OUTSTREAM << "\n          Share key encryption key = " << megaCmdListener->getRequest()->getPassword();
+        }
+    }
+
+    if (actualExpireTime)
+    {
+        OUTSTREAM << " expires at " << getReadableTime(nexported->getExpirationTime());
+    }
+
+    OUTSTREAM << endl;
+}
+
+void MegaCmdExecuter::disableExport(MegaNode *n)
+{
+    if (!n->isExported())
+    {
+        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+        LOG_err << "Could not disable export: node not exported.";
+        return;
+    }
+    MegaCmdListener *megaCmdListener = new MegaCmdListener(api, NULL);
+
+    api->disableExport(n, megaCmdListener);
+    megaCmdListener->wait();
+    if (checkNoErrors(megaCmdListener->getError(), "disable export"))
+    {
+        MegaNode *nexported = api->getNodeByHandle(megaCmdListener->getRequest()->getNodeHandle());
+        if (nexported)
+        {
+            char *nodepath = api->getNodePath(nexported);
+            OUTSTREAM << "Disabled export: " << nodepath << endl;
+            delete[] nodepath;
+            delete nexported;
+        }
+        else
+        {
+            setCurrentThreadOutCode(MCMD_NOTFOUND);
+            LOG_err << "Exported node not found!";
+        }
+    }
+
+    delete megaCmdListener;
+}
+
+void MegaCmdExecuter::exportNodesInBulk(const std::vector<std::unique_ptr<MegaNode>>& nodes, bool disable, int64_t expireTime,
+                                        const std::optional<std::string>& password, bool writable, bool megaHosted, size_t maxInFlight)
+{
+    std::optional<std::string> linkPassword = password;
+    if (!disable && (expireTime != 0 || password) && !amIPro())
+    {
+        if (expireTime != 0)
+        {
+            setCurrentThreadOutCode(MCMD_EARGS);
+            LOG_err << "Only PRO users can set an expiry time for links";
+            return;
+        }
+        LOG_err << "Only PRO users can protect links with passwords. Showing UNPROTECTED links";
+        linkPassword.reset();
+    }
+
+    // Filled by the request listeners as requests finish, so that each result is printed as soon as it is known.
+    // Shared with them, since they may still be returning when this function does
+    struct Completion
+    {
+        size_t mIndex;
+        std::unique_ptr<MegaRequest> mRequest;
+        std::unique_ptr<MegaError> mError;
+    };
+    struct Completions
+    {
+        std::mutex mMutex;
+        std::condition_variable mCV;
+        std::deque<Completion> mCompleted;
+    };
+    auto completions = std::make_shared<Completions>();
+
+    size_t failed = 0;
+    size_t inFlight = 0;
+
+    auto getPath = [this](MegaNode& n)
+    {
+        std::unique_ptr<char[]> path(api->getNodePath(&n));
+        return string(path ? path.get() : n.getName());
+    };
+
+    auto printResult = [&](MegaNode& n, MegaRequest& request, MegaError& error)
+    {
+        const string nodePath = getPath(n);
+        if (error.getErrorCode() != MegaError::API_OK)
+        {
+            failed++;
+            if (disable)
+            {
+                LOG_err << "Failed to disable export of " << nodePath << ": " << formatErrorAndMaySetErrorCode(error);
+            }
+            else
+            {
+                LOG_err << "Failed to export " << nodePath << ": "
+                        << (nodePath == "/" ? string("The root folder cannot be exported") : formatErrorAndMaySetErrorCode(error));
+            }
+            return;
+        }
+
+        if (disable)
+        {
+            // The node given is the one from before disabling the export, so it still has the link that was removed
+            std::unique_ptr<char[]> oldLink(n.getPublicLink());
+            OUTSTREAM << nodePath << "\t" << (oldLink ? oldLink.get() : "-") << endl;
+            return;
+        }
+
+        std::unique_ptr<MegaNode> nexported(api->getNodeByHandle(request.getNodeHandle()));
+        std::unique_ptr<char[]> publicLink(nexported ? nexported->getPublicLink() : nullptr);
+        if (!publicLink)
+        {
+            failed++;
+            setCurrentThreadOutCode(MCMD_NOTFOUND);
+            LOG_err << "Public link for exported node " << nodePath << " not found";
+            return;
+        }
+
+        string nodeLink(publicLink.get());
+        if (linkPassword)
+        {
+            auto passwordListener = std::make_unique<MegaCmdListener>(api, nullptr);
+            api->encryptLinkWithPassword(publicLink.get(), linkPassword->c_str(), passwordListener.get());
+            passwordListener->wait();
+
+            if (checkNoErrors(passwordListener->getError(), "protect public link with password"))
+            {
+                nodeLink = passwordListener->getRequest()->getText();
+            }
+        }
+
+        if (expireTime != 0 && !nexported->getExpirationTime())
+        {
+            setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+            LOG_err << "Could not add expiration date to exported node " << nodePath;
+        }
+
+        OUTSTREAM << nodePath << "\t" << nodeLink;
+
+        const string authKey(nexported->getWritableLinkAuthKey() ? nexported->getWritableLinkAuthKey() : "");
+        constexpr const char* prefix = "https://mega.nz/folder/";
+        if (writable && authKey.empty())
+        {
+            setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+            LOG_err << "Failed to generate writable folder " << nodePath << ": missing auth key. Showing read-only link";
         }
-        else
+        else if (authKey.size() && nodeLink.rfind(prefix, 0) == 0)
         {
-            LOG_err << "Only PRO users can protect links with passwords. Showing UNPROTECTED link";
+            OUTSTREAM << "\t" << nodeLink.substr(strlen(prefix)).append(":").append(authKey);
+            if (megaHosted && request.getPassword())
+            {
+                OUTSTREAM << "\t" << request.getPassword();
+            }
         }
-    }
+        OUTSTREAM << endl;
+    };
 
-    const int64_t actualExpireTime = nexported->getExpirationTime();
-    if (expireTime != 0 && !actualExpireTime)
+    // Results are printed from this thread, where the output of the command goes
+    auto waitForAny = [&]()
     {
-        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
-        LOG_err << "Could not add expiration date to exported node";
-    }
+        Completion completion;
+        {
+            std::unique_lock<std::mutex> lock(completions->mMutex);
+            completions->mCV.wait(lock, [&completions]() { return !completions->mCompleted.empty(); });
+            completion = std::move(completions->mCompleted.front());
+            completions->mCompleted.pop_front();
+        }
+        inFlight--;
+        printResult(*nodes[completion.mIndex], *completion.mRequest, *completion.mError);
+    };
 
-    const string authKey(nexported->getWritableLinkAuthKey() ? nexported->getWritableLinkAuthKey() : "");
-    if (writable && authKey.empty())
+    for (size_t i = 0; i < nodes.size(); ++i)
     {
-        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
-        LOG_err << "Failed to generate writable folder: missing auth key. Showing read-only link";
-    }
+        if (inFlight >= maxInFlight)
+        {
+            waitForAny();
+        }
 
-    const string nodeLink(publicPassProtectedLink.size() ? publicPassProtectedLink : publicLink.get());
-    OUTSTREAM << "Exported " << nodepath.get() << ": " << nodeLink;
+        auto listener = new MegaCmdListenerFuncExecuter([i, completions](MegaApi*, MegaRequest* request, MegaError* e)
+        {
+            std::lock_guard<std::mutex> g(completions->mMutex);
+            completions->mCompleted.push_back({i, std::unique_ptr<MegaRequest>(request->copy()), std::unique_ptr<MegaError>(e->copy())});
+            completions->mCV.notify_one();
+        }, true /*autoremove*/);
 
-    constexpr const char* prefix = "https://mega.nz/folder/";
-    if (authKey.size() && nodeLink.rfind(prefix, 0) == 0)
-    {
-        string authToken = nodeLink.substr(strlen(prefix)).append(":").append(authKey);
-        OUTSTREAM << "\n          AuthToken = " << authToken;
-        if (megaHosted && megaCmdListener->getRequest()->getPassword())
+        inFlight++;
+        if (disable)
         {
-            OUTSTREAM << "\n          Share key encryption key = " << megaCmdListener->getRequest()->getPassword();
+            api->disableExport(nodes[i].get(), listener);
+        }
+        else
+        {
+            api->exportNode(nodes[i].get(), expireTime, writable, megaHosted, listener);
         }
     }
 
-    if (actualExpireTime)
+    while (inFlight)
     {
-        OUTSTREAM << " expires at " << getReadableTime(nexported->getExpirationTime());
+        waitForAny();
     }
 
-    OUTSTREAM << endl;
-}
-
-void MegaCmdExecuter::disableExport(MegaNode *n)
-{
-    if (!n->isExported())
+    if (failed)
     {
-        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
-        LOG_err << "Could not disable export: node not exported.";
-        return;
+        LOG_err << "Failed to " << (disable ? "disable " : "") << "export " << failed << " of " << nodes.size() << " nodes";
     }
-    MegaCmdListener *megaCmdListener = new MegaCmdListener(api, NULL);
-
-    api->disableExport(n, megaCmdListener);
-    megaCmdListener->wait();
-    if (checkNoErrors(megaCmdListener->getError(), "disable export"))
+    else
     {
-        MegaNode *nexported = api->getNodeByHandle(megaCmdListener->getRequest()->getNodeHandle());
-        if (nexported)
-        {
-            char *nodepath = api->getNodePath(nexported);
-            OUTSTREAM << "Disabled export: " << nodepath << endl;
-            delete[] nodepath;
-            delete nexported;
-        }
-        else
-        {
-            setCurrentThreadOutCode(MCMD_NOTFOUND);
-            LOG_err << "Exported node not found!";
-        }
+        LOG_verbose << (disable ? "Disabled " : "Added ") << nodes.size() << " exports";
     }
-
-    delete megaCmdListener;
 }
 
 std::pair<bool/*pending*/, bool /*verified*/> MegaCmdExecuter::isSharePendingAndVerified(MegaNode* n, const char *email) const
@@ -3915,6 +5402,184 @@ long long MegaCmdExecuter::getVersionsSize(MegaNode *n)
     return toret;
 }
 
+constexpr size_t MAX_FOLDER_INFO_REQUESTS_IN_FLIGHT = 32;
+
+std::vector<FolderInfoCache::Counts> MegaCmdExecuter::getFolderInfo(const std::vector<MegaNode*>& nodes, bool useCache, bool withVersions)
+{
+    std::vector<FolderInfoCache::Counts> counts(nodes.size());
+    const auto generation = mFolderInfoCache.getGeneration();
+
+    std::deque<std::pair<size_t, std::unique_ptr<MegaCmdListener>>> inFlight;
+    auto waitForOldest = [&]()
+    {
+        auto [index, megaCmdListener] = std::move(inFlight.front());
+        inFlight.pop_front();
+
+        megaCmdListener->wait();
+        MegaFolderInfo* mfi = megaCmdListener->getRequest()->getMegaFolderInfo();
+        if (megaCmdListener->getError()->getErrorCode() != MegaError::API_OK || !mfi)
+        {
+            LOG_warn << "Failed to get folder info for " << nodes[index]->getName() << ": calculating its size";
+            counts[index].mSize = api->getSize(nodes[index]);
+            counts[index].mSizeWithVersions = withVersions ? getVersionsSize(nodes[index]) : counts[index].mSize;
+            return;
+        }
+
+        counts[index].mFiles = mfi->getNumFiles();
+        counts[index].mFolders = mfi->getNumFolders();
+        counts[index].mSize = mfi->getCurrentSize();
+        counts[index].mSizeWithVersions = mfi->getCurrentSize() + mfi->getVersionsSize();
+        if (useCache)
+        {
+            mFolderInfoCache.set(nodes[index]->getHandle(), counts[index], generation);
+        }
+    };
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        if (!nodes[i])
+        {
+            continue;
+        }
+
+        if (nodes[i]->getType() == MegaNode::TYPE_FILE)
+        {
+            counts[i].mFiles = 1;
+            counts[i].mSize = nodes[i]->getSize();
+            counts[i].mSizeWithVersions = withVersions ? getVersionsSize(nodes[i]) : counts[i].mSize;
+            continue;
+        }
+
+        if (auto cached = (useCache ? mFolderInfoCache.get(nodes[i]->getHandle()) : std::nullopt))
+        {
+            counts[i] = *cached;
+            continue;
+        }
+
+        if (inFlight.size() >= MAX_FOLDER_INFO_REQUESTS_IN_FLIGHT)
+        {
+            waitForOldest();
+        }
+
+        auto megaCmdListener = std::make_unique<MegaCmdListener>(nullptr);
+        api->getFolderInfo(nodes[i], megaCmdListener.get());
+        inFlight.emplace_back(i, std::move(megaCmdListener));
+    }
+
+    while (!inFlight.empty())
+    {
+        waitForOldest();
+    }
+    return counts;
+}
+
+StorageReport MegaCmdExecuter::analyzeStorage(MegaNode& folder, unsigned threads, long long totalBytes, int clientID)
+{
+    const int64_t now = static_cast<int64_t>(time(nullptr));
+
+    std::mutex pendingMutex;
+    std::condition_variable pendingCV;
+    std::deque<std::unique_ptr<MegaNode>> pending;
+    pending.emplace_back(folder.copy());
+    unsigned busy = 0; // walkers with a folder in hand, which may add more
+    long long analyzedBytes = 0;
+    auto lastProgress = std::chrono::steady_clock::now();
+
+    auto walk = [&](StorageReport& report)
+    {
+        while (true)
+        {
+            std::unique_ptr<MegaNode> parent;
+            {
+                std::unique_lock<std::mutex> lock(pendingMutex);
+                pendingCV.wait(lock, [&pending, &busy]() { return !pending.empty() || !busy; });
+                if (pending.empty())
+                {
+                    return; // nobody can add more
+                }
+                parent = std::move(pending.front());
+                pending.pop_front();
+                busy++;
+            }
+
+            std::vector<std::unique_ptr<MegaNode>> subfolders;
+            long long bytes = 0;
+            std::unique_ptr<MegaNodeList> children(api->getChildren(parent.get()));
+            for (int i = 0; children && i < children->size(); i++)
+            {
+                MegaNode *child = children->get(i);
+                if (child->getType() != MegaNode::TYPE_FILE)
+                {
+                    report.addFolder(child->getHandle(), parent->getHandle());
+                    subfolders.emplace_back(child->copy());
+                    continue;
+                }
+
+                long long versions = 0;
+                long long versionsSize = 0;
+                if (api->hasVersions(child))
+                {
+                    std::unique_ptr<MegaNodeList> versionNodes(api->getVersions(child));
+                    for (int j = 0; versionNodes && j < versionNodes->size(); j++)
+                    {
+                        if (versionNodes->get(j)->getHandle() != child->getHandle())
+                        {
+                            versions++;
+                            versionsSize += versionNodes->get(j)->getSize();
+                        }
+                    }
+                }
+                report.addFile(parent->getHandle(), child->getSize(), child->getModificationTime(), versions, versionsSize);
+                bytes += child->getSize();
+            }
+
+            std::optional<long long> progress;
+            {
+                std::lock_guard<std::mutex> g(pendingMutex);
+                for (auto& subfolder : subfolders)
+                {
+                    pending.push_back(std::move(subfolder));
+                }
+                busy--;
+
+                analyzedBytes += bytes;
+                if (std::chrono::steady_clock::now() - lastProgress >= std::chrono::milliseconds(500))
+                {
+                    lastProgress = std::chrono::steady_clock::now();
+                    progress = analyzedBytes;
+                }
+            }
+            pendingCV.notify_all();
+
+            if (progress && clientID >= 0)
+            {
+                informProgressUpdate(*progress, totalBytes, clientID, "Analyzing");
+            }
+        }
+    };
+
+    // Each walker collects its own report, so that they don't need to synchronize but to take folders
+    std::vector<StorageReport> reports(std::max(1u, threads), StorageReport(now));
+    std::vector<std::thread> walkers;
+    for (size_t i = 1; i < reports.size(); i++)
+    {
+        walkers.emplace_back(walk, std::ref(reports[i]));
+    }
+    walk(reports[0]);
+
+    for (size_t i = 0; i < walkers.size(); i++)
+    {
+        walkers[i].join();
+        reports[0].merge(reports[i + 1]);
+    }
+
+    if (clientID >= 0)
+    {
+        informProgressUpdate(PROGRESS_COMPLETE, totalBytes, clientID, "Analyzing");
+    }
+    return std::move(reports[0]);
+}
+
 vector<string> MegaCmdExecuter::listpaths(bool usepcre, string askedPath, bool discardFiles)
 {
     vector<string> paths;
@@ -5929,6 +7594,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
 
             bool force = getFlag(clflags, "f");
             bool none = false;
+            MutationBatch deletions(MAX_MUTATIONS_IN_FLIGHT);
 
             for (unsigned int i = 1; i < words.size(); i++)
             {
@@ -5946,7 +7612,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                     {
                         assert(node);
 
-                        int confirmationCode = deleteNode(node, api, getFlag(clflags, "r"), force);
+                        int confirmationCode = deleteNode(node, api, getFlag(clflags, "r"), force, deletions);
                         if (confirmationCode == MCMDCONFIRM_ALL)
                         {
                             force = true;
@@ -5967,7 +7633,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                     }
                     else
                     {
-                        int confirmationCode = deleteNode(nodeToDelete, api, getFlag(clflags, "r"), force);
+                        int confirmationCode = deleteNode(nodeToDelete, api, getFlag(clflags, "r"), force, deletions);
                         if (confirmationCode == MCMDCONFIRM_ALL)
                         {
                             force = true;
@@ -5979,6 +7645,8 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                     }
                 }
             }
+
+            runMutations(deletions, "delete node", "Removing", getintOption(cloptions, "clientID", -1));
         }
         else
         {
@@ -6008,6 +7676,25 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                 return;
             }
 
+            // Moving into a folder takes a single request per node, so those moves are batched
+            std::unique_ptr<MegaNode> destinyFolder = nodebypath(destiny.c_str());
+            if (destinyFolder && destinyFolder->getType() == MegaNode::TYPE_FILE)
+            {
+                destinyFolder.reset();
+            }
+            MutationBatch moves(MAX_MUTATIONS_IN_FLIGHT);
+            auto move = [&](const std::unique_ptr<MegaNode>& n)
+            {
+                if (destinyFolder && destinyFolder->getHandle() != n->getHandle())
+                {
+                    addNodeMove(moves, n, *destinyFolder);
+                }
+                else
+                {
+                    moveToDestination(n, destiny);
+                }
+            };
+
             for (unsigned int i=1;i<(words.size()-1);i++)
             {
                 string source = words[i];
@@ -6035,7 +7722,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                         for (const auto& node : nodesToList)
                         {
                             assert(node);
-                            moveToDestination(node, destiny);
+                            move(node);
                         }
                     }
                 }
@@ -6044,7 +7731,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                     std::unique_ptr<MegaNode> n = nodebypath(source.c_str());
                     if (n)
                     {
-                        moveToDestination(n, destiny);
+                        move(n);
                     }
                     else
                     {
@@ -6054,6 +7741,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                 }
             }
 
+            runMutations(moves, "move node", "Moving", getintOption(cloptions, "clientID", -1));
         }
         else
         {
@@ -6157,9 +7845,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
         PATHSIZE = max(0, PATHSIZE);
 
         long long totalSize = 0;
-        long long currentSize = 0;
         long long totalVersionsSize = 0;
-        string dpath;
         if (words.size() == 1)
         {
             words.push_back(".");
@@ -6167,42 +7853,57 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
 
         bool humanreadable = getFlag(clflags, "h");
         bool show_versions_size = getFlag(clflags, "versions");
+        bool useCache = !getFlag(clflags, "no-cache");
         bool firstone = true;
 
+        // The sizes of all the nodes matching a path are obtained at once
+        auto printSizes = [&](const string& givenPath, const std::vector<MegaNode*>& nodes)
+        {
+            const auto counts = getFolderInfo(nodes, useCache, show_versions_size);
+            for (size_t j = 0; j < nodes.size(); j++)
+            {
+                totalSize += counts[j].mSize;
+                totalVersionsSize += counts[j].mSizeWithVersions;
+
+                string dpath = getDisplayPath(givenPath, nodes[j]);
+                if (dpath.empty())
+                {
+                    continue;
+                }
+
+                if (firstone)//print header
+                {
+                    OUTSTREAM << getFixLengthString("FILENAME", PATHSIZE) << getFixLengthString("SIZE", 12, ' ', true);
+                    if (show_versions_size)
+                    {
+                        OUTSTREAM << getFixLengthString("S.WITH VERS", 12, ' ', true);
+                    }
+                    OUTSTREAM << endl;
+                    firstone = false;
+                }
+
+                OUTSTREAM << getFixLengthString(dpath+":",PATHSIZE) << getFixLengthString(sizeToText(counts[j].mSize, true, humanreadable), 12, ' ', true);
+                if (show_versions_size)
+                {
+                    OUTSTREAM << getFixLengthString(sizeToText(counts[j].mSizeWithVersions, true, humanreadable), 12, ' ', true);
+                }
+                OUTSTREAM << endl;
+            }
+        };
+
         for (unsigned int i = 1; i < words.size(); i++)
         {
             unescapeifRequired(words[i]);
             if (isRegExp(words[i]))
             {
                 vector<std::unique_ptr<MegaNode>> nodesToList = nodesbypath(words[i].c_str(), getFlag(clflags,"use-pcre"));
+                std::vector<MegaNode*> nodePtrs;
                 for (const auto& n : nodesToList)
                 {
                     assert(n);
-
-                    if (firstone)//print header
-                    {
-                        OUTSTREAM << getFixLengthString("FILENAME", PATHSIZE) << getFixLengthString("SIZE", 12, ' ', true);
-                        if (show_versions_size)
-                        {
-                            OUTSTREAM << getFixLengthString("S.WITH VERS", 12, ' ', true);;
-                        }
-                        OUTSTREAM << endl;
-                        firstone = false;
-                    }
-                    currentSize = api->getSize(n.get());
-                    totalSize += currentSize;
-
-                    dpath = getDisplayPath(words[i], n.get());
-                    OUTSTREAM << getFixLengthString(dpath+":",PATHSIZE) << getFixLengthString(sizeToText(currentSize, true, humanreadable), 12, ' ', true);
-                    if (show_versions_size)
-                    {
-                        long long sizeWithVersions = getVersionsSize(n.get());
-                        OUTSTREAM << getFixLengthString(sizeToText(sizeWithVersions, true, humanreadable), 12, ' ', true);
-                        totalVersionsSize += sizeWithVersions;
-                    }
-
-                    OUTSTREAM << endl;
+                    nodePtrs.push_back(n.get());
                 }
+                printSizes(words[i], nodePtrs);
             }
             else
             {
@@ -6213,51 +7914,132 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                     LOG_err << words[i] << ": No such file or directory";
                     return;
                 }
+                printSizes(words[i], {n.get()});
+            }
+        }
 
-                currentSize = api->getSize(n.get());
-                totalSize += currentSize;
-                dpath = getDisplayPath(words[i], n.get());
-                if (dpath.size())
-                {
-                    if (firstone)//print header
-                    {
-                        OUTSTREAM << getFixLengthString("FILENAME",PATHSIZE) << getFixLengthString("SIZE", 12, ' ', true);
-                        if (show_versions_size)
-                        {
-                            OUTSTREAM << getFixLengthString("S.WITH VERS", 12, ' ', true);;
-                        }
-                        OUTSTREAM << endl;
-                        firstone = false;
-                    }
+        if (!firstone)
+        {
+            for (int i = 0; i < PATHSIZE+12 +(show_versions_size?12:0) ; i++)
+            {
+                OUTSTREAM << "-";
+            }
+            OUTSTREAM << endl;
 
-                    OUTSTREAM << getFixLengthString(dpath+":",PATHSIZE) << getFixLengthString(sizeToText(currentSize, true, humanreadable), 12, ' ', true);
-                    if (show_versions_size)
-                    {
-                        long long sizeWithVersions = getVersionsSize(n.get());
-                        OUTSTREAM << getFixLengthString(sizeToText(sizeWithVersions, true, humanreadable), 12, ' ', true);
-                        totalVersionsSize += sizeWithVersions;
-                    }
-                    OUTSTREAM << endl;
+            OUTSTREAM << getFixLengthString("Total storage used:",PATHSIZE) << getFixLengthString(sizeToText(totalSize, true, humanreadable), 12, ' ', true);
+            //OUTSTREAM << "Total storage used: " << setw(22) << sizeToText(totalSize, true, humanreadable);
+            if (show_versions_size)
+            {
+                OUTSTREAM << getFixLengthString(sizeToText(totalVersionsSize, true, humanreadable), 12, ' ', true);
+            }
+            OUTSTREAM << endl;
+        }
+        return;
+    }
+    else if (words[0] == "storage-report")
+    {
+        if (!api->isFilesystemAvailable())
+        {
+            setCurrentThreadOutCode(MCMD_NOTLOGGEDIN);
+            LOG_err << "Not logged in.";
+            return;
+        }
+
+        const int top = getintOption(cloptions, "top", 10);
+        const int threads = getintOption(cloptions, "threads", 4);
+        if (words.size() > 2 || top < 1 || threads < 1 || threads > 32)
+        {
+            setCurrentThreadOutCode(MCMD_EARGS);
+            LOG_err << "      " << getUsageStr("storage-report");
+            return;
+        }
+
+        string givenPath = words.size() > 1 ? words[1] : ".";
+        unescapeifRequired(givenPath);
+        std::unique_ptr<MegaNode> n = nodebypath(givenPath.c_str());
+        if (!n)
+        {
+            setCurrentThreadOutCode(MCMD_NOTFOUND);
+            LOG_err << givenPath << ": No such file or directory";
+            return;
+        }
+        if (n->getType() == MegaNode::TYPE_FILE)
+        {
+            setCurrentThreadOutCode(MCMD_INVALIDTYPE);
+            LOG_err << givenPath << ": Not a folder";
+            return;
+        }
+
+        auto getPath = [this](MegaHandle h)
+        {
+            std::unique_ptr<MegaNode> folder(api->getNodeByHandle(h));
+            std::unique_ptr<char[]> path(folder ? api->getNodePath(folder.get()) : nullptr);
+            return path ? string(path.get()) : "H:" + handleToBase64(h);
+        };
+        const string analyzedPath = getPath(n->getHandle());
+
+        // The total for the progress comes from the same (cached) folder info as du
+        const long long totalBytes = getFolderInfo({n.get()})[0].mSize;
+        const StorageReport report = analyzeStorage(*n, static_cast<unsigned>(threads), totalBytes, getintOption(cloptions, "clientID", -1));
+        const StorageReport::Summary summary = report.getSummary(static_cast<size_t>(top), getPath, getFlag(clflags, "recursive"));
+
+        const bool humanreadable = getFlag(clflags, "h");
+        const StorageReport::Totals& totals = summary.mTotals;
+        OUTSTREAM << "Storage used by " << analyzedPath << ": " << sizeToText(totals.mSize, false, humanreadable)
+                  << " in " << totals.mFiles << " file(s) and " << totals.mFolders << " folder(s)" << endl;
+        OUTSTREAM << "Previous versions: " << sizeToText(totals.mVersionsSize, false, humanreadable) << " in " << totals.mVersions << " version(s)";
+        if (totals.mSize + totals.mVersionsSize > 0)
+        {
+            OUTSTREAM << " (" << percentageToText(100.0f * static_cast<float>(totals.mVersionsSize) / static_cast<float>(totals.mSize + totals.mVersionsSize)) << " of the total)";
+        }
+        OUTSTREAM << endl;
 
-                }
+        auto printFolders = [&](const string& title, const std::vector<StorageReport::FolderEntry>& folders)
+        {
+            OUTSTREAM << endl << title << ":" << endl;
+            if (folders.empty())
+            {
+                OUTSTREAM << "  (none)" << endl;
+                return;
             }
-        }
 
-        if (!firstone)
+            OUTSTREAM << getFixLengthString("FILES", 10, ' ', true) << getFixLengthString("SIZE", 12, ' ', true)
+                      << getFixLengthString("VERSIONS", 10, ' ', true) << getFixLengthString("S.VERSIONS", 12, ' ', true) << "  PATH" << endl;
+            for (const auto& folder : folders)
+            {
+                const auto& t = folder.mTotals;
+                OUTSTREAM << getFixLengthString(SSTR(t.mFiles), 10, ' ', true) << getFixLengthString(sizeToText(t.mSize, true, humanreadable), 12, ' ', true)
+                          << getFixLengthString(SSTR(t.mVersions), 10, ' ', true) << getFixLengthString(sizeToText(t.mVersionsSize, true, humanreadable), 12, ' ', true)
+                          << "  " << folder.mPath << endl;
+            }
+        };
+        printFolders("Folders with the most space in previous versions", summary.mTopByVersionsSize);
+        printFolders("Folders with the most files", summary.mTopByFiles);
+        printFolders("Folders with the biggest files", summary.mTopBySize);
+
+        auto printHistogram = [&](const string& title, const std::vector<StorageReport::Bucket>& buckets)
         {
-            for (int i = 0; i < PATHSIZE+12 +(show_versions_size?12:0) ; i++)
+            OUTSTREAM << endl << title << ":" << endl;
+            OUTSTREAM << getFixLengthString("RANGE", 18) << getFixLengthString("FILES", 10, ' ', true) << getFixLengthString("SIZE", 12, ' ', true) << endl;
+            for (const auto& bucket : buckets)
             {
-                OUTSTREAM << "-";
+                OUTSTREAM << getFixLengthString(bucket.mLabel, 18) << getFixLengthString(SSTR(bucket.mFiles), 10, ' ', true)
+                          << getFixLengthString(sizeToText(bucket.mSize, true, humanreadable), 12, ' ', true) << endl;
             }
-            OUTSTREAM << endl;
+        };
+        printHistogram("File sizes", summary.mSizeHistogram);
+        printHistogram("File ages (since last modification)", summary.mAgeHistogram);
 
-            OUTSTREAM << getFixLengthString("Total storage used:",PATHSIZE) << getFixLengthString(sizeToText(totalSize, true, humanreadable), 12, ' ', true);
-            //OUTSTREAM << "Total storage used: " << setw(22) << sizeToText(totalSize, true, humanreadable);
-            if (show_versions_size)
+        const string reportFile = getOption(cloptions, "report", "");
+        if (!reportFile.empty())
+        {
+            if (!StorageReport::write(fs::u8path(reportFile), analyzedPath, summary, static_cast<int64_t>(time(nullptr))))
             {
-                OUTSTREAM << getFixLengthString(sizeToText(totalVersionsSize, true, humanreadable), 12, ' ', true);
+                setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+                LOG_err << "Could not write the report to " << reportFile;
+                return;
             }
-            OUTSTREAM << endl;
+            OUTSTREAM << endl << "Report written to " << reportFile << endl;
         }
         return;
     }
@@ -6422,6 +8204,8 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
     }
     else if (words[0] == "get")
     {
+        std::optional<std::chrono::milliseconds> planningTime;
+        std::chrono::steady_clock::time_point transfersStart;
         bool background = getFlag(clflags,"q");
 
         int clientID = getintOption(cloptions, "clientID", -1);
@@ -6440,6 +8224,14 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
 
             if (isPublicLink(words[1]))
             {
+                if (getFlag(clflags, "incremental"))
+                {
+                    // The nodes of links are not in the account, to compare them with the local ones
+                    setCurrentThreadOutCode(MCMD_EARGS);
+                    LOG_err << "--incremental is not supported for links";
+                    return;
+                }
+
                 string publicLink = words[1];
                 if (!decryptLinkIfEncrypted(api, publicLink, cloptions))
                 {
@@ -6553,90 +8345,62 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                         }
                     }
 
-                    MegaApi* apiFolder = getFreeApiFolder();
+                    MegaApi* apiFolder = getApiFolderForLink(*api, publicLink);
                     if (!apiFolder)
                     {
-                        setCurrentThreadOutCode(MCMD_NOTFOUND);
-                        LOG_err << "No available Api folder. Use configure to increase exported_folders_sdks";
                         return;
                     }
-                    char *accountAuth = api->getAccountAuth();
-                    apiFolder->setAccountAuth(accountAuth);
-                    delete []accountAuth;
 
-                    MegaCmdListener *megaCmdListener = new MegaCmdListener(apiFolder, NULL);
-                    apiFolder->loginToFolder(publicLink.c_str(), megaCmdListener);
-                    megaCmdListener->wait();
-                    if (checkNoErrors(megaCmdListener->getError(), "login to folder"))
+                    MegaNode *nodeToDownload = NULL;
+                    bool usedRoot = false;
+                    string shandle = getPublicLinkHandle(publicLink);
+                    if (shandle.size())
                     {
-                        MegaCmdListener *megaCmdListener2 = new MegaCmdListener(apiFolder, NULL);
-                        apiFolder->fetchNodes(megaCmdListener2);
-                        megaCmdListener2->wait();
-                        if (checkNoErrors(megaCmdListener2->getError(), "access folder link " + publicLink))
-                        {
-                            MegaNode *nodeToDownload = NULL;
-                            bool usedRoot = false;
-                            string shandle = getPublicLinkHandle(publicLink);
-                            if (shandle.size())
-                            {
-                                handle thehandle = apiFolder->base64ToHandle(shandle.c_str());
-                                nodeToDownload = apiFolder->getNodeByHandle(thehandle);
-                            }
-                            else
-                            {
-                                nodeToDownload = apiFolder->getRootNode();
-                                usedRoot = true;
-                            }
+                        handle thehandle = apiFolder->base64ToHandle(shandle.c_str());
+                        nodeToDownload = apiFolder->getNodeByHandle(thehandle);
+                    }
+                    else
+                    {
+                        nodeToDownload = apiFolder->getRootNode();
+                        usedRoot = true;
+                    }
 
-                            if (nodeToDownload)
-                            {
-                                if (destinyIsFolder && getFlag(clflags,"m"))
-                                {
-                                    while( (path.find_last_of("/") == path.size()-1) || (path.find_last_of("\\") == path.size()-1))
-                                    {
-                                        path=path.substr(0,path.size()-1);
-                                    }
-                                }
-                                MegaNode *authorizedNode = apiFolder->authorizeNode(nodeToDownload);
-                                if (authorizedNode != NULL)
-                                {
-                                    downloadNode(words[1], path, api, authorizedNode, background, ignorequotawarn, clientID, megaCmdMultiTransferListener);
-                                    delete authorizedNode;
-                                }
-                                else
-                                {
-                                    LOG_debug << "Node couldn't be authorized: " << publicLink << ". Downloading as non-loged user";
-                                    downloadNode(words[1], path, apiFolder, nodeToDownload, background, ignorequotawarn, clientID, megaCmdMultiTransferListener);
-                                }
-                                delete nodeToDownload;
-                            }
-                            else
+                    if (nodeToDownload)
+                    {
+                        if (destinyIsFolder && getFlag(clflags,"m"))
+                        {
+                            while( (path.find_last_of("/") == path.size()-1) || (path.find_last_of("\\") == path.size()-1))
                             {
-                                setCurrentThreadOutCode(MCMD_INVALIDSTATE);
-                                if (usedRoot)
-                                {
-                                    LOG_err << "Couldn't get root folder for folder link";
-                                }
-                                else
-                                {
-                                    LOG_err << "Failed to get node corresponding to handle within public link " << shandle;
-                                }
+                                path=path.substr(0,path.size()-1);
                             }
                         }
-                        delete megaCmdListener2;
-
+                        MegaNode *authorizedNode = apiFolder->authorizeNode(nodeToDownload);
+                        if (authorizedNode != NULL)
                         {
-                            std::unique_ptr<MegaCmdListener> megaCmdListener(new MegaCmdListener(apiFolder));
-                            apiFolder->logout(false, megaCmdListener.get());
-                            megaCmdListener->wait();
-                            if (megaCmdListener->getError()->getErrorCode() != MegaError::API_OK)
-                            {
-                                LOG_err << "Couldn't logout from apiFolder";
-                            }
+                            downloadNode(words[1], path, api, authorizedNode, background, ignorequotawarn, clientID, megaCmdMultiTransferListener);
+                            delete authorizedNode;
+                        }
+                        else
+                        {
+                            LOG_debug << "Node couldn't be authorized: " << publicLink << ". Downloading as non-loged user";
+                            downloadNode(words[1], path, apiFolder, nodeToDownload, background, ignorequotawarn, clientID, megaCmdMultiTransferListener);
                         }
+                        delete nodeToDownload;
                     }
-                    delete megaCmdListener;
-                    freeApiFolder(apiFolder);
+                    else
+                    {
+                        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+                        if (usedRoot)
+                        {
+                            LOG_err << "Couldn't get root folder for folder link";
+                        }
+                        else
+                        {
+                            LOG_err << "Failed to get node corresponding to handle within public link " << shandle;
+                        }
+                    }
+
+                    freeApiFolder(apiFolder, publicLink, true);
                 }
                 else
                 {
@@ -6701,17 +8465,25 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                         }
                     }
 
-                    for (const auto& n : nodesToGet)
-                    {
-                        assert(n);
-                        downloadNode(words[1], path, api, n.get(), background, ignorequotawarn, clientID, megaCmdMultiTransferListener);
-                    }
-
                     if (nodesToGet.empty())
                     {
                         setCurrentThreadOutCode(MCMD_NOTFOUND);
                         LOG_err << "Couldn't find " << words[1];
                     }
+                    else if (getFlag(clflags, "incremental"))
+                    {
+                        std::vector<MegaNode*> nodePtrs;
+                        for (const auto &node : nodesToGet)
+                        {
+                            nodePtrs.push_back(node.get());
+                        }
+                        downloadNodesIncrementally(nodePtrs, path, ignorequotawarn, megaCmdMultiTransferListener);
+                    }
+                    else
+                    {
+                        planningTime = downloadNodes(words[1], path, api, nodesToGet, ignorequotawarn, megaCmdMultiTransferListener);
+                        transfersStart = std::chrono::steady_clock::now();
+                    }
 
                 }
                 else //not regexp
@@ -6786,7 +8558,14 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                                 path=path.substr(0,path.size()-1);
                             }
                         }
-                        downloadNode(words[1], path, api, n.get(), background, ignorequotawarn, clientID, megaCmdMultiTransferListener);
+                        if (getFlag(clflags, "incremental"))
+                        {
+                            downloadNodesIncrementally({n.get()}, path, ignorequotawarn, megaCmdMultiTransferListener);
+                        }
+                        else
+                        {
+                            downloadNode(words[1], path, api, n.get(), background, ignorequotawarn, clientID, megaCmdMultiTransferListener);
+                        }
                     }
                     else
                     {
@@ -6810,6 +8589,13 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                 {
                     informProgressUpdate(PROGRESS_COMPLETE, megaCmdMultiTransferListener->getTotalbytes(), clientID);
                 }
+
+                if (planningTime)
+                {
+                    auto transfersTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - transfersStart);
+                    LOG_verbose << "Download planning took " << planningTime->count() << " ms. Transfers took "
+                                << transfersTime.count() << " ms";
+                }
             }
 
         }
@@ -6998,6 +8784,8 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
 
         bool background = getFlag(clflags,"q");
         bool autocreate = getFlag(clflags, "c");
+        const bool incremental = getFlag(clflags, "incremental");
+        const unsigned scanThreads = static_cast<unsigned>(max(0, getintOption(cloptions, "scan-threads", 0)));
 
         int clientID = getintOption(cloptions, "clientID", -1);
 
@@ -7008,6 +8796,13 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             return;
         }
 
+        if (incremental && scanThreads)
+        {
+            setCurrentThreadOutCode(MCMD_EARGS);
+            LOG_err << "--incremental and --scan-threads cannot be used together";
+            return;
+        }
+
         string targetuser;
         string newname = "";
 
@@ -7065,6 +8860,15 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             }
         });
 
+        IncrementalTransferStats incrementalStats;
+        ScopeGuard incrementalStatsGuard([&]
+        {
+            if (incremental)
+            {
+                informIncrementalTransferStats(incrementalStats);
+            }
+        });
+
         if (n->getType() == MegaNode::TYPE_FILE)
         {
             bool replacing = words.size() == 3 && !IsFolder(words[1]);
@@ -7091,6 +8895,11 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                 return;
             }
 #endif
+            if (incremental && isLocalFileUnchanged(fs::u8path(localPath), *n, incrementalStats))
+            {
+                incrementalStats.mSkipped++;
+                return;
+            }
             uploadNode(*clflags, *cloptions, localPath, api, pn.get(), n->getName(), mayCreateForegroundListener());
             return;
         }
@@ -7112,8 +8921,226 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
 #endif
             for (auto &path : paths)
             {
-                uploadNode(*clflags, *cloptions, path, api, n.get(), newname, mayCreateForegroundListener());
+                if (incremental)
+                {
+                    if (!pathExists(path))
+                    {
+                        setCurrentThreadOutCode(MCMD_NOTFOUND);
+                        LOG_err << "Unable to open local path: " << path;
+                        continue;
+                    }
+
+                    const fs::path localPath = fs::u8path(removeTrailingSeparators(path));
+                    const std::string name = newname.size() ? newname : localPath.filename().u8string();
+                    uploadIncrementally(localPath, *n, name, getChildrenByName(*n), incrementalStats, mayCreateForegroundListener());
+                }
+                else if (scanThreads && IsFolder(path))
+                {
+                    uploadFolderWithParallelScan(*clflags, *cloptions, path, api, n.get(), newname, scanThreads, mayCreateForegroundListener());
+                }
+                else
+                {
+                    uploadNode(*clflags, *cloptions, path, api, n.get(), newname, mayCreateForegroundListener());
+                }
+            }
+        }
+        return;
+    }
+    else if (words[0] == "manifest")
+    {
+        if (!api->isFilesystemAvailable())
+        {
+            setCurrentThreadOutCode(MCMD_NOTLOGGEDIN);
+            LOG_err << "Not logged in.";
+            return;
+        }
+
+        bool background = getFlag(clflags, "q");
+        int clientID = getintOption(cloptions, "clientID", -1);
+
+        if (getFlag(clflags, "d"))
+        {
+            if (words.size() != 2)
+            {
+                setCurrentThreadOutCode(MCMD_EARGS);
+                LOG_err << "      " << getUsageStr("manifest");
+                return;
+            }
+
+            if (getRunningTransferManifest(words[1]))
+            {
+                setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+                LOG_err << "Manifest " << words[1] << " has transfers in progress";
+                return;
+            }
+
+            std::error_code ec;
+            if (!fs::remove(getTransferManifestPath(words[1]), ec))
+            {
+                setCurrentThreadOutCode(MCMD_NOTFOUND);
+                LOG_err << "Manifest not found: " << words[1];
+                return;
+            }
+            OUTSTREAM << "Manifest " << words[1] << " discarded" << endl;
+        }
+        else if (getFlag(clflags, "resume"))
+        {
+            std::vector<std::string> ids(words.begin() + 1, words.end());
+            if (ids.empty())
+            {
+                // All the ones that have not finished
+                std::error_code ec;
+                for (const auto &dirEntry : fs::directory_iterator(ConfigurationManager::getConfigFolderSubdir("manifests"), ec))
+                {
+                    if (dirEntry.path().extension() == ".journal")
+                    {
+                        ids.push_back(dirEntry.path().stem().u8string());
+                    }
+                }
+            }
+
+            for (const auto &id : ids)
+            {
+                if (getRunningTransferManifest(id))
+                {
+                    if (words.size() > 1)
+                    {
+                        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+                        LOG_err << "Manifest " << id << " has transfers in progress";
+                    }
+                    continue;
+                }
+
+                std::shared_ptr<TransferManifest> manifest = TransferManifest::load(getTransferManifestPath(id));
+                if (!manifest)
+                {
+                    setCurrentThreadOutCode(MCMD_NOTFOUND);
+                    LOG_err << "Manifest not found: " << id;
+                    continue;
+                }
+
+                if (manifest->getUnfinishedItems().empty())
+                {
+                    if (words.size() > 1)
+                    {
+                        OUTSTREAM << "Manifest " << id << " has no pending transfers" << endl;
+                    }
+                    continue;
+                }
+
+                runTransferManifest(id, manifest, background, clientID);
+            }
+        }
+        else if (words.size() == 1)
+        {
+            ColumnDisplayer cd(clflags, cloptions);
+            listTransferManifests(cd);
+        }
+        else if (words.size() == 2)
+        {
+            std::ifstream ifs(fs::u8path(words[1]));
+            if (!ifs.is_open())
+            {
+                setCurrentThreadOutCode(MCMD_NOTFOUND);
+                LOG_err << "Unable to open manifest file: " << words[1];
+                return;
+            }
+
+            std::vector<TransferManifest::Item> items;
+            std::string line;
+            std::string error;
+            for (int lineNumber = 1; std::getline(ifs, line); ++lineNumber)
+            {
+                if (auto item = TransferManifest::parseManifestLine(line, error))
+                {
+                    items.push_back(std::move(*item));
+                }
+                else if (!error.empty())
+                {
+                    setCurrentThreadOutCode(MCMD_EARGS);
+                    LOG_err << "Invalid line " << lineNumber << " in " << words[1] << ": " << error;
+                    return;
+                }
+            }
+
+            if (items.empty())
+            {
+                setCurrentThreadOutCode(MCMD_EARGS);
+                LOG_err << "No transfers found in " << words[1];
+                return;
+            }
+
+            // The journal keeps full paths, so that resuming it from another working folder (local or remote) does the same
+            const fs::path localFolder = fs::u8path(getLPWD());
+            auto getFullLocalPath = [&localFolder](const string& path)
+            {
+                const fs::path p = fs::u8path(path);
+                return p.is_absolute() ? path : (localFolder / p).u8string();
+            };
+
+            // Remote paths are resolved as any other one, and the path of the node found is kept.
+            // Upload destinations may not exist yet, as long as their parent does
+            auto getFullRemotePath = [this](const string& path, bool mayBeNew) -> std::optional<string>
+            {
+                string newname;
+                std::unique_ptr<MegaNode> node = nodebypath(path.c_str(), nullptr, mayBeNew ? &newname : nullptr);
+                std::unique_ptr<char[]> nodePath(node ? api->getNodePath(node.get()) : nullptr);
+                if (!nodePath)
+                {
+                    return {};
+                }
+
+                string fullPath = nodePath.get();
+                if (newname.size())
+                {
+                    fullPath += (fullPath.size() && fullPath.back() == '/' ? "" : "/") + newname;
+                }
+                return fullPath;
+            };
+
+            for (auto& item : items)
+            {
+                const bool isDownload = item.mDirection == TransferManifest::Direction::DOWNLOAD;
+                string& localPath = isDownload ? item.mDestination : item.mSource;
+                string& remotePath = isDownload ? item.mSource : item.mDestination;
+                localPath = getFullLocalPath(localPath);
+
+                auto fullRemotePath = getFullRemotePath(remotePath, !isDownload);
+                if (!fullRemotePath)
+                {
+                    setCurrentThreadOutCode(MCMD_NOTFOUND);
+                    LOG_err << "Couldn't find " << remotePath << " in " << words[1];
+                    return;
+                }
+                remotePath = std::move(*fullRemotePath);
+            }
+
+            // Ids are increasing numbers, so that they are easy to type. The next one is only taken once its journal is written
+            std::unique_lock<std::mutex> idsLock(mManifestIdsMutex);
+            unsigned long long nextId = 1;
+            std::error_code ec;
+            for (const auto &dirEntry : fs::directory_iterator(ConfigurationManager::getConfigFolderSubdir("manifests"), ec))
+            {
+                nextId = std::max(nextId, std::strtoull(dirEntry.path().stem().u8string().c_str(), nullptr, 10) + 1);
+            }
+            const std::string id = std::to_string(nextId);
+
+            std::shared_ptr<TransferManifest> manifest = TransferManifest::create(getTransferManifestPath(id), std::move(items));
+            idsLock.unlock();
+            if (!manifest)
+            {
+                setCurrentThreadOutCode(MCMD_EUNEXPECTED);
+                LOG_err << "Unable to write transfer manifest journal: " << getTransferManifestPath(id).u8string();
+                return;
             }
+
+            OUTSTREAM << "Manifest " << id << " created with " << manifest->getCounts().mPending << " transfers" << endl;
+            runTransferManifest(id, manifest, background, clientID);
+        }
+        else
+        {
+            setCurrentThreadOutCode(MCMD_EARGS);
+            LOG_err << "      " << getUsageStr("manifest");
         }
         return;
     }
@@ -7772,7 +9799,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             args.mAction = (excludeAdd ? SyncIgnore::Action::Add : SyncIgnore::Action::Remove);
 
             std::transform(words.begin() + 1, words.end(),
-                           std::inserter(args.mFilters, args.mFilters.end()),
+                           std::back_inserter(args.mFilters),
                            SyncIgnore::getFilterFromLegacyPattern);
 
             SyncIgnore::executeCommand(args);
@@ -7807,12 +9834,49 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
         bool enableSync = getFlag(clflags, "e") || getFlag(clflags, "r") || getFlag(clflags, "enable");
         bool deleteSync = getFlag(clflags, "delete") || getFlag(clflags, "d") || getFlag(clflags, "remove");
         bool showHandles = getFlag(clflags, "show-handles");
+        auto getSyncFolderInfo = [this, useCache = !getFlag(clflags, "no-cache")](const std::vector<MegaNode*>& folders)
+        {
+            return getFolderInfo(folders, useCache);
+        };
+
+        if (!onlyZeroOrOneOf(pauseSync, enableSync, deleteSync))
+        {
+            setCurrentThreadOutCode(MCMD_EARGS);
+            LOG_err << "Only one action (disable, enable, or remove) can be specified at a time";
+            LOG_err << "      " << getUsageStr("sync");
+            return;
+        }
+
+        if (getFlag(clflags, "stats"))
+        {
+            if (pauseSync || enableSync || deleteSync || words.size() > 2)
+            {
+                setCurrentThreadOutCode(MCMD_EARGS);
+                LOG_err << "      " << getUsageStr("sync");
+                return;
+            }
+
+            const bool humanReadable = !getFlag(clflags, "raw");
+            ColumnDisplayer cd(clflags, cloptions);
+            if (words.size() == 2)
+            {
+                auto sync = SyncCommand::getSync(*api, words[1]);
+                if (!sync)
+                {
+                    setCurrentThreadOutCode(MCMD_NOTFOUND);
+                    LOG_err << "Sync not found: " << words[1];
+                    return;
+                }
+                SyncCommand::printSyncStats(cd, *sync, humanReadable);
+            }
+            else
+            {
+                auto syncList = std::unique_ptr<MegaSyncList>(api->getSyncs());
+                assert(syncList);
+                SyncCommand::printSyncStatsList(cd, *syncList, humanReadable);
+            }
 
-        if (!onlyZeroOrOneOf(pauseSync, enableSync, deleteSync))
-        {
-            setCurrentThreadOutCode(MCMD_EARGS);
-            LOG_err << "Only one action (disable, enable, or remove) can be specified at a time";
-            LOG_err << "      " << getUsageStr("sync");
+            OUTSTREAM << cd.str();
             return;
         }
 
@@ -7864,31 +9928,31 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                     return;
                 }
 
-                auto syncIssues = mSyncIssuesManager.getSyncIssues();
+                auto syncIssues = mSyncIssuesManager.getSyncIssues(getFlag(clflags, "refresh"));
 
                 ColumnDisplayer cd(clflags, cloptions);
-                SyncCommand::printSync(*api, cd, showHandles, *sync, syncIssues);
+                SyncCommand::printSync(*api, cd, showHandles, *sync, syncIssues->mSyncIssues, getSyncFolderInfo);
 
                 OUTSTREAM << cd.str();
             }
         }
         else if (words.size() == 1) // show all syncs
         {
-            auto syncIssues = mSyncIssuesManager.getSyncIssues();
+            auto syncIssues = mSyncIssuesManager.getSyncIssues(getFlag(clflags, "refresh"));
             auto syncList = std::unique_ptr<MegaSyncList>(api->getSyncs());
             assert(syncList);
 
             ColumnDisplayer cd(clflags, cloptions);
-            SyncCommand::printSyncList(*api, cd, showHandles, *syncList, syncIssues);
+            SyncCommand::printSyncList(*api, cd, showHandles, *syncList, syncIssues->mSyncIssues, getSyncFolderInfo);
 
             OUTSTREAM << cd.str();
 
-            if (!syncIssues.empty())
+            if (!syncIssues->mSyncIssues.empty())
             {
                 OUTSTREAM << endl;
                 LOG_err << "You have sync issues. Use the \"" << getCommandPrefixBasedOnMode() << "sync-issues\" command to display them.";
             }
-            else if (SyncCommand::isAnySyncUploadDelayed(*api))
+            else if (SyncCommand::isAnySyncUploadDelayed(*api, globalTransferListener->getTransferIndex()))
             {
                 OUTSTREAM << endl;
                 OUTSTREAM << "Some of your \"Pending\" sync uploads are being delayed due to very frequent changes. They will be uploaded once the delay finishes. "
@@ -7930,16 +9994,18 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
         bool ignoreAddExclusion = getFlag(clflags, "add-exclusion");
         bool ignoreRemove = getFlag(clflags, "remove");
         bool ignoreRemoveExclusion = getFlag(clflags, "remove-exclusion");
+        bool ignoreTest = getFlag(clflags, "test");
 
-        if (!onlyZeroOrOneOf(ignoreShow, ignoreAdd, ignoreAddExclusion, ignoreRemove, ignoreRemoveExclusion))
+        if (!onlyZeroOrOneOf(ignoreShow, ignoreAdd, ignoreAddExclusion, ignoreRemove, ignoreRemoveExclusion, ignoreTest))
         {
             setCurrentThreadOutCode(MCMD_EARGS);
-            LOG_err << "Only one action (show, add, add-exclusion, remove, or remove-exclusion) can be specified at a time";
+            LOG_err << "Only one action (show, add, add-exclusion, remove, remove-exclusion or test) can be specified at a time";
             LOG_err << "      " << getUsageStr("sync-ignore");
             return;
         }
 
         SyncIgnore::Args args;
+        const string fromFile = getOption(cloptions, "from-file", "");
 
         args.mAction = SyncIgnore::Action::Show;
         if (ignoreAdd || ignoreAddExclusion)
@@ -7950,9 +10016,15 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
         {
             args.mAction = SyncIgnore::Action::Remove;
         }
+        else if (ignoreTest)
+        {
+            args.mAction = SyncIgnore::Action::Test;
+            args.mTestPathsFile = fs::u8path(fromFile);
+            args.mTestSummaryOnly = getFlag(clflags, "summary");
+        }
 
         // Show cannot have filters
-        if (args.mAction == SyncIgnore::Action::Show && words.size() != 2)
+        if (args.mAction == SyncIgnore::Action::Show && (words.size() != 2 || !fromFile.empty()))
         {
             setCurrentThreadOutCode(MCMD_EARGS);
             LOG_err << "      " << getUsageStr("sync-ignore");
@@ -7982,8 +10054,29 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             return word;
         };
 
-        std::transform(words.begin() + 1, words.end() - 1,
-                       std::inserter(args.mFilters, args.mFilters.end()), filterInserter);
+        if (args.mAction == SyncIgnore::Action::Test)
+        {
+            args.mTestPaths.assign(words.begin() + 1, words.end() - 1);
+        }
+        else
+        {
+            std::transform(words.begin() + 1, words.end() - 1,
+                           std::back_inserter(args.mFilters), filterInserter);
+
+            // Filters from a file go after the ones in the command line, in the same order as in the file
+            if (!fromFile.empty())
+            {
+                vector<string> fileFilters;
+                if (!SyncIgnore::readFiltersFromFile(fs::u8path(fromFile), fileFilters))
+                {
+                    setCurrentThreadOutCode(MCMD_NOTFOUND);
+                    LOG_err << "Unable to open " << fromFile;
+                    return;
+                }
+                std::transform(fileFilters.begin(), fileFilters.end(),
+                               std::back_inserter(args.mFilters), filterInserter);
+            }
+        }
 
         SyncIgnore::executeCommand(args);
     }
@@ -8261,7 +10354,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             delete megaCmdListener;
         }
 
-        if (!checkAndInformPSA(NULL, true) && !discard) // even when discarded: we need to read the next
+        if (!checkAndInformPSA(std::nullopt, true) && !discard) // even when discarded: we need to read the next
         {
             OUTSTREAM << "No PSA available" << endl;
             setCurrentThreadOutCode(MCMD_NOTFOUND);
@@ -9766,6 +11859,118 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             return;
         }
 
+        const string fromFile = getOption(cloptions, "from-file", "");
+        if (getFlag(clflags, "bulk") || !fromFile.empty())
+        {
+            const bool disable = getFlag(clflags, "d");
+            if (add == disable)
+            {
+                setCurrentThreadOutCode(MCMD_EARGS);
+                LOG_err << "Bulk mode requires either -a or -d";
+                LOG_err << "Usage: " << getUsageStr("export");
+                return;
+            }
+
+            const int maxInFlight = getintOption(cloptions, "max-in-flight", 32);
+            if (maxInFlight < 1)
+            {
+                setCurrentThreadOutCode(MCMD_EARGS);
+                LOG_err << "Invalid number of requests in flight: " << maxInFlight;
+                return;
+            }
+
+            vector<string> paths;
+            for (size_t i = 1; i < words.size(); i++)
+            {
+                unescapeifRequired(words[i]);
+                paths.push_back(words[i]);
+            }
+
+            if (!fromFile.empty())
+            {
+                std::ifstream pathsFile(fs::u8path(fromFile));
+                if (!pathsFile.is_open())
+                {
+                    setCurrentThreadOutCode(MCMD_NOTFOUND);
+                    LOG_err << "Unable to open " << fromFile;
+                    return;
+                }
+
+                for (string line; std::getline(pathsFile, line);)
+                {
+                    if (!line.empty() && line.back() == '\r')
+                    {
+                        line.pop_back();
+                    }
+                    if (!line.empty() && line[0] != '#')
+                    {
+                        paths.push_back(std::move(line));
+                    }
+                }
+            }
+
+            if (paths.empty())
+            {
+                setCurrentThreadOutCode(MCMD_EARGS);
+                LOG_err << "No remote paths given";
+                return;
+            }
+
+            // Every target is resolved before sending any request, so that the requests can be pipelined
+            std::set<MegaHandle> seen;
+            vector<std::unique_ptr<MegaNode>> nodes;
+            for (const string& path : paths)
+            {
+                vector<std::unique_ptr<MegaNode>> matches;
+                if (isRegExp(path))
+                {
+                    matches = nodesbypath(path.c_str(), getFlag(clflags,"use-pcre"));
+                }
+                else if (auto n = nodebypath(path.c_str()))
+                {
+                    matches.push_back(std::move(n));
+                }
+
+                if (matches.empty())
+                {
+                    setCurrentThreadOutCode(MCMD_NOTFOUND);
+                    LOG_err << "Node not found: " << path;
+                    continue;
+                }
+
+                for (auto& n : matches)
+                {
+                    if (!seen.insert(n->getHandle()).second)
+                    {
+                        continue;
+                    }
+
+                    if (n->isExported() == disable)
+                    {
+                        nodes.push_back(std::move(n));
+                    }
+                    else if (disable)
+                    {
+                        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+                        LOG_err << "Could not disable export of " << path << ": node not exported";
+                    }
+                    else
+                    {
+                        setCurrentThreadOutCode(MCMD_EXISTS);
+                        LOG_err << "Node " << path << " is already exported. "
+                                << "Use -d to delete it if you want to change its parameters. Note: the new link may differ";
+                    }
+                }
+            }
+
+            if (!nodes.empty() && (disable || acceptExportCopyright(getFlag(clflags, "f"))))
+            {
+                exportNodesInBulk(nodes, disable, expireTime, passwordOpt, getFlag(clflags, "writable"), getFlag(clflags, "mega-hosted"),
+                                  static_cast<size_t>(maxInFlight));
+            }
+            return;
+        }
+
         if (words.size() <= 1)
         {
             LOG_warn << "No file/folder argument provided, will export the current working folder";
@@ -9922,98 +12127,70 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                     }
                     else if (getLinkType(publicLink) == MegaNode::TYPE_FOLDER)
                     {
-                        MegaApi* apiFolder = getFreeApiFolder();
+                        MegaApi* apiFolder = getApiFolderForLink(*api, publicLink);
                         if (!apiFolder)
                         {
-                            setCurrentThreadOutCode(MCMD_NOTFOUND);
-                            LOG_err << "No available Api folder. Use configure to increase exported_folders_sdks";
                             return;
                         }
-                        char *accountAuth = api->getAccountAuth();
-                        apiFolder->setAccountAuth(accountAuth);
-                        delete []accountAuth;
 
-                        MegaCmdListener *megaCmdListener = new MegaCmdListener(apiFolder, NULL);
-                        apiFolder->loginToFolder(publicLink.c_str(), megaCmdListener);
-                        megaCmdListener->wait();
-                        if (checkNoErrors(megaCmdListener->getError(), "login to folder"))
+                        MegaNode *nodeToImport = NULL;
+                        bool usedRoot = false;
+                        string shandle = getPublicLinkHandle(publicLink);
+                        if (shandle.size())
                         {
-                            MegaCmdListener *megaCmdListener2 = new MegaCmdListener(apiFolder, NULL);
-                            apiFolder->fetchNodes(megaCmdListener2);
-                            megaCmdListener2->wait();
-                            if (checkNoErrors(megaCmdListener2->getError(), "access folder link " + publicLink))
-                            {
-                                MegaNode *nodeToImport = NULL;
-                                bool usedRoot = false;
-                                string shandle = getPublicLinkHandle(publicLink);
-                                if (shandle.size())
-                                {
-                                    handle thehandle = apiFolder->base64ToHandle(shandle.c_str());
-                                    nodeToImport = apiFolder->getNodeByHandle(thehandle);
-                                }
-                                else
-                                {
-                                    nodeToImport = apiFolder->getRootNode();
-                                    usedRoot = true;
-                                }
+                            handle thehandle = apiFolder->base64ToHandle(shandle.c_str());
+                            nodeToImport = apiFolder->getNodeByHandle(thehandle);
+                        }
+                        else
+                        {
+                            nodeToImport = apiFolder->getRootNode();
+                            usedRoot = true;
+                        }
 
-                                if (nodeToImport)
-                                {
-                                    MegaNode *authorizedNode = apiFolder->authorizeNode(nodeToImport);
-                                    if (authorizedNode != NULL)
-                                    {
-                                        MegaCmdListener *megaCmdListener3 = new MegaCmdListener(apiFolder, NULL);
-                                        api->copyNode(authorizedNode, dstFolder.get(), megaCmdListener3);
-                                        megaCmdListener3->wait();
+                        if (nodeToImport)
+                        {
+                            MegaNode *authorizedNode = apiFolder->authorizeNode(nodeToImport);
+                            if (authorizedNode != NULL)
+                            {
+                                MegaCmdListener *megaCmdListener3 = new MegaCmdListener(apiFolder, NULL);
+                                api->copyNode(authorizedNode, dstFolder.get(), megaCmdListener3);
+                                megaCmdListener3->wait();
 
-                                        if (checkNoErrors(megaCmdListener->getError(), "import folder node"))
-                                        {
-                                            MegaNode *importedFolderNode = api->getNodeByHandle(megaCmdListener3->getRequest()->getNodeHandle());
-                                            char *pathnewFolder = api->getNodePath(importedFolderNode);
-                                            if (pathnewFolder)
-                                            {
-                                                OUTSTREAM << "Imported folder complete: " << pathnewFolder << endl;
-                                                delete []pathnewFolder;
-                                            }
-                                            delete importedFolderNode;
-                                        }
-                                        delete megaCmdListener3;
-                                        delete authorizedNode;
-                                    }
-                                    else
-                                    {
-                                        setCurrentThreadOutCode(MCMD_EUNEXPECTED);
-                                        LOG_debug << "Node couldn't be authorized: " << publicLink;
-                                    }
-                                    delete nodeToImport;
-                                }
-                                else
+                                if (checkNoErrors(megaCmdListener3->getError(), "import folder node"))
                                 {
-                                    setCurrentThreadOutCode(MCMD_INVALIDSTATE);
-                                    if (usedRoot)
-                                    {
-                                        LOG_err << "Couldn't get root folder for folder link";
-                                    }
-                                    else
+                                    MegaNode *importedFolderNode = api->getNodeByHandle(megaCmdListener3->getRequest()->getNodeHandle());
+                                    char *pathnewFolder = api->getNodePath(importedFolderNode);
+                                    if (pathnewFolder)
                                     {
-                                        LOG_err << "Failed to get node corresponding to handle within public link " << shandle;
+                                        OUTSTREAM << "Imported folder complete: " << pathnewFolder << endl;
+                                        delete []pathnewFolder;
                                     }
+                                    delete importedFolderNode;
                                 }
+                                delete megaCmdListener3;
+                                delete authorizedNode;
                             }
-
+                            else
                             {
-                                std::unique_ptr<MegaCmdListener> megaCmdListener(new MegaCmdListener(apiFolder));
-                                apiFolder->logout(false, megaCmdListener.get());
-                                megaCmdListener->wait();
-                                if (megaCmdListener->getError()->getErrorCode() != MegaError::API_OK)
-                                {
-                                    LOG_err << "Couldn't logout from apiFolder";
-                                }
+                                setCurrentThreadOutCode(MCMD_EUNEXPECTED);
+                                LOG_debug << "Node couldn't be authorized: " << publicLink;
                             }
-                            delete megaCmdListener2;
+                            delete nodeToImport;
                         }
-                        delete megaCmdListener;
-                        freeApiFolder(apiFolder);
+                        else
+                        {
+                            setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+                            if (usedRoot)
+                            {
+                                LOG_err << "Couldn't get root folder for folder link";
+                            }
+                            else
+                            {
+                                LOG_err << "Failed to get node corresponding to handle within public link " << shandle;
+                            }
+                        }
+
+                        freeApiFolder(apiFolder, publicLink, true);
                     }
                     else
                     {
@@ -10048,7 +12225,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
 
         OUTSTREAM << "Reloading account..." << endl;
         MegaCmdListener *megaCmdListener = new MegaCmdListener(NULL, NULL, clientID);
-        sandboxCMD->mNodesCurrentPromise.initiatePromise();
+        Readiness::getInstance().onFetchNodesStarted();
         api->fetchNodes(megaCmdListener);
         actUponFetchNodes(api, megaCmdListener);
         delete megaCmdListener;
@@ -10585,41 +12762,16 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
         }
 
         //show transfers
-        std::unique_ptr<MegaTransferData> transferdata(api->getTransferData());
-
-        int ndownloads = transferdata->getNumDownloads();
-        int nuploads = transferdata->getNumUploads();
+        const TransferIndex& transferIndex = globalTransferListener->getTransferIndex();
+        const TransferIndexSummary summary = transferIndex.getSummary();
 
         if (printsummary)
         {
-            long long transferredDownload = 0, transferredUpload = 0, totalDownload = 0, totalUpload = 0;
-            for (int i = 0; i< ndownloads; i++)
-            {
-                MegaTransfer *t = api->getTransferByTag(transferdata->getDownloadTag(i));
-                {
-                    if (t)
-                    {
-                        transferredDownload += t->getTransferredBytes();
-                        totalDownload += t->getTotalBytes();
-                        delete t;
-                    }
-                }
-            }
-            for (int i = 0; i< nuploads; i++)
-            {
-                MegaTransfer *t = api->getTransferByTag(transferdata->getUploadTag(i));
-                {
-                    if (t)
-                    {
-                        transferredUpload += t->getTransferredBytes();
-                        totalUpload += t->getTotalBytes();
-                        delete t;
-                    }
-                }
-            }
+            const TransferAggregates& dls = summary.mDownloads;
+            const TransferAggregates& uls = summary.mUploads;
 
-            float percentDownload = !totalDownload?0:float(transferredDownload*1.0/totalDownload);
-            float percentUpload = !totalUpload?0:float(transferredUpload*1.0/totalUpload);
+            float percentDownload = !dls.mTotalBytes?0:float(dls.mTransferredBytes*1.0/dls.mTotalBytes);
+            float percentUpload = !uls.mTotalBytes?0:float(uls.mTransferredBytes*1.0/uls.mTotalBytes);
 
             OUTSTREAM << getFixLengthString("NUM DOWNLOADS", 16, ' ', true);
             OUTSTREAM << getFixLengthString("DOWNLOADED", 12, ' ', true);
@@ -10632,184 +12784,133 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             OUTSTREAM << getFixLengthString("%   ", 8, ' ', true);
             OUTSTREAM << endl;
 
-            OUTSTREAM << getFixLengthString(SSTR(ndownloads), 16, ' ', true);
-            OUTSTREAM << getFixLengthString(sizeToText(transferredDownload), 12, ' ', true);
-            OUTSTREAM << getFixLengthString(sizeToText(totalDownload), 12, ' ', true);
+            OUTSTREAM << getFixLengthString(SSTR(dls.mCount), 16, ' ', true);
+            OUTSTREAM << getFixLengthString(sizeToText(dls.mTransferredBytes), 12, ' ', true);
+            OUTSTREAM << getFixLengthString(sizeToText(dls.mTotalBytes), 12, ' ', true);
             OUTSTREAM << getFixLengthString(percentageToText(percentDownload),8,' ',true);
 
             OUTSTREAM << "     ";
-            OUTSTREAM << getFixLengthString(SSTR(nuploads), 16, ' ', true);
-            OUTSTREAM << getFixLengthString(sizeToText(transferredUpload), 12, ' ', true);
-            OUTSTREAM << getFixLengthString(sizeToText(totalUpload), 12, ' ', true);
+            OUTSTREAM << getFixLengthString(SSTR(uls.mCount), 16, ' ', true);
+            OUTSTREAM << getFixLengthString(sizeToText(uls.mTransferredBytes), 12, ' ', true);
+            OUTSTREAM << getFixLengthString(sizeToText(uls.mTotalBytes), 12, ' ', true);
             OUTSTREAM << getFixLengthString(percentageToText(percentUpload),8,' ',true);
             OUTSTREAM << endl;
+
+            auto printStateCounts = [](const char* title, const TransferAggregates& aggregates)
+            {
+                OUTSTREAM << title << ":";
+                bool first = true;
+                for (int state = 0; state < static_cast<int>(aggregates.mCountByState.size()); state++)
+                {
+                    if (aggregates.mCountByState[state])
+                    {
+                        OUTSTREAM << (first ? " " : ", ") << aggregates.mCountByState[state] << " " << getTransferStateStr(state);
+                        first = false;
+                    }
+                }
+                OUTSTREAM << (first ? " -" : "") << endl;
+            };
+            OUTSTREAM << endl;
+            printStateCounts("Download states", dls);
+            printStateCounts("Upload states", uls);
+            OUTSTREAM << "Sync transfers: " << summary.getSyncCount() << " (" << dls.mSyncCount << " downloads, " << uls.mSyncCount << " uploads)" << endl;
+            OUTSTREAM << "Non-sync transfers: " << summary.getNonSyncCount() << endl;
             return;
         }
 
-
-
-        int limit = getintOption(cloptions, "limit", min(10,ndownloads+nuploads+(int)globalTransferListener->completedTransfers.size()));
-
-        if (!transferdata)
+        auto sortBy = TransferIndex::sortByFromString(getOption(cloptions, "sort", ""));
+        if (!sortBy)
         {
-            setCurrentThreadOutCode(MCMD_EUNEXPECTED);
-            LOG_err << "No transferdata.";
+            setCurrentThreadOutCode(MCMD_EARGS);
+            LOG_err << "Invalid sort criteria: " << getOption(cloptions, "sort", "") << ". Valid values are: speed, size";
             return;
         }
 
+        int limit = getintOption(cloptions, "limit", min(10, int(summary.mDownloads.mCount + summary.mUploads.mCount
+                                                                 + globalTransferListener->completedTransfers.size())));
+        limit = max(0, limit);
+        const int requestedOffset = max(0, getintOption(cloptions, "offset", 0));
+        size_t offset = static_cast<size_t>(requestedOffset);
+
         bool downloadpaused = api->areTransfersPaused(MegaTransfer::TYPE_DOWNLOAD);
         bool uploadpaused = api->areTransfersPaused(MegaTransfer::TYPE_UPLOAD);
 
-        int indexUpload = 0;
-        int indexDownload = 0;
-        int shown = 0;
+        TransferIndex::Filter filter;
+        filter.mDownloads = onlydownloads || !onlyuploads;
+        filter.mUploads = onlyuploads || !onlydownloads;
+        filter.mSyncs = showsyncs;
 
-        int showndl = 0;
-        int shownup = 0;
-        unsigned int shownCompleted = 0;
+        // Note: we seek for limit+1 transfers, to know whether there are more to show
+        const size_t toShow = static_cast<size_t>(limit) + 1;
 
-        vector<MegaTransfer *> transfersDLToShow;
-        vector<MegaTransfer *> transfersUPToShow;
         vector<MegaTransfer *> transfersCompletedToShow;
-
         if (showcompleted)
         {
-            globalTransferListener->completedTransfersMutex.lock();
-            size_t totalcompleted = globalTransferListener->completedTransfers.size();
-            for (size_t i = 0;(i < totalcompleted)
-                 && (shownCompleted < totalcompleted)
-                 && (shownCompleted < (size_t)(limit+1)); //Note limit+1 to seek for one more to show if there are more to show!
-                 i++)
+            std::lock_guard<std::mutex> g(globalTransferListener->completedTransfersMutex);
+            for (MegaTransfer *transfer : globalTransferListener->completedTransfers)
             {
-                MegaTransfer *transfer = globalTransferListener->completedTransfers.at(i);
-                if (
-                    (
-                            (transfer->getType() == MegaTransfer::TYPE_UPLOAD && (onlyuploads || (!onlyuploads && !onlydownloads) ))
-                        ||  (transfer->getType() == MegaTransfer::TYPE_DOWNLOAD && (onlydownloads || (!onlyuploads && !onlydownloads) ) )
-                    )
-                    &&  !(!showsyncs && transfer->isSyncTransfer())
-                    )
+                if (transfersCompletedToShow.size() >= toShow)
                 {
-
-                    transfersCompletedToShow.push_back(transfer);
-                    shownCompleted++;
+                    break;
                 }
-            }
-            globalTransferListener->completedTransfersMutex.unlock();
-        }
 
-        shown += shownCompleted;
-
-        while (!onlycompleted)
-        {
-            //MegaTransfer *transfer = transferdata->get(i);
-            MegaTransfer *transfer = NULL;
-            //Next transfer to show
-            if (onlyuploads && !onlydownloads && indexUpload < transferdata->getNumUploads()) //Only uploads
-            {
-                transfer = api->getTransferByTag(transferdata->getUploadTag(indexUpload++));
-            }
-            else
-            {
-                if ( (!onlydownloads || (onlydownloads && onlyuploads)) //both
-                     && ( (shown >= (limit/2) ) || indexDownload == ndownloads ) // /already chosen half slots for dls or no more dls
-                     && indexUpload < transferdata->getNumUploads()
-                     )
-                    //This is not 100 % perfect, it could show with a limit of 10 5 downloads and 3 uploads with more downloads on the queue.
+                if (!filter.matches({transfer->getTag(), transfer->getType(), transfer->getState(), transfer->isSyncTransfer()}))
                 {
-                    transfer = api->getTransferByTag(transferdata->getUploadTag(indexUpload++));
-
+                    continue;
                 }
-                else if(indexDownload < ndownloads)
+
+                if (offset)
                 {
-                    transfer =  api->getTransferByTag(transferdata->getDownloadTag(indexDownload++));
+                    --offset;
+                    continue;
                 }
+                transfersCompletedToShow.push_back(transfer);
             }
+        }
 
-            if (!transfer) break; //finish
-
-            if (
-                    (showcompleted || transfer->getState() != MegaTransfer::STATE_COMPLETED)
-                    &&  !(onlyuploads && transfer->getType() != MegaTransfer::TYPE_UPLOAD && !onlydownloads )
-                    &&  !(onlydownloads && transfer->getType() != MegaTransfer::TYPE_DOWNLOAD && !onlyuploads )
-                    &&  !(!showsyncs && transfer->isSyncTransfer())
-                    &&  (shown < (limit+1)) //Note limit+1 to seek for one more to show if there are more to show!
-                    )
+        // Only the transfers of the page are retrieved from the SDK
+        vector<std::unique_ptr<MegaTransfer>> transfersOngoingToShow;
+        if (!onlycompleted && transfersCompletedToShow.size() < toShow)
+        {
+            for (int tag : transferIndex.getPage(filter, *sortBy, offset, toShow - transfersCompletedToShow.size()))
             {
-                shown++;
-                if (transfer->getType() == MegaTransfer::TYPE_DOWNLOAD)
-                {
-                    transfersDLToShow.push_back(transfer);
-                    showndl++;
-                }
-                else
+                std::unique_ptr<MegaTransfer> transfer(api->getTransferByTag(tag));
+                if (transfer) // it might have finished in the meantime
                 {
-                    transfersUPToShow.push_back(transfer);
-                    shownup++;
+                    transfersOngoingToShow.push_back(std::move(transfer));
                 }
             }
-            else
-            {
-                delete transfer;
-            }
-            if (shown>limit || transfer == NULL) //we-re done
-            {
-                break;
-            }
         }
 
-        vector<MegaTransfer *>::iterator itCompleted = transfersCompletedToShow.begin();
-        vector<MegaTransfer *>::iterator itDLs = transfersDLToShow.begin();
-        vector<MegaTransfer *>::iterator itUPs = transfersUPToShow.begin();
-
         ColumnDisplayer cd(clflags, cloptions);
         cd.addHeader("SOURCEPATH", false);
         cd.addHeader("DESTINYPATH", false);
 
-        for (unsigned int i=0;i<showndl+shownup+shownCompleted; i++)
+        const size_t total = transfersCompletedToShow.size() + transfersOngoingToShow.size();
+        if (total && (uploadpaused || downloadpaused))
         {
-            MegaTransfer *transfer = NULL;
-            bool deleteTransfer = true;
-            if (itDLs == transfersDLToShow.end() && itCompleted == transfersCompletedToShow.end())
-            {
-                transfer = (MegaTransfer *) *itUPs;
-                itUPs++;
-            }
-            else if (itCompleted == transfersCompletedToShow.end())
-            {
-                transfer = (MegaTransfer *) *itDLs;
-                itDLs++;
-            }
-            else
-            {
-                transfer = (MegaTransfer *) *itCompleted;
-                itCompleted++;
-                deleteTransfer=false;
-            }
-            if (i == 0) //first
+            OUTSTREAM << "            " << (downloadpaused?"DOWNLOADS":"") << ((uploadpaused && downloadpaused)?" AND ":"")
+                      << (uploadpaused?"UPLOADS":"") << " ARE PAUSED " << endl;
+        }
+
+        for (size_t i = 0; i < total; i++)
+        {
+            if (i == static_cast<size_t>(limit)) //we are in the extra one (not to be shown)
             {
-                if (uploadpaused || downloadpaused)
+                if (requestedOffset)
                 {
-                    OUTSTREAM << "            " << (downloadpaused?"DOWNLOADS":"") << ((uploadpaused && downloadpaused)?" AND ":"")
-                              << (uploadpaused?"UPLOADS":"") << " ARE PAUSED " << endl;
+                    OUTSTREAM << " ...  Showing transfers " << requestedOffset + 1 << " to " << requestedOffset + limit << " ..." << endl;
                 }
-            }
-            if (i==(unsigned int)limit) //we are in the extra one (not to be shown)
-            {
-                OUTSTREAM << " ...  Showing first " << limit << " transfers ..." << endl;
-                if (deleteTransfer)
+                else
                 {
-                    delete transfer;
+                    OUTSTREAM << " ...  Showing first " << limit << " transfers ..." << endl;
                 }
                 break;
             }
 
+            MegaTransfer *transfer = i < transfersCompletedToShow.size() ? transfersCompletedToShow[i]
+                                                                          : transfersOngoingToShow[i - transfersCompletedToShow.size()].get();
             printTransferColumnDisplayer(&cd, transfer);
-
-            if (deleteTransfer)
-            {
-                delete transfer;
-            }
         }
         OUTSTREAM << cd.str();
     }
@@ -11106,7 +13207,7 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             return;
         }
 
-        if (words.size() != 2)
+        if (words.size() > 2)
         {
             setCurrentThreadOutCode(MCMD_EARGS);
             LOG_err << getUsageStr("fuse-config");
@@ -11120,15 +13221,36 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             return;
         }
 
-        const std::string& identifier = words[1];
-        auto mount = FuseCommand::getMountByNameOrPath(*api, identifier);
-        if (!mount)
+        // Mount flags need a mount; settings are shared by all of them
+        const bool hasIdentifier = (words.size() == 2);
+        if (configDeltaOpt->isAnyFlagSet() != hasIdentifier)
         {
-            setCurrentThreadOutCode(MCMD_NOTFOUND);
+            setCurrentThreadOutCode(MCMD_EARGS);
+            LOG_err << (hasIdentifier ? "FUSE settings are shared by all mounts: no mount must be specified to change them"
+                                      : "A mount must be specified to change its flags");
             return;
         }
 
-        FuseCommand::changeConfig(*api, *mount, *configDeltaOpt);
+        std::unique_ptr<MegaMount> mount;
+        if (hasIdentifier)
+        {
+            mount = FuseCommand::getMountByNameOrPath(*api, words[1]);
+            if (!mount)
+            {
+                setCurrentThreadOutCode(MCMD_NOTFOUND);
+                return;
+            }
+        }
+
+        if (configDeltaOpt->isAnySettingSet())
+        {
+            FuseCommand::changeSettings(*api, *configDeltaOpt);
+        }
+
+        if (mount)
+        {
+            FuseCommand::changeConfig(*api, *mount, *configDeltaOpt);
+        }
     }
 #endif
     else if (words[0] == "sync-issues")
@@ -11176,22 +13298,47 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
             return;
         }
 
-        auto syncIssues = mSyncIssuesManager.getSyncIssues();
+        bool subscribe = getFlag(clflags, "subscribe");
+        bool unsubscribe = getFlag(clflags, "unsubscribe");
+        if (subscribe || unsubscribe)
+        {
+            if (subscribe && unsubscribe)
+            {
+                setCurrentThreadOutCode(MCMD_EARGS);
+                LOG_err << "Only one of --subscribe and --unsubscribe can be specified at a time";
+                return;
+            }
+
+            int clientID = getintOption(cloptions, "clientID", -1);
+            if (clientID == -1 || !setStateListenerSubscription(clientID, SyncIssuesManager::StateEventType, subscribe))
+            {
+                setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+                LOG_err << "Unable to " << (subscribe ? "subscribe to" : "unsubscribe from") << " sync issue changes: this client is not listening to state changes";
+                return;
+            }
+
+            OUTSTREAM << (subscribe ? "Subscribed to" : "Unsubscribed from") << " sync issue changes" << endl;
+            return;
+        }
+
+        auto snapshot = mSyncIssuesManager.getSyncIssues(getFlag(clflags, "refresh"));
 #ifdef MEGACMD_TESTING_CODE
         // Do not trust empty results (SDK may send them after spurious scans delayed 20ds. SDK-4813)
         timelyRetry(std::chrono::milliseconds(2300), std::chrono::milliseconds(200),
-                    [&syncIssues]() { return !syncIssues.empty(); },
-                    [this, &syncIssues, firstTime{true}]() mutable
+                    [&snapshot]() { return !snapshot->mSyncIssues.empty(); },
+                    [this, &snapshot, firstTime{true}]() mutable
         {
             if (firstTime)
             {
                 LOG_warn << "sync-issues first retrieval returned empty";
                 firstTime = false;
             }
-            syncIssues = mSyncIssuesManager.getSyncIssues();
-            LOG_warn << "sync-issues retrieval returned empty. Retried returned = " << syncIssues.size();
+            snapshot = mSyncIssuesManager.getSyncIssues(true);
+            LOG_warn << "sync-issues retrieval returned empty. Retried returned = " << snapshot->mSyncIssues.size();
         });
 #endif
+        const SyncIssueList& syncIssues = snapshot->mSyncIssues;
+        LOG_verbose << "Using sync issues list version " << snapshot->mVersion << ", retrieved " << snapshot->getAge().count() << " seconds ago";
 
         ColumnDisplayer cd(clflags, cloptions);
 
@@ -11229,15 +13376,30 @@ void MegaCmdExecuter::executecommand(vector<string> words, map<string, int> *clf
                 SyncIssuesCommand::printSingleIssueDetail(*api, cd, *syncIssuePtr, disablePathCollapse, rowCountLimit);
             }
         }
+        else if (string pathOrId = getOption(cloptions, "sync", ""); !pathOrId.empty()) // show the issues of a single sync
+        {
+            auto sync = SyncCommand::getSync(*api, pathOrId);
+            if (!sync)
+            {
+                setCurrentThreadOutCode(MCMD_NOTFOUND);
+                LOG_err << "Sync not found: " << pathOrId;
+                return;
+            }
+
+            SyncIssuesCommand::printSyncIssues(*api, cd, syncIssues, *sync, disablePathCollapse, rowCountLimit);
+            SyncIssuesCommand::printSnapshotAge(*snapshot);
+        }
         else // show all sync issues
         {
             if (syncIssues.empty())
             {
                 OUTSTREAM << "There are no sync issues" << endl;
-                return;
             }
-
-            SyncIssuesCommand::printAllIssues(*api, cd, syncIssues, disablePathCollapse, rowCountLimit);
+            else
+            {
+                SyncIssuesCommand::printAllIssues(*api, cd, syncIssues, disablePathCollapse, rowCountLimit);
+            }
+            SyncIssuesCommand::printSnapshotAge(*snapshot);
         }
     }
 #if defined(DEBUG) || defined(MEGACMD_TESTING_CODE)
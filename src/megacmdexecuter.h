@@ -24,6 +24,17 @@
 #include "listeners.h"
 #include "deferred_single_trigger.h"
 #include "sync_issues.h"
+#include "megacmd_transfer_manifest.h"
+#include "megacmd_fingerprint_cache.h"
+#include "megacmd_folder_info_cache.h"
+#include "megacmd_shared_nodes_index.h"
+#include "megacmd_nodes_snapshot.h"
+#include "megacmd_timer_scheduler.h"
+#include "megacmd_mutation_batch.h"
+#include "megacmd_storage_report.h"
+
+#include <condition_variable>
+#include <thread>
 
 namespace megacmd {
 class MegaCmdGlobalTransferListener;
@@ -45,10 +56,40 @@ private:
     std::mutex mtxFtpLocations;
 
     DeferredSingleTrigger mDeferredSharedFoldersVerifier;
+    // Warn and give up while the account is catching up after fetching the nodes (see Readiness)
+    DeferredSingleTrigger mCatchUpWarning;
+    DeferredSingleTrigger mCatchUpTimeout;
     SyncIssuesManager mSyncIssuesManager;
+    FolderInfoCache mFolderInfoCache;
+    SharedNodesIndex mSharedNodesIndex;
+
+    // snapshot of the indexes above, to answer some listings after a restart while the account is still loading
+    std::mutex mNodesSnapshotMutex;
+    std::unique_ptr<NodesSnapshot> mNodesSnapshot; // null if disabled
+    std::chrono::minutes mNodesSnapshotInterval{0};
+    uint64_t mNodesSnapshotSchedule = 0; // increased every time the interval changes
+    std::optional<TimerScheduler::TimerId> mNodesSnapshotTimer;
+    std::optional<std::pair<uint64_t, uint64_t>> mNodesSnapshotGenerations; // of the indexes in the last one written
+    // Snapshots are taken in their own thread: resolving the paths and writing the file is too much for the timer's
+    std::thread mNodesSnapshotThread;
+    std::condition_variable mNodesSnapshotCV;
+    std::optional<uint64_t> mNodesSnapshotDue; // schedule of the timer that went off
+    bool mNodesSnapshotsStopped = false;
+
+    void scheduleNodesSnapshot(uint64_t schedule);
+    void nodesSnapshotLoop();
 
     std::recursive_mutex mtxBackupsMap;
 
+    // transfer manifests with transfers in progress, by id
+    std::mutex mRunningManifestsMutex;
+    std::map<std::string, std::weak_ptr<TransferManifest>> mRunningManifests;
+    std::mutex mManifestIdsMutex; // held from choosing an id until its journal exists
+
+    // local fingerprints used by incremental transfers, loaded on first use
+    std::mutex mFingerprintCacheMutex;
+    std::unique_ptr<LocalFingerprintCache> mFingerprintCache;
+
     // login/signup e-mail address
     std::string login;
 
@@ -103,6 +144,23 @@ public:
 
     void updateprompt(mega::MegaApi *api = nullptr);
 
+    // keeps cached folder info in line with the node updates received (null nodes means everything might have changed)
+    void updateFolderInfoCache(mega::MegaNodeList *nodes);
+    // keeps the index of exported and shared nodes in line with the node updates received (same for null nodes)
+    void updateSharedNodesIndex(mega::MegaNodeList *nodes);
+
+    // writes a snapshot of the indexes every interval (if they changed) and when stopped. 0 disables it, removing the snapshot
+    void setNodesSnapshotInterval(std::chrono::minutes interval);
+    void stopNodesSnapshots();
+    bool loadNodesSnapshot();
+    void saveNodesSnapshot();
+    // answers the listings (export, share) and sizes (du of folders by full path) that can be answered from the snapshot loaded.
+    // False if the command cannot be
+    bool executeFromNodesSnapshot(const std::vector<std::string>& words, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions);
+
+    // ongoing transfers, as seen by the global transfer listener
+    const TransferIndex& getTransferIndex() const;
+
     // nodes browsing
     void listtrees();
     static bool includeIfIsExported(mega::MegaApi* api, mega::MegaNode * n, void *arg);
@@ -125,11 +183,16 @@ public:
     void dumpNode(mega::MegaNode* n, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, int extended_info, bool showversions = false, int depth = 0, const char* title = NULL);
     void dumptree(mega::MegaNode* n, bool treelike, std::vector<bool> &lastleaf, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, int recurse, int extended_info, bool showversions = false, int depth = 0, std::string pathRelativeTo = "NULL");
     void dumpNodeSummaryHeader(const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions);
-    void dumpNodeSummary(mega::MegaNode* n, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, bool humanreadable = false, const char* title = NULL);
+    // folderSize is shown for folders, if known
+    void dumpNodeSummary(mega::MegaNode* n, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, bool humanreadable = false, const char* title = NULL, std::optional<long long> folderSize = std::nullopt);
     void dumpTreeSummary(mega::MegaNode* n, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, int recurse, bool show_versions, int depth = 0, bool humanreadable = false, std::string pathRelativeTo = "NULL");
     std::unique_ptr<mega::MegaContactRequest> getPcrByContact(std::string contactEmail);
     bool TestCanWriteOnContainingFolder(std::string path);
     std::string getDisplayPath(std::string givenPath, mega::MegaNode* n);
+    bool loadSharedNodesIndex();
+    // The nodes within the tree of n (n included) of any of the given kinds, from the index when possible (sorted by path),
+    // or else by walking the tree with the given processor
+    std::vector<std::unique_ptr<mega::MegaNode>> getSharedNodesInTree(mega::MegaNode* n, uint8_t kinds, bool processor(mega::MegaApi *, mega::MegaNode *, void *));
     int dumpListOfExported(mega::MegaNode* n, const char *timeFormat, std::map<std::string, int> *clflags, std::map<std::string, std::string> *cloptions, std::string givenPath);
     void listnodeshares(mega::MegaNode* n, std::string name, bool listPending, bool onlyPending);
     void dumpListOfShared(mega::MegaNode* n, std::string givenPath);
@@ -137,6 +200,13 @@ public:
     void dumpListOfPendingShares(mega::MegaNode* n, std::string givenPath);
     std::string getCurrentPath();
     long long getVersionsSize(mega::MegaNode* n);
+    // What is under each node (a file counts as itself, a null node as nothing). Folders are taken from the folder
+    // info cache unless useCache is false, and the ones not cached are requested concurrently. Unless withVersions,
+    // the versions of files are not looked up (which is slow): their size with versions is left as their size
+    std::vector<FolderInfoCache::Counts> getFolderInfo(const std::vector<mega::MegaNode*>& nodes, bool useCache = true, bool withVersions = false);
+    // Walks the tree under the folder with that many threads, each taking the next folder pending, and informs
+    // the client of the progress (in bytes out of totalBytes)
+    StorageReport analyzeStorage(mega::MegaNode& folder, unsigned threads, long long totalBytes, int clientID);
 
     //acting
     void verifySharedFolders(mega::MegaApi * api); //verifies unverified shares and broadcasts warning accordingly
@@ -148,13 +218,28 @@ public:
     void actUponLogout(mega::MegaApi& api, mega::MegaError* e, bool keptSession);
     void actUponLogout(mega::SynchronousRequestListener *srl, bool keptSession, int timeout = 0);
     int actUponCreateFolder(mega::SynchronousRequestListener *srl, int timeout = 0);
-    int deleteNode(const std::unique_ptr<mega::MegaNode>& nodeToDelete, mega::MegaApi* api, int recursive, int force = 0);
+    // Confirmed deletions are added to the batch, to be run once all the nodes have been gone through
+    int deleteNode(const std::unique_ptr<mega::MegaNode>& nodeToDelete, mega::MegaApi* api, int recursive, int force, MutationBatch& deletions);
     int deleteNodeVersions(const std::unique_ptr<mega::MegaNode>& nodeToDelete, mega::MegaApi* api, int force = 0);
+    bool checkDownloadQuota(mega::MegaApi* api, long long bytesToDownload, bool ignorequotawarn);
+    void startNodeDownload(const std::string &source, std::string localPath, mega::MegaApi* api, mega::MegaNode *node, const std::shared_ptr<MegaCmdMultiTransferListener> &listener, const char *customName = nullptr);
     void downloadNode(std::string source, std::string localPath, mega::MegaApi* api, mega::MegaNode *node, bool background, bool ignorequotawar, int clientID, std::shared_ptr<MegaCmdMultiTransferListener> listener);
+    // Downloads several nodes into the same destination: quota is evaluated once for all of them and the ones sharing
+    // their name are given "name (N)" before any transfer starts. Returns the planning time
+    std::chrono::milliseconds downloadNodes(const std::string &source, const std::string &localPath, mega::MegaApi* api, const std::vector<std::unique_ptr<mega::MegaNode>> &nodes, bool ignorequotawarn, const std::shared_ptr<MegaCmdMultiTransferListener> &listener);
+    // Starts the upload of a local path as it is, i.e. already unescaped
+    void startNodeUpload(const std::map<std::string, int> &clflags, std::string path, mega::MegaApi* api, mega::MegaNode *node, const std::string &newname, MegaCmdMultiTransferListener *multiTransferListener);
     void uploadNode(const std::map<std::string, int> &clflags, const std::map<std::string, std::string> &cloptions, const std::string &receivedPath, mega::MegaApi* api, mega::MegaNode *node, const std::string &newname, MegaCmdMultiTransferListener *multiTransferListener = NULL);
+    // Uploads a local folder file by file, while it is being scanned by scanThreads threads
+    void uploadFolderWithParallelScan(const std::map<std::string, int> &clflags, const std::map<std::string, std::string> &cloptions, const std::string &receivedPath, mega::MegaApi* api, mega::MegaNode *node, const std::string &newname, unsigned scanThreads, MegaCmdMultiTransferListener *multiTransferListener = NULL);
     void exportNode(mega::MegaNode *n, int64_t expireTime, const std::optional<std::string>& password = {},
                     std::map<std::string, int> *clflags = nullptr, std::map<std::string, std::string> *cloptions = nullptr);
     void disableExport(mega::MegaNode *n);
+    // Adds (or, with disable, deletes) the exports of many nodes, keeping up to maxInFlight requests in flight.
+    // Results are printed as "path<TAB>link" as they complete; failures are reported without stopping the rest
+    void exportNodesInBulk(const std::vector<std::unique_ptr<mega::MegaNode>>& nodes, bool disable, int64_t expireTime,
+                           const std::optional<std::string>& password, bool writable, bool megaHosted, size_t maxInFlight);
+    bool acceptExportCopyright(bool force);
     std::pair<bool, bool> isSharePendingAndVerified(mega::MegaNode *n, const char *email) const;
     void shareNode(mega::MegaNode *n, std::string with, int level = mega::MegaShare::ACCESS_READ);
     void disableShare(mega::MegaNode *n, std::string with);
@@ -182,7 +267,10 @@ public:
     int makedir(std::string remotepath, bool recursive, mega::MegaNode *parentnode = NULL);
     bool IsFolder(std::string path);
     bool pathExists(const std::string &path);
-    void doDeleteNode(const std::unique_ptr<mega::MegaNode>& nodeToDelete, mega::MegaApi* api);
+    void addNodeDeletion(MutationBatch& deletions, const std::unique_ptr<mega::MegaNode>& nodeToDelete, mega::MegaApi* api);
+    void addNodeMove(MutationBatch& moves, const std::unique_ptr<mega::MegaNode>& n, mega::MegaNode& destinyFolder);
+    // Runs the batch streaming its progress to the client, and reports the failures. Returns whether all succeeded
+    bool runMutations(MutationBatch& batch, const std::string& action, const std::string& title, int clientID = -1);
 
     void confirmDelete();
     void discardDelete();
@@ -213,7 +301,8 @@ public:
     // decrypt a link if it's encrypted. Returns false in case of error
     bool decryptLinkIfEncrypted(mega::MegaApi *api, std::string &publicLink, std::map<std::string, std::string> *cloptions);
 
-    bool checkAndInformPSA(CmdPetition *inf, bool enforce = false);
+    // Informs the given client (or every one, if none) of a new PSA
+    bool checkAndInformPSA(std::optional<int> clientID, bool enforce = false);
 
     // Provide a helpful error message for the provided error, setting the current error code in case of an error.
     std::string formatErrorAndMaySetErrorCode(const mega::MegaError &error);
@@ -222,6 +311,28 @@ public:
     bool checkNoErrors(::mega::SynchronousRequestListener *listener, const std::string &message = "", mega::SyncError syncError = mega::SyncError::NO_SYNC_ERROR);
 
     void confirmCancel(const char* confirmlink, const char* pass);
+    struct IncrementalTransferStats
+    {
+        uint64_t mQueued = 0;
+        uint64_t mSkipped = 0;
+        uint64_t mHashed = 0;
+        uint64_t mErrors = 0;
+    };
+    LocalFingerprintCache &getFingerprintCache();
+    std::map<std::string, std::vector<std::unique_ptr<mega::MegaNode>>> getChildrenByName(mega::MegaNode &folder);
+    // Whether the local file has the same contents as the node: same size and modification time, or same CRC
+    bool isLocalFileUnchanged(const fs::path &localPath, mega::MegaNode &node, IncrementalTransferStats &stats);
+    void uploadIncrementally(const fs::path &localPath, mega::MegaNode &remoteParent, const std::string &name, const std::map<std::string, std::vector<std::unique_ptr<mega::MegaNode>>> &remoteSiblings, IncrementalTransferStats &stats, MegaCmdMultiTransferListener *multiTransferListener);
+    void downloadIncrementally(mega::MegaNode &node, const fs::path &localTarget, IncrementalTransferStats &stats, const std::shared_ptr<MegaCmdMultiTransferListener> &multiTransferListener);
+    // Downloads the nodes into path (within it, if it ends with a separator) skipping the unchanged files. Quota is evaluated once for all of them
+    void downloadNodesIncrementally(const std::vector<mega::MegaNode*> &nodes, const std::string &path, bool ignorequotawarn, const std::shared_ptr<MegaCmdMultiTransferListener> &multiTransferListener);
+    void informIncrementalTransferStats(const IncrementalTransferStats &stats);
+
+    fs::path getTransferManifestPath(const std::string &id);
+    std::shared_ptr<TransferManifest> getRunningTransferManifest(const std::string &id);
+    void runTransferManifest(const std::string &id, const std::shared_ptr<TransferManifest> &manifest, bool background, int clientID);
+    void listTransferManifests(ColumnDisplayer &cd);
+
     bool amIPro();
 
     void processPath(std::string path, bool usepcre, bool& firstone, void (*nodeprocessor)(MegaCmdExecuter *, mega::MegaNode *, bool), MegaCmdExecuter *context = NULL);
@@ -322,6 +322,33 @@ void statechangehandle(string statestring, MegaCmdShellCommunications &comsManag
         {
             clientID = newstate.substr(strlen("clientID:")).c_str();
         }
+        else if (newstate.compare(0, strlen("syncissue:"), "syncissue:") == 0)
+        {
+            // syncissue:<added|removed|changed>:<ISSUE_ID>:<PARENT_SYNC_ID>:<REASON>
+            auto fields = split(newstate.substr(strlen("syncissue:")), ":");
+            if (fields.size() >= 4)
+            {
+                string reason = newstate.substr(strlen("syncissue:") + fields[0].size() + fields[1].size() + fields[2].size() + 3);
+
+                stringstream os;
+                if (shown_partial_progress)
+                {
+                    os << endl;
+                }
+                os << "Sync issue " << fields[0] << ": " << fields[1] << " (sync " << fields[2] << "): " << reason << endl;
+
+#ifdef _WIN32
+                wstring wbuffer;
+                stringtolocalw((const char*)os.str().data(),&wbuffer);
+                WindowsUtf8StdoutGuard utf8Guard;
+                OUTSTREAM << wbuffer << flush;
+#else
+                StdoutMutexGuard stdoutGuard;
+                OUTSTREAM << os.str();
+#endif
+                requirepromptinstall = true;
+            }
+        }
         else if (newstate.compare(0, strlen("progress:"), "progress:") == 0)
         {
             string rest = newstate.substr(strlen("progress:"));
@@ -354,6 +381,28 @@ void statechangehandle(string statestring, MegaCmdShellCommunications &comsManag
             const char * progressTitle = title.empty() ? "TRANSFERRING" : title.c_str();
             printprogress(completed, charstoll(total.c_str()), progressTitle);
         }
+        else if (newstate.compare(0, strlen("readiness:"), "readiness:") == 0)
+        {
+            // readiness:<STATE>:<FETCHED_BYTES>:<TOTAL_BYTES>
+            auto fields = split(newstate.substr(strlen("readiness:")), ":");
+            if (fields.size() >= 3 && charstoll(fields[2].c_str()) > 0)
+            {
+                if (fields[0] == "FETCHING_NODES")
+                {
+                    shown_partial_progress = true;
+                    printprogress(charstoll(fields[1].c_str()), charstoll(fields[2].c_str()), "Fetching nodes");
+                }
+                else if (shown_partial_progress)
+                {
+                    shown_partial_progress = false;
+                    printprogress(PROGRESS_COMPLETE, charstoll(fields[2].c_str()), "Fetching nodes");
+
+                    // The command held meanwhile may show its own progress next
+                    alreadyFinished = false;
+                    percentDowloaded = 0.0;
+                }
+            }
+        }
         else if (newstate == "ack")
         {
             // do nothing, all good
@@ -379,7 +428,7 @@ void statechangehandle(string statestring, MegaCmdShellCommunications &comsManag
         }
 
 
-        if (newstate.compare(0, strlen("progress:"), "progress:") != 0)
+        if (newstate.compare(0, strlen("progress:"), "progress:") != 0 && newstate.compare(0, strlen("readiness:"), "readiness:") != 0)
         {
             shown_partial_progress = false;
         }
@@ -1588,7 +1637,7 @@ void process_line(const char * line)
                 }
                 else
                 {
-                    if ( words[0] == "get" || words[0] == "put" || words[0] == "reload")
+                    if ( words[0] == "get" || words[0] == "put" || words[0] == "manifest" || words[0] == "storage-report" || words[0] == "rm" || words[0] == "mv" || words[0] == "reload" || words[0] == "sync-issues")
                     {
                         string s = commandtoexec;
                         if (clientID.size())
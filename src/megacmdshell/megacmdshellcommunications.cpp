@@ -761,6 +761,15 @@ void MegaCmdShellCommunications::shutdown()
     }
 }
 
+void MegaCmdShellCommunications::waitForStateListenerEnd()
+{
+    if (mListenerThread)
+    {
+        mListenerThread->join();
+        mListenerThread.reset();
+    }
+}
+
 bool MegaCmdShellCommunications::registerRequired()
 {
     std::lock_guard<std::mutex> g(mRegistrationMutex);
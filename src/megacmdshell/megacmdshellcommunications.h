@@ -106,6 +106,8 @@ public:
     bool isServerUpdating();
 
     void shutdown();
+    // Blocks until the state listener stops, i.e. until shutdown or the server closing the connection
+    void waitForStateListenerEnd();
     bool registerRequired();
     void setForRegisterAgain(bool dontWait = false);
 
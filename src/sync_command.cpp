@@ -19,74 +19,18 @@
 #include "megacmdutils.h"
 #include "megacmdlogger.h"
 #include "configurationmanager.h"
+#include "megacmd_sync_metrics.h"
+
 
 using std::string;
 
 namespace {
 
-bool isSyncTransfer(mega::MegaApi& api, int transferTag)
-{
-    std::unique_ptr<mega::MegaTransfer> transfer(api.getTransferByTag(transferTag));
-    return transfer && transfer->isSyncTransfer();
-}
-
-bool hasPendingSyncTransfers(mega::MegaApi& api)
-{
-    std::unique_ptr<mega::MegaTransferData> transferData(api.getTransferData());
-    assert(transferData);
-
-    for (int i = 0; i < transferData->getNumDownloads(); ++i)
-    {
-        const int tag = transferData->getDownloadTag(i);
-        if (isSyncTransfer(api, tag))
-        {
-            return true;
-        }
-    }
-
-    for (int i = 0; i < transferData->getNumUploads(); ++i)
-    {
-        const int tag = transferData->getUploadTag(i);
-        if (isSyncTransfer(api, tag))
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
-
 string getSyncId(mega::MegaSync& sync)
 {
     return syncBackupIdToBase64(sync.getBackupId());
 }
 
-void getInfoFromFolder(mega::MegaNode& n, mega::MegaApi& api, long long& nFiles, long long& nFolders, long long *nVersions = nullptr)
-{
-    auto megaCmdListener = std::make_unique<MegaCmdListener>(nullptr);
-    api.getFolderInfo(&n, megaCmdListener.get());
-
-    megaCmdListener->wait();
-    if (megaCmdListener->getError()->getErrorCode() != mega::MegaError::API_OK)
-    {
-        LOG_err << "Failed to get folder info for " << n.getName();
-        return;
-    }
-
-    mega::MegaFolderInfo* mfi = megaCmdListener->getRequest()->getMegaFolderInfo();
-    if (!mfi)
-    {
-        return;
-    }
-
-    nFiles = mfi->getNumFiles();
-    nFolders = mfi->getNumFolders();
-    if (nVersions)
-    {
-        *nVersions = mfi->getNumVersions();
-    }
-}
-
 void printSyncHeader(ColumnDisplayer &cd)
 {
     // Add headers with unfixed width (those that can be ellided)
@@ -94,7 +38,7 @@ void printSyncHeader(ColumnDisplayer &cd)
     cd.addHeader("REMOTEPATH", false);
 }
 
-void printSingleSync(mega::MegaApi& api, mega::MegaSync& sync, mega::MegaNode* node, long long nFiles, long long nFolders, ColumnDisplayer &cd, bool showHandle, int syncIssuesCount)
+void printSingleSync(mega::MegaApi& api, mega::MegaSync& sync, const FolderInfoCache::Counts& counts, ColumnDisplayer &cd, bool showHandle, int syncIssuesCount)
 {
     cd.addValue("ID", getSyncId(sync));
     cd.addValue("LOCALPATH", sync.getLocalFolder());
@@ -130,9 +74,9 @@ void printSingleSync(mega::MegaApi& api, mega::MegaSync& sync, mega::MegaNode* n
         cd.addValue("ERROR", syncIssuesMsg);
     }
 
-    cd.addValue("SIZE", sizeToText(node ? api.getSize(node) : 0));
-    cd.addValue("FILES", std::to_string(nFiles));
-    cd.addValue("DIRS", std::to_string(nFolders));
+    cd.addValue("SIZE", sizeToText(counts.mSize));
+    cd.addValue("FILES", std::to_string(counts.mFiles));
+    cd.addValue("DIRS", std::to_string(counts.mFolders));
 }
 
 std::pair<std::optional<string>, std::optional<string>> getErrorsAndSetOutCode(MegaCmdListener& listener)
@@ -162,6 +106,53 @@ std::pair<std::optional<string>, std::optional<string>> getErrorsAndSetOutCode(M
 
     return {errorOpt, syncErrorOpt};
 }
+string durationToText(std::chrono::milliseconds duration, bool humanReadable)
+{
+    if (!humanReadable)
+    {
+        return std::to_string(duration.count());
+    }
+    if (duration < std::chrono::seconds(1))
+    {
+        return std::to_string(duration.count()) + " ms";
+    }
+    return secondsToText(std::chrono::duration_cast<std::chrono::seconds>(duration).count());
+}
+
+void printSingleSyncStats(mega::MegaSync& sync, ColumnDisplayer& cd, bool humanReadable)
+{
+    // Syncs are only registered from the sync callbacks: one not notified yet has no activity to show
+    const SyncMetrics::Counters counters = SyncMetrics::getInstance().getCounters(sync.getBackupId()).value_or(SyncMetrics::Counters());
+
+    cd.addValue("ID", getSyncId(sync));
+    cd.addValue("LOCALPATH", sync.getLocalFolder());
+    cd.addValue("UPLOADED", std::to_string(counters.mFilesUploaded));
+    cd.addValue("UP_BYTES", sizeToText(static_cast<long long>(counters.mBytesUploaded), true, humanReadable));
+    cd.addValue("DOWNLOADED", std::to_string(counters.mFilesDownloaded));
+    cd.addValue("DOWN_BYTES", sizeToText(static_cast<long long>(counters.mBytesDownloaded), true, humanReadable));
+    cd.addValue("IN_FLIGHT", std::to_string(counters.mTransfersInFlight));
+    cd.addValue("FAILED", std::to_string(counters.mFailedTransfers));
+    cd.addValue("SCANS", std::to_string(counters.mScanCount));
+    cd.addValue("LAST_SCAN", counters.mScanning && humanReadable ? "scanning" : durationToText(counters.mLastScanDuration, humanReadable));
+    cd.addValue("SCAN_TIME", durationToText(counters.mTotalScanDuration, humanReadable));
+    cd.addValue("STALLS", std::to_string(counters.mStallCount));
+
+    string lastActivity = "-";
+    if (counters.mLastActivity)
+    {
+        if (humanReadable)
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(SyncMetrics::Clock::now() - *counters.mLastActivity);
+            lastActivity = secondsToText(std::max<m_time_t>(0, elapsed.count())) + " ago";
+        }
+        else
+        {
+            lastActivity = std::to_string(SyncMetrics::Clock::to_time_t(*counters.mLastActivity));
+        }
+    }
+    cd.addValue("LAST_ACTIVITY", lastActivity);
+}
+
 } // end namespace
 
 namespace SyncCommand {
@@ -184,7 +175,7 @@ std::unique_ptr<mega::MegaSync> reloadSync(mega::MegaApi& api, std::unique_ptr<m
     return std::unique_ptr<mega::MegaSync>(api.getSyncByBackupId(sync->getBackupId()));
 }
 
-bool isAnySyncUploadDelayed(mega::MegaApi& api)
+bool isAnySyncUploadDelayed(mega::MegaApi& api, const TransferIndex& transferIndex)
 {
     const bool isSyncing = api.isSyncing();
     if (!isSyncing)
@@ -198,7 +189,7 @@ bool isAnySyncUploadDelayed(mega::MegaApi& api)
         return false;
     }
 
-    const bool pendingSyncTransfers = hasPendingSyncTransfers(api);
+    const bool pendingSyncTransfers = transferIndex.hasPendingSyncTransfers();
     if (pendingSyncTransfers)
     {
         return false;
@@ -223,7 +214,7 @@ bool isAnySyncUploadDelayed(mega::MegaApi& api)
     return request->getFlag();
 }
 
-void printSync(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandle, mega::MegaSync& sync,  const SyncIssueList& syncIssues)
+void printSync(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandle, mega::MegaSync& sync,  const SyncIssueList& syncIssues, const FolderInfoGetter& getFolderInfo)
 {
     std::unique_ptr<mega::MegaNode> node(api.getNodeByHandle(sync.getMegaHandle()));
     if (!node)
@@ -232,42 +223,59 @@ void printSync(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandle, mega::M
         return;
     }
 
-    long long nFiles = 0;
-    long long nFolders = 0;
-    getInfoFromFolder(*node, api, nFiles, nFolders);
+    auto counts = getFolderInfo({node.get()});
 
     printSyncHeader(cd);
 
     unsigned int syncIssuesCount = syncIssues.getSyncIssuesCount(sync);
-    printSingleSync(api, sync, node.get(), nFiles, nFolders, cd, showHandle, syncIssuesCount);
+    printSingleSync(api, sync, counts[0], cd, showHandle, syncIssuesCount);
 }
 
-void printSyncList(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandles, const mega::MegaSyncList& syncList, const SyncIssueList& syncIssues)
+void printSyncList(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandles, const mega::MegaSyncList& syncList, const SyncIssueList& syncIssues, const FolderInfoGetter& getFolderInfo)
 {
     if (syncList.size() > 0)
     {
         printSyncHeader(cd);
     }
 
+    std::vector<std::unique_ptr<mega::MegaNode>> nodes;
+    std::vector<mega::MegaNode*> nodePtrs;
     for (int i = 0; i < syncList.size(); ++i)
     {
         mega::MegaSync& sync = *syncList.get(i);
 
-        std::unique_ptr<mega::MegaNode> node(api.getNodeByHandle(sync.getMegaHandle()));
-
-        long long nFiles = 0;
-        long long nFolders = 0;
-        if (node)
-        {
-            getInfoFromFolder(*node, api, nFiles, nFolders);
-        }
-        else
+        nodes.emplace_back(api.getNodeByHandle(sync.getMegaHandle()));
+        nodePtrs.push_back(nodes.back().get());
+        if (!nodes.back())
         {
             LOG_warn << "Remote node not found for sync " << getSyncId(sync);
         }
+    }
+
+    // Folder info is requested for all syncs at once, instead of waiting for each one before asking for the next
+    const auto counts = getFolderInfo(nodePtrs);
+
+    for (int i = 0; i < syncList.size(); ++i)
+    {
+        mega::MegaSync& sync = *syncList.get(i);
 
         unsigned int syncIssuesCount = syncIssues.getSyncIssuesCount(sync);
-        printSingleSync(api, sync, node.get(), nFiles, nFolders, cd, showHandles, syncIssuesCount);
+        printSingleSync(api, sync, counts[i], cd, showHandles, syncIssuesCount);
+    }
+}
+
+void printSyncStats(ColumnDisplayer& cd, mega::MegaSync& sync, bool humanReadable)
+{
+    cd.addHeader("LOCALPATH", false);
+    printSingleSyncStats(sync, cd, humanReadable);
+}
+
+void printSyncStatsList(ColumnDisplayer& cd, const mega::MegaSyncList& syncList, bool humanReadable)
+{
+    cd.addHeader("LOCALPATH", false);
+    for (int i = 0; i < syncList.size(); ++i)
+    {
+        printSingleSyncStats(*syncList.get(i), cd, humanReadable);
     }
 }
 
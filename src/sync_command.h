@@ -15,10 +15,13 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "megacmdcommonutils.h"
 #include "sync_issues.h"
+#include "megacmd_folder_info_cache.h"
+#include "megacmd_transfer_index.h"
 
 using namespace megacmd;
 
@@ -27,10 +30,17 @@ namespace SyncCommand
     std::unique_ptr<mega::MegaSync> getSync(mega::MegaApi& api, const std::string& pathOrId);
     std::unique_ptr<mega::MegaSync> reloadSync(mega::MegaApi& api, std::unique_ptr<mega::MegaSync>&& sync);
 
-    bool isAnySyncUploadDelayed(mega::MegaApi& api);
+    bool isAnySyncUploadDelayed(mega::MegaApi& api, const TransferIndex& transferIndex);
 
-    void printSync(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandle, mega::MegaSync& sync,  const SyncIssueList& syncIssues);
-    void printSyncList(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandles, const mega::MegaSyncList& syncList, const SyncIssueList& syncIssues);
+    // Gets the counts of the given folders (which may be null), all at once
+    using FolderInfoGetter = std::function<std::vector<FolderInfoCache::Counts>(const std::vector<mega::MegaNode*>& folders)>;
+
+    void printSync(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandle, mega::MegaSync& sync,  const SyncIssueList& syncIssues, const FolderInfoGetter& getFolderInfo);
+    void printSyncList(mega::MegaApi& api, ColumnDisplayer& cd, bool showHandles, const mega::MegaSyncList& syncList, const SyncIssueList& syncIssues, const FolderInfoGetter& getFolderInfo);
+
+    // Activity counters of the syncs since the server started (exact numbers, timestamps and milliseconds if not human readable)
+    void printSyncStats(ColumnDisplayer& cd, mega::MegaSync& sync, bool humanReadable);
+    void printSyncStatsList(ColumnDisplayer& cd, const mega::MegaSyncList& syncList, bool humanReadable);
 
     void addSync(mega::MegaApi& api, const fs::path& localPath, mega::MegaNode& node);
 
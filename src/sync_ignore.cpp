@@ -15,12 +15,15 @@
 
 #include "sync_ignore.h"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <cstring>
 #include <regex>
 
 #include "megacmdcommonutils.h"
 #include "megacmdlogger.h"
+#include "megacmd_ignore_filters.h"
 
 using namespace megacmd;
 
@@ -44,6 +47,23 @@ void trimSpaces(std::string& str)
     str.erase(end, str.end());
 }
 
+// Where a new version of the file is written before being renamed over it. For a .megaignore within a sync
+// that is the local debris folder of the sync, which the sync engine never syncs: next to the file, the
+// temporary one could be uploaded or make the sync stall
+fs::path getTemporaryPath(const fs::path& path, std::error_code& ec)
+{
+    if (path.filename() != ".megaignore")
+    {
+        fs::path tmpPath = path;
+        tmpPath += ".tmp";
+        return tmpPath;
+    }
+
+    const fs::path debrisTmpFolder = path.parent_path() / ".debris" / "tmp";
+    fs::create_directories(debrisTmpFolder, ec);
+    return debrisTmpFolder / ".megaignore.tmp";
+}
+
 std::unique_lock<std::mutex> getFileLock(const fs::path& path)
 {
     static std::mutex mapMutex;
@@ -53,7 +73,7 @@ std::unique_lock<std::mutex> getFileLock(const fs::path& path)
     return std::unique_lock(fileMutexMap[path]);
 }
 
-void executeAdd(MegaIgnoreFile& megaIgnoreFile, const std::set<std::string>& filters)
+void executeAdd(MegaIgnoreFile& megaIgnoreFile, const std::vector<std::string>& filters)
 {
     // Only check the format of the filters when adding, to allow users to remove invalid filters from the file
     for (const std::string& filter : filters)
@@ -70,21 +90,32 @@ void executeAdd(MegaIgnoreFile& megaIgnoreFile, const std::set<std::string>& fil
         return;
     }
 
-    std::set<std::string> toAdd;
+    std::vector<std::string> toAdd;
+    std::set<std::string> seen;
     for (const std::string& filter : filters)
     {
-        if (megaIgnoreFile.containsFilter(filter))
+        if (megaIgnoreFile.containsFilter(filter) || !seen.insert(filter).second)
         {
             OUTSTREAM << "Cannot add filter \"" << filter << "\" because it's already in the .megaignore file (skipped)" << endl;
             continue;
         }
-        toAdd.insert(filter);
+        toAdd.push_back(filter);
+    }
+
+    if (!megaIgnoreFile.addFilters(toAdd))
+    {
+        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+        LOG_err << "Unable to write to the .megaignore file";
+        return;
+    }
+
+    for (const std::string& filter : toAdd)
+    {
         OUTSTREAM << "Added filter \"" << filter << "\"" << endl;
     }
-    megaIgnoreFile.addFilters(toAdd);
 }
 
-void executeRemove(MegaIgnoreFile& megaIgnoreFile, const std::set<std::string>& filters)
+void executeRemove(MegaIgnoreFile& megaIgnoreFile, const std::vector<std::string>& filters)
 {
     std::set<std::string> toRemove;
     for (const std::string& filter : filters)
@@ -95,9 +126,176 @@ void executeRemove(MegaIgnoreFile& megaIgnoreFile, const std::set<std::string>&
             continue;
         }
         toRemove.insert(filter);
+    }
+
+    if (!megaIgnoreFile.removeFilters(toRemove))
+    {
+        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+        LOG_err << "Unable to write to the .megaignore file";
+        return;
+    }
+
+    for (const std::string& filter : toRemove)
+    {
         OUTSTREAM << "Removed filter \"" << filter << "\"" << endl;
     }
-    megaIgnoreFile.removeFilters(toRemove);
+}
+
+// Makes the path relative to the folder of the .megaignore, with '/' as separator. Returns false if it's outside of it.
+bool getRelativeTestPath(std::string& path, bool& isFolder, const fs::path& megaIgnoreDirPath)
+{
+#ifdef _WIN32
+    std::replace(path.begin(), path.end(), '\\', '/');
+#endif
+    isFolder = !path.empty() && path.back() == '/';
+    while (!path.empty() && path.back() == '/')
+    {
+        path.pop_back();
+    }
+
+    if (fs::u8path(path).is_absolute())
+    {
+        std::string dirPath = megaIgnoreDirPath.u8string();
+        if (dirPath.empty())
+        {
+            return false; // the default filters don't belong to any folder
+        }
+#ifdef _WIN32
+        std::replace(dirPath.begin(), dirPath.end(), '\\', '/');
+#endif
+        if (dirPath.back() != '/')
+        {
+            dirPath += '/';
+        }
+        if (path.compare(0, dirPath.size(), dirPath))
+        {
+            return false;
+        }
+        path.erase(0, dirPath.size());
+    }
+
+    while (path.rfind("./", 0) == 0)
+    {
+        path.erase(0, 2);
+    }
+    return !path.empty();
+}
+
+void executeTest(const SyncIgnore::Args& args, MegaIgnoreFile& megaIgnoreFile)
+{
+    // Size filters (and anything else that doesn't look like a name filter) have no effect on paths
+    std::vector<std::string> filters;
+    for (const std::string& filter : megaIgnoreFile.getOrderedFilters())
+    {
+        if (MegaIgnoreFile::isValidFilter(filter))
+        {
+            filters.push_back(filter);
+        }
+        else
+        {
+            LOG_warn << "Line \"" << filter << "\" is not a name filter and won't be evaluated";
+        }
+    }
+
+    std::string error;
+    auto compiledFilters = IgnoreFilters::compile(filters, error);
+    if (!compiledFilters)
+    {
+        setCurrentThreadOutCode(MCMD_INVALIDSTATE);
+        LOG_err << error;
+        return;
+    }
+
+    std::ifstream pathsFile;
+    if (!args.mTestPathsFile.empty())
+    {
+        pathsFile.open(args.mTestPathsFile);
+        if (!pathsFile.is_open())
+        {
+            setCurrentThreadOutCode(MCMD_NOTFOUND);
+            LOG_err << "Unable to open " << args.mTestPathsFile.u8string();
+            return;
+        }
+    }
+
+    IgnoreFiltersEvaluator evaluator(*compiledFilters);
+
+    uint64_t numExcluded = 0;
+    uint64_t numIncluded = 0;
+    uint64_t numOutside = 0;
+    const auto startTime = std::chrono::steady_clock::now();
+
+    auto testPath = [&] (std::string path)
+    {
+        const std::string originalPath = path;
+
+        bool isFolder = false;
+        if (!getRelativeTestPath(path, isFolder, args.mMegaIgnoreDirPath))
+        {
+            numOutside++;
+            if (!args.mTestSummaryOnly)
+            {
+                OUTSTREAM << "OUTSIDE\t" << originalPath << endl;
+            }
+            return;
+        }
+
+        auto result = evaluator.evaluate(path, isFolder);
+        (result.mExcluded ? numExcluded : numIncluded)++;
+        if (args.mTestSummaryOnly)
+        {
+            return;
+        }
+
+        OUTSTREAM << (result.mExcluded ? "EXCLUDED" : "INCLUDED") << "\t" << originalPath;
+        if (result.mFilterIndex >= 0)
+        {
+            OUTSTREAM << "\t" << compiledFilters->getFilter(result.mFilterIndex);
+            if (!result.mExcludedAncestor.empty())
+            {
+                OUTSTREAM << " (on " << result.mExcludedAncestor << ")";
+            }
+        }
+        OUTSTREAM << endl;
+    };
+
+    for (const auto& path : args.mTestPaths)
+    {
+        testPath(path);
+    }
+    for (std::string line; pathsFile.is_open() && std::getline(pathsFile, line);)
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty())
+        {
+            testPath(std::move(line));
+        }
+    }
+
+    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    const uint64_t numPaths = numExcluded + numIncluded + numOutside;
+    if (args.mTestSummaryOnly)
+    {
+        OUTSTREAM << "Evaluated " << numPaths << " paths against " << compiledFilters->size() << " filters in " << elapsedMs << " ms";
+        if (elapsedMs > 0)
+        {
+            OUTSTREAM << " (" << (numPaths * 1000 / elapsedMs) << " paths/s)";
+        }
+        OUTSTREAM << endl;
+        OUTSTREAM << "Excluded: " << numExcluded << endl;
+        OUTSTREAM << "Included: " << numIncluded << endl;
+        if (numOutside)
+        {
+            OUTSTREAM << "Outside of the sync: " << numOutside << endl;
+        }
+    }
+    else
+    {
+        LOG_verbose << "Evaluated " << numPaths << " paths against " << compiledFilters->size() << " filters in " << elapsedMs << " ms";
+    }
 }
 
 void executeSyncIgnoreCommand(const SyncIgnore::Args& args, MegaIgnoreFile& megaIgnoreFile)
@@ -119,6 +317,11 @@ void executeSyncIgnoreCommand(const SyncIgnore::Args& args, MegaIgnoreFile& mega
             executeRemove(megaIgnoreFile, args.mFilters);
             break;
         }
+        case SyncIgnore::Action::Test:
+        {
+            executeTest(args, megaIgnoreFile);
+            break;
+        }
     }
 }
 
@@ -136,6 +339,14 @@ void executeCommand(const Args& args)
         return;
     }
 
+    if (args.mTestPaths.empty() && args.mTestPathsFile.empty() && args.mAction == Action::Test)
+    {
+        setCurrentThreadOutCode(MCMD_EARGS);
+        LOG_err << "At least one path (or a file with paths) is required for test";
+        LOG_err << "      " << getUsageStr("sync-ignore");
+        return;
+    }
+
     fs::path megaIgnoreFilePath;
     bool isDefault = true;
     if (args.mMegaIgnoreDirPath.empty())
@@ -177,6 +388,32 @@ void executeCommand(const Args& args)
     executeSyncIgnoreCommand(args, megaIgnoreFile);
 }
 
+bool readFiltersFromFile(const fs::path& path, std::vector<std::string>& filters)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    bool firstLine = true;
+    for (std::string line; getline(file, line); firstLine = false)
+    {
+        if (firstLine && !line.compare(0, strlen(BOMStr), BOMStr))
+        {
+            line.erase(0, strlen(BOMStr));
+        }
+        trimSpaces(line);
+        line.erase(0, line.find_first_not_of(" \t"));
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        filters.push_back(std::move(line));
+    }
+    return true;
+}
+
 std::string getFilterFromLegacyPattern(const std::string& pattern)
 {
     return "-:" + pattern;
@@ -201,6 +438,7 @@ bool MegaIgnoreFile::checkBOMAndSkip(std::ifstream& file)
 void MegaIgnoreFile::loadFilters(std::ifstream& file)
 {
     mFilters.clear();
+    mOrderedFilters.clear();
     for (std::string line; getline(file, line);)
     {
         trimSpaces(line);
@@ -208,7 +446,9 @@ void MegaIgnoreFile::loadFilters(std::ifstream& file)
         {
             continue;
         }
+        // Repeated lines are kept: a later one may override filters in between, as the last match wins
         mFilters.insert(line);
+        mOrderedFilters.push_back(line);
     }
 }
 
@@ -271,28 +511,70 @@ void MegaIgnoreFile::createWithBOM()
     mValid = true;
 }
 
-void MegaIgnoreFile::addFilters(const std::set<std::string>& filters)
+bool MegaIgnoreFile::addFilters(const std::vector<std::string>& filters)
 {
+    assert(mValid);
     auto fileLock = getFileLock(mPath);
+
+    std::string newContents;
+    for (const std::string& filter : filters)
     {
-        std::ofstream file(mPath, std::ios_base::app);
-        for (const std::string& filter : filters)
+        if (mFilters.insert(filter).second)
         {
-            file << filter << NL;
+            mOrderedFilters.push_back(filter);
+            newContents += filter + NL;
         }
     }
 
-    loadFromPath();
+    if (newContents.empty())
+    {
+        return true;
+    }
+
+    // If the last line has no line break, the first filter would be appended to it
+    bool needsLineBreak = false;
+    {
+        std::ifstream file(mPath, std::ios_base::binary | std::ios_base::ate);
+        const auto size = file.is_open() ? static_cast<long long>(file.tellg()) : 0;
+        if (size > 0 && file.seekg(-1, std::ios_base::end))
+        {
+            char lastChar = '\0';
+            file.get(lastChar);
+            needsLineBreak = lastChar != '\n' && !(size == 3 && lastChar == BOMStr[2]);
+        }
+    }
+
+    std::ofstream file(mPath, std::ios_base::app);
+    file << (needsLineBreak ? NL : "") << newContents;
+    file.close();
+    if (file.fail())
+    {
+        LOG_err << "Failed to append filters to " << mPath;
+        loadFromPath();
+        return false;
+    }
+    return true;
 }
 
-void MegaIgnoreFile::removeFilters(const std::set<std::string>& filters)
+bool MegaIgnoreFile::removeFilters(const std::set<std::string>& filters)
 {
+    assert(mValid);
+    if (filters.empty())
+    {
+        return true;
+    }
+
     auto fileLock = getFileLock(mPath);
 
     std::string newContents;
     bool hasBOM = false;
     {
         std::ifstream file(mPath);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
         hasBOM = checkBOMAndSkip(file);
         for (std::string line; getline(file, line);)
         {
@@ -305,12 +587,45 @@ void MegaIgnoreFile::removeFilters(const std::set<std::string>& filters)
         }
     }
 
+    // Write the new contents aside and replace the file, so that the sync engine never sees a partial file
+    std::error_code tmpEc;
+    const fs::path tmpPath = getTemporaryPath(mPath, tmpEc);
+    if (tmpEc)
     {
-        std::ofstream outFile(mPath, std::ios_base::trunc);
+        LOG_err << "Failed to create the folder for " << tmpPath << ": " << errorCodeStr(tmpEc);
+        return false;
+    }
+    {
+        std::ofstream outFile(tmpPath, std::ios_base::trunc);
         outFile << (hasBOM ? BOMStr : "") << newContents;
+        outFile.close();
+        if (outFile.fail())
+        {
+            LOG_err << "Failed to write " << tmpPath;
+            std::error_code ec;
+            fs::remove(tmpPath, ec);
+            return false;
+        }
     }
 
-    loadFromPath();
+    std::error_code ec;
+    fs::rename(tmpPath, mPath, ec);
+    if (ec)
+    {
+        LOG_err << "Failed to replace " << mPath << ": " << errorCodeStr(ec);
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+
+    for (const std::string& filter : filters)
+    {
+        mFilters.erase(filter);
+    }
+    mOrderedFilters.erase(std::remove_if(mOrderedFilters.begin(), mOrderedFilters.end(), [&filters] (const std::string& filter)
+    {
+        return filters.count(filter) > 0;
+    }), mOrderedFilters.end());
+    return true;
 }
 
 bool MegaIgnoreFile::containsFilter(const std::string& filter) const
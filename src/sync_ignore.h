@@ -19,6 +19,7 @@
 
 #include <string>
 #include <set>
+#include <vector>
 
 namespace SyncIgnore
 {
@@ -26,24 +27,34 @@ namespace SyncIgnore
     {
         Show,
         Add,
-        Remove
+        Remove,
+        Test
     };
 
     struct Args
     {
         Action mAction;
         fs::path mMegaIgnoreDirPath;
-        std::set<std::string> mFilters;
+        std::vector<std::string> mFilters; // in the order they are added to the file
+
+        // Only for Test
+        std::vector<std::string> mTestPaths;
+        fs::path mTestPathsFile;
+        bool mTestSummaryOnly = false;
     };
 
     void executeCommand(const Args& args);
 
+    // Reads one filter per line, skipping empty lines and comments. Returns false if the file cannot be opened.
+    bool readFiltersFromFile(const fs::path& path, std::vector<std::string>& filters);
+
     std::string getFilterFromLegacyPattern(const std::string& pattern);
 }
 
 class MegaIgnoreFile
 {
     std::set<std::string> mFilters;
+    std::vector<std::string> mOrderedFilters; // as they appear in the file (their order matters to the sync engine)
     fs::path mPath;
     bool mValid;
 
@@ -61,8 +72,13 @@ public:
 
     bool isValid() const { return mValid; }
 
-    void addFilters(const std::set<std::string>& filters);
-    void removeFilters(const std::set<std::string>& filters);
+    // Appends the filters that are not already in the file, without rewriting it
+    bool addFilters(const std::vector<std::string>& filters);
+
+    // Rewrites the file without the given filters in a single step (the new contents replace the file atomically)
+    bool removeFilters(const std::set<std::string>& filters);
+
+    const std::vector<std::string>& getOrderedFilters() const { return mOrderedFilters; }
 
     bool containsFilter(const std::string& filter) const;
     std::string getFilterContents() const; // without comments, bom, etc.
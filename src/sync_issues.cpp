@@ -22,6 +22,8 @@
 #include "configurationmanager.h"
 #include "listeners.h"
 #include "megacmdutils.h"
+#include "deferred_single_trigger.h"
+#include "megacmd_sync_metrics.h"
 
 #ifdef MEGACMD_TESTING_CODE
     #include "../tests/common/Instruments.h"
@@ -116,16 +118,16 @@ class SyncIssuesRequestListener : public mega::SynchronousRequestListener
             SyncIssue syncIssue(*stall);
             syncIssues.mIssuesMap.emplace(syncIssue.getId(), std::move(syncIssue));
         }
-        onSyncIssuesChanged(syncIssues);
-
-        {
-            std::lock_guard lock(mSyncIssuesMtx);
-            mSyncIssues = std::move(syncIssues);
-        }
+        syncIssues.buildIndex(*api);
+        onSyncIssuesReceived(std::move(syncIssues));
     }
 
 protected:
-    virtual void onSyncIssuesChanged(const SyncIssueList& syncIssues) {}
+    virtual void onSyncIssuesReceived(SyncIssueList&& syncIssues)
+    {
+        std::lock_guard lock(mSyncIssuesMtx);
+        mSyncIssues = std::move(syncIssues);
+    }
 
 public:
     virtual ~SyncIssuesRequestListener() = default;
@@ -143,72 +145,48 @@ public:
 class SyncIssuesBroadcastListener : public SyncIssuesRequestListener
 {
     using SyncStalledChangedCb = std::function<void(unsigned int syncIssuesSize)>;
-    using Clock = std::chrono::high_resolution_clock;
-    using TimePoint = Clock::time_point;
+    using SyncIssuesReceivedCb = std::function<void(SyncIssueList&& syncIssues)>;
 
+    SyncIssuesReceivedCb mSyncIssuesReceivedCb;
     SyncStalledChangedCb mBroadcastSyncIssuesCb;
     unsigned int mSyncIssuesSize;
-    bool mRunning;
-    TimePoint mLastTriggerTime;
 
     std::mutex mDebouncerMtx;
-    std::condition_variable mDebouncerCv;
-    std::thread mDebouncerThread;
 
-    void onSyncIssuesChanged(const SyncIssueList& syncIssues) override
+    // Last, so that it's destroyed (waiting for any broadcast still running) before what the broadcast uses
+    DeferredSingleTrigger mBroadcastTrigger;
+
+    void onSyncIssuesReceived(SyncIssueList&& syncIssues) override
     {
         {
             std::lock_guard lock(mDebouncerMtx);
             mSyncIssuesSize = syncIssues.size();
-            mLastTriggerTime = Clock::now();
         }
+        mBroadcastTrigger.triggerDeferredSingleShot([this] { broadcast(); });
 
-        mDebouncerCv.notify_one();
+        // Unlike the broadcast, the list itself is made available right away
+        mSyncIssuesReceivedCb(std::move(syncIssues));
     }
 
-    void debouncerLoop()
+    void broadcast()
     {
-        while (true)
+        unsigned int syncIssuesSize;
         {
-            std::unique_lock lock(mDebouncerMtx);
-            bool stopOrTrigger = mDebouncerCv.wait_for(lock, std::chrono::milliseconds(20), [this]
-            {
-                constexpr auto minTriggerTime = std::chrono::milliseconds(300);
-                return !mRunning || Clock::now() - mLastTriggerTime > minTriggerTime;
-            });
-
-            if (!mRunning) // stop
-            {
-                return;
-            }
-
-            if (stopOrTrigger) // trigger
-            {
-                mBroadcastSyncIssuesCb(mSyncIssuesSize);
-                mLastTriggerTime = TimePoint::max();
-            }
+            std::lock_guard lock(mDebouncerMtx);
+            syncIssuesSize = mSyncIssuesSize;
         }
+        mBroadcastSyncIssuesCb(syncIssuesSize);
     }
 
 public:
-    template<typename BroadcastSyncIssuesCb>
-    SyncIssuesBroadcastListener(BroadcastSyncIssuesCb&& broadcastSyncIssuesCb) :
+    template<typename SyncIssuesReceivedCb, typename BroadcastSyncIssuesCb>
+    SyncIssuesBroadcastListener(SyncIssuesReceivedCb&& syncIssuesReceivedCb, BroadcastSyncIssuesCb&& broadcastSyncIssuesCb) :
+        mSyncIssuesReceivedCb(std::move(syncIssuesReceivedCb)),
         mBroadcastSyncIssuesCb(std::move(broadcastSyncIssuesCb)),
         mSyncIssuesSize(0),
-        mRunning(true),
-        mLastTriggerTime(TimePoint::max()),
-        mDebouncerThread([this] { debouncerLoop(); }) {}
-
-    virtual ~SyncIssuesBroadcastListener()
-    {
-        {
-            std::lock_guard lock(mDebouncerMtx);
-            mRunning = false;
-        }
+        mBroadcastTrigger(std::chrono::milliseconds(300)) {}
 
-        mDebouncerCv.notify_one();
-        mDebouncerThread.join();
-    }
+    virtual ~SyncIssuesBroadcastListener() = default;
 };
 
 template<bool isCloud>
@@ -545,6 +523,59 @@ std::vector<SyncIssue::PathProblem> SyncIssue::getPathProblems(mega::MegaApi& ap
     return pathProblems;
 }
 
+std::vector<mega::PathProblem> SyncIssue::getPathProblemTypes() const
+{
+    assert(mMegaStall);
+
+    std::vector<mega::PathProblem> pathProblemTypes;
+    for (bool isCloud : {false, true})
+    {
+        for (int i = 0; i < mMegaStall->pathCount(isCloud); ++i)
+        {
+            auto pathProblem = static_cast<mega::PathProblem>(std::max(0, mMegaStall->pathProblem(isCloud, i)));
+
+#ifdef MEGACMD_TESTING_CODE
+            auto pathProblemOpt = TI::Instance().testValue(TI::TestValue::SYNC_ISSUE_ENFORCE_PATH_PROBLEM);
+            if (pathProblemOpt)
+            {
+                pathProblem = static_cast<mega::PathProblem>(std::get<int64_t>(*pathProblemOpt));
+            }
+#endif
+            pathProblemTypes.push_back(pathProblem);
+        }
+    }
+    return pathProblemTypes;
+}
+
+bool SyncIssue::hasSameDetails(const SyncIssue& other) const
+{
+    assert(mMegaStall && other.mMegaStall);
+    if (mMegaStall->reason() != other.mMegaStall->reason())
+    {
+        return false;
+    }
+
+    for (bool isCloud : {false, true})
+    {
+        if (mMegaStall->pathCount(isCloud) != other.mMegaStall->pathCount(isCloud))
+        {
+            return false;
+        }
+
+        for (int i = 0; i < mMegaStall->pathCount(isCloud); ++i)
+        {
+            const char* path = mMegaStall->path(isCloud, i);
+            const char* otherPath = other.mMegaStall->path(isCloud, i);
+            if (mMegaStall->pathProblem(isCloud, i) != other.mMegaStall->pathProblem(isCloud, i)
+                || std::strcmp(path ? path : "", otherPath ? otherPath : ""))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 bool SyncIssue::belongsToSync(const mega::MegaSync& sync) const
 {
     const char* issueCloudPath = mMegaStall->path(true, 0);
@@ -576,17 +607,110 @@ SyncIssue const* SyncIssueList::getSyncIssue(const std::string& id) const
     return &it->second;
 }
 
-unsigned int SyncIssueList::getSyncIssuesCount(const mega::MegaSync& sync) const
+std::string_view SyncIssueChange::getTypeStr() const
+{
+    switch (mType)
+    {
+        case Type::ADDED: return "added";
+        case Type::REMOVED: return "removed";
+        case Type::CHANGED: return "changed";
+    }
+    assert(false);
+    return "<unsupported>";
+}
+
+std::vector<SyncIssueChange> SyncIssueList::diff(const SyncIssueList& previous, const SyncIssueList& current)
 {
-    unsigned int count = 0;
-    for (const auto& syncIssue : *this)
+    std::vector<SyncIssueChange> changes;
+
+    // Both maps are sorted by id: a single merge pass finds every difference
+    auto prevIt = previous.begin();
+    auto currIt = current.begin();
+    while (prevIt != previous.end() || currIt != current.end())
     {
-        if (syncIssue.second.belongsToSync(sync))
+        if (currIt == current.end() || (prevIt != previous.end() && prevIt->first < currIt->first))
+        {
+            changes.push_back({SyncIssueChange::Type::REMOVED, prevIt->first});
+            ++prevIt;
+        }
+        else if (prevIt == previous.end() || currIt->first < prevIt->first)
         {
-            ++count;
+            changes.push_back({SyncIssueChange::Type::ADDED, currIt->first});
+            ++currIt;
+        }
+        else
+        {
+            if (previous.getParentSyncBackupId(prevIt->first) != current.getParentSyncBackupId(currIt->first)
+                || !prevIt->second.hasSameDetails(currIt->second))
+            {
+                changes.push_back({SyncIssueChange::Type::CHANGED, currIt->first});
+            }
+            ++prevIt;
+            ++currIt;
         }
     }
-    return count;
+    return changes;
+}
+
+void SyncIssueList::buildIndex(mega::MegaApi& api)
+{
+    mParentSyncs.clear();
+    mSyncSummaries.clear();
+
+    std::unique_ptr<mega::MegaSyncList> syncList(api.getSyncs());
+    if (!syncList)
+    {
+        return;
+    }
+
+    for (const auto& [id, syncIssue] : mIssuesMap)
+    {
+        for (int i = 0; i < syncList->size(); ++i)
+        {
+            mega::MegaSync* sync = syncList->get(i);
+            assert(sync);
+
+            if (!syncIssue.belongsToSync(*sync))
+            {
+                continue;
+            }
+
+            const mega::MegaHandle backupId = sync->getBackupId();
+            mParentSyncs.emplace(id, backupId);
+
+            // Issues are visited in id order, so the ids of each summary end up sorted as well
+            auto& summary = mSyncSummaries[backupId];
+            summary.mIssueIds.push_back(id);
+            for (auto pathProblem : syncIssue.getPathProblemTypes())
+            {
+                ++summary.mPathProblemCounts[pathProblem];
+            }
+            break;
+        }
+    }
+}
+
+unsigned int SyncIssueList::getSyncIssuesCount(const mega::MegaSync& sync) const
+{
+    return getSyncIssuesCount(sync.getBackupId());
+}
+
+unsigned int SyncIssueList::getSyncIssuesCount(mega::MegaHandle backupId) const
+{
+    auto summary = getSyncSummary(backupId);
+    return summary ? static_cast<unsigned int>(summary->mIssueIds.size()) : 0;
+}
+
+mega::MegaHandle SyncIssueList::getParentSyncBackupId(const std::string& id) const
+{
+    auto it = mParentSyncs.find(id);
+    return it == mParentSyncs.end() ? mega::INVALID_HANDLE : it->second;
+}
+
+SyncIssueList::SyncSummary const* SyncIssueList::getSyncSummary(mega::MegaHandle backupId) const
+{
+    auto it = mSyncSummaries.find(backupId);
+    return it == mSyncSummaries.end() ? nullptr : &it->second;
 }
 
 void SyncIssuesManager::onSyncIssuesChanged(unsigned int newSyncIssuesSize)
@@ -606,8 +730,61 @@ void SyncIssuesManager::onSyncIssuesChanged(unsigned int newSyncIssuesSize)
 #endif
 }
 
+std::chrono::seconds SyncIssuesSnapshot::getAge() const
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - mRetrievalTime);
+}
+
+SyncIssuesSnapshotPtr SyncIssuesManager::publishSnapshot(SyncIssueList&& syncIssues)
+{
+    auto snapshot = std::make_shared<SyncIssuesSnapshot>();
+    snapshot->mSyncIssues = std::move(syncIssues);
+    snapshot->mVersion = ++mLastSnapshotVersion;
+    snapshot->mRetrievalTime = std::chrono::steady_clock::now();
+
+    SyncIssuesSnapshotPtr constSnapshot = std::move(snapshot);
+
+    // Lists can be received from several threads: never replace a newer one
+    auto current = std::atomic_load(&mSnapshot);
+    while (!current || current->mVersion < constSnapshot->mVersion)
+    {
+        if (std::atomic_compare_exchange_weak(&mSnapshot, &current, constSnapshot))
+        {
+            static const SyncIssueList noSyncIssues;
+            informSyncIssueChanges(current ? current->mSyncIssues : noSyncIssues, constSnapshot->mSyncIssues);
+            break;
+        }
+    }
+    return constSnapshot;
+}
+
+void SyncIssuesManager::informSyncIssueChanges(const SyncIssueList& previous, const SyncIssueList& current)
+{
+    for (const auto& change : SyncIssueList::diff(previous, current))
+    {
+        const bool removed = change.mType == SyncIssueChange::Type::REMOVED;
+        const SyncIssueList& syncIssues = removed ? previous : current;
+
+        auto syncIssue = syncIssues.getSyncIssue(change.mId);
+        assert(syncIssue);
+
+        const mega::MegaHandle backupId = syncIssues.getParentSyncBackupId(change.mId);
+        if (change.mType == SyncIssueChange::Type::ADDED && backupId != mega::INVALID_HANDLE)
+        {
+            SyncMetrics::getInstance().onStall(backupId);
+        }
+
+        // syncissue:<added|removed|changed>:<ISSUE_ID>:<PARENT_SYNC_ID or ->:<REASON>
+        std::string s = StateEventType + ":" + std::string(change.getTypeStr()) + ":" + change.mId + ":"
+                      + (backupId == mega::INVALID_HANDLE ? "-" : syncBackupIdToBase64(backupId)) + ":"
+                      + syncIssue->getSyncInfo(nullptr).mReason;
+        informSubscribedStateListeners(StateEventType, s);
+    }
+}
+
 SyncIssuesManager::SyncIssuesManager(mega::MegaApi *api) :
-    mApi(*api)
+    mApi(*api),
+    mLastSnapshotVersion(0)
 {
     // The global listener will be triggered whenever there's a change in the sync state
     // It'll request the sync issue list from the API (if the stalled state changed)
@@ -616,20 +793,32 @@ SyncIssuesManager::SyncIssuesManager(mega::MegaApi *api) :
          [this, api] { api->getMegaSyncStallList(mRequestListener.get()); });
 
     // The broadcast listener will be triggered whenever the api call above finishes
-    // getting the list of stalls; it'll be used to notify the user (and the integration tests)
+    // getting the list of stalls; it'll keep the snapshot served to commands up to date,
+    // and it'll be used to notify the user (and the integration tests)
     mRequestListener = std::make_unique<SyncIssuesBroadcastListener>(
+        [this] (SyncIssueList&& syncIssues) { publishSnapshot(std::move(syncIssues)); },
         [this] (unsigned int newSyncIssuesSize) { onSyncIssuesChanged(newSyncIssuesSize); });
 
     mWarningEnabled = ConfigurationManager::getConfigurationValue("stalled_issues_warning", true);
 }
 
-SyncIssueList SyncIssuesManager::getSyncIssues() const
+SyncIssuesSnapshotPtr SyncIssuesManager::getSyncIssues(bool refresh)
 {
+    if (!refresh)
+    {
+        // The global listener requests a new list every time the stalls change;
+        // as long as we have one, it's as fresh as a new request would be
+        if (auto snapshot = std::atomic_load(&mSnapshot))
+        {
+            return snapshot;
+        }
+    }
+
     auto listener = std::make_unique<SyncIssuesRequestListener>();
     mApi.getMegaSyncStallList(listener.get());
     listener->wait();
 
-    return listener->releaseSyncIssues();
+    return publishSnapshot(listener->releaseSyncIssues());
 }
 
 void SyncIssuesManager::disableWarning()
@@ -662,13 +851,23 @@ namespace SyncIssuesCommand
     {
         cd.addHeader("PARENT_SYNC", disablePathCollapse);
 
-        syncIssues.forEach([&api, &cd] (const SyncIssue& syncIssue)
+        // Issues usually pile up in a few syncs: avoid fetching the same one again and again
+        std::map<mega::MegaHandle, std::unique_ptr<mega::MegaSync>> parentSyncs;
+
+        syncIssues.forEach([&api, &cd, &syncIssues, &parentSyncs] (const SyncIssue& syncIssue)
         {
-            auto parentSync = syncIssue.getParentSync(api);
+            const mega::MegaHandle backupId = syncIssues.getParentSyncBackupId(syncIssue.getId());
+            auto it = parentSyncs.find(backupId);
+            if (it == parentSyncs.end())
+            {
+                std::unique_ptr<mega::MegaSync> sync(backupId == mega::INVALID_HANDLE ? nullptr : api.getSyncByBackupId(backupId));
+                it = parentSyncs.emplace(backupId, std::move(sync)).first;
+            }
+            const mega::MegaSync* parentSync = it->second.get();
 
             cd.addValue("ISSUE_ID", syncIssue.getId());
             cd.addValue("PARENT_SYNC", parentSync ? parentSync->getName() : "<not found>");
-            cd.addValue("REASON", syncIssue.getSyncInfo(parentSync.get()).mReason);
+            cd.addValue("REASON", syncIssue.getSyncInfo(parentSync).mReason);
         }, rowCountLimit);
 
         OUTSTREAM << cd.str();
@@ -681,6 +880,63 @@ namespace SyncIssuesCommand
         OUTSTREAM << "Use \"" << getCommandPrefixBasedOnMode() << "sync-issues --detail <ISSUE_ID>\" to get further details on a specific issue." << endl;
     }
 
+    void printSyncIssues(mega::MegaApi& api, ColumnDisplayer& cd, const SyncIssueList& syncIssues, const mega::MegaSync& sync, bool disablePathCollapse, int rowCountLimit)
+    {
+        const std::string syncId = syncBackupIdToBase64(sync.getBackupId());
+
+        auto summary = syncIssues.getSyncSummary(sync.getBackupId());
+        if (!summary)
+        {
+            OUTSTREAM << "There are no sync issues in sync " << syncId << endl;
+            return;
+        }
+
+        cd.addHeader("PARENT_SYNC", disablePathCollapse);
+
+        syncIssues.forEachInSync([&cd, &sync] (const SyncIssue& syncIssue)
+        {
+            cd.addValue("ISSUE_ID", syncIssue.getId());
+            cd.addValue("PARENT_SYNC", sync.getName());
+            cd.addValue("REASON", syncIssue.getSyncInfo(&sync).mReason);
+        }, sync.getBackupId(), rowCountLimit);
+
+        OUTSTREAM << cd.str();
+        OUTSTREAM << endl;
+
+        const unsigned int syncIssuesCount = static_cast<unsigned int>(summary->mIssueIds.size());
+        if (rowCountLimit < syncIssuesCount)
+        {
+            OUTSTREAM << "Note: showing " << rowCountLimit << " out of " << syncIssuesCount << " issues of sync " << syncId << ". "
+                      << "Use \"" << getCommandPrefixBasedOnMode() << "sync-issues --sync=" << syncId << " --limit=0\" to see all of them." << endl;
+        }
+
+        bool hasPathProblems = false;
+        for (const auto& [problem, count] : summary->mPathProblemCounts)
+        {
+            if (problem == mega::PathProblem::NoProblem)
+            {
+                continue;
+            }
+
+            if (!hasPathProblems)
+            {
+                OUTSTREAM << "Path problems in this sync:" << endl;
+                hasPathProblems = true;
+            }
+
+            SyncIssue::PathProblem pathProblem;
+            pathProblem.mProblem = problem;
+            OUTSTREAM << "  " << pathProblem.getProblemStr() << ": " << count << endl;
+        }
+        OUTSTREAM << "Use \"" << getCommandPrefixBasedOnMode() << "sync-issues --detail <ISSUE_ID>\" to get further details on a specific issue." << endl;
+    }
+
+    void printSnapshotAge(const SyncIssuesSnapshot& snapshot)
+    {
+        OUTSTREAM << "Sync issues retrieved " << secondsToText(snapshot.getAge().count()) << " ago. "
+                  << "Use \"" << getCommandPrefixBasedOnMode() << "sync-issues --refresh\" to request them again." << endl;
+    }
+
     void printSingleIssueDetail(mega::MegaApi& api, megacmd::ColumnDisplayer& cd, const SyncIssue& syncIssue, bool disablePathCollapse, int rowCountLimit)
     {
         auto parentSync = syncIssue.getParentSync(api);
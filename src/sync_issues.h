@@ -15,10 +15,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <cassert>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <string_view>
+#include <vector>
 
 #include "megaapi.h"
 #include "mega/types.h"
@@ -110,15 +115,51 @@ public:
     template<bool isCloud>
     std::vector<PathProblem> getPathProblems(mega::MegaApi& api) const;
 
+    // Only the problem types; unlike getPathProblems, it doesn't need to query nodes nor the filesystem
+    std::vector<mega::PathProblem> getPathProblemTypes() const;
+
     std::unique_ptr<mega::MegaSync> getParentSync(mega::MegaApi& api) const;
     bool belongsToSync(const mega::MegaSync& sync) const;
+
+    // Same reason, paths and path problems (i.e., what the user would see)
+    bool hasSameDetails(const SyncIssue& other) const;
+};
+
+struct SyncIssueChange
+{
+    enum class Type
+    {
+        ADDED,
+        REMOVED,
+        CHANGED
+    };
+
+    Type mType;
+    std::string mId;
+
+    std::string_view getTypeStr() const;
 };
 
 class SyncIssueList
 {
+public:
+    struct SyncSummary
+    {
+        std::vector<std::string> mIssueIds; // sorted, like the issue map
+        std::map<mega::PathProblem, unsigned int> mPathProblemCounts;
+    };
+
+private:
     using SyncIssuesMapT = std::map<std::string, SyncIssue>;
     SyncIssuesMapT mIssuesMap;
 
+    // Index by parent sync, built once when the list is populated so that
+    // queries per sync don't need to match every issue against every sync
+    std::map<std::string, mega::MegaHandle> mParentSyncs;
+    std::map<mega::MegaHandle, SyncSummary> mSyncSummaries;
+
+    void buildIndex(mega::MegaApi& api);
+
     friend class SyncIssuesRequestListener; // only one that can actually populate this
 
 public:
@@ -131,8 +172,34 @@ public:
         }
     }
 
+    // Like forEach, but only for the issues of the sync with the given backup id
+    template<typename Cb>
+    void forEachInSync(Cb&& callback, mega::MegaHandle backupId, size_t sizeLimit) const
+    {
+        auto summary = getSyncSummary(backupId);
+        if (!summary)
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < summary->mIssueIds.size() && i < sizeLimit; ++i)
+        {
+            auto syncIssue = getSyncIssue(summary->mIssueIds[i]);
+            assert(syncIssue);
+            callback(*syncIssue);
+        }
+    }
+
     SyncIssue const* getSyncIssue(const std::string& id) const;
     unsigned int getSyncIssuesCount(const mega::MegaSync& sync) const;
+    unsigned int getSyncIssuesCount(mega::MegaHandle backupId) const;
+
+    // Backup id of the sync the issue belongs to, or INVALID_HANDLE if it wasn't found when the list was populated
+    mega::MegaHandle getParentSyncBackupId(const std::string& id) const;
+    SyncSummary const* getSyncSummary(mega::MegaHandle backupId) const;
+
+    // Issues added, removed or changed (same id in both, with different details or parent sync) from previous to current
+    static std::vector<SyncIssueChange> diff(const SyncIssueList& previous, const SyncIssueList& current);
 
     bool empty() const { return mIssuesMap.empty(); }
     unsigned int size() const { return mIssuesMap.size(); }
@@ -141,22 +208,45 @@ public:
     SyncIssuesMapT::const_iterator end() const { return mIssuesMap.end(); }
 };
 
+// An immutable list of sync issues, shared by every command reading it while it's the latest one
+struct SyncIssuesSnapshot
+{
+    SyncIssueList mSyncIssues;
+    uint64_t mVersion = 0;
+    std::chrono::steady_clock::time_point mRetrievalTime;
+
+    std::chrono::seconds getAge() const;
+};
+
+using SyncIssuesSnapshotPtr = std::shared_ptr<const SyncIssuesSnapshot>;
+
 class SyncIssuesManager final
 {
     mega::MegaApi& mApi;
     bool mWarningEnabled;
     std::mutex mWarningMtx;
 
+    // Only accessed through std::atomic_load/atomic_store
+    SyncIssuesSnapshotPtr mSnapshot;
+    std::atomic<uint64_t> mLastSnapshotVersion;
+
     std::unique_ptr<mega::MegaGlobalListener> mGlobalListener;
     std::unique_ptr<mega::MegaRequestListener> mRequestListener;
 
 private:
     void onSyncIssuesChanged(unsigned int newSyncIssuesSize);
+    SyncIssuesSnapshotPtr publishSnapshot(SyncIssueList&& syncIssues);
+    void informSyncIssueChanges(const SyncIssueList& previous, const SyncIssueList& current);
 
 public:
+    // State listeners subscribed to this type receive one "syncissue:" state change per added/removed/changed issue
+    inline static const std::string StateEventType = "syncissue";
+
     SyncIssuesManager(mega::MegaApi *api);
 
-    SyncIssueList getSyncIssues() const;
+    // Returns the latest snapshot, kept up to date by the global listener. The list is only
+    // requested to the API if there's no snapshot yet, or if refresh is true.
+    SyncIssuesSnapshotPtr getSyncIssues(bool refresh = false);
 
     void disableWarning();
     void enableWarning();
@@ -167,6 +257,9 @@ public:
 namespace SyncIssuesCommand
 {
     void printAllIssues(mega::MegaApi& api, megacmd::ColumnDisplayer& cd, const SyncIssueList& syncIssues, bool disablePathCollapse, int rowCountLimit);
+    void printSyncIssues(mega::MegaApi& api, megacmd::ColumnDisplayer& cd, const SyncIssueList& syncIssues, const mega::MegaSync& sync, bool disablePathCollapse, int rowCountLimit);
+
+    void printSnapshotAge(const SyncIssuesSnapshot& snapshot);
 
     void printSingleIssueDetail(mega::MegaApi& api, megacmd::ColumnDisplayer& cd, const SyncIssue& syncIssue, bool disablePathCollapse, int rowCountLimit);
     void printAllIssuesDetail(mega::MegaApi& api, megacmd::ColumnDisplayer& cd, const SyncIssueList& syncIssues, bool disablePathCollapse, int rowCountLimit);
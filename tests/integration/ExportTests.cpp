@@ -257,3 +257,47 @@ TEST_F(ExportTest, PasswordProtected)
         EXPECT_THAT(rDisable.out(), testing::StartsWith("Disabled export: /" + file_path));
     }
 }
+
+TEST_F(ExportTest, Bulk)
+{
+    const std::string file_path = "testExportFile01.txt";
+    const std::string dir_path = "testExportFolder";
+
+    {
+        G_SUBTEST << "Adding";
+        auto rCreate = executeInClient({"export", "-a", "-f", "--bulk", "--max-in-flight=1", file_path, dir_path, "doesNotExist"});
+        ASSERT_FALSE(rCreate.ok());
+        EXPECT_THAT(rCreate.err(), testing::HasSubstr("Node not found: doesNotExist"));
+        EXPECT_THAT(rCreate.out(), ContainsStdRegex("/" + file_path + "\t" + megaFileLinkRegex));
+        EXPECT_THAT(rCreate.out(), ContainsStdRegex("/" + dir_path + "\t" + megaFolderLinkRegex));
+
+        // Both were exported regardless of the path that failed
+        EXPECT_TRUE(executeInClient({"export", file_path}).ok());
+        EXPECT_TRUE(executeInClient({"export", dir_path}).ok());
+    }
+
+    {
+        G_SUBTEST << "Already exported";
+        auto rCreate = executeInClient({"export", "-a", "-f", "--bulk", file_path});
+        ASSERT_FALSE(rCreate.ok());
+        EXPECT_THAT(rCreate.err(), testing::HasSubstr("is already exported"));
+    }
+
+    {
+        G_SUBTEST << "Deleting";
+        auto rDisable = executeInClient({"export", "-d", "--bulk", file_path, dir_path});
+        ASSERT_TRUE(rDisable.ok());
+        EXPECT_THAT(rDisable.out(), ContainsStdRegex("/" + file_path + "\t" + megaFileLinkRegex));
+        EXPECT_THAT(rDisable.out(), ContainsStdRegex("/" + dir_path + "\t" + megaFolderLinkRegex));
+
+        EXPECT_FALSE(executeInClient({"export", file_path}).ok());
+        EXPECT_FALSE(executeInClient({"export", dir_path}).ok());
+    }
+
+    {
+        G_SUBTEST << "Without -a or -d";
+        auto rList = executeInClient({"export", "--bulk", file_path});
+        ASSERT_FALSE(rList.ok());
+        EXPECT_THAT(rList.err(), testing::HasSubstr("Bulk mode requires either -a or -d"));
+    }
+}
@@ -179,6 +179,60 @@ TEST_F(SyncIgnoreTests, CannotRemoveIfDoesntExist)
     EXPECT_THAT(result.out(), testing::HasSubstr("it's not in the .megaignore file"));
 }
 
+TEST_F(SyncIgnoreTests, AddAndRemoveFromFile)
+{
+    std::string comment = "# Kept in the .megaignore file";
+    std::string existingFilter = "-:keep_me.txt";
+    writeToDefaultFile({comment, existingFilter});
+
+    std::vector<std::string> filters;
+    for (int i = 0; i < 200; ++i)
+    {
+        filters.push_back("-f:file_" + std::to_string(i) + ".tmp");
+    }
+
+    const fs::path filtersFilePath = mTmpDir.path() / "filters.txt";
+    {
+        std::ofstream filtersFile(filtersFilePath);
+        ASSERT_TRUE(filtersFile.is_open());
+        filtersFile << "# Comments and empty lines are ignored" << '\n' << '\n';
+        for (const std::string& filter : filters)
+        {
+            filtersFile << filter << '\n';
+        }
+    }
+
+    auto result = executeInClient({"sync-ignore", "--add", "--from-file=" + filtersFilePath.string(), "DEFAULT"});
+    ASSERT_TRUE(result.ok());
+    EXPECT_THAT(result.out(), testing::HasSubstr("Added filter " + qw(filters.front())));
+    EXPECT_THAT(result.out(), testing::HasSubstr("Added filter " + qw(filters.back())));
+
+    {
+        std::string contents;
+        readFromDefaultFile(contents);
+        EXPECT_THAT(contents, testing::HasSubstr(comment));
+
+        // Filters are appended in the same order as in the file
+        const auto firstPos = contents.find(filters.front());
+        const auto lastPos = contents.find(filters.back());
+        ASSERT_NE(firstPos, std::string::npos);
+        ASSERT_NE(lastPos, std::string::npos);
+        EXPECT_LT(contents.find(existingFilter), firstPos);
+        EXPECT_LT(firstPos, lastPos);
+    }
+
+    result = executeInClient({"sync-ignore", "--remove", "--from-file=" + filtersFilePath.string(), "DEFAULT"});
+    ASSERT_TRUE(result.ok());
+    EXPECT_THAT(result.out(), testing::HasSubstr("Removed filter " + qw(filters.front())));
+    EXPECT_THAT(result.out(), testing::HasSubstr("Removed filter " + qw(filters.back())));
+
+    std::string contents;
+    readFromDefaultFile(contents);
+    EXPECT_THAT(contents, testing::HasSubstr(comment));
+    EXPECT_THAT(contents, testing::HasSubstr(existingFilter));
+    EXPECT_THAT(contents, testing::Not(testing::HasSubstr(filters.front())));
+}
+
 TEST_F(SyncIgnoreTests, NonDefaultIgnoreFile)
 {
     std::string localDir = mTmpDir.string();
@@ -0,0 +1,144 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_fingerprint_cache.h"
+
+using megacmd::LocalFingerprintCache;
+using megacmd::getLocalFileInfo;
+
+namespace
+{
+    class FingerprintCacheTest : public ::testing::Test
+    {
+    protected:
+        fs::path mFolder;
+        fs::path mCacheFile;
+        unsigned mComputed = 0;
+
+        void SetUp() override
+        {
+            mFolder = fs::temp_directory_path() / ("megacmd_fingerprint_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+            fs::remove_all(mFolder);
+            fs::create_directories(mFolder);
+            mCacheFile = mFolder / "cache";
+        }
+
+        void TearDown() override
+        {
+            fs::remove_all(mFolder);
+        }
+
+        LocalFingerprintCache::ComputeFn countingCompute()
+        {
+            return [this](const fs::path& path)
+            {
+                mComputed++;
+                std::ifstream ifs(path);
+                std::string content;
+                std::getline(ifs, content);
+                return "fp-" + content;
+            };
+        }
+    };
+}
+
+TEST_F(FingerprintCacheTest, unchangedFilesAreNotRead)
+{
+    const fs::path file = mFolder / "file";
+    std::ofstream(file) << "one";
+
+    auto info = getLocalFileInfo(file);
+    ASSERT_TRUE(info);
+    EXPECT_EQ(info->mSize, 3);
+    EXPECT_FALSE(getLocalFileInfo(mFolder / "missing"));
+
+    {
+        LocalFingerprintCache cache(mCacheFile);
+        EXPECT_EQ(cache.getFingerprint(file, *info, countingCompute()), "fp-one");
+        EXPECT_EQ(cache.getFingerprint(file, *info, countingCompute()), "fp-one");
+        EXPECT_EQ(mComputed, 1u);
+        EXPECT_TRUE(cache.save());
+    }
+
+    G_SUBTEST << "Persisted across instances";
+    {
+        LocalFingerprintCache cache(mCacheFile);
+        EXPECT_EQ(cache.getFingerprint(file, *info, countingCompute()), "fp-one");
+        EXPECT_EQ(mComputed, 1u);
+    }
+
+    G_SUBTEST << "Modified files are read again";
+    {
+        LocalFingerprintCache cache(mCacheFile);
+        auto modified = *info;
+        modified.mMtime++;
+        EXPECT_EQ(cache.getFingerprint(file, modified, countingCompute()), "fp-one");
+        EXPECT_EQ(mComputed, 2u);
+    }
+
+    G_SUBTEST << "Rewritten within the same second";
+    {
+        LocalFingerprintCache cache(mCacheFile);
+        auto rewritten = *info;
+        rewritten.mMtimeNanos = (rewritten.mMtimeNanos + 1) % 1000000000;
+        cache.getFingerprint(file, rewritten, countingCompute());
+        EXPECT_EQ(mComputed, 3u);
+    }
+
+    G_SUBTEST << "Same inode in another device";
+    {
+        LocalFingerprintCache cache(mCacheFile);
+        auto elsewhere = *info;
+        elsewhere.mDevice++;
+        cache.getFingerprint(file, elsewhere, countingCompute());
+        EXPECT_EQ(mComputed, 4u);
+    }
+}
+
+TEST_F(FingerprintCacheTest, unusedEntriesDroppedWhenFull)
+{
+    {
+        LocalFingerprintCache cache(mCacheFile, 2);
+        for (uint64_t inode = 1; inode <= 3; ++inode)
+        {
+            cache.getFingerprint(mFolder, {inode, 0, 0}, [](const fs::path&) { return std::string("fp"); });
+        }
+        EXPECT_TRUE(cache.save());
+    }
+
+    G_SUBTEST << "All entries used in the session are kept";
+    {
+        LocalFingerprintCache cache(mCacheFile, 2);
+        cache.getFingerprint(mFolder, {3, 0, 0}, countingCompute());
+        cache.getFingerprint(mFolder, {4, 0, 0}, [](const fs::path&) { return std::string("fp"); });
+        EXPECT_EQ(mComputed, 0u);
+        EXPECT_TRUE(cache.save());
+    }
+
+    G_SUBTEST << "The ones not used are dropped";
+    {
+        LocalFingerprintCache cache(mCacheFile, 2);
+        cache.getFingerprint(mFolder, {3, 0, 0}, countingCompute());
+        cache.getFingerprint(mFolder, {4, 0, 0}, countingCompute());
+        EXPECT_EQ(mComputed, 0u);
+        cache.getFingerprint(mFolder, {1, 0, 0}, [this](const fs::path&) { mComputed++; return std::string("fp"); });
+        EXPECT_EQ(mComputed, 1u);
+    }
+}
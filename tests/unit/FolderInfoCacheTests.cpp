@@ -0,0 +1,85 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_folder_info_cache.h"
+
+using megacmd::FolderInfoCache;
+
+TEST(FolderInfoCacheTest, updates)
+{
+    FolderInfoCache cache;
+    EXPECT_TRUE(cache.empty());
+
+    cache.set(1, {10, 2, 1000, 1500}, cache.getGeneration());
+    cache.set(2, {5, 1, 500, 500}, cache.getGeneration());
+    ASSERT_TRUE(cache.get(1));
+    EXPECT_EQ(cache.get(1)->mFiles, 10);
+    EXPECT_FALSE(cache.get(3));
+
+    G_SUBTEST << "Deltas are applied to cached ancestors";
+    {
+        cache.applyDelta({3, 2, 1}, {1, 0, 100, 100});
+        cache.applyDelta({2, 1}, {0, 1, 0, 0});
+        EXPECT_EQ(cache.get(1)->mFiles, 11);
+        EXPECT_EQ(cache.get(1)->mFolders, 3);
+        EXPECT_EQ(cache.get(1)->mSize, 1100);
+        EXPECT_EQ(cache.get(1)->mSizeWithVersions, 1600);
+        EXPECT_EQ(cache.get(2)->mFiles, 6);
+        EXPECT_FALSE(cache.get(3));
+    }
+
+    G_SUBTEST << "Versions only count in the size with versions";
+    {
+        cache.applyDelta({1}, {0, 0, 0, -200});
+        EXPECT_EQ(cache.get(1)->mSize, 1100);
+        EXPECT_EQ(cache.get(1)->mSizeWithVersions, 1400);
+    }
+
+    G_SUBTEST << "Inconsistent values are dropped";
+    {
+        cache.applyDelta({2}, {-7, 0, 0, 0});
+        EXPECT_FALSE(cache.get(2));
+        EXPECT_TRUE(cache.get(1));
+
+        cache.applyDelta({1}, {0, 0, 0, -500}); // less than the current versions
+        EXPECT_FALSE(cache.get(1));
+    }
+
+    G_SUBTEST << "Invalidation";
+    {
+        cache.set(1, {10, 2, 1000, 1500}, cache.getGeneration());
+        cache.invalidate({1});
+        EXPECT_TRUE(cache.empty());
+    }
+}
+
+TEST(FolderInfoCacheTest, valuesObtainedBeforeAnUpdateAreNotCached)
+{
+    FolderInfoCache cache;
+    const auto generation = cache.getGeneration();
+
+    cache.applyDelta({1}, {1, 0, 10, 10}); // the update arrives while the value is being fetched
+    cache.set(1, {10, 2, 100, 100}, generation);
+    EXPECT_FALSE(cache.get(1));
+
+    cache.set(1, {11, 2, 110, 110}, cache.getGeneration());
+    EXPECT_TRUE(cache.get(1));
+
+    cache.clear();
+    EXPECT_FALSE(cache.get(1));
+}
@@ -0,0 +1,245 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <future>
+
+#include "TestUtils.h"
+#include "megacmd_folder_link_cache.h"
+
+using megacmd::FolderLinkApiCache;
+using namespace std::chrono_literals;
+
+namespace
+{
+    // The cache never dereferences the instances, so any distinct addresses will do
+    class FakeApis
+    {
+        std::vector<char> mStorage;
+    public:
+        FakeApis(size_t count) : mStorage(count) {}
+        mega::MegaApi* get(size_t i) { return reinterpret_cast<mega::MegaApi*>(&mStorage[i]); }
+    };
+
+    struct CacheWithResets
+    {
+        std::vector<mega::MegaApi*> mResets;
+        FolderLinkApiCache mCache;
+
+        CacheWithResets(FolderLinkApiCache::Clock::duration idleExpiry) :
+            mCache(idleExpiry, [this](mega::MegaApi* api) { mResets.push_back(api); }) {}
+    };
+}
+
+TEST(FolderLinkCacheTest, hitsAndLruEviction)
+{
+    FakeApis apis(2);
+    CacheWithResets c(10min);
+    c.mCache.add(apis.get(0));
+    c.mCache.add(apis.get(1));
+
+    const auto t0 = FolderLinkApiCache::Clock::now();
+
+    auto a = c.mCache.acquire("A", t0);
+    EXPECT_FALSE(a.mHit);
+    c.mCache.release(a.mApi, "A", true, t0);
+
+    auto b = c.mCache.acquire("B", t0 + 1s);
+    EXPECT_FALSE(b.mHit);
+    EXPECT_NE(a.mApi, b.mApi);
+    c.mCache.release(b.mApi, "B", true, t0 + 1s);
+
+    {
+        G_SUBTEST << "Same link is a hit";
+        auto again = c.mCache.acquire("A", t0 + 2s);
+        EXPECT_TRUE(again.mHit);
+        EXPECT_EQ(again.mApi, a.mApi);
+        c.mCache.release(again.mApi, "A", true, t0 + 2s);
+    }
+
+    {
+        G_SUBTEST << "New link evicts the least recently used";
+        auto other = c.mCache.acquire("C", t0 + 3s);
+        EXPECT_FALSE(other.mHit);
+        EXPECT_EQ(other.mApi, b.mApi);
+        ASSERT_EQ(c.mResets.size(), 1u);
+        EXPECT_EQ(c.mResets[0], b.mApi);
+        c.mCache.release(other.mApi, "C", false, t0 + 3s); // failed to log in
+    }
+
+    {
+        G_SUBTEST << "Unbound instances are preferred over evictions";
+        auto other = c.mCache.acquire("D", t0 + 4s);
+        EXPECT_EQ(other.mApi, b.mApi);
+        EXPECT_EQ(c.mResets.size(), 1u);
+        c.mCache.release(other.mApi, "D", true, t0 + 4s);
+    }
+
+    auto stats = c.mCache.getStats();
+    EXPECT_EQ(stats.mHits, 1u);
+    EXPECT_EQ(stats.mMisses, 4u);
+    EXPECT_EQ(stats.mEvictions, 1u);
+    EXPECT_EQ(stats.mInstances, 2u);
+    EXPECT_EQ(stats.mBound, 2u);
+    EXPECT_EQ(stats.mInUse, 0u);
+}
+
+TEST(FolderLinkCacheTest, idleExpiry)
+{
+    FakeApis apis(2);
+    CacheWithResets c(60s);
+    c.mCache.add(apis.get(0));
+    c.mCache.add(apis.get(1));
+
+    const auto t0 = FolderLinkApiCache::Clock::now();
+    EXPECT_FALSE(c.mCache.getNextExpiry());
+
+    auto a = c.mCache.acquire("A", t0);
+    c.mCache.release(a.mApi, "A", true, t0);
+    auto b = c.mCache.acquire("B", t0 + 30s);
+    c.mCache.release(b.mApi, "B", true, t0 + 30s);
+
+    ASSERT_TRUE(c.mCache.getNextExpiry());
+    EXPECT_EQ(*c.mCache.getNextExpiry(), t0 + 60s);
+
+    EXPECT_EQ(c.mCache.expireIdle(t0 + 59s), 0u);
+    EXPECT_EQ(c.mCache.expireIdle(t0 + 60s), 1u);
+    ASSERT_EQ(c.mResets.size(), 1u);
+    EXPECT_EQ(c.mResets[0], a.mApi);
+    EXPECT_EQ(*c.mCache.getNextExpiry(), t0 + 90s);
+
+    EXPECT_FALSE(c.mCache.acquire("A", t0 + 61s).mHit);
+    EXPECT_EQ(c.mCache.getStats().mExpirations, 1u);
+}
+
+TEST(FolderLinkCacheTest, cachingDisabled)
+{
+    FakeApis apis(1);
+    CacheWithResets c(0s);
+    c.mCache.add(apis.get(0));
+
+    auto a = c.mCache.acquire("A");
+    c.mCache.release(a.mApi, "A", true);
+    EXPECT_EQ(c.mResets.size(), 1u);
+    EXPECT_FALSE(c.mCache.acquire("A").mHit);
+}
+
+TEST(FolderLinkCacheTest, waitsForFreeInstance)
+{
+    FakeApis apis(1);
+    CacheWithResets c(10min);
+
+    EXPECT_EQ(c.mCache.acquire("A").mApi, nullptr);
+
+    c.mCache.add(apis.get(0));
+    auto a = c.mCache.acquire("A");
+
+    auto waiter = std::async(std::launch::async, [&c] { return c.mCache.acquire("A"); });
+    EXPECT_EQ(waiter.wait_for(50ms), std::future_status::timeout);
+
+    c.mCache.release(a.mApi, "A", true);
+    auto second = waiter.get();
+    EXPECT_TRUE(second.mHit);
+    EXPECT_EQ(second.mApi, a.mApi);
+}
+
+TEST(FolderLinkCacheTest, keys)
+{
+    EXPECT_EQ(FolderLinkApiCache::getKey("https://mega.nz/folder/abcd1234#KeyKey-_"), "https://mega.nz/folder/abcd1234#KeyKey-_");
+    EXPECT_EQ(FolderLinkApiCache::getKey("https://mega.nz/folder/abcd1234#KeyKey-_/folder/sub12345"), "https://mega.nz/folder/abcd1234#KeyKey-_");
+    EXPECT_EQ(FolderLinkApiCache::getKey("https://mega.nz/folder/abcd1234#KeyKey-_/file/sub12345"), "https://mega.nz/folder/abcd1234#KeyKey-_");
+    EXPECT_EQ(FolderLinkApiCache::getKey("https://mega.nz/#F!abcd1234!KeyKey-_"), "https://mega.nz/#F!abcd1234!KeyKey-_");
+    EXPECT_EQ(FolderLinkApiCache::getKey("https://mega.nz/#F!abcd1234!KeyKey-_!sub12345"), "https://mega.nz/#F!abcd1234!KeyKey-_");
+    EXPECT_EQ(FolderLinkApiCache::getKey("https://mega.nz/#F!abcd1234!KeyKey-_?sub12345"), "https://mega.nz/#F!abcd1234!KeyKey-_");
+}
+
+TEST(FolderLinkCacheTest, elasticPool)
+{
+    FakeApis apis(4);
+    std::vector<size_t> createdSlots;
+    std::vector<mega::MegaApi*> destroyed;
+
+    CacheWithResets c(60s);
+    FolderLinkApiCache::Limits limits;
+    limits.mMin = 1;
+    limits.mMax = 3;
+    limits.mReclaimAfter = 120s;
+    c.mCache.setElastic(limits,
+                        [&apis, &createdSlots](size_t slot) { createdSlots.push_back(slot); return apis.get(slot); },
+                        [&destroyed](mega::MegaApi* api) { destroyed.push_back(api); });
+
+    {
+        G_SUBTEST << "The minimum is created right away";
+        ASSERT_EQ(createdSlots.size(), 1u);
+        EXPECT_EQ(c.mCache.getStats().mInstances, 1u);
+    }
+
+    const auto t0 = FolderLinkApiCache::Clock::now();
+    auto a = c.mCache.acquire("A", t0);
+    auto b = c.mCache.acquire("B", t0);
+    auto d = c.mCache.acquire("D", t0);
+
+    {
+        G_SUBTEST << "Instances are created on demand, up to the maximum, each in its own slot";
+        EXPECT_EQ(createdSlots, (std::vector<size_t>{0, 1, 2}));
+        EXPECT_EQ(c.mCache.getStats().mPeakInstances, 3u);
+        EXPECT_TRUE(c.mResets.empty());
+    }
+
+    {
+        G_SUBTEST << "Once at the maximum, acquisitions wait and the wait is measured";
+        auto waiter = std::async(std::launch::async, [&c, t0] { return c.mCache.acquire("E", t0); });
+        EXPECT_EQ(waiter.wait_for(20ms), std::future_status::timeout);
+        c.mCache.release(d.mApi, "D", false, t0);
+        auto e = waiter.get();
+        EXPECT_EQ(e.mApi, d.mApi);
+        EXPECT_GE(e.mWaited, 20ms);
+        c.mCache.release(e.mApi, "E", false, t0);
+
+        auto stats = c.mCache.getStats();
+        EXPECT_EQ(stats.mWaits, 1u);
+        EXPECT_GE(stats.mMaxWait, 20ms);
+        EXPECT_EQ(stats.mTotalWait, stats.mMaxWait);
+    }
+
+    c.mCache.release(a.mApi, "A", true, t0);
+    c.mCache.release(b.mApi, "B", false, t0);
+
+    {
+        G_SUBTEST << "Idle unbound instances are reclaimed down to the minimum";
+        EXPECT_EQ(*c.mCache.getNextExpiry(), t0 + 60s);
+        EXPECT_EQ(c.mCache.expireIdle(t0 + 60s), 1u); // A is logged out
+        EXPECT_EQ(c.mResets, (std::vector<mega::MegaApi*>{a.mApi}));
+        EXPECT_TRUE(destroyed.empty());
+
+        EXPECT_EQ(c.mCache.expireIdle(t0 + 120s), 2u); // B and D are destroyed
+        EXPECT_EQ(destroyed.size(), 2u);
+        EXPECT_EQ(c.mCache.getStats().mInstances, 1u);
+
+        EXPECT_EQ(c.mCache.expireIdle(t0 + 1h), 0u); // A is kept as the minimum
+        EXPECT_FALSE(c.mCache.getNextExpiry());
+        EXPECT_EQ(c.mCache.getStats().mDestroyed, 2u);
+    }
+
+    {
+        G_SUBTEST << "Freed slots are reused";
+        auto x = c.mCache.acquire("X");
+        auto y = c.mCache.acquire("Y");
+        EXPECT_EQ(createdSlots.back(), 1u);
+        c.mCache.release(x.mApi, "X", false);
+        c.mCache.release(y.mApi, "Y", false);
+    }
+}
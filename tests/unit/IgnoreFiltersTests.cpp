@@ -0,0 +1,137 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_ignore_filters.h"
+
+using megacmd::IgnoreFilters;
+using megacmd::IgnoreFiltersEvaluator;
+
+namespace
+{
+    std::unique_ptr<IgnoreFilters> compile(const std::vector<std::string>& filters)
+    {
+        std::string error;
+        auto compiled = IgnoreFilters::compile(filters, error);
+        EXPECT_TRUE(compiled) << error;
+        return compiled;
+    }
+}
+
+TEST(IgnoreFiltersTest, InvalidFilters)
+{
+    for (const std::string filter : {"", "*.tmp", "-x:a", "-:", "-fdG:a", "-r:cache[0-9"})
+    {
+        G_SUBTEST << "Filter \"" << filter << "\"";
+        std::string error;
+        EXPECT_FALSE(IgnoreFilters::compile({filter}, error));
+        EXPECT_FALSE(error.empty());
+    }
+}
+
+TEST(IgnoreFiltersTest, Matching)
+{
+    auto filters = compile({"-g:*.tmp", "-:Thumbs.db", "-d:build", "-fp:docs/*.pdf", "-N:top", "-r:cache[0-9]+", "-g:draft*", "-:[ab]?c", "-:file[1].txt"});
+    ASSERT_TRUE(filters);
+    IgnoreFiltersEvaluator evaluator(*filters);
+
+    G_SUBTEST << "Case insensitive globs";
+    EXPECT_TRUE(evaluator.evaluate("a/b/file.TMP", false).mExcluded);
+    EXPECT_TRUE(evaluator.evaluate("Draft-1.txt", false).mExcluded);
+    EXPECT_FALSE(evaluator.evaluate("file.txt", false).mExcluded);
+
+    G_SUBTEST << "Case sensitive globs by default";
+    EXPECT_TRUE(evaluator.evaluate("pics/Thumbs.db", false).mExcluded);
+    EXPECT_FALSE(evaluator.evaluate("pics/thumbs.db", false).mExcluded);
+
+    G_SUBTEST << "Brackets are not wildcards";
+    EXPECT_TRUE(evaluator.evaluate("x/[ab]zc", false).mExcluded);
+    EXPECT_FALSE(evaluator.evaluate("x/bzc", false).mExcluded);
+    EXPECT_TRUE(evaluator.evaluate("x/file[1].txt", false).mExcluded);
+    EXPECT_FALSE(evaluator.evaluate("x/file1.txt", false).mExcluded);
+
+    G_SUBTEST << "Targets";
+    EXPECT_TRUE(evaluator.evaluate("src/build", true).mExcluded);
+    EXPECT_FALSE(evaluator.evaluate("src/build", false).mExcluded);
+
+    G_SUBTEST << "Paths and direct children";
+    EXPECT_TRUE(evaluator.evaluate("docs/manual.pdf", false).mExcluded);
+    EXPECT_FALSE(evaluator.evaluate("other/manual.pdf", false).mExcluded);
+    EXPECT_TRUE(evaluator.evaluate("top", false).mExcluded);
+    EXPECT_FALSE(evaluator.evaluate("sub/top", false).mExcluded);
+
+    G_SUBTEST << "Regular expressions";
+    EXPECT_TRUE(evaluator.evaluate("x/CACHE12", false).mExcluded);
+    EXPECT_FALSE(evaluator.evaluate("x/cache12b", false).mExcluded);
+
+    G_SUBTEST << "Excluded ancestors";
+    auto result = evaluator.evaluate("src/build/out/main.o", false);
+    EXPECT_TRUE(result.mExcluded);
+    EXPECT_EQ(result.mExcludedAncestor, "src/build");
+    EXPECT_EQ(filters->getFilter(result.mFilterIndex), "-d:build");
+}
+
+TEST(IgnoreFiltersTest, LastMatchingFilterWins)
+{
+    auto filters = compile({"-g:*.log", "+:keep.log", "-:KEEP.LOG"});
+    ASSERT_TRUE(filters);
+    IgnoreFiltersEvaluator evaluator(*filters);
+
+    EXPECT_TRUE(evaluator.evaluate("a.log", false).mExcluded);
+
+    auto result = evaluator.evaluate("keep.log", false);
+    EXPECT_FALSE(result.mExcluded);
+    EXPECT_EQ(result.mFilterIndex, 1);
+
+    result = evaluator.evaluate("KEEP.LOG", false);
+    EXPECT_TRUE(result.mExcluded);
+    EXPECT_EQ(result.mFilterIndex, 2);
+
+    result = evaluator.evaluate("other.txt", false);
+    EXPECT_FALSE(result.mExcluded);
+    EXPECT_EQ(result.mFilterIndex, -1);
+
+    G_SUBTEST << "Repeated filters";
+    auto repeated = compile({"-:foo", "+:foo", "-:foo"});
+    ASSERT_TRUE(repeated);
+    result = IgnoreFiltersEvaluator(*repeated).evaluate("foo", false);
+    EXPECT_TRUE(result.mExcluded);
+    EXPECT_EQ(result.mFilterIndex, 2);
+}
+
+TEST(IgnoreFiltersTest, ManyFilters)
+{
+    std::vector<std::string> filterTexts;
+    for (int i = 0; i < 500; ++i)
+    {
+        filterTexts.push_back("-:name" + std::to_string(i));
+        filterTexts.push_back("-:*.ext" + std::to_string(i));
+    }
+    auto filters = compile(filterTexts);
+    ASSERT_TRUE(filters);
+
+    IgnoreFiltersEvaluator evaluator(*filters);
+    constexpr size_t numPaths = 200000;
+    size_t excluded = 0;
+
+    for (size_t i = 0; i < numPaths; ++i)
+    {
+        const std::string path = "root/folder" + std::to_string(i / 1000) + "/file" + std::to_string(i) + ".ext" + std::to_string(i % 1000);
+        excluded += evaluator.evaluate(path, false).mExcluded;
+    }
+    EXPECT_EQ(excluded, numPaths / 2);
+}
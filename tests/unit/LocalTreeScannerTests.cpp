@@ -0,0 +1,124 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <fstream>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_local_scanner.h"
+
+using megacmd::LocalTreeScanner;
+
+namespace
+{
+    class LocalTreeScannerTest : public ::testing::Test
+    {
+    protected:
+        fs::path mRoot;
+
+        void SetUp() override
+        {
+            mRoot = fs::temp_directory_path() / ("megacmd_scanner_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+            fs::remove_all(mRoot);
+            for (int i = 0; i < 5; ++i)
+            {
+                const fs::path folder = mRoot / ("folder" + std::to_string(i)) / "nested";
+                fs::create_directories(folder);
+                for (int j = 0; j < 20; ++j)
+                {
+                    std::ofstream(folder / ("file" + std::to_string(j))) << j;
+                }
+            }
+            std::ofstream(mRoot / "topfile") << "content";
+#ifndef _WIN32
+            fs::create_directory_symlink(mRoot / "folder0", mRoot / "link");
+#endif
+        }
+
+        void TearDown() override
+        {
+            fs::remove_all(mRoot);
+        }
+    };
+}
+
+TEST_F(LocalTreeScannerTest, AllEntriesAreHandedOutParentsFirst)
+{
+    for (unsigned numThreads : {1u, 4u})
+    {
+        G_SUBTEST << "With " << numThreads << " threads";
+
+        // A tiny queue forces scanners to wait for the consumer
+        LocalTreeScanner scanner(mRoot, numThreads, 3);
+
+        std::set<fs::path> seenFolders;
+        size_t files = 0;
+        size_t symlinks = 0;
+        while (auto entry = scanner.next())
+        {
+            if (entry->mPath != mRoot)
+            {
+                EXPECT_TRUE(seenFolders.count(entry->mPath.parent_path())) << entry->mPath;
+            }
+
+            if (entry->mIsSymlink)
+            {
+                EXPECT_FALSE(entry->mIsFolder);
+                symlinks++;
+            }
+            else if (entry->mIsFolder)
+            {
+                seenFolders.insert(entry->mPath);
+            }
+            else
+            {
+                files++;
+            }
+        }
+
+        EXPECT_EQ(seenFolders.size(), 11u);
+        EXPECT_EQ(files, 101u);
+
+        auto stats = scanner.getStats();
+        EXPECT_EQ(stats.mFolders, 11u);
+        EXPECT_EQ(stats.mFiles, 101u);
+#ifndef _WIN32
+        G_SUBTEST << "Symbolic links are reported, not followed";
+        EXPECT_EQ(symlinks, 1u);
+        EXPECT_EQ(stats.mSymlinks, 1u);
+#endif
+        EXPECT_EQ(stats.mErrors, 0u);
+    }
+}
+
+TEST_F(LocalTreeScannerTest, SingleFileAndEarlyDestruction)
+{
+    {
+        G_SUBTEST << "Single file";
+        LocalTreeScanner scanner(mRoot / "topfile", 4);
+        auto entry = scanner.next();
+        ASSERT_TRUE(entry);
+        EXPECT_FALSE(entry->mIsFolder);
+        EXPECT_FALSE(scanner.next());
+    }
+
+    {
+        G_SUBTEST << "Destroyed before consuming everything";
+        LocalTreeScanner scanner(mRoot, 4, 1);
+        EXPECT_TRUE(scanner.next());
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "TestUtils.h"
+#include "megacmd_mutation_batch.h"
+
+using megacmd::MutationBatch;
+using namespace std::chrono_literals;
+
+TEST(MutationBatchTest, boundedInFlight)
+{
+    constexpr size_t maxInFlight = 3;
+    MutationBatch batch(maxInFlight);
+
+    std::atomic<size_t> inFlight{0};
+    std::atomic<size_t> peakInFlight{0};
+    std::vector<std::thread> requests;
+    for (int i = 0; i < 20; ++i)
+    {
+        batch.add("node" + std::to_string(i), [&](MutationBatch::Finish&& finish)
+        {
+            const size_t current = ++inFlight;
+            size_t peak = peakInFlight;
+            while (current > peak && !peakInFlight.compare_exchange_weak(peak, current)) {}
+
+            // Like the SDK, finish from another thread
+            requests.emplace_back([&inFlight, finish = std::move(finish)]()
+            {
+                std::this_thread::sleep_for(2ms);
+                --inFlight;
+                finish(0);
+            });
+        });
+    }
+
+    std::vector<size_t> progress;
+    auto result = batch.run([&progress](size_t finished, size_t total)
+    {
+        EXPECT_EQ(total, 20u);
+        progress.push_back(finished);
+    });
+
+    for (auto& request : requests)
+    {
+        request.join();
+    }
+
+    EXPECT_EQ(result.mSucceeded, 20u);
+    EXPECT_TRUE(result.mFailures.empty());
+    EXPECT_LE(peakInFlight.load(), maxInFlight);
+    EXPECT_GT(peakInFlight.load(), 1u);
+
+    {
+        G_SUBTEST << "Progress only goes forward, up to the total";
+        ASSERT_FALSE(progress.empty());
+        EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+        EXPECT_EQ(std::adjacent_find(progress.begin(), progress.end()), progress.end());
+        EXPECT_EQ(progress.back(), 20u);
+    }
+
+    EXPECT_TRUE(batch.empty());
+}
+
+TEST(MutationBatchTest, failuresAreAggregated)
+{
+    MutationBatch batch(2);
+    for (int i = 0; i < 6; ++i)
+    {
+        // Finished synchronously, as when a request fails before being sent
+        batch.add("node" + std::to_string(i), [i](MutationBatch::Finish&& finish) { finish(i % 3 ? 0 : -9); });
+    }
+
+    auto result = batch.run();
+    EXPECT_EQ(result.mSucceeded, 4u);
+    ASSERT_EQ(result.mFailures.size(), 2u);
+    EXPECT_EQ(result.mFailures[0].mDescription, "node0");
+    EXPECT_EQ(result.mFailures[0].mErrorCode, -9);
+    EXPECT_EQ(result.mFailures[1].mDescription, "node3");
+}
+
+TEST(MutationBatchTest, empty)
+{
+    MutationBatch batch(0); // the window is at least one
+    bool progressed = false;
+    auto result = batch.run([&progressed](size_t, size_t) { progressed = true; });
+    EXPECT_EQ(result.mSucceeded, 0u);
+    EXPECT_TRUE(result.mFailures.empty());
+    EXPECT_FALSE(progressed);
+}
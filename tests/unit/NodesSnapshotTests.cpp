@@ -0,0 +1,151 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_nodes_snapshot.h"
+#include "megacmd_shared_nodes_index.h"
+
+using megacmd::NodesSnapshot;
+using megacmd::SharedNodesIndex;
+using namespace std::chrono_literals;
+
+namespace
+{
+    class NodesSnapshotTest : public ::testing::Test
+    {
+    protected:
+        fs::path mFolder;
+        fs::path mSnapshotFile;
+
+        void SetUp() override
+        {
+            mFolder = fs::temp_directory_path() / ("megacmd_nodes_snapshot_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+            fs::remove_all(mFolder);
+            fs::create_directories(mFolder);
+            mSnapshotFile = mFolder / "nodes_snapshot";
+        }
+
+        void TearDown() override
+        {
+            fs::remove_all(mFolder);
+        }
+
+        static NodesSnapshot::Entry entry(const std::string& path, uint8_t kinds, std::optional<megacmd::FolderInfoCache::Counts> counts = {})
+        {
+            NodesSnapshot::Entry e;
+            e.mPath = path;
+            e.mSharedKinds = kinds;
+            e.mFolderCounts = counts;
+            return e;
+        }
+    };
+}
+
+TEST_F(NodesSnapshotTest, writeAndRead)
+{
+    const auto takenAt = NodesSnapshot::Clock::time_point(std::chrono::seconds(1700000000));
+    NodesSnapshot::Entries entries;
+    entries[1] = entry("/b", SharedNodesIndex::EXPORTED);
+    entries[2] = entry("/a/with spaces", SharedNodesIndex::SHARED | SharedNodesIndex::EXPORTED, megacmd::FolderInfoCache::Counts{3, 1, 300, 450});
+    entries[3] = entry("//in/x", 0, megacmd::FolderInfoCache::Counts{0, 0, 0, 0});
+    entries[4] = entry("/broken\nname", SharedNodesIndex::EXPORTED);
+
+    ASSERT_TRUE(NodesSnapshot(mSnapshotFile).write(entries, takenAt));
+    EXPECT_FALSE(fs::exists(mSnapshotFile.string() + ".tmp"));
+
+    NodesSnapshot snapshot(mSnapshotFile);
+    EXPECT_FALSE(snapshot.isLoaded());
+    ASSERT_TRUE(snapshot.read());
+    EXPECT_TRUE(snapshot.isLoaded());
+    EXPECT_EQ(*snapshot.getTakenAt(), takenAt);
+
+    {
+        G_SUBTEST << "Shared nodes, sorted by path";
+        auto exported = snapshot.getShared(SharedNodesIndex::EXPORTED);
+        ASSERT_EQ(exported.size(), 2u);
+        EXPECT_EQ(exported[0].first, 2u);
+        EXPECT_EQ(exported[0].second.mPath, "/a/with spaces");
+        EXPECT_EQ(exported[1].second.mPath, "/b");
+
+        EXPECT_EQ(snapshot.getShared(SharedNodesIndex::SHARED | SharedNodesIndex::PENDING_SHARED).size(), 1u);
+        EXPECT_EQ(snapshot.getShared(SharedNodesIndex::EXPORTED, "/a").size(), 1u);
+    }
+
+    {
+        G_SUBTEST << "Folder counts";
+        auto a = snapshot.findByPath("/a/with spaces");
+        ASSERT_TRUE(a && a->mFolderCounts);
+        EXPECT_EQ(a->mFolderCounts->mFiles, 3);
+        EXPECT_EQ(a->mFolderCounts->mFolders, 1);
+        EXPECT_EQ(a->mFolderCounts->mSize, 300);
+        EXPECT_EQ(a->mFolderCounts->mSizeWithVersions, 450);
+        EXPECT_FALSE(snapshot.findByPath("/b")->mFolderCounts);
+        EXPECT_TRUE(snapshot.findByPath("//in/x")->mFolderCounts);
+        EXPECT_FALSE(snapshot.findByPath("/missing"));
+    }
+
+    snapshot.remove();
+    EXPECT_FALSE(snapshot.isLoaded());
+    EXPECT_FALSE(fs::exists(mSnapshotFile));
+}
+
+TEST_F(NodesSnapshotTest, writeRefreshesTheLoadedOne)
+{
+    NodesSnapshot::Entries entries;
+    entries[1] = entry("/old", SharedNodesIndex::EXPORTED);
+
+    NodesSnapshot snapshot(mSnapshotFile);
+    ASSERT_TRUE(snapshot.write(entries, NodesSnapshot::Clock::time_point(std::chrono::seconds(1700000000))));
+    ASSERT_TRUE(snapshot.read());
+
+    const auto takenAt = NodesSnapshot::Clock::time_point(std::chrono::seconds(1700000600));
+    entries.clear();
+    entries[2] = entry("/new", SharedNodesIndex::EXPORTED, megacmd::FolderInfoCache::Counts{1, 0, 10, 10});
+    entries[3] = entry("/broken\nname", SharedNodesIndex::EXPORTED);
+    ASSERT_TRUE(snapshot.write(entries, takenAt));
+
+    EXPECT_EQ(*snapshot.getTakenAt(), takenAt);
+    EXPECT_FALSE(snapshot.findByPath("/old"));
+    ASSERT_TRUE(snapshot.findByPath("/new"));
+    EXPECT_EQ(snapshot.findByPath("/new")->mFolderCounts->mSize, 10);
+    EXPECT_EQ(snapshot.getShared(SharedNodesIndex::EXPORTED).size(), 1u);
+}
+
+TEST_F(NodesSnapshotTest, unreadableSnapshots)
+{
+    NodesSnapshot snapshot(mSnapshotFile);
+    EXPECT_FALSE(snapshot.read());
+
+    std::ofstream(mSnapshotFile) << "MEGAcmd nodes snapshot v1\n1700000000\n1 1 -1 -1 /ok\n";
+    EXPECT_FALSE(snapshot.read());
+
+    std::ofstream(mSnapshotFile) << "MEGAcmd nodes snapshot v2\n1700000000\n1 1 -1 -1 -1 -1 /ok\ngarbage\n2 1 -1 -1 -1 -1\n";
+    ASSERT_TRUE(snapshot.read());
+    EXPECT_EQ(snapshot.getShared(SharedNodesIndex::EXPORTED).size(), 1u);
+}
+
+TEST_F(NodesSnapshotTest, ageStr)
+{
+    EXPECT_EQ(NodesSnapshot::getAgeStr(1s), "1 second");
+    EXPECT_EQ(NodesSnapshot::getAgeStr(-5s), "0 seconds");
+    EXPECT_EQ(NodesSnapshot::getAgeStr(5min + 30s), "5 minutes");
+    EXPECT_EQ(NodesSnapshot::getAgeStr(1h), "1 hour");
+    EXPECT_EQ(NodesSnapshot::getAgeStr(72h), "3 days");
+}
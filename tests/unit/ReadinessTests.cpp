@@ -0,0 +1,150 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <future>
+
+#include "TestUtils.h"
+#include "megacmd_readiness.h"
+
+using megacmd::Readiness;
+using State = Readiness::State;
+using namespace std::chrono_literals;
+
+namespace
+{
+    struct ReadinessWithChanges
+    {
+        std::vector<std::string> mMessages;
+        Readiness mReadiness;
+
+        ReadinessWithChanges()
+        {
+            mReadiness.setListener([this](const Readiness::Status& status)
+            {
+                mMessages.push_back(Readiness::getStateMessage(status));
+            });
+        }
+    };
+}
+
+TEST(ReadinessTest, sessionResumption)
+{
+    ReadinessWithChanges r;
+    EXPECT_EQ(r.mReadiness.getState(), State::LOGGED_OUT);
+    EXPECT_FALSE(r.mReadiness.isBusy());
+
+    r.mReadiness.onLoginStarted();
+    r.mReadiness.onFetchNodesStarted();
+    EXPECT_TRUE(r.mReadiness.isBusy());
+
+    {
+        G_SUBTEST << "Only new percents of the fetch are notified";
+        r.mReadiness.onFetchNodesProgress(0, 1000);
+        r.mReadiness.onFetchNodesProgress(1, 1000);
+        r.mReadiness.onFetchNodesProgress(500, 1000);
+        r.mReadiness.onFetchNodesProgress(505, 1000);
+        EXPECT_EQ(r.mMessages, (std::vector<std::string>{"readiness:LOGGING_IN:0:0",
+                                                         "readiness:FETCHING_NODES:0:0",
+                                                         "readiness:FETCHING_NODES:0:1000",
+                                                         "readiness:FETCHING_NODES:500:1000"}));
+    }
+
+    {
+        G_SUBTEST << "Fetched nodes are not ready until the account is current";
+        EXPECT_TRUE(r.mReadiness.onFetchNodesFinished(true));
+        EXPECT_EQ(r.mReadiness.getState(), State::CATCHING_UP);
+        EXPECT_TRUE(r.mReadiness.isBusy());
+
+        r.mReadiness.onNodesCurrent();
+        EXPECT_EQ(r.mReadiness.getState(), State::READY);
+        EXPECT_EQ(r.mMessages.back(), "readiness:READY:1000:1000");
+        EXPECT_FALSE(r.mReadiness.onCatchUpTimedOut());
+    }
+
+    {
+        G_SUBTEST << "A login attempted while logged in doesn't change the state";
+        r.mReadiness.onLoginStarted();
+        r.mReadiness.onLoginFinished();
+        EXPECT_EQ(r.mReadiness.getState(), State::READY);
+    }
+
+    r.mReadiness.onLoggedOut();
+    EXPECT_EQ(r.mReadiness.getState(), State::LOGGED_OUT);
+}
+
+TEST(ReadinessTest, failures)
+{
+    Readiness readiness;
+
+    {
+        G_SUBTEST << "Login failed";
+        readiness.onLoginStarted();
+        readiness.onLoginFinished();
+        EXPECT_EQ(readiness.getState(), State::LOGGED_OUT);
+    }
+
+    {
+        G_SUBTEST << "Fetch nodes failed";
+        readiness.onLoginStarted();
+        readiness.onFetchNodesStarted();
+        EXPECT_FALSE(readiness.onFetchNodesFinished(false));
+        EXPECT_EQ(readiness.getState(), State::LOGGED_OUT);
+    }
+
+    {
+        G_SUBTEST << "Gave up catching up";
+        readiness.onFetchNodesStarted();
+        readiness.onFetchNodesFinished(true);
+        EXPECT_TRUE(readiness.onCatchUpTimedOut());
+        EXPECT_EQ(readiness.getState(), State::READY);
+    }
+}
+
+TEST(ReadinessTest, currentBeforeFetchFinished)
+{
+    Readiness readiness;
+    readiness.onFetchNodesStarted();
+    readiness.onNodesCurrent();
+    EXPECT_EQ(readiness.getState(), State::FETCHING_NODES);
+    EXPECT_FALSE(readiness.onFetchNodesFinished(true));
+    EXPECT_EQ(readiness.getState(), State::READY);
+
+    {
+        G_SUBTEST << "A fetch started again (e.g. reload) needs the account to be current again";
+        readiness.onFetchNodesStarted();
+        EXPECT_TRUE(readiness.onFetchNodesFinished(true));
+        EXPECT_EQ(readiness.getState(), State::CATCHING_UP);
+    }
+}
+
+TEST(ReadinessTest, waitWhileBusy)
+{
+    Readiness readiness;
+    EXPECT_EQ(readiness.waitWhileBusy(), State::LOGGED_OUT);
+
+    readiness.onLoginStarted();
+    EXPECT_EQ(readiness.waitWhileBusy(10ms), State::LOGGING_IN);
+
+    auto waiter = std::async(std::launch::async, [&readiness] { return readiness.waitWhileBusy(); });
+    readiness.onFetchNodesStarted();
+    readiness.onFetchNodesFinished(true);
+    EXPECT_EQ(waiter.wait_for(50ms), std::future_status::timeout);
+
+    readiness.onNodesCurrent();
+    EXPECT_EQ(waiter.get(), State::READY);
+}
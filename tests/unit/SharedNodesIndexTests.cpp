@@ -0,0 +1,94 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "TestUtils.h"
+#include "megacmd_shared_nodes_index.h"
+
+using megacmd::SharedNodesIndex;
+
+namespace
+{
+    std::vector<mega::MegaHandle> sorted(std::vector<mega::MegaHandle> handles)
+    {
+        std::sort(handles.begin(), handles.end());
+        return handles;
+    }
+}
+
+TEST(SharedNodesIndexTest, updates)
+{
+    SharedNodesIndex index;
+    EXPECT_FALSE(index.isLoaded());
+
+    {
+        G_SUBTEST << "Updates before loading are not kept";
+        index.update(9, SharedNodesIndex::EXPORTED);
+        EXPECT_TRUE(index.get(SharedNodesIndex::EXPORTED).empty());
+    }
+
+    ASSERT_TRUE(index.load({{1, SharedNodesIndex::EXPORTED},
+                            {2, SharedNodesIndex::SHARED | SharedNodesIndex::PENDING_SHARED},
+                            {3, SharedNodesIndex::PENDING_SHARED}}, index.getGeneration()));
+    EXPECT_TRUE(index.isLoaded());
+
+    EXPECT_EQ(index.get(SharedNodesIndex::EXPORTED), (std::vector<mega::MegaHandle>{1}));
+    EXPECT_EQ(sorted(index.get(SharedNodesIndex::PENDING_SHARED)), (std::vector<mega::MegaHandle>{2, 3}));
+    EXPECT_EQ(sorted(index.get(SharedNodesIndex::SHARED | SharedNodesIndex::PENDING_SHARED)), (std::vector<mega::MegaHandle>{2, 3}));
+
+    {
+        G_SUBTEST << "Nodes are added, changed and removed";
+        index.update(4, SharedNodesIndex::EXPORTED);
+        index.update(1, SharedNodesIndex::EXPORTED | SharedNodesIndex::SHARED);
+        index.update(2, 0);
+        EXPECT_EQ(sorted(index.get(SharedNodesIndex::EXPORTED)), (std::vector<mega::MegaHandle>{1, 4}));
+        EXPECT_EQ(index.get(SharedNodesIndex::SHARED), (std::vector<mega::MegaHandle>{1}));
+        EXPECT_EQ(index.get(SharedNodesIndex::PENDING_SHARED), (std::vector<mega::MegaHandle>{3}));
+    }
+
+    {
+        G_SUBTEST << "Clearing unloads it";
+        index.clear();
+        EXPECT_FALSE(index.isLoaded());
+        EXPECT_TRUE(index.get(SharedNodesIndex::EXPORTED).empty());
+    }
+}
+
+TEST(SharedNodesIndexTest, loadsObtainedBeforeAnUpdateAreDiscarded)
+{
+    SharedNodesIndex index;
+    const auto generation = index.getGeneration();
+    index.update(1, SharedNodesIndex::EXPORTED);
+
+    EXPECT_FALSE(index.load({{2, SharedNodesIndex::EXPORTED}}, generation));
+    EXPECT_FALSE(index.isLoaded());
+    EXPECT_TRUE(index.load({{2, SharedNodesIndex::EXPORTED}}, index.getGeneration()));
+}
+
+TEST(SharedNodesIndexTest, pathInTree)
+{
+    EXPECT_TRUE(SharedNodesIndex::isPathInTree("/a/b", "/a"));
+    EXPECT_TRUE(SharedNodesIndex::isPathInTree("/a", "/a"));
+    EXPECT_TRUE(SharedNodesIndex::isPathInTree("/a/b", "/"));
+    EXPECT_TRUE(SharedNodesIndex::isPathInTree("/", "/"));
+    EXPECT_TRUE(SharedNodesIndex::isPathInTree("//bin/x", "//bin"));
+    EXPECT_FALSE(SharedNodesIndex::isPathInTree("/ab", "/a"));
+    EXPECT_FALSE(SharedNodesIndex::isPathInTree("/a", "/a/b"));
+    EXPECT_FALSE(SharedNodesIndex::isPathInTree("//bin/x", "/"));
+    EXPECT_FALSE(SharedNodesIndex::isPathInTree("/a", ""));
+}
@@ -0,0 +1,145 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+
+#include "TestUtils.h"
+#include "megacmd_startup_graph.h"
+
+using megacmd::StartupGraph;
+using namespace std::chrono_literals;
+
+TEST(StartupGraphTest, dependenciesRunFirst)
+{
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto step = [&mutex, &order](const std::string& name)
+    {
+        return [&mutex, &order, name]
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            order.push_back(name);
+        };
+    };
+
+    StartupGraph graph;
+    graph.add("a", {}, step("a"));
+    graph.add("b", {"a"}, step("b"));
+    graph.add("c", {"a", "b"}, step("c"));
+    graph.start();
+    graph.waitFor("c");
+
+    std::lock_guard<std::mutex> g(mutex);
+    EXPECT_EQ(order, (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST(StartupGraphTest, independentStepsRunInParallel)
+{
+    std::promise<void> bStarted;
+    std::promise<void> releaseA;
+    auto releaseAFuture = releaseA.get_future();
+
+    StartupGraph graph;
+    graph.add("a", {}, [&releaseAFuture] { releaseAFuture.wait(); });
+    graph.add("b", {}, [&bStarted] { bStarted.set_value(); });
+    graph.start();
+
+    // b does not wait for a
+    EXPECT_EQ(bStarted.get_future().wait_for(5s), std::future_status::ready);
+    graph.waitFor("b");
+    releaseA.set_value();
+    graph.waitForAll();
+}
+
+TEST(StartupGraphTest, timings)
+{
+    StartupGraph graph;
+    graph.record("outside", StartupGraph::Clock::now());
+    graph.add("slow", {}, [] { std::this_thread::sleep_for(20ms); });
+    graph.add("after", {"slow"}, [] {});
+    graph.start();
+    graph.waitForAll();
+
+    auto timings = graph.getTimings();
+    ASSERT_EQ(timings.size(), 3u);
+    EXPECT_EQ(timings[0].mName, "outside");
+    EXPECT_EQ(timings[1].mName, "slow");
+    EXPECT_EQ(timings[2].mName, "after");
+    EXPECT_GE(timings[1].mDuration, 20ms);
+    EXPECT_GE(timings[2].mStart, timings[1].mStart + timings[1].mDuration);
+
+    const auto summary = graph.getSummary();
+    EXPECT_NE(summary.find("outside 0+0 ms, slow "), std::string::npos) << summary;
+}
+
+TEST(StartupGraphTest, stepsAddedAfterStarting)
+{
+    std::atomic<int> runs{0};
+    StartupGraph graph;
+    graph.add("a", {}, [&runs] { runs++; });
+    graph.start();
+    graph.waitFor("a");
+
+    graph.add("b", {"a"}, [&runs] { runs++; });
+    graph.waitFor("b");
+    EXPECT_EQ(runs, 2);
+}
+
+TEST(StartupGraphTest, failedStepsFailTheirDependents)
+{
+    std::mutex mutex;
+    std::vector<std::pair<std::string, std::string>> failures;
+    std::atomic<int> runs{0};
+
+    StartupGraph graph;
+    graph.setFailureHandler([&mutex, &failures](const std::string& name, const std::string& error)
+    {
+        std::lock_guard<std::mutex> g(mutex);
+        failures.emplace_back(name, error);
+    });
+    graph.add("a", {}, [] { throw std::runtime_error("no api"); });
+    graph.add("b", {"a"}, [&runs] { runs++; });
+    graph.add("c", {"b"}, [&runs] { runs++; });
+    graph.add("other", {}, [&runs] { runs++; });
+    graph.start();
+
+    EXPECT_FALSE(graph.waitFor("c"));
+    EXPECT_TRUE(graph.waitFor("other"));
+    graph.waitForAll();
+    EXPECT_EQ(runs, 1);
+
+    {
+        std::lock_guard<std::mutex> g(mutex);
+        ASSERT_EQ(failures.size(), 3u);
+        EXPECT_EQ(failures[0], (std::pair<std::string, std::string>{"a", "no api"}));
+        EXPECT_EQ(failures[1].first, "b");
+        EXPECT_EQ(failures[2].first, "c");
+        EXPECT_NE(failures[2].second.find("b"), std::string::npos);
+    }
+
+    {
+        G_SUBTEST << "Steps added afterwards fail right away";
+        graph.add("d", {"a"}, [&runs] { runs++; });
+        EXPECT_FALSE(graph.waitFor("d"));
+        EXPECT_EQ(runs, 1);
+
+        std::lock_guard<std::mutex> g(mutex);
+        EXPECT_EQ(failures.size(), 4u);
+    }
+}
@@ -0,0 +1,209 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_storage_report.h"
+
+using megacmd::StorageReport;
+
+namespace
+{
+    constexpr int64_t NOW = 1700000000;
+    constexpr int64_t DAY = 24 * 3600;
+
+    std::string pathOf(mega::MegaHandle h)
+    {
+        return "/folder" + std::to_string(h);
+    }
+
+    StorageReport makeReport()
+    {
+        StorageReport report(NOW);
+        report.addFolder(2, 1);
+        report.addFolder(3, 1);
+        report.addFile(1, 100, NOW - 3600, 0, 0);
+        report.addFile(1, 200, NOW - 2 * DAY, 0, 0);
+        report.addFile(1, 300, NOW - 400 * DAY, 0, 0);
+        report.addFile(2, 5 * 1024 * 1024, NOW - 10 * DAY, 3, 12 * 1024 * 1024);
+        report.addFile(3, 2048, NOW + 60, 1, 1024); // modified "in the future"
+        return report;
+    }
+}
+
+TEST(StorageReportTest, topFolders)
+{
+    auto summary = makeReport().getSummary(2, pathOf);
+
+    {
+        G_SUBTEST << "Totals";
+        EXPECT_EQ(summary.mTotals.mFiles, 5);
+        EXPECT_EQ(summary.mTotals.mFolders, 2);
+        EXPECT_EQ(summary.mTotals.mSize, 600 + 5 * 1024 * 1024 + 2048);
+        EXPECT_EQ(summary.mTotals.mVersions, 4);
+        EXPECT_EQ(summary.mTotals.mVersionsSize, 12 * 1024 * 1024 + 1024);
+    }
+
+    {
+        G_SUBTEST << "By version overhead";
+        ASSERT_EQ(summary.mTopByVersionsSize.size(), 2u);
+        EXPECT_EQ(summary.mTopByVersionsSize[0].mPath, "/folder2");
+        EXPECT_EQ(summary.mTopByVersionsSize[0].mTotals.mVersions, 3);
+        EXPECT_EQ(summary.mTopByVersionsSize[1].mPath, "/folder3");
+    }
+
+    {
+        G_SUBTEST << "By files and by size";
+        ASSERT_EQ(summary.mTopByFiles.size(), 2u);
+        EXPECT_EQ(summary.mTopByFiles[0].mPath, "/folder1");
+        EXPECT_EQ(summary.mTopByFiles[0].mTotals.mFiles, 3);
+        EXPECT_EQ(summary.mTopByFiles[0].mTotals.mFolders, 2);
+        EXPECT_EQ(summary.mTopByFiles[1].mPath, "/folder2"); // ties by handle
+
+        ASSERT_EQ(summary.mTopBySize.size(), 2u);
+        EXPECT_EQ(summary.mTopBySize[0].mPath, "/folder2");
+        EXPECT_EQ(summary.mTopBySize[1].mPath, "/folder3");
+    }
+
+    {
+        G_SUBTEST << "Folders without the ranked value are left out";
+        StorageReport report(NOW);
+        report.addFile(1, 10, NOW, 0, 0);
+        EXPECT_TRUE(report.getSummary(10, pathOf).mTopByVersionsSize.empty());
+        EXPECT_TRUE(report.getSummary(0, pathOf).mTopByFiles.empty());
+    }
+}
+
+TEST(StorageReportTest, topSubtrees)
+{
+    // 1 (analyzed) -> 2 -> 4, 5, 6; 1 -> 3. The files of 2 are split across its small subfolders
+    StorageReport report(NOW);
+    report.addFolder(2, 1);
+    report.addFolder(3, 1);
+    report.addFolder(4, 2);
+    report.addFolder(5, 2);
+    report.addFolder(6, 2);
+    report.addFile(3, 1000, NOW, 0, 0);
+    report.addFile(4, 400, NOW, 1, 10);
+    report.addFile(5, 400, NOW, 0, 0);
+    report.addFile(6, 400, NOW, 2, 20);
+
+    {
+        G_SUBTEST << "Direct";
+        auto summary = report.getSummary(1, pathOf);
+        EXPECT_FALSE(summary.mRecursive);
+        ASSERT_EQ(summary.mTopBySize.size(), 1u);
+        EXPECT_EQ(summary.mTopBySize[0].mPath, "/folder3");
+    }
+
+    {
+        G_SUBTEST << "Recursive";
+        auto summary = report.getSummary(10, pathOf, true);
+        EXPECT_TRUE(summary.mRecursive);
+        ASSERT_EQ(summary.mTopBySize.size(), 5u); // the analyzed folder is left out
+        EXPECT_EQ(summary.mTopBySize[0].mPath, "/folder2");
+        EXPECT_EQ(summary.mTopBySize[0].mTotals.mSize, 1200);
+        EXPECT_EQ(summary.mTopBySize[0].mTotals.mFiles, 3);
+        EXPECT_EQ(summary.mTopBySize[0].mTotals.mFolders, 3);
+        EXPECT_EQ(summary.mTopBySize[1].mPath, "/folder3");
+
+        ASSERT_EQ(summary.mTopByVersionsSize.size(), 3u);
+        EXPECT_EQ(summary.mTopByVersionsSize[0].mPath, "/folder2");
+        EXPECT_EQ(summary.mTopByVersionsSize[0].mTotals.mVersions, 3);
+        EXPECT_EQ(summary.mTopByVersionsSize[0].mTotals.mVersionsSize, 30);
+
+        EXPECT_EQ(summary.mTotals.mSize, 2200); // totals don't depend on the ranking
+    }
+}
+
+TEST(StorageReportTest, histograms)
+{
+    auto summary = makeReport().getSummary(10, pathOf);
+
+    ASSERT_EQ(summary.mSizeHistogram.size(), 6u);
+    EXPECT_EQ(summary.mSizeHistogram[0].mLabel, "< 1 KB");
+    EXPECT_EQ(summary.mSizeHistogram[0].mFiles, 3);
+    EXPECT_EQ(summary.mSizeHistogram[0].mSize, 600);
+    EXPECT_EQ(summary.mSizeHistogram[1].mFiles, 1);
+    EXPECT_EQ(summary.mSizeHistogram[2].mFiles, 1);
+    EXPECT_EQ(summary.mSizeHistogram[5].mFiles, 0);
+
+    ASSERT_EQ(summary.mAgeHistogram.size(), 5u);
+    EXPECT_EQ(summary.mAgeHistogram[0].mFiles, 2);
+    EXPECT_EQ(summary.mAgeHistogram[1].mFiles, 1);
+    EXPECT_EQ(summary.mAgeHistogram[2].mFiles, 1);
+    EXPECT_EQ(summary.mAgeHistogram[3].mFiles, 0);
+    EXPECT_EQ(summary.mAgeHistogram[4].mLabel, ">= 1 year");
+    EXPECT_EQ(summary.mAgeHistogram[4].mFiles, 1);
+}
+
+TEST(StorageReportTest, merge)
+{
+    // The same files, collected by two walkers
+    StorageReport first(NOW);
+    first.addFolder(2, 1);
+    first.addFile(1, 100, NOW - 3600, 0, 0);
+    first.addFile(1, 200, NOW - 2 * DAY, 0, 0);
+    first.addFile(2, 5 * 1024 * 1024, NOW - 10 * DAY, 3, 12 * 1024 * 1024);
+
+    StorageReport second(NOW);
+    second.addFolder(3, 1);
+    second.addFile(1, 300, NOW - 400 * DAY, 0, 0);
+    second.addFile(3, 2048, NOW + 60, 1, 1024);
+
+    first.merge(second);
+    auto merged = first.getSummary(10, pathOf);
+    auto expected = makeReport().getSummary(10, pathOf);
+
+    EXPECT_EQ(merged.mTotals.mFiles, expected.mTotals.mFiles);
+    EXPECT_EQ(merged.mTotals.mFolders, expected.mTotals.mFolders);
+    EXPECT_EQ(merged.mTotals.mVersionsSize, expected.mTotals.mVersionsSize);
+    ASSERT_EQ(merged.mTopByFiles.size(), expected.mTopByFiles.size());
+    EXPECT_EQ(merged.mTopByFiles[0].mTotals.mFiles, 3);
+    EXPECT_EQ(merged.mTopByFiles[0].mTotals.mFolders, 2);
+    for (size_t i = 0; i < expected.mAgeHistogram.size(); ++i)
+    {
+        EXPECT_EQ(merged.mAgeHistogram[i].mFiles, expected.mAgeHistogram[i].mFiles);
+        EXPECT_EQ(merged.mSizeHistogram[i].mSize, expected.mSizeHistogram[i].mSize);
+    }
+}
+
+TEST(StorageReportTest, reportFile)
+{
+    const fs::path reportFile = fs::temp_directory_path() / ("megacmd_storage_report_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    ASSERT_TRUE(StorageReport::write(reportFile, "/analyzed", makeReport().getSummary(1, pathOf), NOW));
+
+    std::vector<std::string> lines;
+    std::ifstream ifs(reportFile);
+    for (std::string line; std::getline(ifs, line);)
+    {
+        lines.push_back(line);
+    }
+    ifs.close();
+    fs::remove(reportFile);
+
+    ASSERT_GE(lines.size(), 6u);
+    EXPECT_EQ(lines[0], "MEGAcmd storage report v1");
+    EXPECT_EQ(lines[1], "path\t/analyzed");
+    EXPECT_EQ(lines[3], "ranking\tdirect");
+    EXPECT_EQ(lines[5], "totals\t5\t2\t" + std::to_string(600 + 5 * 1024 * 1024 + 2048) + "\t4\t" + std::to_string(12 * 1024 * 1024 + 1024));
+    EXPECT_NE(std::find(lines.begin(), lines.end(), "top_versions\t1\t" + std::to_string(5 * 1024 * 1024) + "\t3\t" + std::to_string(12 * 1024 * 1024) + "\t/folder2"), lines.end());
+    EXPECT_NE(std::find(lines.begin(), lines.end(), "size_histogram\t< 1 KB\t3\t600"), lines.end());
+    EXPECT_NE(std::find(lines.begin(), lines.end(), "age_histogram\t>= 1 year\t1\t300"), lines.end());
+}
@@ -0,0 +1,142 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_sync_metrics.h"
+
+using megacmd::SyncMetrics;
+using mega::MegaTransfer;
+
+namespace
+{
+    class FakeSyncTransfer : public MegaTransfer
+    {
+    public:
+        int mTag = 0;
+        int mType = TYPE_UPLOAD;
+        int mState = STATE_COMPLETED;
+        bool mSync = true;
+        long long mTotal = 0;
+        std::string mPath;
+
+        FakeSyncTransfer(int tag, int type, const std::string& path, long long total) :
+            mTag(tag), mType(type), mTotal(total), mPath(path) {}
+
+        int getTag() const override { return mTag; }
+        int getType() const override { return mType; }
+        int getState() const override { return mState; }
+        bool isSyncTransfer() const override { return mSync; }
+        long long getTotalBytes() const override { return mTotal; }
+        const char* getPath() const override { return mPath.c_str(); }
+    };
+}
+
+TEST(SyncMetricsTest, transfers)
+{
+    SyncMetrics metrics;
+    metrics.onSyncAdded(1, "/home/user/docs/");
+    metrics.onSyncAdded(2, "/home/user/docs2");
+
+    FakeSyncTransfer upload(10, MegaTransfer::TYPE_UPLOAD, "/home/user/docs/a/b.txt", 100);
+    FakeSyncTransfer download(11, MegaTransfer::TYPE_DOWNLOAD, "/home/user/docs2/c.txt", 50);
+    FakeSyncTransfer outside(12, MegaTransfer::TYPE_UPLOAD, "/home/user/other.txt", 10);
+    FakeSyncTransfer nonSync(13, MegaTransfer::TYPE_UPLOAD, "/home/user/docs/d.txt", 10);
+    nonSync.mSync = false;
+
+    for (auto* t : {&upload, &download, &outside, &nonSync})
+    {
+        metrics.onTransferStart(*t);
+    }
+
+    G_SUBTEST << "Transfers are attributed to the sync containing them";
+    {
+        ASSERT_TRUE(metrics.getCounters(1));
+        EXPECT_EQ(metrics.getCounters(1)->mTransfersInFlight, 1u);
+        EXPECT_EQ(metrics.getCounters(2)->mTransfersInFlight, 1u);
+        EXPECT_FALSE(metrics.getCounters(3));
+    }
+
+    G_SUBTEST << "Finished transfers";
+    {
+        metrics.onTransferFinish(upload, true);
+        metrics.onTransferFinish(download, false);
+        metrics.onTransferFinish(nonSync, true);
+
+        auto counters = *metrics.getCounters(1);
+        EXPECT_EQ(counters.mTransfersInFlight, 0u);
+        EXPECT_EQ(counters.mFilesUploaded, 1u);
+        EXPECT_EQ(counters.mBytesUploaded, 100u);
+        EXPECT_TRUE(counters.mLastActivity);
+
+        counters = *metrics.getCounters(2);
+        EXPECT_EQ(counters.mFilesDownloaded, 0u);
+        EXPECT_EQ(counters.mFailedTransfers, 1u);
+    }
+
+    G_SUBTEST << "Cancelled transfers are not failures";
+    {
+        FakeSyncTransfer cancelled(14, MegaTransfer::TYPE_UPLOAD, "/home/user/docs2/e.txt", 10);
+        cancelled.mState = MegaTransfer::STATE_CANCELLED;
+        metrics.onTransferStart(cancelled);
+        metrics.onTransferFinish(cancelled, false);
+        EXPECT_EQ(metrics.getCounters(2)->mFailedTransfers, 1u);
+    }
+
+    G_SUBTEST << "Deleted syncs are forgotten";
+    {
+        metrics.onSyncDeleted(1);
+        EXPECT_FALSE(metrics.getCounters(1));
+
+        FakeSyncTransfer late(15, MegaTransfer::TYPE_UPLOAD, "/home/user/docs/f.txt", 10);
+        metrics.onTransferStart(late);
+        EXPECT_FALSE(metrics.getCounters(1));
+    }
+}
+
+TEST(SyncMetricsTest, scansAndStalls)
+{
+    SyncMetrics metrics;
+    metrics.onSyncAdded(1, "/sync");
+
+    const auto start = SyncMetrics::Clock::now();
+    metrics.onScanningChanged(1, true, start);
+    EXPECT_TRUE(metrics.getCounters(1)->mScanning);
+
+    metrics.onScanningChanged(1, false, start + std::chrono::seconds(3));
+    metrics.onScanningChanged(1, true, start + std::chrono::seconds(10));
+    metrics.onScanningChanged(1, false, start + std::chrono::seconds(11));
+    metrics.onStall(1);
+    metrics.onStall(2); // unknown syncs are ignored
+
+    auto counters = *metrics.getCounters(1);
+    EXPECT_FALSE(counters.mScanning);
+    EXPECT_EQ(counters.mScanCount, 2u);
+    EXPECT_EQ(counters.mLastScanDuration, std::chrono::seconds(1));
+    EXPECT_EQ(counters.mTotalScanDuration, std::chrono::seconds(4));
+    EXPECT_EQ(counters.mStallCount, 1u);
+
+    G_SUBTEST << "Moved sync roots";
+    {
+        metrics.onSyncStateChanged(1, "/moved");
+        FakeSyncTransfer upload(1, MegaTransfer::TYPE_UPLOAD, "/moved/a", 1);
+        FakeSyncTransfer oldUpload(2, MegaTransfer::TYPE_UPLOAD, "/sync/a", 1);
+        metrics.onTransferStart(upload);
+        metrics.onTransferStart(oldUpload);
+        EXPECT_EQ(metrics.getCounters(1)->mTransfersInFlight, 1u);
+        EXPECT_EQ(metrics.getCounters(1)->mRunStateChanges, 1u);
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_timer_scheduler.h"
+#include "deferred_single_trigger.h"
+
+using megacmd::TimerScheduler;
+using namespace std::chrono_literals;
+
+TEST(TimerSchedulerTest, CallbacksRunInDeadlineOrder)
+{
+    TimerScheduler scheduler;
+
+    std::mutex mutex;
+    std::vector<int> order;
+    std::promise<void> done;
+
+    scheduler.schedule(60ms, [&] { std::lock_guard<std::mutex> g(mutex); order.push_back(3); done.set_value(); });
+    scheduler.schedule(20ms, [&] { std::lock_guard<std::mutex> g(mutex); order.push_back(1); });
+    scheduler.schedule(40ms, [&] { std::lock_guard<std::mutex> g(mutex); order.push_back(2); });
+
+    ASSERT_EQ(done.get_future().wait_for(5s), std::future_status::ready);
+
+    std::lock_guard<std::mutex> g(mutex);
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(scheduler.getPendingCount(), 0u);
+}
+
+TEST(TimerSchedulerTest, Cancel)
+{
+    TimerScheduler scheduler;
+    std::atomic_int calls = 0;
+
+    {
+        G_SUBTEST << "Pending timer";
+        auto id = scheduler.schedule(50ms, [&] { ++calls; });
+        EXPECT_TRUE(scheduler.cancel(id));
+        EXPECT_FALSE(scheduler.cancel(id));
+        EXPECT_EQ(scheduler.getPendingCount(), 0u);
+    }
+
+    {
+        G_SUBTEST << "Waiting for a running callback";
+        std::promise<void> started;
+        auto id = scheduler.schedule(0ms, [&]
+        {
+            started.set_value();
+            std::this_thread::sleep_for(50ms);
+            ++calls;
+        });
+
+        started.get_future().wait();
+        EXPECT_FALSE(scheduler.cancel(id, true));
+        EXPECT_EQ(calls, 1);
+    }
+
+    {
+        G_SUBTEST << "Timers still pending are dropped on destruction";
+        TimerScheduler otherScheduler;
+        otherScheduler.schedule(1h, [&] { ++calls; });
+    }
+
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(TimerSchedulerTest, DeferredSingleTriggerWaitsForEveryRunningCallback)
+{
+    std::atomic_int calls = 0;
+    std::atomic_bool firstFinished = false;
+
+    {
+        DeferredSingleTrigger trigger(0ms);
+
+        std::promise<void> started;
+        trigger.triggerDeferredSingleShot([&]
+        {
+            started.set_value();
+            std::this_thread::sleep_for(100ms);
+            firstFinished = true;
+            ++calls;
+        });
+        started.get_future().wait();
+
+        // Too late to cancel the first one, which is no longer the latest when the trigger is destroyed
+        trigger.triggerDeferredSingleShot([&] { ++calls; });
+    }
+
+    EXPECT_TRUE(firstFinished);
+    EXPECT_GE(calls, 1);
+}
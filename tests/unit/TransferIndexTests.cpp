@@ -0,0 +1,199 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_transfer_index.h"
+
+using megacmd::TransferIndex;
+using mega::MegaTransfer;
+
+namespace
+{
+    class FakeTransfer : public MegaTransfer
+    {
+    public:
+        int mTag = 0;
+        int mType = TYPE_DOWNLOAD;
+        int mState = STATE_QUEUED;
+        bool mSync = false;
+        bool mFolder = false;
+        long long mTotal = 0;
+        long long mTransferred = 0;
+        long long mSpeed = 0;
+
+        FakeTransfer(int tag, int type, long long total) : mTag(tag), mType(type), mTotal(total) {}
+
+        int getTag() const override { return mTag; }
+        int getType() const override { return mType; }
+        int getState() const override { return mState; }
+        bool isSyncTransfer() const override { return mSync; }
+        bool isFolderTransfer() const override { return mFolder; }
+        long long getTotalBytes() const override { return mTotal; }
+        long long getTransferredBytes() const override { return mTransferred; }
+        long long getSpeed() const override { return mSpeed; }
+    };
+}
+
+TEST(TransferIndexTest, summary)
+{
+    TransferIndex index;
+    FakeTransfer dl1(1, MegaTransfer::TYPE_DOWNLOAD, 100);
+    FakeTransfer dl2(2, MegaTransfer::TYPE_DOWNLOAD, 50);
+    FakeTransfer ul(3, MegaTransfer::TYPE_UPLOAD, 10);
+    FakeTransfer folder(4, MegaTransfer::TYPE_UPLOAD, 1000);
+    folder.mFolder = true;
+
+    for (auto* t : {&dl1, &dl2, &ul, &folder})
+    {
+        index.onTransferStart(*t);
+    }
+
+    G_SUBTEST << "Folder transfers are not indexed";
+    {
+        auto summary = index.getSummary();
+        EXPECT_EQ(summary.mDownloads.mCount, 2u);
+        EXPECT_EQ(summary.mDownloads.mTotalBytes, 150);
+        EXPECT_EQ(summary.mUploads.mCount, 1u);
+        EXPECT_EQ(summary.mUploads.mTotalBytes, 10);
+        EXPECT_EQ(summary.mDownloads.mCountByState[MegaTransfer::STATE_QUEUED], 2u);
+    }
+
+    G_SUBTEST << "Updates replace previous values";
+    {
+        dl1.mState = MegaTransfer::STATE_ACTIVE;
+        dl1.mTransferred = 40;
+        index.onTransferUpdate(dl1);
+
+        auto summary = index.getSummary();
+        EXPECT_EQ(summary.mDownloads.mCount, 2u);
+        EXPECT_EQ(summary.mDownloads.mTransferredBytes, 40);
+        EXPECT_EQ(summary.mDownloads.mCountByState[MegaTransfer::STATE_QUEUED], 1u);
+        EXPECT_EQ(summary.mDownloads.mCountByState[MegaTransfer::STATE_ACTIVE], 1u);
+    }
+
+    G_SUBTEST << "Finished transfers are removed";
+    {
+        index.onTransferFinish(dl1);
+        index.onTransferFinish(dl1); // twice should be harmless
+
+        auto summary = index.getSummary();
+        EXPECT_EQ(summary.mDownloads.mCount, 1u);
+        EXPECT_EQ(summary.mDownloads.mTotalBytes, 50);
+        EXPECT_EQ(summary.mDownloads.mTransferredBytes, 0);
+        EXPECT_EQ(summary.mDownloads.mCountByState[MegaTransfer::STATE_ACTIVE], 0u);
+    }
+}
+
+TEST(TransferIndexTest, syncCounts)
+{
+    TransferIndex index;
+    FakeTransfer dl(1, MegaTransfer::TYPE_DOWNLOAD, 100);
+    FakeTransfer syncDl(2, MegaTransfer::TYPE_DOWNLOAD, 100);
+    FakeTransfer syncUl(3, MegaTransfer::TYPE_UPLOAD, 100);
+    syncDl.mSync = true;
+    syncUl.mSync = true;
+
+    EXPECT_FALSE(index.hasPendingTransfers());
+    EXPECT_FALSE(index.hasPendingSyncTransfers());
+
+    G_SUBTEST << "Sync and non-sync transfers are counted separately";
+    {
+        for (auto* t : {&dl, &syncDl, &syncUl})
+        {
+            index.onTransferStart(*t);
+        }
+        index.onTransferUpdate(syncDl); // updates must not count twice
+
+        auto summary = index.getSummary();
+        EXPECT_EQ(summary.getSyncCount(), 2u);
+        EXPECT_EQ(summary.getNonSyncCount(), 1u);
+        EXPECT_EQ(summary.mDownloads.mSyncCount, 1u);
+        EXPECT_EQ(summary.mUploads.mSyncCount, 1u);
+        EXPECT_TRUE(index.hasPendingSyncTransfers());
+    }
+
+    G_SUBTEST << "Pending sync transfers until the last one finishes";
+    {
+        index.onTransferFinish(syncDl);
+        EXPECT_TRUE(index.hasPendingSyncTransfers());
+
+        index.onTransferFinish(syncUl);
+        EXPECT_FALSE(index.hasPendingSyncTransfers());
+        EXPECT_TRUE(index.hasPendingTransfers());
+        EXPECT_EQ(index.getSummary().getNonSyncCount(), 1u);
+    }
+
+    G_SUBTEST << "Folder transfers are pending until they finish";
+    {
+        FakeTransfer folder(4, MegaTransfer::TYPE_UPLOAD, 0);
+        folder.mFolder = true;
+
+        index.onTransferFinish(dl);
+        index.onTransferStart(folder);
+        EXPECT_TRUE(index.hasPendingTransfers());
+        EXPECT_EQ(index.getSummary().mUploads.mCount, 0u);
+
+        index.onTransferFinish(folder);
+        EXPECT_FALSE(index.hasPendingTransfers());
+    }
+}
+
+TEST(TransferIndexTest, paging)
+{
+    TransferIndex index;
+    std::vector<std::unique_ptr<FakeTransfer>> transfers;
+    for (int tag = 1; tag <= 10; ++tag)
+    {
+        transfers.emplace_back(new FakeTransfer(tag, tag % 2 ? MegaTransfer::TYPE_DOWNLOAD : MegaTransfer::TYPE_UPLOAD, tag * 10));
+        transfers.back()->mSpeed = 100 - tag;
+        transfers.back()->mSync = (tag == 10);
+        index.onTransferStart(*transfers.back());
+    }
+
+    TransferIndex::Filter all;
+
+    G_SUBTEST << "Queue order";
+    {
+        EXPECT_EQ(index.getPage(all, TransferIndex::SortBy::QUEUE, 0, 3), (std::vector<int>{1, 2, 3}));
+        EXPECT_EQ(index.getPage(all, TransferIndex::SortBy::QUEUE, 8, 5), (std::vector<int>{9, 10}));
+        EXPECT_TRUE(index.getPage(all, TransferIndex::SortBy::QUEUE, 20, 5).empty());
+    }
+
+    G_SUBTEST << "Filtering";
+    {
+        TransferIndex::Filter uploadsNoSyncs;
+        uploadsNoSyncs.mDownloads = false;
+        uploadsNoSyncs.mSyncs = false;
+        EXPECT_EQ(index.getPage(uploadsNoSyncs, TransferIndex::SortBy::QUEUE, 1, 10), (std::vector<int>{4, 6, 8}));
+    }
+
+    G_SUBTEST << "Sorting";
+    {
+        EXPECT_EQ(index.getPage(all, TransferIndex::SortBy::SIZE, 0, 3), (std::vector<int>{10, 9, 8}));
+        EXPECT_EQ(index.getPage(all, TransferIndex::SortBy::SIZE, 2, 2), (std::vector<int>{8, 7}));
+        EXPECT_EQ(index.getPage(all, TransferIndex::SortBy::SPEED, 0, 2), (std::vector<int>{1, 2}));
+        EXPECT_EQ(index.getPage(all, TransferIndex::SortBy::SPEED, 9, 10), (std::vector<int>{10}));
+    }
+
+    G_SUBTEST << "Sort criteria parsing";
+    {
+        EXPECT_EQ(TransferIndex::sortByFromString(""), TransferIndex::SortBy::QUEUE);
+        EXPECT_EQ(TransferIndex::sortByFromString("speed"), TransferIndex::SortBy::SPEED);
+        EXPECT_EQ(TransferIndex::sortByFromString("size"), TransferIndex::SortBy::SIZE);
+        EXPECT_FALSE(TransferIndex::sortByFromString("color"));
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * (c) 2013 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of MEGAcmd.
+ *
+ * MEGAcmd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "megacmd_transfer_manifest.h"
+
+using megacmd::TransferManifest;
+
+namespace
+{
+    class TransferManifestTest : public ::testing::Test
+    {
+    protected:
+        fs::path mJournalPath;
+
+        void SetUp() override
+        {
+            mJournalPath = fs::temp_directory_path() / ("megacmd_manifest_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+            fs::remove(mJournalPath);
+        }
+
+        void TearDown() override
+        {
+            fs::remove(mJournalPath);
+        }
+
+        std::vector<TransferManifest::Item> makeItems()
+        {
+            std::vector<TransferManifest::Item> items;
+            std::string error;
+            for (const char* line : {"get\t/remote/file1\t/local/dir/", "put\t/local/with\\backslash\t/remote/", "get\t/remote/file2\t/local/"})
+            {
+                auto item = TransferManifest::parseManifestLine(line, error);
+                EXPECT_TRUE(item) << error;
+                items.push_back(*item);
+            }
+            return items;
+        }
+    };
+}
+
+TEST_F(TransferManifestTest, parseManifestLine)
+{
+    std::string error;
+
+    G_SUBTEST << "Valid lines";
+    {
+        auto item = TransferManifest::parseManifestLine("put\t/local/a b\t/remote/\r", error);
+        ASSERT_TRUE(item);
+        EXPECT_EQ(item->mDirection, TransferManifest::Direction::UPLOAD);
+        EXPECT_EQ(item->mSource, "/local/a b");
+        EXPECT_EQ(item->mDestination, "/remote/");
+    }
+
+    G_SUBTEST << "Empty lines and comments are skipped";
+    {
+        EXPECT_FALSE(TransferManifest::parseManifestLine("", error));
+        EXPECT_TRUE(error.empty());
+        EXPECT_FALSE(TransferManifest::parseManifestLine("# comment", error));
+        EXPECT_TRUE(error.empty());
+    }
+
+    G_SUBTEST << "Invalid lines";
+    {
+        EXPECT_FALSE(TransferManifest::parseManifestLine("get\t/remote/file", error));
+        EXPECT_FALSE(error.empty());
+        EXPECT_FALSE(TransferManifest::parseManifestLine("copy\ta\tb", error));
+        EXPECT_FALSE(error.empty());
+    }
+}
+
+TEST_F(TransferManifestTest, resumeFromJournal)
+{
+    {
+        auto manifest = TransferManifest::create(mJournalPath, makeItems());
+        ASSERT_TRUE(manifest);
+        manifest->markDone(0);
+        manifest->markFailed(2, -9);
+    }
+
+    G_SUBTEST << "Completed items are skipped and failed ones retried";
+    {
+        auto manifest = TransferManifest::load(mJournalPath);
+        ASSERT_TRUE(manifest);
+        EXPECT_EQ(manifest->getUnfinishedItems(), (std::vector<size_t>{1, 2}));
+        EXPECT_EQ(manifest->getItem(1).mSource, "/local/with\\backslash");
+        EXPECT_EQ(manifest->getItem(2).mErrorCode, -9);
+
+        auto counts = manifest->getCounts();
+        EXPECT_EQ(counts.mDone, 1u);
+        EXPECT_EQ(counts.mFailed, 1u);
+        EXPECT_EQ(counts.mPending, 1u);
+
+        manifest->markDone(1);
+    }
+
+    G_SUBTEST << "A record interrupted while being written is ignored";
+    {
+        std::ofstream(mJournalPath, std::ios::app) << "D\t2";
+
+        auto manifest = TransferManifest::load(mJournalPath);
+        ASSERT_TRUE(manifest);
+        EXPECT_EQ(manifest->getUnfinishedItems(), (std::vector<size_t>{2}));
+    }
+
+    G_SUBTEST << "Not a journal";
+    {
+        std::ofstream(mJournalPath, std::ios::trunc) << "something else\n";
+        EXPECT_FALSE(TransferManifest::load(mJournalPath));
+    }
+}